@@ -0,0 +1,66 @@
+# Compiles the GLSL shaders, optimizes and strips the SPIR-V, and writes it both as .spv
+# files and as Shaders.h, which MinimalVulkan.c embeds when it exists.
+# Needs glslangValidator and spirv-opt from the Vulkan SDK on the PATH.
+#
+# Run it before building, e.g. as a pre-build event. For hot-swapping, point it at the
+# directory passed to --shader-dir while the app is running:
+#   .\CompileShaders.ps1 -SpirvDirectory C:\shaders
+
+param(
+    [string]$SpirvDirectory = $PSScriptRoot,
+    [string]$HeaderPath = (Join-Path $PSScriptRoot "Shaders.h")
+)
+
+$ErrorActionPreference = "Stop"
+
+# Name must match the SHADER_SPIRV entries in MinimalVulkan.c
+$Shaders = @(
+    @{ Source = "VertexShader.glsl";           Stage = "vert"; Output = "vert.spv";              Name = "SceneVertex" },
+    @{ Source = "FragmentShader.glsl";         Stage = "frag"; Output = "frag.spv";              Name = "SceneFragment" },
+    @{ Source = "VertexPullingShader.glsl";    Stage = "vert"; Output = "vert_pulling.spv";      Name = "SceneVertexPulling" },
+    @{ Source = "ParticleSimulateShader.glsl"; Stage = "comp"; Output = "particle_simulate.spv"; Name = "ParticleSimulate" },
+    @{ Source = "ParticleEmitShader.glsl";     Stage = "comp"; Output = "particle_emit.spv";     Name = "ParticleEmit" },
+    @{ Source = "ParticleVertexShader.glsl";   Stage = "vert"; Output = "particle_vert.spv";     Name = "ParticleVertex" },
+    @{ Source = "ParticleFragmentShader.glsl"; Stage = "frag"; Output = "particle_frag.spv";     Name = "ParticleFragment" }
+)
+
+New-Item -ItemType Directory -Force -Path $SpirvDirectory | Out-Null
+
+$Header = [System.Text.StringBuilder]::new()
+[void]$Header.AppendLine("// generated by CompileShaders.ps1, do not edit")
+[void]$Header.AppendLine("#pragma once")
+[void]$Header.AppendLine()
+
+foreach ($Shader in $Shaders)
+{
+    $SourcePath = Join-Path $PSScriptRoot $Shader.Source
+    $OutputPath = Join-Path $SpirvDirectory $Shader.Output
+    $UnoptimizedPath = "$OutputPath.unoptimized"
+
+    & glslangValidator -V --target-env vulkan1.2 -S $Shader.Stage -o $UnoptimizedPath $SourcePath
+    if ($LASTEXITCODE -ne 0) { throw "glslangValidator failed on $($Shader.Source)" }
+
+    # -O is the performance recipe; the strip passes drop names, line info and reflection
+    # data the driver never looks at
+    & spirv-opt -O --strip-debug --strip-nonsemantic $UnoptimizedPath -o $OutputPath
+    if ($LASTEXITCODE -ne 0) { throw "spirv-opt failed on $($Shader.Source)" }
+
+    Remove-Item $UnoptimizedPath
+
+    $Bytes = [System.IO.File]::ReadAllBytes($OutputPath)
+    $Words = for ($i = 0; $i -lt $Bytes.Length; $i += 4) { "0x{0:x8}" -f [System.BitConverter]::ToUInt32($Bytes, $i) }
+
+    # uint32_t elements give vkCreateShaderModule the 4 byte alignment it requires
+    [void]$Header.AppendLine("static const uint32_t $($Shader.Name)Spirv[] = {")
+
+    for ($i = 0; $i -lt $Words.Count; $i += 8)
+    {
+        $Line = ($Words[$i..([Math]::Min($i + 7, $Words.Count - 1))] -join ", ")
+        [void]$Header.AppendLine("`t$Line,")
+    }
+
+    [void]$Header.AppendLine("};")
+    [void]$Header.AppendLine()
+}
+
+[System.IO.File]::WriteAllText($HeaderPath, $Header.ToString())
@@ -1,5 +1,8 @@
 #version 450
 
+layout(constant_id = 0) const bool TEXTURED = true;
+layout(constant_id = 1) const int OPACITY = 100;
+
 layout(binding = 1) uniform sampler2D texSampler;
 
 layout(location = 0) in vec3 fragColor;
@@ -8,5 +11,6 @@ layout(location = 1) in vec2 fragTexCoord;
 layout(location = 0) out vec4 outColor;
 
 void main() {
-    outColor = texture(texSampler, fragTexCoord);
+    vec4 color = TEXTURED ? texture(texSampler, fragTexCoord) : vec4(fragColor, 1.0);
+    outColor = vec4(color.rgb, color.a * (OPACITY / 100.0));
 }
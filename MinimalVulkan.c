@@ -1,1684 +1,10528 @@
-/*
-* (C) 2025 badasahog. All Rights Reserved
-*
-* The above copyright notice shall be included in
-* all copies or substantial portions of the Software.
-*
-* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
-* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
-* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
-* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
-* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
-* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
-* DEALINGS IN THE SOFTWARE.
-*/
-
-#define WIN32_LEAN_AND_MEAN
-#define _CRT_SECURE_NO_WARNINGS
-#include <windows.h>
-#undef _CRT_SECURE_NO_WARNINGS
-
-#define VK_USE_PLATFORM_WIN32_KHR
-#include <vulkan/vulkan.h>
-
-#include <cglm/cglm.h>
-#include <cglm/struct.h>
-#include <cglm/call.h>
-#include <cglm/cam.h>
-#include <cglm/clipspace/persp_rh_zo.h>
-
-#include <stdint.h>
-#include <stdbool.h>
-#include <stdalign.h>
-
-__declspec(dllexport) DWORD NvOptimusEnablement = 1;
-__declspec(dllexport) int AmdPowerXpressRequestHighPerformance = 1;
-
-HANDLE ConsoleHandle;
-
-inline void THROW_ON_FAIL_IMPL(HRESULT hr, int line)
-{
-	if (FAILED(hr))
-	{
-		LPWSTR messageBuffer;
-		DWORD formattedErrorLength = FormatMessageW(
-			FORMAT_MESSAGE_ALLOCATE_BUFFER | FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS,
-			NULL,
-			hr,
-			MAKELANGID(LANG_ENGLISH, SUBLANG_ENGLISH_US),
-			(LPWSTR)&messageBuffer,
-			0,
-			NULL
-		);
-
-		if (formattedErrorLength == 0)
-			WriteConsoleA(ConsoleHandle, "an error occured, unable to retrieve error message\n", 51, NULL, NULL);
-		else
-		{
-			WriteConsoleA(ConsoleHandle, "an error occured: ", 18, NULL, NULL);
-			WriteConsoleW(ConsoleHandle, messageBuffer, formattedErrorLength, NULL, NULL);
-			WriteConsoleA(ConsoleHandle, "\n", 1, NULL, NULL);
-			LocalFree(messageBuffer);
-		}
-
-		char buffer[50];
-		int stringlength = _snprintf_s(buffer, 50, _TRUNCATE, "error code: 0x%X\nlocation:line %i\n", hr, line);
-		WriteConsoleA(ConsoleHandle, buffer, stringlength, NULL, NULL);
-
-		RaiseException(0, EXCEPTION_NONCONTINUABLE, 0, NULL);
-	}
-}
-
-void THROW_ON_FAIL_VK_IMPL(VkResult Result, int line)
-{
-	if (Result < VK_SUCCESS)
-	{
-		char buffer[50];
-		int stringlength = _snprintf_s(buffer, 50, _TRUNCATE, "Vulkan Error: %i\nlocation:line %i\n", Result, line);
-		WriteConsoleA(ConsoleHandle, buffer, stringlength, NULL, NULL);
-
-		RaiseException(0, EXCEPTION_NONCONTINUABLE, 0, NULL);
-	}
-}
-
-#define THROW_ON_FAIL(x) THROW_ON_FAIL_IMPL(x, __LINE__)
-
-#define THROW_ON_FAIL_VK(x) THROW_ON_FAIL_VK_IMPL(x, __LINE__)
-
-#define THROW_ON_FALSE(x) if((x) == FALSE) THROW_ON_FAIL(HRESULT_FROM_WIN32(GetLastError()))
-
-#define VALIDATE_HANDLE(x) if((x) == NULL || (x) == INVALID_HANDLE_VALUE) THROW_ON_FAIL(HRESULT_FROM_WIN32(GetLastError()))
-
-void FailFastWithMessage(const char* Message)
-{
-	WriteConsoleA(ConsoleHandle, Message, strlen(Message), NULL, NULL);
-	RaiseException(0, EXCEPTION_NONCONTINUABLE, 0, NULL);
-}
-
-LRESULT CALLBACK PreInitProc(HWND hwnd, UINT message, WPARAM wParam, LPARAM lParam);
-LRESULT CALLBACK IdleProc(HWND hwnd, UINT message, WPARAM wParam, LPARAM lParam);
-LRESULT CALLBACK WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam);
-
-static const UINT TEXTURE_WIDTH = 64;
-static const UINT TEXTURE_HEIGHT = 64;
-static const UINT BYTES_PER_TEXEL = 2;
-static const VkFormat IMAGE_FORMAT = VK_FORMAT_B5G6R5_UNORM_PACK16;
-
-static const LPCTSTR WindowClassName = L"MinimalVulkan";
-
-//note: these are presumptive. Not within spec (as far as I know)
-#define MAX_FRAMES_IN_FLIGHT 3
-#define MAX_SURFACE_FORMATS 32
-#define MAX_PRESENT_MODES 8
-#define SWAP_CHAIN_MAX_IMAGE_COUNT 8
-#define MAX_DEVICE_COUNT 16
-#define MAX_QUEUE_FAMILY_COUNT 16
-
-#define WM_INIT (WM_USER + 1)
-
-static const char* const VALIDATION_LAYERS[] = {
-	"VK_LAYER_KHRONOS_validation"
-};
-
-static const char* const DEVICE_EXTENSIONS[] = {
-	VK_KHR_SWAPCHAIN_EXTENSION_NAME
-};
-
-#ifdef _DEBUG
-static VKAPI_ATTR VkBool32 VKAPI_CALL DebugCallback(VkDebugUtilsMessageSeverityFlagBitsEXT MessageSeverity, VkDebugUtilsMessageTypeFlagsEXT MessageType, const VkDebugUtilsMessengerCallbackDataEXT* pCallbackData, void* pUserData)
-{
-	char buffer[512];
-	int stringlength = _snprintf_s(buffer, sizeof(buffer), _TRUNCATE, "validation layer: %s\n", pCallbackData->pMessage);
-	WriteConsoleA(ConsoleHandle, buffer, stringlength, NULL, NULL);
-	return VK_FALSE;
-}
-
-void DestroyDebugUtilsMessengerEXT(VkInstance VulkanInstance, VkDebugUtilsMessengerEXT DebugMessenger, const VkAllocationCallbacks* pAllocator)
-{
-	PFN_vkDestroyDebugUtilsMessengerEXT Func = vkGetInstanceProcAddr(VulkanInstance, "vkDestroyDebugUtilsMessengerEXT");
-	if (Func)
-	{
-		Func(VulkanInstance, DebugMessenger, pAllocator);
-	}
-}
-#endif
-
-struct QueueFamilyIndices
-{
-	uint32_t GraphicsFamily;
-	uint32_t PresentFamily;
-};
-
-struct Vertex
-{
-	vec3 Pos;
-	vec3 Color;
-	vec2 TexCoord;
-};
-
-struct UniformBufferObject
-{
-	alignas(16) mat4 Model;
-	alignas(16) mat4 View;
-	alignas(16) mat4 Proj;
-};
-
-static const struct Vertex Vertices[] = {
-	{{-0.5f, -0.5f, 0.0f}, {1.0f, 0.0f, 0.0f}, {1.0f, 0.0f}},
-	{{0.5f, -0.5f, 0.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f}},
-	{{0.5f, 0.5f, 0.0f}, {0.0f, 0.0f, 1.0f}, {0.0f, 1.0f}},
-	{{-0.5f, 0.5f, 0.0f}, {1.0f, 1.0f, 1.0f}, {1.0f, 1.0f}},
-
-	{{-0.5f, -0.5f, -0.5f}, {1.0f, 0.0f, 0.0f}, {1.0f, 0.0f}},
-	{{0.5f, -0.5f, -0.5f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f}},
-	{{0.5f, 0.5f, -0.5f}, {0.0f, 0.0f, 1.0f}, {0.0f, 1.0f}},
-	{{-0.5f, 0.5f, -0.5f}, {1.0f, 1.0f, 1.0f}, {1.0f, 1.0f}}
-};
-
-static const uint16_t Indices[] = {
-	0, 1, 2, 2, 3, 0,
-	4, 5, 6, 6, 7, 4
-};
-
-struct VulkanObjects
-{
-#ifdef _DEBUG
-	VkDebugUtilsMessengerEXT DebugMessenger;
-#endif
-	VkSurfaceKHR Surface;
-
-	VkFormat DepthFormat;
-
-	VkPhysicalDevice PhysicalDevice;
-	VkDevice Device;
-
-	struct QueueFamilyIndices QueueFamilyIndices;
-
-
-	VkQueue PresentQueue;
-	VkQueue GraphicsQueue;
-
-	uint32_t SwapChainImageCount;
-
-	VkSurfaceCapabilitiesKHR SurfaceCapabilities;
-	VkSwapchainKHR SwapChain;
-	VkImage SwapChainImages[SWAP_CHAIN_MAX_IMAGE_COUNT];
-	VkSurfaceFormatKHR SwapChainImageFormat;
-	VkPresentModeKHR SwapChainPresentMode;
-	VkExtent2D SwapChainExtent;
-	VkImageView SwapChainImageViews[SWAP_CHAIN_MAX_IMAGE_COUNT];
-	VkFramebuffer SwapChainFramebuffers[SWAP_CHAIN_MAX_IMAGE_COUNT];
-
-	VkRenderPass RenderPass;
-	VkPipelineLayout PipelineLayout;
-	VkPipeline GraphicsPipeline;
-
-	VkImage DepthImage;
-	VkDeviceMemory DepthImageMemory;
-	VkImageView DepthImageView;
-
-	VkBuffer VertexBuffer;
-	VkDeviceMemory VertexBufferMemory;
-	VkBuffer IndexBuffer;
-	VkDeviceMemory IndexBufferMemory;
-
-	void* UniformBuffersMapped[MAX_FRAMES_IN_FLIGHT];
-
-	VkDescriptorSet DescriptorSets[MAX_FRAMES_IN_FLIGHT];
-
-	VkCommandBuffer CommandBuffers[MAX_FRAMES_IN_FLIGHT];
-
-	VkSemaphore ImageAvailableSemaphores[MAX_FRAMES_IN_FLIGHT];
-	VkSemaphore RenderFinishedSemaphores[MAX_FRAMES_IN_FLIGHT];
-	VkFence InFlightFences[MAX_FRAMES_IN_FLIGHT];
-};
-
-uint32_t ClampU32(uint32_t value, uint32_t min, uint32_t max)
-{
-	if (value < min)
-	{
-		return min;
-	}
-	else if (value > max)
-	{
-		return max;
-	}
-	return value;
-}
-
-VkCommandBuffer BeginSingleTimeCommands(VkDevice Device, VkCommandPool CommandPool)
-{
-	VkCommandBuffer CommandBuffer;
-
-	{
-		VkCommandBufferAllocateInfo AllocInfo = { 0 };
-		AllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-		AllocInfo.commandPool = CommandPool;
-		AllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-		AllocInfo.commandBufferCount = 1;
-		vkAllocateCommandBuffers(Device, &AllocInfo, &CommandBuffer);
-	}
-
-	{
-		VkCommandBufferBeginInfo BeginInfo = { 0 };
-		BeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-		BeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-		vkBeginCommandBuffer(CommandBuffer, &BeginInfo);
-	}
-
-	return CommandBuffer;
-}
-
-void EndSingleTimeCommands(VkDevice Device, VkCommandPool CommandPool, VkQueue GraphicsQueue, VkCommandBuffer CommandBuffer)
-{
-	vkEndCommandBuffer(CommandBuffer);
-
-	{
-		VkSubmitInfo SubmitInfo = { 0 };
-		SubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-		SubmitInfo.commandBufferCount = 1;
-		SubmitInfo.pCommandBuffers = &CommandBuffer;
-		vkQueueSubmit(GraphicsQueue, 1, &SubmitInfo, VK_NULL_HANDLE);
-	}
-
-	vkQueueWaitIdle(GraphicsQueue);
-
-	vkFreeCommandBuffers(Device, CommandPool, 1, &CommandBuffer);
-}
-
-uint32_t FindMemoryType(VkPhysicalDevice PhysicalDevice, uint32_t TypeFilter, VkMemoryPropertyFlags Properties)
-{
-	VkPhysicalDeviceMemoryProperties MemProperties;
-	vkGetPhysicalDeviceMemoryProperties(PhysicalDevice, &MemProperties);
-
-	for (int i = 0; i < MemProperties.memoryTypeCount; i++) {
-		if ((TypeFilter & (1 << i)) && (MemProperties.memoryTypes[i].propertyFlags & Properties) == Properties) {
-			return i;
-		}
-	}
-
-	FailFastWithMessage("failed to find suitable memory type!");
-}
-
-void CreateBuffer(VkPhysicalDevice PhysicalDevice, VkDevice Device, VkDeviceSize Size, VkBufferUsageFlags Usage, VkMemoryPropertyFlags Properties, VkBuffer* Buffer, VkDeviceMemory* BufferMemory)
-{
-	{
-		VkBufferCreateInfo BufferInfo = { 0 };
-		BufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-		BufferInfo.size = Size;
-		BufferInfo.usage = Usage;
-		BufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-		THROW_ON_FAIL_VK(vkCreateBuffer(Device, &BufferInfo, NULL, Buffer));
-	}
-
-	{
-		VkMemoryRequirements MemRequirements;
-		vkGetBufferMemoryRequirements(Device, *Buffer, &MemRequirements);
-
-		VkMemoryAllocateInfo AllocInfo = { 0 };
-		AllocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-		AllocInfo.allocationSize = MemRequirements.size;
-		AllocInfo.memoryTypeIndex = FindMemoryType(PhysicalDevice, MemRequirements.memoryTypeBits, Properties);
-		THROW_ON_FAIL_VK(vkAllocateMemory(Device, &AllocInfo, NULL, BufferMemory));
-	}
-
-	vkBindBufferMemory(Device, *Buffer, *BufferMemory, 0);
-}
-
-int main()
-{
-	ConsoleHandle = GetStdHandle(STD_OUTPUT_HANDLE);
-
-	HINSTANCE Instance = GetModuleHandleW(NULL);
-
-	HICON Icon = LoadIconW(NULL, IDI_APPLICATION);
-	HCURSOR Cursor = LoadCursorW(NULL, IDC_ARROW);
-
-	WNDCLASSEXW WindowClass = { 0 };
-	WindowClass.cbSize = sizeof(WNDCLASSEXW);
-	WindowClass.style = CS_HREDRAW | CS_VREDRAW;
-	WindowClass.lpfnWndProc = PreInitProc;
-	WindowClass.cbClsExtra = 0;
-	WindowClass.cbWndExtra = 0;
-	WindowClass.hInstance = Instance;
-	WindowClass.hIcon = Icon;
-	WindowClass.hCursor = Cursor;
-	WindowClass.hbrBackground = (HBRUSH)(COLOR_WINDOW + 2);
-	WindowClass.lpszMenuName = NULL;
-	WindowClass.lpszClassName = WindowClassName;
-	WindowClass.hIconSm = Icon;
-
-	ATOM WindowClassAtom = RegisterClassExW(&WindowClass);
-	if (WindowClassAtom == 0)
-		THROW_ON_FAIL(HRESULT_FROM_WIN32(GetLastError()));
-
-	RECT WindowRect = { 0 };
-	WindowRect.left = 0;
-	WindowRect.top = 0;
-	WindowRect.right = 800;
-	WindowRect.bottom = 600;
-
-	THROW_ON_FALSE(AdjustWindowRect(&WindowRect, WS_OVERLAPPEDWINDOW, FALSE));
-
-	HWND Window = CreateWindowExW(
-		0,
-		WindowClassName,
-		L"Minimal Vulkan",
-		WS_OVERLAPPEDWINDOW,
-		CW_USEDEFAULT,
-		CW_USEDEFAULT,
-		WindowRect.right - WindowRect.left,
-		WindowRect.bottom - WindowRect.top,
-		NULL,
-		NULL,
-		Instance,
-		NULL);
-
-	VALIDATE_HANDLE(Window);
-
-	THROW_ON_FALSE(ShowWindow(Window, SW_SHOW));
-
-	VkInstance VulkanInstance;
-
-	{
-		VkApplicationInfo AppInfo = { 0 };
-		AppInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
-		AppInfo.pApplicationName = "Hello Triangle";
-		AppInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
-		AppInfo.pEngineName = "No Engine";
-		AppInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-		AppInfo.apiVersion = VK_API_VERSION_1_0;
-
-		static const char* const Extensions[] =
-		{
-			"VK_KHR_surface",
-			"VK_KHR_win32_surface",
-#ifdef _DEBUG
-			VK_EXT_DEBUG_UTILS_EXTENSION_NAME
-#endif
-		};
-
-#ifdef _DEBUG
-		VkDebugUtilsMessengerCreateInfoEXT DebugCreateInfo = { 0 };
-		DebugCreateInfo.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT;
-		DebugCreateInfo.messageSeverity = VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT;
-		DebugCreateInfo.messageType = VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT;
-		DebugCreateInfo.pfnUserCallback = DebugCallback;
-#endif
-
-		VkInstanceCreateInfo CreateInfo = { 0 };
-		CreateInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
-		CreateInfo.pApplicationInfo = &AppInfo;
-		CreateInfo.enabledExtensionCount = ARRAYSIZE(Extensions);
-		CreateInfo.ppEnabledExtensionNames = Extensions;
-
-#ifdef _DEBUG
-		CreateInfo.pNext = &DebugCreateInfo;
-		CreateInfo.enabledLayerCount = ARRAYSIZE(VALIDATION_LAYERS);
-		CreateInfo.ppEnabledLayerNames = VALIDATION_LAYERS;
-#else
-		CreateInfo.pNext = NULL;
-		CreateInfo.enabledLayerCount = 0;
-#endif
-
-		THROW_ON_FAIL_VK(vkCreateInstance(&CreateInfo, NULL, &VulkanInstance));
-	}
-
-	struct VulkanObjects VulkanObjects = { 0 };
-
-#ifdef _DEBUG
-	PFN_vkCreateDebugUtilsMessengerEXT CallbackFunction = vkGetInstanceProcAddr(VulkanInstance, "vkCreateDebugUtilsMessengerEXT");
-	if (CallbackFunction)
-	{
-		VkDebugUtilsMessengerCreateInfoEXT CreateInfo = { 0 };
-		CreateInfo.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT;
-		CreateInfo.messageSeverity = VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT;
-		CreateInfo.messageType = VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT;
-		CreateInfo.pfnUserCallback = DebugCallback;
-		THROW_ON_FAIL_VK(CallbackFunction(VulkanInstance, &CreateInfo, NULL, &VulkanObjects.DebugMessenger));
-	}
-	else
-	{
-		THROW_ON_FAIL_VK(VK_ERROR_EXTENSION_NOT_PRESENT);
-	}
-#endif
-
-	{
-		VkWin32SurfaceCreateInfoKHR CreateInfo = { 0 };
-		CreateInfo.sType = VK_STRUCTURE_TYPE_WIN32_SURFACE_CREATE_INFO_KHR;
-		CreateInfo.hinstance = Instance;
-		CreateInfo.hwnd = Window;
-		THROW_ON_FAIL_VK(vkCreateWin32SurfaceKHR(VulkanInstance, &CreateInfo, NULL, &VulkanObjects.Surface));
-	}
-
-	{
-		uint32_t DeviceCount = 0;
-		vkEnumeratePhysicalDevices(VulkanInstance, &DeviceCount, NULL);
-		VkPhysicalDevice Devices[MAX_DEVICE_COUNT];
-
-		vkEnumeratePhysicalDevices(VulkanInstance, &DeviceCount, Devices);
-
-		// are devices organized in any kind of order? just pick the first one
-		VulkanObjects.PhysicalDevice = Devices[0];
-	}
-
-	{
-		uint32_t QueueFamilyCount = 0;
-		vkGetPhysicalDeviceQueueFamilyProperties(VulkanObjects.PhysicalDevice, &QueueFamilyCount, NULL);
-
-		VkQueueFamilyProperties QueueFamilies[MAX_QUEUE_FAMILY_COUNT];
-		vkGetPhysicalDeviceQueueFamilyProperties(VulkanObjects.PhysicalDevice, &QueueFamilyCount, QueueFamilies);
-
-		bool HasGraphics = false;
-		bool HasPresent = false;
-
-		for (int i = 0; i < QueueFamilyCount; i++)
-		{
-			if (QueueFamilies[i].queueFlags & VK_QUEUE_GRAPHICS_BIT)
-			{
-				VulkanObjects.QueueFamilyIndices.GraphicsFamily = i;
-				HasGraphics = true;
-			}
-
-			VkBool32 PresentSupport = false;
-			vkGetPhysicalDeviceSurfaceSupportKHR(VulkanObjects.PhysicalDevice, i, VulkanObjects.Surface, &PresentSupport);
-
-			if (PresentSupport)
-			{
-				VulkanObjects.QueueFamilyIndices.PresentFamily = i;
-				HasPresent = true;
-			}
-
-			if (HasGraphics && HasPresent)
-			{
-				break;
-			}
-		}
-	}
-
-	{
-		float QueuePriority = 1.0f;
-
-		uint32_t UniqueQueueFamilies[2] = { 0 };
-
-		UniqueQueueFamilies[0] = VulkanObjects.QueueFamilyIndices.GraphicsFamily;
-
-		if (VulkanObjects.QueueFamilyIndices.PresentFamily != VulkanObjects.QueueFamilyIndices.GraphicsFamily)
-		{
-			UniqueQueueFamilies[1] = VulkanObjects.QueueFamilyIndices.PresentFamily;
-		}
-
-		const int UniqueQueueFamilyCount = (VulkanObjects.QueueFamilyIndices.PresentFamily == VulkanObjects.QueueFamilyIndices.GraphicsFamily) ? 1 : 2;
-
-		VkDeviceQueueCreateInfo QueueCreateInfos[2] = { 0 };
-	
-		for (int i = 0; i < UniqueQueueFamilyCount; i++)
-		{
-			QueueCreateInfos[i].sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
-			QueueCreateInfos[i].queueFamilyIndex = UniqueQueueFamilies[i];
-			QueueCreateInfos[i].queueCount = 1;
-			QueueCreateInfos[i].pQueuePriorities = &QueuePriority;
-		}
-
-		VkPhysicalDeviceFeatures DeviceFeatures = { 0 };
-		DeviceFeatures.samplerAnisotropy = VK_TRUE;
-
-		VkDeviceCreateInfo DeviceCreationInfo = { 0 };
-		DeviceCreationInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-		DeviceCreationInfo.queueCreateInfoCount = UniqueQueueFamilyCount;
-		DeviceCreationInfo.pQueueCreateInfos = QueueCreateInfos;
-
-
-#ifdef _DEBUG
-		DeviceCreationInfo.enabledLayerCount = ARRAYSIZE(VALIDATION_LAYERS);
-		DeviceCreationInfo.ppEnabledLayerNames = VALIDATION_LAYERS;
-#else
-		DeviceCreationInfo.enabledLayerCount = 0;
-		DeviceCreationInfo.ppEnabledLayerNames = NULL;
-#endif
-
-		DeviceCreationInfo.enabledExtensionCount = ARRAYSIZE(DEVICE_EXTENSIONS);
-		DeviceCreationInfo.ppEnabledExtensionNames = DEVICE_EXTENSIONS;
-		DeviceCreationInfo.pEnabledFeatures = &DeviceFeatures;
-
-		THROW_ON_FAIL_VK(vkCreateDevice(VulkanObjects.PhysicalDevice, &DeviceCreationInfo, NULL, &VulkanObjects.Device));
-
-		vkGetDeviceQueue(VulkanObjects.Device, VulkanObjects.QueueFamilyIndices.GraphicsFamily, 0, &VulkanObjects.GraphicsQueue);
-		vkGetDeviceQueue(VulkanObjects.Device, VulkanObjects.QueueFamilyIndices.PresentFamily, 0, &VulkanObjects.PresentQueue);
-	}
-
-	vkGetPhysicalDeviceSurfaceCapabilitiesKHR(VulkanObjects.PhysicalDevice, VulkanObjects.Surface, &VulkanObjects.SurfaceCapabilities);
-
-	{
-		uint32_t SurfaceFormatCount;
-		VkSurfaceFormatKHR SurfaceFormats[MAX_SURFACE_FORMATS];
-		vkGetPhysicalDeviceSurfaceFormatsKHR(VulkanObjects.PhysicalDevice, VulkanObjects.Surface, &SurfaceFormatCount, NULL);
-		vkGetPhysicalDeviceSurfaceFormatsKHR(VulkanObjects.PhysicalDevice, VulkanObjects.Surface, &SurfaceFormatCount, SurfaceFormats);
-
-		VulkanObjects.SwapChainImageFormat = SurfaceFormats[0];
-
-		for (int i = 0; i < SurfaceFormatCount; i++)
-		{
-			if (SurfaceFormats[i].format == VK_FORMAT_B8G8R8A8_SRGB &&
-				SurfaceFormats[i].colorSpace == VK_COLOR_SPACE_SRGB_NONLINEAR_KHR)
-			{
-				VulkanObjects.SwapChainImageFormat = SurfaceFormats[i];
-				break;
-			}
-		}
-	}
-	
-	{
-		uint32_t PresentModeCount;
-		VkPresentModeKHR PresentModes[MAX_PRESENT_MODES];
-		vkGetPhysicalDeviceSurfacePresentModesKHR(VulkanObjects.PhysicalDevice, VulkanObjects.Surface, &PresentModeCount, NULL);
-		vkGetPhysicalDeviceSurfacePresentModesKHR(VulkanObjects.PhysicalDevice, VulkanObjects.Surface, &PresentModeCount, PresentModes);
-
-		VulkanObjects.SwapChainPresentMode = VK_PRESENT_MODE_FIFO_KHR;
-
-		for (int i = 0; i < PresentModeCount; i++)
-		{
-			if (PresentModes[i] == VK_PRESENT_MODE_MAILBOX_KHR)
-			{
-				VulkanObjects.SwapChainPresentMode = VK_PRESENT_MODE_MAILBOX_KHR;
-			}
-		}
-	}
-
-	VulkanObjects.SwapChainImageCount = VulkanObjects.SurfaceCapabilities.minImageCount + 1;
-
-	if (VulkanObjects.SurfaceCapabilities.maxImageCount > 0 && VulkanObjects.SwapChainImageCount > VulkanObjects.SurfaceCapabilities.maxImageCount)
-	{
-		VulkanObjects.SwapChainImageCount = VulkanObjects.SurfaceCapabilities.maxImageCount;
-	}
-
-	{
-		VkFormat Formats[] = {
-			VK_FORMAT_D32_SFLOAT,
-			VK_FORMAT_D32_SFLOAT_S8_UINT,
-			VK_FORMAT_D24_UNORM_S8_UINT
-		};
-
-		VulkanObjects.DepthFormat == VK_FORMAT_UNDEFINED;
-
-		for (int i = 0; i < ARRAYSIZE(Formats); i++) {
-			VkFormatProperties Props;
-			vkGetPhysicalDeviceFormatProperties(VulkanObjects.PhysicalDevice, Formats[i], &Props);
-
-			if ((Props.optimalTilingFeatures & VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT) == VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT)
-			{
-				VulkanObjects.DepthFormat = Formats[i];
-				break;
-			}
-		}
-
-		if (VulkanObjects.DepthFormat == VK_FORMAT_UNDEFINED)
-			FailFastWithMessage("failed to find supported format!");
-	}
-
-	{
-		VkAttachmentDescription Attachments[2] = { 0 };
-		Attachments[0].format = VulkanObjects.SwapChainImageFormat.format;
-		Attachments[0].samples = VK_SAMPLE_COUNT_1_BIT;
-		Attachments[0].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-		Attachments[0].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-		Attachments[0].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-		Attachments[0].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-		Attachments[0].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-		Attachments[0].finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-
-		Attachments[1].format = VulkanObjects.DepthFormat;
-		Attachments[1].samples = VK_SAMPLE_COUNT_1_BIT;
-		Attachments[1].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-		Attachments[1].storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-		Attachments[1].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-		Attachments[1].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-		Attachments[1].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-		Attachments[1].finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-
-		VkAttachmentReference ColorAttachmentRef = { 0 };
-		ColorAttachmentRef.attachment = 0;
-		ColorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-
-		VkAttachmentReference DepthAttachmentRef = { 0 };
-		DepthAttachmentRef.attachment = 1;
-		DepthAttachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-
-		VkSubpassDescription Subpass = { 0 };
-		Subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-		Subpass.colorAttachmentCount = 1;
-		Subpass.pColorAttachments = &ColorAttachmentRef;
-		Subpass.pDepthStencilAttachment = &DepthAttachmentRef;
-
-		VkSubpassDependency Dependency = { 0 };
-		Dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-		Dependency.dstSubpass = 0;
-		Dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
-		Dependency.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-		Dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-		Dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-
-		VkRenderPassCreateInfo RenderPassInfo = { 0 };
-		RenderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-		RenderPassInfo.attachmentCount = ARRAYSIZE(Attachments);
-		RenderPassInfo.pAttachments = Attachments;
-		RenderPassInfo.subpassCount = 1;
-		RenderPassInfo.pSubpasses = &Subpass;
-		RenderPassInfo.dependencyCount = 1;
-		RenderPassInfo.pDependencies = &Dependency;
-
-		THROW_ON_FAIL_VK(vkCreateRenderPass(VulkanObjects.Device, &RenderPassInfo, NULL, &VulkanObjects.RenderPass));
-	}
-
-	VkDescriptorSetLayout DescriptorSetLayout;
-
-	{
-		VkDescriptorSetLayoutBinding Bindings[2] = { 0 };
-		Bindings[0].binding = 0;
-		Bindings[0].descriptorCount = 1;
-		Bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-		Bindings[0].pImmutableSamplers = NULL;
-		Bindings[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
-
-		Bindings[1].binding = 1;
-		Bindings[1].descriptorCount = 1;
-		Bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-		Bindings[1].pImmutableSamplers = NULL;
-		Bindings[1].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-
-		VkDescriptorSetLayoutCreateInfo LayoutInfo = { 0 };
-		LayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-		LayoutInfo.bindingCount = ARRAYSIZE(Bindings);
-		LayoutInfo.pBindings = Bindings;
-
-		THROW_ON_FAIL_VK(vkCreateDescriptorSetLayout(VulkanObjects.Device, &LayoutInfo, NULL, &DescriptorSetLayout));
-	}
-
-	{
-		VkShaderModule VertexShaderModule;
-		{
-			HANDLE VertexShaderFile = CreateFileW(L"vert.spv", GENERIC_READ, 0, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
-			VALIDATE_HANDLE(VertexShaderFile);
-
-			SIZE_T VertexShaderSize;
-			THROW_ON_FALSE(GetFileSizeEx(VertexShaderFile, &VertexShaderSize));
-
-			HANDLE VertexShaderFileMap = CreateFileMappingW(VertexShaderFile, NULL, PAGE_READONLY, 0, 0, NULL);
-			VALIDATE_HANDLE(VertexShaderFileMap);
-
-			const void* VertexShaderBytecode = MapViewOfFile(VertexShaderFileMap, FILE_MAP_READ, 0, 0, 0);
-
-			VkShaderModuleCreateInfo CreateInfo = { 0 };
-			CreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-			CreateInfo.codeSize = VertexShaderSize;
-			CreateInfo.pCode = VertexShaderBytecode;
-
-			THROW_ON_FAIL_VK(vkCreateShaderModule(VulkanObjects.Device, &CreateInfo, NULL, &VertexShaderModule));
-
-			THROW_ON_FALSE(UnmapViewOfFile(VertexShaderBytecode));
-			THROW_ON_FALSE(CloseHandle(VertexShaderFileMap));
-			THROW_ON_FALSE(CloseHandle(VertexShaderFile));
-		}
-
-		VkShaderModule FragmentShaderModule;
-		{
-			HANDLE FragmentShaderFile = CreateFileW(L"frag.spv", GENERIC_READ, 0, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
-			VALIDATE_HANDLE(FragmentShaderFile);
-
-			SIZE_T FragmentShaderSize;
-			THROW_ON_FALSE(GetFileSizeEx(FragmentShaderFile, &FragmentShaderSize));
-
-			HANDLE FragmentShaderFileMap = CreateFileMappingW(FragmentShaderFile, NULL, PAGE_READONLY, 0, 0, NULL);
-			VALIDATE_HANDLE(FragmentShaderFileMap);
-
-			const void* FragmentShaderBytecode = MapViewOfFile(FragmentShaderFileMap, FILE_MAP_READ, 0, 0, 0);
-
-			VkShaderModuleCreateInfo createInfo = { 0 };
-			createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-			createInfo.codeSize = FragmentShaderSize;
-			createInfo.pCode = FragmentShaderBytecode;
-
-			THROW_ON_FAIL_VK(vkCreateShaderModule(VulkanObjects.Device, &createInfo, NULL, &FragmentShaderModule));
-
-			THROW_ON_FALSE(UnmapViewOfFile(FragmentShaderBytecode));
-			THROW_ON_FALSE(CloseHandle(FragmentShaderFileMap));
-			THROW_ON_FALSE(CloseHandle(FragmentShaderFile));
-		}
-
-		VkPipelineShaderStageCreateInfo ShaderStages[2] = { 0 };
-		ShaderStages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-		ShaderStages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
-		ShaderStages[0].module = VertexShaderModule;
-		ShaderStages[0].pName = "main";
-		
-		ShaderStages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-		ShaderStages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-		ShaderStages[1].module = FragmentShaderModule;
-		ShaderStages[1].pName = "main";
-		
-		VkVertexInputBindingDescription BindingDescription = { 0 };
-		BindingDescription.binding = 0;
-		BindingDescription.stride = sizeof(struct Vertex);
-		BindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-
-		VkVertexInputAttributeDescription AttributeDescriptions[3] = { 0 };
-		AttributeDescriptions[0].binding = 0;
-		AttributeDescriptions[0].location = 0;
-		AttributeDescriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
-		AttributeDescriptions[0].offset = offsetof(struct Vertex, Pos);
-
-		AttributeDescriptions[1].binding = 0;
-		AttributeDescriptions[1].location = 1;
-		AttributeDescriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT;
-		AttributeDescriptions[1].offset = offsetof(struct Vertex, Color);
-
-		AttributeDescriptions[2].binding = 0;
-		AttributeDescriptions[2].location = 2;
-		AttributeDescriptions[2].format = VK_FORMAT_R32G32_SFLOAT;
-		AttributeDescriptions[2].offset = offsetof(struct Vertex, TexCoord);
-
-		VkPipelineVertexInputStateCreateInfo VertexInputInfo = { 0 };
-		VertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-		VertexInputInfo.vertexBindingDescriptionCount = 1;
-		VertexInputInfo.pVertexBindingDescriptions = &BindingDescription;
-		VertexInputInfo.vertexAttributeDescriptionCount = ARRAYSIZE(AttributeDescriptions);
-		VertexInputInfo.pVertexAttributeDescriptions = AttributeDescriptions;
-
-		VkPipelineInputAssemblyStateCreateInfo InputAssembly = { 0 };
-		InputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-		InputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-		InputAssembly.primitiveRestartEnable = VK_FALSE;
-
-		VkPipelineViewportStateCreateInfo ViewportState = { 0 };
-		ViewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-		ViewportState.viewportCount = 1;
-		ViewportState.scissorCount = 1;
-
-		VkPipelineRasterizationStateCreateInfo Rasterizer = { 0 };
-		Rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-		Rasterizer.depthClampEnable = VK_FALSE;
-		Rasterizer.rasterizerDiscardEnable = VK_FALSE;
-		Rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
-		Rasterizer.lineWidth = 1.0f;
-		Rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
-		Rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
-		Rasterizer.depthBiasEnable = VK_FALSE;
-
-		VkPipelineMultisampleStateCreateInfo Multisampling = { 0 };
-		Multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-		Multisampling.sampleShadingEnable = VK_FALSE;
-		Multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
-
-		VkPipelineDepthStencilStateCreateInfo DepthStencil = { 0 };
-		DepthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
-		DepthStencil.depthTestEnable = VK_TRUE;
-		DepthStencil.depthWriteEnable = VK_TRUE;
-		DepthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
-		DepthStencil.depthBoundsTestEnable = VK_FALSE;
-		DepthStencil.stencilTestEnable = VK_FALSE;
-
-		VkPipelineColorBlendAttachmentState ColorBlendAttachment = { 0 };
-		ColorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-		ColorBlendAttachment.blendEnable = VK_FALSE;
-
-		VkPipelineColorBlendStateCreateInfo ColorBlending = { 0 };
-		ColorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-		ColorBlending.logicOpEnable = VK_FALSE;
-		ColorBlending.logicOp = VK_LOGIC_OP_COPY;
-		ColorBlending.attachmentCount = 1;
-		ColorBlending.pAttachments = &ColorBlendAttachment;
-		ColorBlending.blendConstants[0] = 0.0f;
-		ColorBlending.blendConstants[1] = 0.0f;
-		ColorBlending.blendConstants[2] = 0.0f;
-		ColorBlending.blendConstants[3] = 0.0f;
-
-		VkDynamicState DynamicStates[] = {
-			VK_DYNAMIC_STATE_VIEWPORT,
-			VK_DYNAMIC_STATE_SCISSOR
-		};
-
-		VkPipelineDynamicStateCreateInfo DynamicState = { 0 };
-		DynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
-		DynamicState.dynamicStateCount = ARRAYSIZE(DynamicStates);
-		DynamicState.pDynamicStates = DynamicStates;
-
-		VkPipelineLayoutCreateInfo PipelineLayoutInfo = { 0 };
-		PipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-		PipelineLayoutInfo.setLayoutCount = 1;
-		PipelineLayoutInfo.pSetLayouts = &DescriptorSetLayout;
-
-		THROW_ON_FAIL_VK(vkCreatePipelineLayout(VulkanObjects.Device, &PipelineLayoutInfo, NULL, &VulkanObjects.PipelineLayout));
-
-		VkGraphicsPipelineCreateInfo PipelineInfo = { 0 };
-		PipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-		PipelineInfo.stageCount = ARRAYSIZE(ShaderStages);
-		PipelineInfo.pStages = ShaderStages;
-		PipelineInfo.pVertexInputState = &VertexInputInfo;
-		PipelineInfo.pInputAssemblyState = &InputAssembly;
-		PipelineInfo.pViewportState = &ViewportState;
-		PipelineInfo.pRasterizationState = &Rasterizer;
-		PipelineInfo.pMultisampleState = &Multisampling;
-		PipelineInfo.pDepthStencilState = &DepthStencil;
-		PipelineInfo.pColorBlendState = &ColorBlending;
-		PipelineInfo.pDynamicState = &DynamicState;
-		PipelineInfo.layout = VulkanObjects.PipelineLayout;
-		PipelineInfo.renderPass = VulkanObjects.RenderPass;
-		PipelineInfo.subpass = 0;
-		PipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
-		THROW_ON_FAIL_VK(vkCreateGraphicsPipelines(VulkanObjects.Device, VK_NULL_HANDLE, 1, &PipelineInfo, NULL, &VulkanObjects.GraphicsPipeline));
-
-		vkDestroyShaderModule(VulkanObjects.Device, FragmentShaderModule, NULL);
-		vkDestroyShaderModule(VulkanObjects.Device, VertexShaderModule, NULL);
-	}
-
-	VkCommandPool CommandPool;
-
-	{
-		VkCommandPoolCreateInfo PoolInfo = { 0 };
-		PoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-		PoolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
-		PoolInfo.queueFamilyIndex = VulkanObjects.QueueFamilyIndices.GraphicsFamily;
-		THROW_ON_FAIL_VK(vkCreateCommandPool(VulkanObjects.Device, &PoolInfo, NULL, &CommandPool));
-	}
-
-	VkImage TextureImage;
-	VkDeviceMemory TextureImageMemory;
-
-	{
-		VkDeviceSize ImageSize = TEXTURE_WIDTH * TEXTURE_HEIGHT * 4;
-
-		VkBuffer StagingBuffer;
-		VkDeviceMemory StagingBufferMemory;
-		CreateBuffer(VulkanObjects.PhysicalDevice, VulkanObjects.Device, ImageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &StagingBuffer, &StagingBufferMemory);
-
-		{
-			uint16_t* Data;
-			vkMapMemory(VulkanObjects.Device, StagingBufferMemory, 0, ImageSize, 0, &Data);
-
-			for (UINT y = 0; y < TEXTURE_HEIGHT; y++)
-			{
-				for (UINT x = 0; x < TEXTURE_WIDTH; x++)
-				{
-					Data[(y * TEXTURE_WIDTH + x) * (BYTES_PER_TEXEL / sizeof(WORD))] = x == 0 || x == (TEXTURE_WIDTH - 1) || y == 0 || y == (TEXTURE_HEIGHT - 1) ? 0b1111100000000000 : rand() * (UINT16_MAX / RAND_MAX);
-				}
-			}
-
-			vkUnmapMemory(VulkanObjects.Device, StagingBufferMemory);
-		}
-
-		{
-			VkImageCreateInfo ImageInfo = { 0 };
-			ImageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
-			ImageInfo.imageType = VK_IMAGE_TYPE_2D;
-			ImageInfo.extent.width = TEXTURE_WIDTH;
-			ImageInfo.extent.height = TEXTURE_HEIGHT;
-			ImageInfo.extent.depth = 1;
-			ImageInfo.mipLevels = 1;
-			ImageInfo.arrayLayers = 1;
-			ImageInfo.format = IMAGE_FORMAT;
-			ImageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
-			ImageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-			ImageInfo.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
-			ImageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
-			ImageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-			THROW_ON_FAIL_VK(vkCreateImage(VulkanObjects.Device, &ImageInfo, NULL, &TextureImage));
-		}
-
-		{
-			VkMemoryRequirements MemRequirements;
-			vkGetImageMemoryRequirements(VulkanObjects.Device, TextureImage, &MemRequirements);
-
-			VkMemoryAllocateInfo AllocInfo = { 0 };
-			AllocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-			AllocInfo.allocationSize = MemRequirements.size;
-			AllocInfo.memoryTypeIndex = FindMemoryType(VulkanObjects.PhysicalDevice, MemRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-			THROW_ON_FAIL_VK(vkAllocateMemory(VulkanObjects.Device, &AllocInfo, NULL, &TextureImageMemory));
-		}
-
-		vkBindImageMemory(VulkanObjects.Device, TextureImage, TextureImageMemory, 0);
-
-		{
-			VkCommandBuffer CommandBuffer = BeginSingleTimeCommands(VulkanObjects.Device, CommandPool);
-
-			{
-				VkImageMemoryBarrier Barrier = { 0 };
-				Barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-				Barrier.srcAccessMask = 0;
-				Barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-				Barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-				Barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-				Barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-				Barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-				Barrier.image = TextureImage;
-				Barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-				Barrier.subresourceRange.baseMipLevel = 0;
-				Barrier.subresourceRange.levelCount = 1;
-				Barrier.subresourceRange.baseArrayLayer = 0;
-				Barrier.subresourceRange.layerCount = 1;
-				vkCmdPipelineBarrier(
-					CommandBuffer,
-					VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-					VK_PIPELINE_STAGE_TRANSFER_BIT,
-					0,
-					0,
-					NULL,
-					0,
-					NULL,
-					1,
-					&Barrier
-				);
-			}
-
-			{
-				VkBufferImageCopy Region = { 0 };
-				Region.bufferOffset = 0;
-				Region.bufferRowLength = 0;
-				Region.bufferImageHeight = 0;
-				Region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-				Region.imageSubresource.mipLevel = 0;
-				Region.imageSubresource.baseArrayLayer = 0;
-				Region.imageSubresource.layerCount = 1;
-				Region.imageOffset.x = 0;
-				Region.imageOffset.y = 0;
-				Region.imageOffset.z = 0;
-				Region.imageExtent.width = TEXTURE_WIDTH;
-				Region.imageExtent.height = TEXTURE_HEIGHT;
-				Region.imageExtent.depth = 1;
-				vkCmdCopyBufferToImage(CommandBuffer, StagingBuffer, TextureImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &Region);
-			}
-
-			{
-				VkImageMemoryBarrier Barrier = { 0 };
-				Barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-				Barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-				Barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-				Barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-				Barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-				Barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-				Barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-				Barrier.image = TextureImage;
-				Barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-				Barrier.subresourceRange.baseMipLevel = 0;
-				Barrier.subresourceRange.levelCount = 1;
-				Barrier.subresourceRange.baseArrayLayer = 0;
-				Barrier.subresourceRange.layerCount = 1;
-
-				vkCmdPipelineBarrier(
-					CommandBuffer,
-					VK_PIPELINE_STAGE_TRANSFER_BIT,
-					VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-					0,
-					0,
-					NULL,
-					0,
-					NULL,
-					1,
-					&Barrier
-				);
-			}
-
-			EndSingleTimeCommands(VulkanObjects.Device, CommandPool, VulkanObjects.GraphicsQueue, CommandBuffer);
-		}
-
-		vkDestroyBuffer(VulkanObjects.Device, StagingBuffer, NULL);
-		vkFreeMemory(VulkanObjects.Device, StagingBufferMemory, NULL);
-	}
-
-	VkImageView TextureImageView;
-
-	{
-		VkImageViewCreateInfo ViewInfo = { 0 };
-		ViewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-		ViewInfo.image = TextureImage;
-		ViewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
-		ViewInfo.format = IMAGE_FORMAT;
-		ViewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-		ViewInfo.subresourceRange.baseMipLevel = 0;
-		ViewInfo.subresourceRange.levelCount = 1;
-		ViewInfo.subresourceRange.baseArrayLayer = 0;
-		ViewInfo.subresourceRange.layerCount = 1;
-		THROW_ON_FAIL_VK(vkCreateImageView(VulkanObjects.Device, &ViewInfo, NULL, &TextureImageView));
-	}
-
-	VkSampler TextureSampler;
-
-	{
-		VkPhysicalDeviceProperties DeviceProperties = { 0 };
-		vkGetPhysicalDeviceProperties(VulkanObjects.PhysicalDevice, &DeviceProperties);
-
-		VkSamplerCreateInfo SamplerInfo = { 0 };
-		SamplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
-		SamplerInfo.magFilter = VK_FILTER_LINEAR;
-		SamplerInfo.minFilter = VK_FILTER_LINEAR;
-		SamplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-		SamplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-		SamplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-		SamplerInfo.anisotropyEnable = VK_TRUE;
-		SamplerInfo.maxAnisotropy = DeviceProperties.limits.maxSamplerAnisotropy;
-		SamplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
-		SamplerInfo.unnormalizedCoordinates = VK_FALSE;
-		SamplerInfo.compareEnable = VK_FALSE;
-		SamplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
-		SamplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
-		THROW_ON_FAIL_VK(vkCreateSampler(VulkanObjects.Device, &SamplerInfo, NULL, &TextureSampler));
-	}
-
-	{
-		VkBuffer StagingBuffer;
-		VkDeviceMemory stagingBufferMemory;
-		CreateBuffer(VulkanObjects.PhysicalDevice, VulkanObjects.Device, sizeof(Vertices), VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &StagingBuffer, &stagingBufferMemory);
-
-		void* Data;
-		vkMapMemory(VulkanObjects.Device, stagingBufferMemory, 0, sizeof(Vertices), 0, &Data);
-		memcpy(Data, Vertices, sizeof(Vertices));
-		vkUnmapMemory(VulkanObjects.Device, stagingBufferMemory);
-
-		CreateBuffer(VulkanObjects.PhysicalDevice, VulkanObjects.Device, sizeof(Vertices), VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &VulkanObjects.VertexBuffer, &VulkanObjects.VertexBufferMemory);
-
-		VkCommandBuffer CommandBuffer = BeginSingleTimeCommands(VulkanObjects.Device, CommandPool);
-
-		{
-			VkBufferCopy CopyRegion = { 0 };
-			CopyRegion.size = sizeof(Vertices);
-			vkCmdCopyBuffer(CommandBuffer, StagingBuffer, VulkanObjects.VertexBuffer, 1, &CopyRegion);
-		}
-
-		EndSingleTimeCommands(VulkanObjects.Device, CommandPool, VulkanObjects.GraphicsQueue, CommandBuffer);
-
-		vkDestroyBuffer(VulkanObjects.Device, StagingBuffer, NULL);
-		vkFreeMemory(VulkanObjects.Device, stagingBufferMemory, NULL);
-	}
-
-	{
-		VkBuffer stagingBuffer;
-		VkDeviceMemory stagingBufferMemory;
-		CreateBuffer(VulkanObjects.PhysicalDevice, VulkanObjects.Device, sizeof(Indices), VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &stagingBuffer, &stagingBufferMemory);
-
-		{
-			void* Data;
-			vkMapMemory(VulkanObjects.Device, stagingBufferMemory, 0, sizeof(Indices), 0, &Data);
-			memcpy(Data, Indices, sizeof(Indices));
-			vkUnmapMemory(VulkanObjects.Device, stagingBufferMemory);
-		}
-
-		CreateBuffer(VulkanObjects.PhysicalDevice, VulkanObjects.Device, sizeof(Indices), VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &VulkanObjects.IndexBuffer, &VulkanObjects.IndexBufferMemory);
-
-		VkCommandBuffer CommandBuffer = BeginSingleTimeCommands(VulkanObjects.Device, CommandPool);
-
-		{
-			VkBufferCopy CopyRegion = { 0 };
-			CopyRegion.size = sizeof(Indices);
-			vkCmdCopyBuffer(CommandBuffer, stagingBuffer, VulkanObjects.IndexBuffer, 1, &CopyRegion);
-		}
-
-		EndSingleTimeCommands(VulkanObjects.Device, CommandPool, VulkanObjects.GraphicsQueue, CommandBuffer);
-
-		vkDestroyBuffer(VulkanObjects.Device, stagingBuffer, NULL);
-		vkFreeMemory(VulkanObjects.Device, stagingBufferMemory, NULL);
-	}
-
-	VkDeviceMemory UniformBuffersMemory[MAX_FRAMES_IN_FLIGHT];
-	VkBuffer UniformBuffers[MAX_FRAMES_IN_FLIGHT];
-
-	for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
-	{
-		CreateBuffer(VulkanObjects.PhysicalDevice, VulkanObjects.Device, sizeof(struct UniformBufferObject), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &UniformBuffers[i], &UniformBuffersMemory[i]);
-		vkMapMemory(VulkanObjects.Device, UniformBuffersMemory[i], 0, sizeof(struct UniformBufferObject), 0, &VulkanObjects.UniformBuffersMapped[i]);
-	}
-
-	VkDescriptorPool DescriptorPool;
-
-	{
-		VkDescriptorPoolSize PoolSizes[2] = { 0 };
-		PoolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-		PoolSizes[0].descriptorCount = MAX_FRAMES_IN_FLIGHT;
-		PoolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-		PoolSizes[1].descriptorCount = MAX_FRAMES_IN_FLIGHT;
-
-		VkDescriptorPoolCreateInfo PoolInfo = { 0 };
-		PoolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-		PoolInfo.poolSizeCount = ARRAYSIZE(PoolSizes);
-		PoolInfo.pPoolSizes = PoolSizes;
-		PoolInfo.maxSets = MAX_FRAMES_IN_FLIGHT;
-		THROW_ON_FAIL_VK(vkCreateDescriptorPool(VulkanObjects.Device, &PoolInfo, NULL, &DescriptorPool));
-	}
-
-	{
-		VkDescriptorSetLayout DescriptorSetLayouts[MAX_FRAMES_IN_FLIGHT] = { 0 };
-
-		for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
-		{
-			DescriptorSetLayouts[i] = DescriptorSetLayout;
-		}
-
-		{
-			VkDescriptorSetAllocateInfo AllocInfo = { 0 };
-			AllocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-			AllocInfo.descriptorPool = DescriptorPool;
-			AllocInfo.descriptorSetCount = MAX_FRAMES_IN_FLIGHT;
-			AllocInfo.pSetLayouts = DescriptorSetLayouts;
-			THROW_ON_FAIL_VK(vkAllocateDescriptorSets(VulkanObjects.Device, &AllocInfo, VulkanObjects.DescriptorSets));
-		}
-	}
-	
-	for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
-	{
-		VkDescriptorBufferInfo BufferInfo = { 0 };
-		BufferInfo.buffer = UniformBuffers[i];
-		BufferInfo.offset = 0;
-		BufferInfo.range = sizeof(struct UniformBufferObject);
-
-		VkDescriptorImageInfo ImageInfo = { 0 };
-		ImageInfo.sampler = TextureSampler;
-		ImageInfo.imageView = TextureImageView;
-		ImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-
-		VkWriteDescriptorSet DescriptorWrites[2] = { 0 };
-		DescriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-		DescriptorWrites[0].dstSet = VulkanObjects.DescriptorSets[i];
-		DescriptorWrites[0].dstBinding = 0;
-		DescriptorWrites[0].dstArrayElement = 0;
-		DescriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-		DescriptorWrites[0].descriptorCount = 1;
-		DescriptorWrites[0].pBufferInfo = &BufferInfo;
-
-		DescriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-		DescriptorWrites[1].dstSet = VulkanObjects.DescriptorSets[i];
-		DescriptorWrites[1].dstBinding = 1;
-		DescriptorWrites[1].dstArrayElement = 0;
-		DescriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-		DescriptorWrites[1].descriptorCount = 1;
-		DescriptorWrites[1].pImageInfo = &ImageInfo;
-
-		vkUpdateDescriptorSets(VulkanObjects.Device, ARRAYSIZE(DescriptorWrites), DescriptorWrites, 0, NULL);
-	}
-
-	{
-		VkCommandBufferAllocateInfo AllocInfo = { 0 };
-		AllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-		AllocInfo.commandPool = CommandPool;
-		AllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-		AllocInfo.commandBufferCount = ARRAYSIZE(VulkanObjects.CommandBuffers);
-		THROW_ON_FAIL_VK(vkAllocateCommandBuffers(VulkanObjects.Device, &AllocInfo, VulkanObjects.CommandBuffers));
-	}
-	
-	{
-		VkSemaphoreCreateInfo SemaphoreInfo = { 0 };
-		SemaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
-
-		VkFenceCreateInfo FenceInfo = { 0 };
-		FenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-		FenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-
-		for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-			THROW_ON_FAIL_VK(vkCreateSemaphore(VulkanObjects.Device, &SemaphoreInfo, NULL, &VulkanObjects.ImageAvailableSemaphores[i]));
-			THROW_ON_FAIL_VK(vkCreateSemaphore(VulkanObjects.Device, &SemaphoreInfo, NULL, &VulkanObjects.RenderFinishedSemaphores[i]));
-			THROW_ON_FAIL_VK(vkCreateFence(VulkanObjects.Device, &FenceInfo, NULL, &VulkanObjects.InFlightFences[i]));
-		}
-	}
-
-	THROW_ON_FALSE(SetWindowLongPtrW(Window, GWLP_WNDPROC, (LONG_PTR)WndProc) != 0);
-
-	
-	DispatchMessageW(&(MSG) {
-		.hwnd = Window,
-		.message = WM_INIT,
-		.wParam = &VulkanObjects,
-		.lParam = 0
-	});
-	
-
-	DispatchMessageW(&(MSG) {
-		.hwnd = Window,
-		.message = WM_SIZE,
-		.wParam = SIZE_RESTORED,
-		.lParam = MAKELONG(WindowRect.right - WindowRect.left, WindowRect.bottom - WindowRect.top)
-	});
-
-	MSG Message = { 0 };
-
-	while (Message.message != WM_QUIT)
-	{
-		if (PeekMessageW(&Message, NULL, 0, 0, PM_REMOVE))
-		{
-			TranslateMessage(&Message);
-			DispatchMessageW(&Message);
-		}
-	}
-
-	vkDeviceWaitIdle(VulkanObjects.Device);
-
-	vkDestroyImageView(VulkanObjects.Device, VulkanObjects.DepthImageView, NULL);
-	vkDestroyImage(VulkanObjects.Device, VulkanObjects.DepthImage, NULL);
-	vkFreeMemory(VulkanObjects.Device, VulkanObjects.DepthImageMemory, NULL);
-
-	for (int i = 0; i < VulkanObjects.SwapChainImageCount; i++)
-	{
-		vkDestroyFramebuffer(VulkanObjects.Device, VulkanObjects.SwapChainFramebuffers[i], NULL);
-	}
-
-	for (int i = 0; i < VulkanObjects.SwapChainImageCount; i++)
-	{
-		vkDestroyImageView(VulkanObjects.Device, VulkanObjects.SwapChainImageViews[i], NULL);
-	}
-
-	vkDestroySwapchainKHR(VulkanObjects.Device, VulkanObjects.SwapChain, NULL);
-
-	vkDestroyPipeline(VulkanObjects.Device, VulkanObjects.GraphicsPipeline, NULL);
-	vkDestroyPipelineLayout(VulkanObjects.Device, VulkanObjects.PipelineLayout, NULL);
-	vkDestroyRenderPass(VulkanObjects.Device, VulkanObjects.RenderPass, NULL);
-
-	for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
-	{
-		vkDestroyBuffer(VulkanObjects.Device, UniformBuffers[i], NULL);
-		vkFreeMemory(VulkanObjects.Device, UniformBuffersMemory[i], NULL);
-	}
-
-	vkDestroyDescriptorPool(VulkanObjects.Device, DescriptorPool, NULL);
-
-	vkDestroySampler(VulkanObjects.Device, TextureSampler, NULL);
-	vkDestroyImageView(VulkanObjects.Device, TextureImageView, NULL);
-
-	vkDestroyImage(VulkanObjects.Device, TextureImage, NULL);
-	vkFreeMemory(VulkanObjects.Device, TextureImageMemory, NULL);
-
-	vkDestroyDescriptorSetLayout(VulkanObjects.Device, DescriptorSetLayout, NULL);
-
-	vkDestroyBuffer(VulkanObjects.Device, VulkanObjects.IndexBuffer, NULL);
-	vkFreeMemory(VulkanObjects.Device, VulkanObjects.IndexBufferMemory, NULL);
-
-	vkDestroyBuffer(VulkanObjects.Device, VulkanObjects.VertexBuffer, NULL);
-	vkFreeMemory(VulkanObjects.Device, VulkanObjects.VertexBufferMemory, NULL);
-
-	for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
-	{
-		vkDestroySemaphore(VulkanObjects.Device, VulkanObjects.RenderFinishedSemaphores[i], NULL);
-		vkDestroySemaphore(VulkanObjects.Device, VulkanObjects.ImageAvailableSemaphores[i], NULL);
-		vkDestroyFence(VulkanObjects.Device, VulkanObjects.InFlightFences[i], NULL);
-	}
-
-	vkDestroyCommandPool(VulkanObjects.Device, CommandPool, NULL);
-
-	vkDestroyDevice(VulkanObjects.Device, NULL);
-
-#ifdef _DEBUG
-		DestroyDebugUtilsMessengerEXT(VulkanInstance, VulkanObjects.DebugMessenger, NULL);
-#endif
-
-	vkDestroySurfaceKHR(VulkanInstance, VulkanObjects.Surface, NULL);
-	vkDestroyInstance(VulkanInstance, NULL);
-
-	THROW_ON_FALSE(UnregisterClassW(WindowClassName, Instance));
-
-	THROW_ON_FALSE(DestroyCursor(Cursor));
-	THROW_ON_FALSE(DestroyIcon(Icon));
-
-	return EXIT_SUCCESS;
-}
-
-LRESULT CALLBACK PreInitProc(HWND Window, UINT message, WPARAM wParam, LPARAM lParam)
-{
-	switch (message)
-	{
-	case WM_DESTROY:
-		PostQuitMessage(0);
-		break;
-	default:
-		return DefWindowProcW(Window, message, wParam, lParam);
-	}
-	return 0;
-}
-
-LRESULT CALLBACK IdleProc(HWND Window, UINT message, WPARAM wParam, LPARAM lParam)
-{
-	switch (message)
-	{
-	case WM_PAINT:
-		Sleep(25);
-		break;
-	case WM_SIZE:
-		if (wParam == SIZE_RESTORED)
-			THROW_ON_FALSE(SetWindowLongPtrW(Window, GWLP_WNDPROC, (LONG_PTR)WndProc) != 0);
-		break;
-	case WM_DESTROY:
-		PostQuitMessage(0);
-		break;
-	default:
-		return DefWindowProcW(Window, message, wParam, lParam);
-	}
-	return 0;
-}
-
-LRESULT CALLBACK WndProc(HWND Window, UINT message, WPARAM wParam, LPARAM lParam)
-{
-	static uint32_t CurrentFrame = 0;
-	static bool bFullScreen = false;
-
-	static int WindowWidth = 0;
-	static int WindowHeight = 0;
-
-	static struct VulkanObjects* restrict VulkanObjects = NULL;
-
-	static struct
-	{
-		LARGE_INTEGER ProcessorFrequency;
-		LARGE_INTEGER TickCount;
-	} Timer = { 0 };
-
-	switch (message)
-	{
-	case WM_INIT:
-		QueryPerformanceFrequency(&Timer.ProcessorFrequency);
-
-		VulkanObjects = ((struct VulkanObjects*)wParam);
-		break;
-	case WM_PAINT:
-		vkWaitForFences(VulkanObjects->Device, 1, &VulkanObjects->InFlightFences[CurrentFrame], VK_TRUE, UINT64_MAX);
-
-		uint32_t ImageIndex;
-		THROW_ON_FAIL_VK(vkAcquireNextImageKHR(VulkanObjects->Device, VulkanObjects->SwapChain, UINT64_MAX, VulkanObjects->ImageAvailableSemaphores[CurrentFrame], VK_NULL_HANDLE, &ImageIndex));
-
-		{
-			LARGE_INTEGER TickCountNow;
-			QueryPerformanceCounter(&TickCountNow);
-			ULONGLONG TickCountDelta = TickCountNow.QuadPart - Timer.TickCount.QuadPart;
-
-			float Time = TickCountDelta / ((float)Timer.ProcessorFrequency.QuadPart);
-
-			struct UniformBufferObject Ubo = { 0 };
-			glm_mat4_identity(Ubo.Model);
-			glm_rotate(Ubo.Model, Time * glm_rad(90.0f), (vec3) { 0.0f, 0.0f, 1.0f });
-			glm_lookat_rh((vec3) { 2.0f, 2.0f, 2.0f }, (vec3) { 0.0f, 0.0f, 0.0f }, (vec3) { 0.0f, 0.0f, 1.0f }, Ubo.View);
-			glm_perspective_rh_zo(glm_rad(45.0f), VulkanObjects->SwapChainExtent.width / (float)VulkanObjects->SwapChainExtent.height, 0.1f, 10.0f, Ubo.Proj);
-			Ubo.Proj[1][1] *= -1;
-
-			memcpy(VulkanObjects->UniformBuffersMapped[CurrentFrame], &Ubo, sizeof(Ubo));
-		}
-
-		vkResetFences(VulkanObjects->Device, 1, &VulkanObjects->InFlightFences[CurrentFrame]);
-
-		vkResetCommandBuffer(VulkanObjects->CommandBuffers[CurrentFrame], 0);
-
-		{
-			VkCommandBufferBeginInfo BeginInfo = { 0 };
-			BeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-			THROW_ON_FAIL_VK(vkBeginCommandBuffer(VulkanObjects->CommandBuffers[CurrentFrame], &BeginInfo));
-		}
-
-		{
-			VkClearValue ClearValues[2] = { 0 };
-			ClearValues[0].color = (VkClearColorValue){ {0.0f, 0.0f, 0.0f, 1.0f} };
-			ClearValues[1].depthStencil.depth = 1.0f;
-			ClearValues[1].depthStencil.stencil = 0;
-
-			VkRenderPassBeginInfo RenderPassInfo = { 0 };
-			RenderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-			RenderPassInfo.renderPass = VulkanObjects->RenderPass;
-			RenderPassInfo.framebuffer = VulkanObjects->SwapChainFramebuffers[ImageIndex];
-			RenderPassInfo.renderArea.offset.x = 0;
-			RenderPassInfo.renderArea.offset.y = 0;
-			RenderPassInfo.renderArea.extent = VulkanObjects->SwapChainExtent;
-			RenderPassInfo.clearValueCount = ARRAYSIZE(ClearValues);
-			RenderPassInfo.pClearValues = ClearValues;
-			vkCmdBeginRenderPass(VulkanObjects->CommandBuffers[CurrentFrame], &RenderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
-		}
-
-		vkCmdBindPipeline(VulkanObjects->CommandBuffers[CurrentFrame], VK_PIPELINE_BIND_POINT_GRAPHICS, VulkanObjects->GraphicsPipeline);
-
-		{
-			VkViewport Viewport = { 0 };
-			Viewport.x = 0.0f;
-			Viewport.y = 0.0f;
-			Viewport.width = VulkanObjects->SwapChainExtent.width;
-			Viewport.height = VulkanObjects->SwapChainExtent.height;
-			Viewport.minDepth = 0.0f;
-			Viewport.maxDepth = 1.0f;
-			vkCmdSetViewport(VulkanObjects->CommandBuffers[CurrentFrame], 0, 1, &Viewport);
-		}
-
-		{
-			VkRect2D Scissor = { 0 };
-			Scissor.offset.x = 0;
-			Scissor.offset.y = 0;
-			Scissor.extent = VulkanObjects->SwapChainExtent;
-			vkCmdSetScissor(VulkanObjects->CommandBuffers[CurrentFrame], 0, 1, &Scissor);
-		}
-
-		{
-			VkBuffer vertexBuffers[] = { VulkanObjects->VertexBuffer };
-			VkDeviceSize offsets[] = { 0 };
-			vkCmdBindVertexBuffers(VulkanObjects->CommandBuffers[CurrentFrame], 0, 1, vertexBuffers, offsets);
-		}
-
-		vkCmdBindIndexBuffer(VulkanObjects->CommandBuffers[CurrentFrame], VulkanObjects->IndexBuffer, 0, VK_INDEX_TYPE_UINT16);
-
-		vkCmdBindDescriptorSets(VulkanObjects->CommandBuffers[CurrentFrame], VK_PIPELINE_BIND_POINT_GRAPHICS, VulkanObjects->PipelineLayout, 0, 1, &VulkanObjects->DescriptorSets[CurrentFrame], 0, NULL);
-
-		vkCmdDrawIndexed(VulkanObjects->CommandBuffers[CurrentFrame], ARRAYSIZE(Indices), 1, 0, 0, 0);
-
-		vkCmdEndRenderPass(VulkanObjects->CommandBuffers[CurrentFrame]);
-
-		THROW_ON_FAIL_VK(vkEndCommandBuffer(VulkanObjects->CommandBuffers[CurrentFrame]));
-
-		VkSemaphore SignalSemaphores[] = { VulkanObjects->RenderFinishedSemaphores[CurrentFrame] };
-
-		{
-			VkSemaphore WaitSemaphores[] = { VulkanObjects->ImageAvailableSemaphores[CurrentFrame] };
-			VkPipelineStageFlags WaitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
-
-			VkSubmitInfo SubmitInfo = { 0 };
-			SubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-			SubmitInfo.waitSemaphoreCount = 1;
-			SubmitInfo.pWaitSemaphores = WaitSemaphores;
-			SubmitInfo.pWaitDstStageMask = WaitStages;
-			SubmitInfo.commandBufferCount = 1;
-			SubmitInfo.pCommandBuffers = &VulkanObjects->CommandBuffers[CurrentFrame];
-			SubmitInfo.signalSemaphoreCount = 1;
-			SubmitInfo.pSignalSemaphores = SignalSemaphores;
-			THROW_ON_FAIL_VK(vkQueueSubmit(VulkanObjects->GraphicsQueue, 1, &SubmitInfo, VulkanObjects->InFlightFences[CurrentFrame]));
-		}
-
-		{
-			VkSwapchainKHR SwapChains[] = { VulkanObjects->SwapChain };
-			VkPresentInfoKHR PresentInfo = { 0 };
-			PresentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
-			PresentInfo.waitSemaphoreCount = 1;
-			PresentInfo.pWaitSemaphores = SignalSemaphores;
-			PresentInfo.swapchainCount = 1;
-			PresentInfo.pSwapchains = SwapChains;
-			PresentInfo.pImageIndices = &ImageIndex;
-			THROW_ON_FAIL_VK(vkQueuePresentKHR(VulkanObjects->PresentQueue, &PresentInfo));
-		}
-
-		CurrentFrame = (CurrentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
-		break;
-		case WM_KEYDOWN:
-			switch (wParam)
-			{
-			case VK_ESCAPE:
-				THROW_ON_FALSE(DestroyWindow(Window));
-				break;
-			}
-			break;
-		case WM_SYSKEYDOWN:
-			if (wParam == VK_RETURN && (lParam & 0x60000000) == 0x20000000)
-			{
-				bFullScreen = !bFullScreen;
-
-				if (bFullScreen)
-				{
-					THROW_ON_FALSE(SetWindowLongPtrW(Window, GWL_EXSTYLE, WS_EX_TOPMOST) != 0);
-					THROW_ON_FALSE(SetWindowLongPtrW(Window, GWL_STYLE, 0) != 0);
-
-					THROW_ON_FALSE(ShowWindow(Window, SW_SHOWMAXIMIZED));
-				}
-				else
-				{
-					THROW_ON_FALSE(SetWindowLongPtrW(Window, GWL_STYLE, WS_OVERLAPPEDWINDOW) != 0);
-					THROW_ON_FALSE(SetWindowLongPtrW(Window, GWL_EXSTYLE, 0) != 0);
-
-					THROW_ON_FALSE(ShowWindow(Window, SW_SHOWMAXIMIZED));
-				}
-			}
-			break;
-	case WM_SIZE:
-		if (wParam == SIZE_MINIMIZED)
-		{
-			THROW_ON_FALSE(SetWindowLongPtrW(Window, GWLP_WNDPROC, (LONG_PTR)IdleProc) != 0);
-			break;
-		}
-
-		if (WindowWidth == LOWORD(lParam) && WindowHeight == HIWORD(lParam))
-			break;
-
-		vkDeviceWaitIdle(VulkanObjects->Device);
-
-		vkDestroyImageView(VulkanObjects->Device, VulkanObjects->DepthImageView, NULL);
-		vkDestroyImage(VulkanObjects->Device, VulkanObjects->DepthImage, NULL);
-		vkFreeMemory(VulkanObjects->Device, VulkanObjects->DepthImageMemory, NULL);
-
-		for (int i = 0; i < VulkanObjects->SwapChainImageCount; i++)
-		{
-			vkDestroyFramebuffer(VulkanObjects->Device, VulkanObjects->SwapChainFramebuffers[i], NULL);
-		}
-
-		for (int i = 0; i < VulkanObjects->SwapChainImageCount; i++)
-		{
-			vkDestroyImageView(VulkanObjects->Device, VulkanObjects->SwapChainImageViews[i], NULL);
-		}
-
-		vkDestroySwapchainKHR(VulkanObjects->Device, VulkanObjects->SwapChain, NULL);
-
-		if (VulkanObjects->SurfaceCapabilities.currentExtent.width != UINT32_MAX)
-		{
-			VulkanObjects->SwapChainExtent = VulkanObjects->SurfaceCapabilities.currentExtent;
-		}
-		else
-		{
-			VulkanObjects->SwapChainExtent.width = ClampU32(WindowWidth, VulkanObjects->SurfaceCapabilities.minImageExtent.width, VulkanObjects->SurfaceCapabilities.maxImageExtent.width);
-			VulkanObjects->SwapChainExtent.height = ClampU32(WindowHeight, VulkanObjects->SurfaceCapabilities.minImageExtent.height, VulkanObjects->SurfaceCapabilities.maxImageExtent.height);
-		}
-
-		{
-			VkSwapchainCreateInfoKHR SwapchainCreateInfo = { 0 };
-			SwapchainCreateInfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
-			SwapchainCreateInfo.surface = VulkanObjects->Surface;
-			SwapchainCreateInfo.minImageCount = VulkanObjects->SwapChainImageCount;
-			SwapchainCreateInfo.imageFormat = VulkanObjects->SwapChainImageFormat.format;
-			SwapchainCreateInfo.imageColorSpace = VulkanObjects->SwapChainImageFormat.colorSpace;
-			SwapchainCreateInfo.imageExtent = VulkanObjects->SwapChainExtent;
-			SwapchainCreateInfo.imageArrayLayers = 1;
-			SwapchainCreateInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
-
-			uint32_t QueueFamilyIndicesU32[] = { VulkanObjects->QueueFamilyIndices.GraphicsFamily, VulkanObjects->QueueFamilyIndices.PresentFamily };
-
-			if (VulkanObjects->QueueFamilyIndices.GraphicsFamily != VulkanObjects->QueueFamilyIndices.PresentFamily)
-			{
-				SwapchainCreateInfo.imageSharingMode = VK_SHARING_MODE_CONCURRENT;
-				SwapchainCreateInfo.queueFamilyIndexCount = 2;
-				SwapchainCreateInfo.pQueueFamilyIndices = QueueFamilyIndicesU32;
-			}
-			else
-			{
-				SwapchainCreateInfo.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
-			}
-
-			SwapchainCreateInfo.preTransform = VulkanObjects->SurfaceCapabilities.currentTransform;
-			SwapchainCreateInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
-			SwapchainCreateInfo.presentMode = VulkanObjects->SwapChainPresentMode;
-			SwapchainCreateInfo.clipped = VK_TRUE;
-
-			THROW_ON_FAIL_VK(vkCreateSwapchainKHR(VulkanObjects->Device, &SwapchainCreateInfo, NULL, &VulkanObjects->SwapChain));
-		}
-
-		vkGetSwapchainImagesKHR(VulkanObjects->Device, VulkanObjects->SwapChain, &VulkanObjects->SwapChainImageCount, NULL);
-		vkGetSwapchainImagesKHR(VulkanObjects->Device, VulkanObjects->SwapChain, &VulkanObjects->SwapChainImageCount, VulkanObjects->SwapChainImages);
-
-		for (int i = 0; i < VulkanObjects->SwapChainImageCount; i++)
-		{
-			VkImageViewCreateInfo ViewInfo = { 0 };
-			ViewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-			ViewInfo.image = VulkanObjects->SwapChainImages[i];
-			ViewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
-			ViewInfo.format = VulkanObjects->SwapChainImageFormat.format;
-			ViewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-			ViewInfo.subresourceRange.baseMipLevel = 0;
-			ViewInfo.subresourceRange.levelCount = 1;
-			ViewInfo.subresourceRange.baseArrayLayer = 0;
-			ViewInfo.subresourceRange.layerCount = 1;
-			THROW_ON_FAIL_VK(vkCreateImageView(VulkanObjects->Device, &ViewInfo, NULL, &VulkanObjects->SwapChainImageViews[i]));
-		}
-		
-		{
-			VkImageCreateInfo ImageInfo = { 0 };
-			ImageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
-			ImageInfo.imageType = VK_IMAGE_TYPE_2D;
-			ImageInfo.extent.width = VulkanObjects->SwapChainExtent.width;
-			ImageInfo.extent.height = VulkanObjects->SwapChainExtent.height;
-			ImageInfo.extent.depth = 1;
-			ImageInfo.mipLevels = 1;
-			ImageInfo.arrayLayers = 1;
-			ImageInfo.format = VulkanObjects->DepthFormat;
-			ImageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
-			ImageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-			ImageInfo.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
-			ImageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
-			ImageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-			THROW_ON_FAIL_VK(vkCreateImage(VulkanObjects->Device, &ImageInfo, NULL, &VulkanObjects->DepthImage));
-		}
-
-		{
-			VkMemoryRequirements MemRequirements;
-			vkGetImageMemoryRequirements(VulkanObjects->Device, VulkanObjects->DepthImage, &MemRequirements);
-
-			VkMemoryAllocateInfo AllocInfo = { 0 };
-			AllocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-			AllocInfo.allocationSize = MemRequirements.size;
-			AllocInfo.memoryTypeIndex = FindMemoryType(VulkanObjects->PhysicalDevice, MemRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-			THROW_ON_FAIL_VK(vkAllocateMemory(VulkanObjects->Device, &AllocInfo, NULL, &VulkanObjects->DepthImageMemory));
-		}
-
-		vkBindImageMemory(VulkanObjects->Device, VulkanObjects->DepthImage, VulkanObjects->DepthImageMemory, 0);
-
-		{
-			VkImageViewCreateInfo ViewInfo = { 0 };
-			ViewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-			ViewInfo.image = VulkanObjects->DepthImage;
-			ViewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
-			ViewInfo.format = VulkanObjects->DepthFormat;
-			ViewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
-			ViewInfo.subresourceRange.baseMipLevel = 0;
-			ViewInfo.subresourceRange.levelCount = 1;
-			ViewInfo.subresourceRange.baseArrayLayer = 0;
-			ViewInfo.subresourceRange.layerCount = 1;
-			THROW_ON_FAIL_VK(vkCreateImageView(VulkanObjects->Device, &ViewInfo, NULL, &VulkanObjects->DepthImageView));
-		}
-
-		for (int i = 0; i < VulkanObjects->SwapChainImageCount; i++)
-		{
-			VkImageView Attachments[2] = {
-				VulkanObjects->SwapChainImageViews[i],
-				VulkanObjects->DepthImageView
-			};
-
-			VkFramebufferCreateInfo FramebufferInfo = { 0 };
-			FramebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-			FramebufferInfo.renderPass = VulkanObjects->RenderPass;
-			FramebufferInfo.attachmentCount = ARRAYSIZE(Attachments);
-			FramebufferInfo.pAttachments = Attachments;
-			FramebufferInfo.width = VulkanObjects->SwapChainExtent.width;
-			FramebufferInfo.height = VulkanObjects->SwapChainExtent.height;
-			FramebufferInfo.layers = 1;
-
-			THROW_ON_FAIL_VK(vkCreateFramebuffer(VulkanObjects->Device, &FramebufferInfo, NULL, &VulkanObjects->SwapChainFramebuffers[i]));
-		}
-
-		break;
-	case WM_DESTROY:
-		PostQuitMessage(0);
-		break;
-	default:
-		return DefWindowProcW(Window, message, wParam, lParam);
-	}
-	return 0;
-}
+/*
+* (C) 2025 badasahog. All Rights Reserved
+*
+* The above copyright notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#define WIN32_LEAN_AND_MEAN
+#define _CRT_SECURE_NO_WARNINGS
+#include <windows.h>
+#undef _CRT_SECURE_NO_WARNINGS
+
+// WaitOnAddress and WakeByAddressAll
+#pragma comment(lib, "Synchronization.lib")
+
+#define VK_USE_PLATFORM_WIN32_KHR
+#define VK_NO_PROTOTYPES
+#include <vulkan/vulkan.h>
+
+#include <cglm/cglm.h>
+#include <cglm/struct.h>
+#include <cglm/call.h>
+#include <cglm/cam.h>
+#include <cglm/clipspace/persp_rh_zo.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdalign.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <float.h>
+
+__declspec(dllexport) DWORD NvOptimusEnablement = 1;
+__declspec(dllexport) int AmdPowerXpressRequestHighPerformance = 1;
+
+HANDLE LogHandle;
+
+/*
+* WriteFile rather than WriteConsoleA, because with --capture=- the log goes to stderr, which
+* may be a pipe or a file. text that can't be written goes to the debugger instead
+*/
+void WriteLog(const char* Text, int Length)
+{
+	if (Length <= 0)
+		return;
+
+	DWORD BytesWritten;
+
+	if (WriteFile(LogHandle, Text, Length, &BytesWritten, NULL) == FALSE || BytesWritten != (DWORD)Length)
+		OutputDebugStringA(Text);
+}
+
+inline void THROW_ON_FAIL_IMPL(HRESULT hr, int line)
+{
+	if (FAILED(hr))
+	{
+		LPSTR messageBuffer;
+		DWORD formattedErrorLength = FormatMessageA(
+			FORMAT_MESSAGE_ALLOCATE_BUFFER | FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS,
+			NULL,
+			hr,
+			MAKELANGID(LANG_ENGLISH, SUBLANG_ENGLISH_US),
+			(LPSTR)&messageBuffer,
+			0,
+			NULL
+		);
+
+		if (formattedErrorLength == 0)
+			WriteLog("an error occured, unable to retrieve error message\n", 51);
+		else
+		{
+			WriteLog("an error occured: ", 18);
+			WriteLog(messageBuffer, formattedErrorLength);
+			WriteLog("\n", 1);
+			LocalFree(messageBuffer);
+		}
+
+		char buffer[50];
+		int stringlength = _snprintf_s(buffer, 50, _TRUNCATE, "error code: 0x%X\nlocation:line %i\n", hr, line);
+		WriteLog(buffer, stringlength);
+
+		RaiseException(0, EXCEPTION_NONCONTINUABLE, 0, NULL);
+	}
+}
+
+void THROW_ON_FAIL_VK_IMPL(VkResult Result, int line)
+{
+	if (Result < VK_SUCCESS)
+	{
+		char buffer[50];
+		int stringlength = _snprintf_s(buffer, 50, _TRUNCATE, "Vulkan Error: %i\nlocation:line %i\n", Result, line);
+		WriteLog(buffer, stringlength);
+
+		RaiseException(0, EXCEPTION_NONCONTINUABLE, 0, NULL);
+	}
+}
+
+#define THROW_ON_FAIL(x) THROW_ON_FAIL_IMPL(x, __LINE__)
+
+#define THROW_ON_FAIL_VK(x) THROW_ON_FAIL_VK_IMPL(x, __LINE__)
+
+#define THROW_ON_FALSE(x) if((x) == FALSE) THROW_ON_FAIL(HRESULT_FROM_WIN32(GetLastError()))
+
+#define VALIDATE_HANDLE(x) if((x) == NULL || (x) == INVALID_HANDLE_VALUE) THROW_ON_FAIL(HRESULT_FROM_WIN32(GetLastError()))
+
+void FailFastWithMessage(const char* Message)
+{
+	WriteLog(Message, (int)strlen(Message));
+	RaiseException(0, EXCEPTION_NONCONTINUABLE, 0, NULL);
+}
+
+void LogMessage(const char* Format, ...)
+{
+	char buffer[512];
+
+	va_list Arguments;
+	va_start(Arguments, Format);
+	int stringlength = _vsnprintf_s(buffer, sizeof(buffer), _TRUNCATE, Format, Arguments);
+	va_end(Arguments);
+
+	if (stringlength < 0)
+		stringlength = sizeof(buffer) - 1;
+
+	WriteLog(buffer, stringlength);
+}
+
+/*
+* define ENABLE_PROFILING to record zones, counters and frame markers into per-thread
+* buffers and write them out as a Chrome trace (chrome://tracing, ui.perfetto.dev) at exit.
+* without it every macro below expands to nothing. a zone is a for loop around the block
+* that follows, so the block must not be left with return, break or goto
+*/
+#ifdef ENABLE_PROFILING
+
+#define PROFILE_MAX_THREADS 64
+#define PROFILE_EVENTS_PER_THREAD 65536
+
+enum ProfileEventType
+{
+	PROFILE_EVENT_ZONE,
+	PROFILE_EVENT_COUNTER,
+	PROFILE_EVENT_FRAME
+};
+
+struct ProfileEvent
+{
+	const char* Name;
+	enum ProfileEventType Type;
+	LONGLONG Start;
+
+	union
+	{
+		LONGLONG End;
+		double Value;
+	};
+};
+
+/*
+* only the owning thread appends, so recording takes no locks. the buffers are read when
+* the trace is written, after every other thread has stopped
+*/
+struct ProfileThreadBuffer
+{
+	char ThreadName[32];
+	DWORD ThreadId;
+	volatile LONG EventCount;
+	LONG DroppedEvents;
+	struct ProfileEvent Events[PROFILE_EVENTS_PER_THREAD];
+};
+
+struct ProfileZoneScope
+{
+	const char* Name;
+	LONGLONG Start;
+	bool Active;
+};
+
+static struct
+{
+	LARGE_INTEGER Frequency;
+	LARGE_INTEGER StartTime;
+	volatile LONG ThreadCount;
+	struct ProfileThreadBuffer* Threads[PROFILE_MAX_THREADS];
+} ProfilerState;
+
+static __declspec(thread) struct ProfileThreadBuffer* ProfileCurrentThread = NULL;
+
+struct ProfileThreadBuffer* ProfileCreateTrack(const char* Name, DWORD ThreadId)
+{
+	// committed pages are only backed once they are touched
+	struct ProfileThreadBuffer* Buffer = VirtualAlloc(NULL, sizeof(struct ProfileThreadBuffer), MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+	VALIDATE_HANDLE(Buffer);
+
+	strncpy_s(Buffer->ThreadName, sizeof(Buffer->ThreadName), Name, _TRUNCATE);
+	Buffer->ThreadId = ThreadId;
+
+	LONG Index = InterlockedIncrement(&ProfilerState.ThreadCount) - 1;
+
+	if (Index >= PROFILE_MAX_THREADS)
+		FailFastWithMessage("too many profiled threads\n");
+
+	ProfilerState.Threads[Index] = Buffer;
+
+	return Buffer;
+}
+
+static struct ProfileThreadBuffer* ProfileGetThreadBuffer(void)
+{
+	if (ProfileCurrentThread == NULL)
+	{
+		char Name[32];
+		_snprintf_s(Name, sizeof(Name), _TRUNCATE, "Thread %lu", GetCurrentThreadId());
+		ProfileCurrentThread = ProfileCreateTrack(Name, GetCurrentThreadId());
+	}
+
+	return ProfileCurrentThread;
+}
+
+void ProfileRecord(struct ProfileThreadBuffer* Buffer, const struct ProfileEvent* Event)
+{
+	LONG EventCount = Buffer->EventCount;
+
+	if (EventCount == PROFILE_EVENTS_PER_THREAD)
+	{
+		Buffer->DroppedEvents++;
+		return;
+	}
+
+	Buffer->Events[EventCount] = *Event;
+	WriteRelease(&Buffer->EventCount, EventCount + 1);
+}
+
+void ProfileInit(void)
+{
+	QueryPerformanceFrequency(&ProfilerState.Frequency);
+	QueryPerformanceCounter(&ProfilerState.StartTime);
+}
+
+void ProfileSetThreadName(const char* Name)
+{
+	struct ProfileThreadBuffer* Buffer = ProfileGetThreadBuffer();
+	strncpy_s(Buffer->ThreadName, sizeof(Buffer->ThreadName), Name, _TRUNCATE);
+}
+
+struct ProfileZoneScope ProfileZoneBegin(const char* Name)
+{
+	LARGE_INTEGER Now;
+	QueryPerformanceCounter(&Now);
+
+	struct ProfileZoneScope Scope = { Name, Now.QuadPart, true };
+	return Scope;
+}
+
+void ProfileZoneEnd(struct ProfileZoneScope* Scope)
+{
+	LARGE_INTEGER Now;
+	QueryPerformanceCounter(&Now);
+
+	struct ProfileEvent Event = { 0 };
+	Event.Name = Scope->Name;
+	Event.Type = PROFILE_EVENT_ZONE;
+	Event.Start = Scope->Start;
+	Event.End = Now.QuadPart;
+	ProfileRecord(ProfileGetThreadBuffer(), &Event);
+
+	Scope->Active = false;
+}
+
+void ProfileCounter(const char* Name, double Value)
+{
+	LARGE_INTEGER Now;
+	QueryPerformanceCounter(&Now);
+
+	struct ProfileEvent Event = { 0 };
+	Event.Name = Name;
+	Event.Type = PROFILE_EVENT_COUNTER;
+	Event.Start = Now.QuadPart;
+	Event.Value = Value;
+	ProfileRecord(ProfileGetThreadBuffer(), &Event);
+}
+
+void ProfileFrameMark(void)
+{
+	LARGE_INTEGER Now;
+	QueryPerformanceCounter(&Now);
+
+	struct ProfileEvent Event = { 0 };
+	Event.Name = "Frame";
+	Event.Type = PROFILE_EVENT_FRAME;
+	Event.Start = Now.QuadPart;
+	ProfileRecord(ProfileGetThreadBuffer(), &Event);
+}
+
+static double ProfileTicksToMicroseconds(LONGLONG Ticks)
+{
+	return (Ticks - ProfilerState.StartTime.QuadPart) * 1000000.0 / ProfilerState.Frequency.QuadPart;
+}
+
+static void ProfileWrite(HANDLE File, char* Buffer, uint32_t* Used, uint32_t Capacity, const char* Format, ...)
+{
+	// flush before anything could be truncated; no single event comes close to 512 bytes
+	if (Capacity - *Used < 512)
+	{
+		DWORD BytesWritten;
+		THROW_ON_FALSE(WriteFile(File, Buffer, *Used, &BytesWritten, NULL));
+		*Used = 0;
+	}
+
+	va_list Arguments;
+	va_start(Arguments, Format);
+	int Written = _vsnprintf_s(Buffer + *Used, Capacity - *Used, _TRUNCATE, Format, Arguments);
+	va_end(Arguments);
+
+	if (Written > 0)
+		*Used += Written;
+}
+
+// call once every profiled thread has stopped recording
+void ProfileWriteTrace(LPCWSTR FileName)
+{
+	HANDLE File = CreateFileW(FileName, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	VALIDATE_HANDLE(File);
+
+	enum { BUFFER_SIZE = 64 * 1024 };
+	char* Buffer = malloc(BUFFER_SIZE);
+
+	if (Buffer == NULL)
+		FailFastWithMessage("failed to allocate the trace buffer\n");
+
+	uint32_t Used = 0;
+	const char* Separator = "";
+
+	ProfileWrite(File, Buffer, &Used, BUFFER_SIZE, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+	LONG ThreadCount = min(ReadAcquire(&ProfilerState.ThreadCount), PROFILE_MAX_THREADS);
+
+	for (LONG i = 0; i < ThreadCount; i++)
+	{
+		const struct ProfileThreadBuffer* Thread = ProfilerState.Threads[i];
+
+		if (Thread == NULL)
+			continue;
+
+		ProfileWrite(File, Buffer, &Used, BUFFER_SIZE, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%lu,\"args\":{\"name\":\"%s\"}}", Separator, Thread->ThreadId, Thread->ThreadName);
+		Separator = ",\n";
+
+		LONG EventCount = ReadAcquire(&Thread->EventCount);
+
+		for (LONG j = 0; j < EventCount; j++)
+		{
+			const struct ProfileEvent* Event = &Thread->Events[j];
+
+			switch (Event->Type)
+			{
+			case PROFILE_EVENT_ZONE:
+				ProfileWrite(File, Buffer, &Used, BUFFER_SIZE, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%lu,\"ts\":%.3f,\"dur\":%.3f}",
+					Event->Name, Thread->ThreadId, ProfileTicksToMicroseconds(Event->Start), (Event->End - Event->Start) * 1000000.0 / ProfilerState.Frequency.QuadPart);
+				break;
+			case PROFILE_EVENT_COUNTER:
+				ProfileWrite(File, Buffer, &Used, BUFFER_SIZE, ",\n{\"name\":\"%s\",\"ph\":\"C\",\"pid\":1,\"tid\":%lu,\"ts\":%.3f,\"args\":{\"value\":%f}}",
+					Event->Name, Thread->ThreadId, ProfileTicksToMicroseconds(Event->Start), Event->Value);
+				break;
+			case PROFILE_EVENT_FRAME:
+				ProfileWrite(File, Buffer, &Used, BUFFER_SIZE, ",\n{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":%lu,\"ts\":%.3f}",
+					Event->Name, Thread->ThreadId, ProfileTicksToMicroseconds(Event->Start));
+				break;
+			}
+		}
+
+		if (Thread->DroppedEvents > 0)
+			LogMessage("profiler: %s dropped %ld events\n", Thread->ThreadName, Thread->DroppedEvents);
+	}
+
+	ProfileWrite(File, Buffer, &Used, BUFFER_SIZE, "\n]}\n");
+
+	DWORD BytesWritten;
+	THROW_ON_FALSE(WriteFile(File, Buffer, Used, &BytesWritten, NULL));
+
+	free(Buffer);
+	THROW_ON_FALSE(CloseHandle(File));
+}
+
+#define PROFILE_ZONE(Name) for (struct ProfileZoneScope ProfileZone = ProfileZoneBegin(Name); ProfileZone.Active; ProfileZoneEnd(&ProfileZone))
+#define PROFILE_COUNTER(Name, Value) ProfileCounter(Name, Value)
+#define PROFILE_FRAME_MARK() ProfileFrameMark()
+#define PROFILE_THREAD_NAME(Name) ProfileSetThreadName(Name)
+
+#else
+
+#define PROFILE_ZONE(Name)
+#define PROFILE_COUNTER(Name, Value)
+#define PROFILE_FRAME_MARK()
+#define PROFILE_THREAD_NAME(Name)
+
+#endif
+
+LRESULT CALLBACK PreInitProc(HWND hwnd, UINT message, WPARAM wParam, LPARAM lParam);
+LRESULT CALLBACK WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam);
+
+static const UINT TEXTURE_WIDTH = 64;
+static const UINT TEXTURE_HEIGHT = 64;
+static const UINT BYTES_PER_TEXEL = 2;
+static const VkFormat IMAGE_FORMAT = VK_FORMAT_B5G6R5_UNORM_PACK16;
+
+static const LPCTSTR WindowClassName = L"MinimalVulkan";
+
+//note: these are presumptive. Not within spec (as far as I know)
+#define MAX_FRAMES_IN_FLIGHT 3
+#define MAX_SURFACE_FORMATS 32
+#define MAX_PRESENT_MODES 8
+#define SWAP_CHAIN_MAX_IMAGE_COUNT 8
+#define MAX_DEVICE_COUNT 16
+#define MAX_QUEUE_FAMILY_COUNT 16
+#define MAX_ENABLED_DEVICE_EXTENSIONS 16
+#define MAX_DEFERRED_DELETIONS 64
+
+#define WM_INIT (WM_USER + 1)
+#define WM_APPLY_FULLSCREEN (WM_USER + 2)
+#define WM_RENDER_THREAD_EXITED (WM_USER + 3)
+
+static const char* const VALIDATION_LAYERS[] = {
+	"VK_LAYER_KHRONOS_validation"
+};
+
+static const char* const DEVICE_EXTENSIONS[] = {
+	VK_KHR_SWAPCHAIN_EXTENSION_NAME
+};
+
+// generated by CompileShaders.ps1. without it the shaders are read from .spv files at startup
+#if __has_include("Shaders.h")
+#include "Shaders.h"
+#define SHADER_SPIRV(Name) Name##Spirv, sizeof(Name##Spirv)
+#else
+#define SHADER_SPIRV(Name) NULL, 0
+#endif
+
+enum ShaderId
+{
+	SHADER_SCENE_VERTEX,
+	SHADER_SCENE_FRAGMENT,
+	SHADER_SCENE_VERTEX_PULLING,
+	SHADER_PARTICLE_SIMULATE,
+	SHADER_PARTICLE_EMIT,
+	SHADER_PARTICLE_VERTEX,
+	SHADER_PARTICLE_FRAGMENT,
+	SHADER_COUNT
+};
+
+struct ShaderSource
+{
+	LPCWSTR FileName;
+	const uint32_t* Code;
+	size_t CodeSize;
+};
+
+static const struct ShaderSource SHADER_SOURCES[SHADER_COUNT] = {
+	[SHADER_SCENE_VERTEX] = { L"vert.spv", SHADER_SPIRV(SceneVertex) },
+	[SHADER_SCENE_FRAGMENT] = { L"frag.spv", SHADER_SPIRV(SceneFragment) },
+	[SHADER_SCENE_VERTEX_PULLING] = { L"vert_pulling.spv", SHADER_SPIRV(SceneVertexPulling) },
+	[SHADER_PARTICLE_SIMULATE] = { L"particle_simulate.spv", SHADER_SPIRV(ParticleSimulate) },
+	[SHADER_PARTICLE_EMIT] = { L"particle_emit.spv", SHADER_SPIRV(ParticleEmit) },
+	[SHADER_PARTICLE_VERTEX] = { L"particle_vert.spv", SHADER_SPIRV(ParticleVertex) },
+	[SHADER_PARTICLE_FRAGMENT] = { L"particle_frag.spv", SHADER_SPIRV(ParticleFragment) }
+};
+
+// set by --shader-dir. files found there take precedence over the embedded SPIR-V and are
+// reloaded whenever the directory changes
+static WCHAR ShaderDirectory[MAX_PATH];
+
+#define PIPELINE_MAX_SPECIALIZATION_CONSTANTS 4
+
+enum VertexLayout
+{
+	VERTEX_LAYOUT_SCENE,
+
+	// no vertex input at all. the vertex shader reads the mesh through buffer addresses
+	VERTEX_LAYOUT_PULLED
+};
+
+/*
+* everything that tells one scene pipeline from another. only 32 bit fields, so there is no
+* padding and the struct can be hashed and compared as bytes. specialization constant i has
+* constant_id i in both stages: the fragment shader takes TEXTURED and OPACITY (in percent)
+*/
+struct PipelineState
+{
+	uint32_t VertexShader;
+	uint32_t FragmentShader;
+	uint32_t VertexLayout;
+	uint32_t CullMode;
+	uint32_t DepthTest;
+	uint32_t DepthWrite;
+	uint32_t DepthCompareOp;
+	uint32_t BlendEnable;
+	uint32_t SpecializationConstantCount;
+	uint32_t SpecializationConstants[PIPELINE_MAX_SPECIALIZATION_CONSTANTS];
+};
+
+// FNV-1a
+uint64_t HashBytes(const void* Data, size_t Size)
+{
+	const uint8_t* Bytes = Data;
+	uint64_t Hash = 0xcbf29ce484222325;
+
+	for (size_t i = 0; i < Size; i++)
+	{
+		Hash ^= Bytes[i];
+		Hash *= 0x100000001b3;
+	}
+
+	return Hash;
+}
+
+uint64_t HashPipelineState(const struct PipelineState* State)
+{
+	return HashBytes(State, sizeof(struct PipelineState));
+}
+
+/*
+* with VK_EXT_graphics_pipeline_library a scene pipeline is linked from these four parts.
+* materials that only differ in one part share the other three
+*/
+enum PipelinePart
+{
+	PIPELINE_PART_VERTEX_INPUT,
+	PIPELINE_PART_PRE_RASTERIZATION,
+	PIPELINE_PART_FRAGMENT_SHADER,
+	PIPELINE_PART_FRAGMENT_OUTPUT,
+	PIPELINE_PART_COUNT
+};
+
+static const char* PIPELINE_PART_NAMES[PIPELINE_PART_COUNT] = {
+	"vertex input",
+	"pre-rasterization",
+	"fragment shader",
+	"fragment output"
+};
+
+static const VkGraphicsPipelineLibraryFlagsEXT PIPELINE_PART_FLAGS[PIPELINE_PART_COUNT] = {
+	VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT,
+	VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT,
+	VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT,
+	VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT
+};
+
+// keeps the fields Part is built from and zeroes the rest, so the result hashes like any state
+void GetPipelinePartState(const struct PipelineState* State, enum PipelinePart Part, struct PipelineState* PartState)
+{
+	memset(PartState, 0, sizeof(struct PipelineState));
+
+	switch (Part)
+	{
+	case PIPELINE_PART_VERTEX_INPUT:
+		PartState->VertexLayout = State->VertexLayout;
+		break;
+	case PIPELINE_PART_PRE_RASTERIZATION:
+		PartState->VertexShader = State->VertexShader;
+		PartState->CullMode = State->CullMode;
+		PartState->SpecializationConstantCount = State->SpecializationConstantCount;
+		memcpy(PartState->SpecializationConstants, State->SpecializationConstants, sizeof(State->SpecializationConstants));
+		break;
+	case PIPELINE_PART_FRAGMENT_SHADER:
+		PartState->FragmentShader = State->FragmentShader;
+		PartState->DepthTest = State->DepthTest;
+		PartState->DepthWrite = State->DepthWrite;
+		PartState->DepthCompareOp = State->DepthCompareOp;
+		PartState->SpecializationConstantCount = State->SpecializationConstantCount;
+		memcpy(PartState->SpecializationConstants, State->SpecializationConstants, sizeof(State->SpecializationConstants));
+		break;
+	case PIPELINE_PART_FRAGMENT_OUTPUT:
+		PartState->BlendEnable = State->BlendEnable;
+		break;
+	}
+}
+
+struct SceneMaterial
+{
+	const char* Name;
+	struct PipelineState State;
+};
+
+// the first material is the pipeline built at startup, and stands in for the others until
+// they have been compiled
+static const struct SceneMaterial SCENE_MATERIALS[] = {
+	{ "textured", { SHADER_SCENE_VERTEX, SHADER_SCENE_FRAGMENT, VERTEX_LAYOUT_SCENE, VK_CULL_MODE_BACK_BIT, VK_TRUE, VK_TRUE, VK_COMPARE_OP_LESS, VK_FALSE, 2, { VK_TRUE, 100 } } },
+	{ "vertex color", { SHADER_SCENE_VERTEX, SHADER_SCENE_FRAGMENT, VERTEX_LAYOUT_SCENE, VK_CULL_MODE_BACK_BIT, VK_TRUE, VK_TRUE, VK_COMPARE_OP_LESS, VK_FALSE, 2, { VK_FALSE, 100 } } },
+	{ "two sided", { SHADER_SCENE_VERTEX, SHADER_SCENE_FRAGMENT, VERTEX_LAYOUT_SCENE, VK_CULL_MODE_NONE, VK_TRUE, VK_TRUE, VK_COMPARE_OP_LESS, VK_FALSE, 2, { VK_TRUE, 100 } } },
+	{ "blended", { SHADER_SCENE_VERTEX, SHADER_SCENE_FRAGMENT, VERTEX_LAYOUT_SCENE, VK_CULL_MODE_NONE, VK_TRUE, VK_FALSE, VK_COMPARE_OP_LESS, VK_TRUE, 2, { VK_FALSE, 50 } } }
+};
+
+/*
+* vulkan-1.dll is loaded at runtime and every entry point is called through these pointers,
+* the way volk does it, so there is no import library to link. device functions come from
+* vkGetDeviceProcAddr, which returns the driver's own entry points: recording and submitting
+* skip the loader trampoline that would otherwise look up the device's dispatch table first
+*/
+#define VULKAN_GLOBAL_FUNCTIONS(X) \
+	X(vkCreateInstance)
+
+#define VULKAN_INSTANCE_FUNCTIONS(X) \
+	X(vkDestroyInstance) \
+	X(vkEnumeratePhysicalDevices) \
+	X(vkGetPhysicalDeviceProperties) \
+	X(vkGetPhysicalDeviceProperties2) \
+	X(vkGetPhysicalDeviceFeatures2) \
+	X(vkGetPhysicalDeviceFormatProperties) \
+	X(vkGetPhysicalDeviceImageFormatProperties2) \
+	X(vkGetPhysicalDeviceMemoryProperties) \
+	X(vkGetPhysicalDeviceMemoryProperties2) \
+	X(vkGetPhysicalDeviceQueueFamilyProperties) \
+	X(vkEnumerateDeviceExtensionProperties) \
+	X(vkCreateDevice) \
+	X(vkGetDeviceProcAddr)
+
+// only loaded when there is a window to present to
+#define VULKAN_SURFACE_FUNCTIONS(X) \
+	X(vkCreateWin32SurfaceKHR) \
+	X(vkDestroySurfaceKHR) \
+	X(vkGetPhysicalDeviceSurfaceSupportKHR) \
+	X(vkGetPhysicalDeviceSurfaceCapabilitiesKHR) \
+	X(vkGetPhysicalDeviceSurfaceFormatsKHR) \
+	X(vkGetPhysicalDeviceSurfacePresentModesKHR)
+
+#define VULKAN_DEVICE_FUNCTIONS(X) \
+	X(vkAllocateCommandBuffers) \
+	X(vkAllocateDescriptorSets) \
+	X(vkAllocateMemory) \
+	X(vkBeginCommandBuffer) \
+	X(vkBindBufferMemory) \
+	X(vkBindImageMemory) \
+	X(vkCmdBeginRenderPass) \
+	X(vkCmdBindDescriptorSets) \
+	X(vkCmdBindIndexBuffer) \
+	X(vkCmdBindPipeline) \
+	X(vkCmdBindVertexBuffers) \
+	X(vkCmdBlitImage) \
+	X(vkCmdClearColorImage) \
+	X(vkCmdCopyBuffer) \
+	X(vkCmdCopyBufferToImage) \
+	X(vkCmdCopyImage) \
+	X(vkCmdCopyImageToBuffer) \
+	X(vkCmdDispatch) \
+	X(vkCmdDraw) \
+	X(vkCmdDrawIndexed) \
+	X(vkCmdDrawIndirect) \
+	X(vkCmdEndRenderPass) \
+	X(vkCmdPipelineBarrier) \
+	X(vkCmdPushConstants) \
+	X(vkCmdResetQueryPool) \
+	X(vkCmdSetScissor) \
+	X(vkCmdSetViewport) \
+	X(vkCmdUpdateBuffer) \
+	X(vkCmdWriteTimestamp) \
+	X(vkCreateBuffer) \
+	X(vkCreateCommandPool) \
+	X(vkCreateComputePipelines) \
+	X(vkCreateDescriptorPool) \
+	X(vkCreateDescriptorSetLayout) \
+	X(vkCreateFramebuffer) \
+	X(vkCreateGraphicsPipelines) \
+	X(vkCreateImage) \
+	X(vkCreateImageView) \
+	X(vkCreatePipelineCache) \
+	X(vkCreatePipelineLayout) \
+	X(vkCreateQueryPool) \
+	X(vkCreateRenderPass) \
+	X(vkCreateSampler) \
+	X(vkCreateSemaphore) \
+	X(vkCreateShaderModule) \
+	X(vkDestroyBuffer) \
+	X(vkDestroyCommandPool) \
+	X(vkDestroyDescriptorPool) \
+	X(vkDestroyDescriptorSetLayout) \
+	X(vkDestroyDevice) \
+	X(vkDestroyFramebuffer) \
+	X(vkDestroyImage) \
+	X(vkDestroyImageView) \
+	X(vkDestroyPipeline) \
+	X(vkDestroyPipelineCache) \
+	X(vkDestroyPipelineLayout) \
+	X(vkDestroyQueryPool) \
+	X(vkDestroyRenderPass) \
+	X(vkDestroySampler) \
+	X(vkDestroySemaphore) \
+	X(vkDestroyShaderModule) \
+	X(vkDeviceWaitIdle) \
+	X(vkEndCommandBuffer) \
+	X(vkFlushMappedMemoryRanges) \
+	X(vkFreeCommandBuffers) \
+	X(vkFreeMemory) \
+	X(vkGetBufferDeviceAddress) \
+	X(vkGetBufferMemoryRequirements) \
+	X(vkGetDeviceQueue) \
+	X(vkGetImageMemoryRequirements) \
+	X(vkGetQueryPoolResults) \
+	X(vkGetSemaphoreCounterValue) \
+	X(vkInvalidateMappedMemoryRanges) \
+	X(vkMapMemory) \
+	X(vkQueueSubmit) \
+	X(vkResetCommandBuffer) \
+	X(vkUnmapMemory) \
+	X(vkUpdateDescriptorSets) \
+	X(vkWaitSemaphores)
+
+#define VULKAN_SWAPCHAIN_FUNCTIONS(X) \
+	X(vkAcquireNextImageKHR) \
+	X(vkCreateSwapchainKHR) \
+	X(vkDestroySwapchainKHR) \
+	X(vkGetSwapchainImagesKHR) \
+	X(vkQueuePresentKHR)
+
+#define DECLARE_VULKAN_FUNCTION(Name) static PFN_##Name Name;
+
+static PFN_vkGetInstanceProcAddr vkGetInstanceProcAddr;
+VULKAN_GLOBAL_FUNCTIONS(DECLARE_VULKAN_FUNCTION)
+VULKAN_INSTANCE_FUNCTIONS(DECLARE_VULKAN_FUNCTION)
+VULKAN_SURFACE_FUNCTIONS(DECLARE_VULKAN_FUNCTION)
+VULKAN_DEVICE_FUNCTIONS(DECLARE_VULKAN_FUNCTION)
+VULKAN_SWAPCHAIN_FUNCTIONS(DECLARE_VULKAN_FUNCTION)
+
+static HMODULE VulkanLibrary;
+
+#define LOAD_GLOBAL_FUNCTION(Name) if ((Name = (PFN_##Name)vkGetInstanceProcAddr(NULL, #Name)) == NULL) FailFastWithMessage("failed to load " #Name "\n");
+#define LOAD_INSTANCE_FUNCTION(Name) if ((Name = (PFN_##Name)vkGetInstanceProcAddr(Instance, #Name)) == NULL) FailFastWithMessage("failed to load " #Name "\n");
+#define LOAD_DEVICE_FUNCTION(Name) if ((Name = (PFN_##Name)vkGetDeviceProcAddr(Device, #Name)) == NULL) FailFastWithMessage("failed to load " #Name "\n");
+
+void LoadVulkanLibrary(void)
+{
+	VulkanLibrary = LoadLibraryW(L"vulkan-1.dll");
+	VALIDATE_HANDLE(VulkanLibrary);
+
+	vkGetInstanceProcAddr = (PFN_vkGetInstanceProcAddr)GetProcAddress(VulkanLibrary, "vkGetInstanceProcAddr");
+
+	if (vkGetInstanceProcAddr == NULL)
+		FailFastWithMessage("vulkan-1.dll does not export vkGetInstanceProcAddr\n");
+
+	VULKAN_GLOBAL_FUNCTIONS(LOAD_GLOBAL_FUNCTION)
+}
+
+// a headless instance has no surface extensions, and their functions stay NULL
+void LoadInstanceFunctions(VkInstance Instance, bool Surface)
+{
+	VULKAN_INSTANCE_FUNCTIONS(LOAD_INSTANCE_FUNCTION)
+
+	if (Surface)
+	{
+		VULKAN_SURFACE_FUNCTIONS(LOAD_INSTANCE_FUNCTION)
+	}
+}
+
+// there is only ever one device, so the table is global like the instance level one
+void LoadDeviceFunctions(VkDevice Device, bool Swapchain)
+{
+	VULKAN_DEVICE_FUNCTIONS(LOAD_DEVICE_FUNCTION)
+
+	if (Swapchain)
+	{
+		VULKAN_SWAPCHAIN_FUNCTIONS(LOAD_DEVICE_FUNCTION)
+	}
+}
+
+#ifdef _DEBUG
+static VKAPI_ATTR VkBool32 VKAPI_CALL DebugCallback(VkDebugUtilsMessageSeverityFlagBitsEXT MessageSeverity, VkDebugUtilsMessageTypeFlagsEXT MessageType, const VkDebugUtilsMessengerCallbackDataEXT* pCallbackData, void* pUserData)
+{
+	char buffer[512];
+	int stringlength = _snprintf_s(buffer, sizeof(buffer), _TRUNCATE, "validation layer: %s\n", pCallbackData->pMessage);
+	WriteLog(buffer, stringlength);
+	return VK_FALSE;
+}
+
+void DestroyDebugUtilsMessengerEXT(VkInstance VulkanInstance, VkDebugUtilsMessengerEXT DebugMessenger, const VkAllocationCallbacks* pAllocator)
+{
+	PFN_vkDestroyDebugUtilsMessengerEXT Func = vkGetInstanceProcAddr(VulkanInstance, "vkDestroyDebugUtilsMessengerEXT");
+	if (Func)
+	{
+		Func(VulkanInstance, DebugMessenger, pAllocator);
+	}
+}
+#endif
+
+struct QueueFamilyIndices
+{
+	uint32_t GraphicsFamily;
+	uint32_t PresentFamily;
+
+	// a compute-only family when the device has one, the graphics family otherwise
+	uint32_t ComputeFamily;
+};
+
+// VertexPullingShader.glsl reads these as 8 tightly packed floats
+struct Vertex
+{
+	vec3 Pos;
+	vec3 Color;
+	vec2 TexCoord;
+};
+
+// must match MAX_VIEWS in VertexShader.glsl. every device with multiview supports at least 6
+#define MAX_VIEWS 4
+
+enum ViewMode
+{
+	// one pass renders every view into its own layer, VK_KHR_multiview style
+	VIEW_MODE_MULTIVIEW,
+	// one pass per view, for comparing against the multiview pass
+	VIEW_MODE_SEQUENTIAL,
+	VIEW_MODE_COUNT
+};
+
+static const char* const VIEW_MODE_NAMES[VIEW_MODE_COUNT] = {
+	"multiview",
+	"sequential"
+};
+
+// the model transforms are per instance, in the scene's instance buffers
+struct UniformBufferObject
+{
+	alignas(16) mat4 View[MAX_VIEWS];
+	alignas(16) mat4 Proj[MAX_VIEWS];
+};
+
+// must match the push constants of the scene vertex shaders
+struct ScenePushConstants
+{
+	// the first view of the pass
+	uint32_t FirstView;
+	uint32_t Padding;
+
+	// the mesh, for the vertex pulling shader only
+	VkDeviceAddress Vertices;
+	VkDeviceAddress Indices;
+};
+
+static const struct Vertex Vertices[] = {
+	{{-0.5f, -0.5f, 0.0f}, {1.0f, 0.0f, 0.0f}, {1.0f, 0.0f}},
+	{{0.5f, -0.5f, 0.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f}},
+	{{0.5f, 0.5f, 0.0f}, {0.0f, 0.0f, 1.0f}, {0.0f, 1.0f}},
+	{{-0.5f, 0.5f, 0.0f}, {1.0f, 1.0f, 1.0f}, {1.0f, 1.0f}},
+
+	{{-0.5f, -0.5f, -0.5f}, {1.0f, 0.0f, 0.0f}, {1.0f, 0.0f}},
+	{{0.5f, -0.5f, -0.5f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f}},
+	{{0.5f, 0.5f, -0.5f}, {0.0f, 0.0f, 1.0f}, {0.0f, 1.0f}},
+	{{-0.5f, 0.5f, -0.5f}, {1.0f, 1.0f, 1.0f}, {1.0f, 1.0f}}
+};
+
+// the vertex pulling shader reads the indices two at a time, so keep the count even
+static const uint16_t Indices[] = {
+	0, 1, 2, 2, 3, 0,
+	4, 5, 6, 6, 7, 4
+};
+
+#define SCENE_NODE_NONE UINT32_MAX
+#define SCENE_NODE_DIRTY 0x1
+
+/*
+* node transforms as parallel arrays, ordered by depth so every parent comes before its
+* children, with the children of one parent next to each other. each node is also an
+* instance: instance i of the scene's draw uses World[i]
+*/
+struct SceneGraph
+{
+	uint32_t Count;
+	uint32_t Capacity;
+
+	uint32_t* Parents;
+	uint32_t* Depths;
+	uint32_t* FirstChildren;
+	uint32_t* ChildCounts;
+	uint8_t* Flags;
+	mat4* Locals;
+	mat4* Worlds;
+
+	// nodes whose local transform changed since the last update, each listed once
+	uint32_t* DirtyNodes;
+	uint32_t DirtyCount;
+
+	// roots of the subtrees being recomputed, then their descendants
+	uint32_t* UpdateQueue;
+
+	// world transforms not yet written to each frame slot's instance buffer. a bit per slot
+	// in PendingSlots keeps every list free of duplicates
+	uint32_t* Pending[MAX_FRAMES_IN_FLIGHT];
+	uint32_t PendingCounts[MAX_FRAMES_IN_FLIGHT];
+	uint8_t* PendingSlots;
+
+	// accumulated over each stats interval
+	double UpdateMilliseconds;
+	uint64_t UploadedBytes;
+	uint32_t Samples;
+};
+
+void InitSceneGraph(struct SceneGraph* Scene, uint32_t Capacity)
+{
+	*Scene = (struct SceneGraph){ 0 };
+	Scene->Capacity = Capacity;
+
+	Scene->Parents = malloc(Capacity * sizeof(uint32_t));
+	Scene->Depths = malloc(Capacity * sizeof(uint32_t));
+	Scene->FirstChildren = malloc(Capacity * sizeof(uint32_t));
+	Scene->ChildCounts = calloc(Capacity, sizeof(uint32_t));
+	Scene->Flags = calloc(Capacity, sizeof(uint8_t));
+	Scene->Locals = _aligned_malloc(Capacity * sizeof(mat4), 16);
+	Scene->Worlds = _aligned_malloc(Capacity * sizeof(mat4), 16);
+	Scene->DirtyNodes = malloc(Capacity * sizeof(uint32_t));
+	Scene->UpdateQueue = malloc(Capacity * sizeof(uint32_t));
+	Scene->PendingSlots = calloc(Capacity, sizeof(uint8_t));
+
+	if (!Scene->Parents || !Scene->Depths || !Scene->FirstChildren || !Scene->ChildCounts || !Scene->Flags || !Scene->Locals || !Scene->Worlds || !Scene->DirtyNodes || !Scene->UpdateQueue || !Scene->PendingSlots)
+		FailFastWithMessage("out of memory\n");
+
+	for (uint32_t Slot = 0; Slot < MAX_FRAMES_IN_FLIGHT; Slot++)
+	{
+		Scene->Pending[Slot] = malloc(Capacity * sizeof(uint32_t));
+
+		if (Scene->Pending[Slot] == NULL)
+			FailFastWithMessage("out of memory\n");
+	}
+}
+
+void DestroySceneGraph(struct SceneGraph* Scene)
+{
+	free(Scene->Parents);
+	free(Scene->Depths);
+	free(Scene->FirstChildren);
+	free(Scene->ChildCounts);
+	free(Scene->Flags);
+	_aligned_free(Scene->Locals);
+	_aligned_free(Scene->Worlds);
+	free(Scene->DirtyNodes);
+	free(Scene->UpdateQueue);
+	free(Scene->PendingSlots);
+
+	for (uint32_t Slot = 0; Slot < MAX_FRAMES_IN_FLIGHT; Slot++)
+	{
+		free(Scene->Pending[Slot]);
+	}
+}
+
+static void MarkSceneNodeDirty(struct SceneGraph* Scene, uint32_t Node)
+{
+	if (!(Scene->Flags[Node] & SCENE_NODE_DIRTY))
+	{
+		Scene->Flags[Node] |= SCENE_NODE_DIRTY;
+		Scene->DirtyNodes[Scene->DirtyCount++] = Node;
+	}
+}
+
+// setting the transform a node already has leaves it clean
+void SetSceneNodeLocal(struct SceneGraph* Scene, uint32_t Node, mat4 Local)
+{
+	if (memcmp(Scene->Locals[Node], Local, sizeof(mat4)) == 0)
+		return;
+
+	glm_mat4_copy(Local, Scene->Locals[Node]);
+	MarkSceneNodeDirty(Scene, Node);
+}
+
+/*
+* nodes are added breadth first: a node's depth may not be less than the last one's, and
+* siblings have to be added one after the other
+*/
+uint32_t AddSceneNode(struct SceneGraph* Scene, uint32_t Parent, mat4 Local)
+{
+	if (Scene->Count == Scene->Capacity)
+		FailFastWithMessage("the scene graph is full\n");
+
+	uint32_t Node = Scene->Count;
+	uint32_t Depth = Parent == SCENE_NODE_NONE ? 0 : Scene->Depths[Parent] + 1;
+
+	if (Node > 0 && Depth < Scene->Depths[Node - 1])
+		FailFastWithMessage("scene nodes have to be added in order of depth\n");
+
+	if (Parent != SCENE_NODE_NONE)
+	{
+		if (Scene->ChildCounts[Parent] == 0)
+			Scene->FirstChildren[Parent] = Node;
+		else if (Scene->FirstChildren[Parent] + Scene->ChildCounts[Parent] != Node)
+			FailFastWithMessage("the children of a scene node have to be added together\n");
+
+		Scene->ChildCounts[Parent]++;
+	}
+
+	Scene->Parents[Node] = Parent;
+	Scene->Depths[Node] = Depth;
+	Scene->Count++;
+
+	glm_mat4_copy(Local, Scene->Locals[Node]);
+	MarkSceneNodeDirty(Scene, Node);
+
+	return Node;
+}
+
+/*
+* recomputes the world transforms below every node whose local transform changed, and
+* queues them for upload to each frame slot. untouched subtrees are never visited, so the
+* cost follows what moved rather than the size of the scene. returns the nodes recomputed
+*/
+uint32_t UpdateSceneGraph(struct SceneGraph* Scene)
+{
+	if (Scene->DirtyCount == 0)
+		return 0;
+
+	uint32_t QueueCount = 0;
+
+	// a node below another dirty node is recomputed as part of that node's subtree
+	for (uint32_t i = 0; i < Scene->DirtyCount; i++)
+	{
+		uint32_t Node = Scene->DirtyNodes[i];
+		uint32_t Ancestor = Scene->Parents[Node];
+
+		while (Ancestor != SCENE_NODE_NONE && !(Scene->Flags[Ancestor] & SCENE_NODE_DIRTY))
+		{
+			Ancestor = Scene->Parents[Ancestor];
+		}
+
+		if (Ancestor == SCENE_NODE_NONE)
+			Scene->UpdateQueue[QueueCount++] = Node;
+	}
+
+	// the subtrees are disjoint and a parent is always taken from the queue before its
+	// children, so each node is written once and after its parent
+	for (uint32_t i = 0; i < QueueCount; i++)
+	{
+		uint32_t Node = Scene->UpdateQueue[i];
+		uint32_t Parent = Scene->Parents[Node];
+
+		if (Parent == SCENE_NODE_NONE)
+			glm_mat4_copy(Scene->Locals[Node], Scene->Worlds[Node]);
+		else
+			glm_mat4_mul(Scene->Worlds[Parent], Scene->Locals[Node], Scene->Worlds[Node]);
+
+		for (uint32_t Slot = 0; Slot < MAX_FRAMES_IN_FLIGHT; Slot++)
+		{
+			if (!(Scene->PendingSlots[Node] & (1 << Slot)))
+			{
+				Scene->PendingSlots[Node] |= 1 << Slot;
+				Scene->Pending[Slot][Scene->PendingCounts[Slot]++] = Node;
+			}
+		}
+
+		for (uint32_t Child = 0; Child < Scene->ChildCounts[Node]; Child++)
+		{
+			Scene->UpdateQueue[QueueCount++] = Scene->FirstChildren[Node] + Child;
+		}
+	}
+
+	for (uint32_t i = 0; i < Scene->DirtyCount; i++)
+	{
+		Scene->Flags[Scene->DirtyNodes[i]] &= ~SCENE_NODE_DIRTY;
+	}
+
+	Scene->DirtyCount = 0;
+
+	return QueueCount;
+}
+
+/*
+* a static hierarchy for measuring the scene update: separate roots on a grid behind the
+* model, each with a ring of children and a ring of grandchildren below every child
+*/
+#define SCENE_STRESS_FANOUT 8
+#define SCENE_STRESS_NODES_PER_ROOT (1 + SCENE_STRESS_FANOUT + SCENE_STRESS_FANOUT * SCENE_STRESS_FANOUT)
+
+// NodeCount is a multiple of SCENE_STRESS_NODES_PER_ROOT
+void AddStressNodes(struct SceneGraph* Scene, uint32_t NodeCount)
+{
+	uint32_t RootCount = NodeCount / SCENE_STRESS_NODES_PER_ROOT;
+	uint32_t GridSize = (uint32_t)ceilf(sqrtf((float)RootCount));
+	float Spacing = 4.0f / GridSize;
+
+	uint32_t FirstRoot = Scene->Count;
+
+	for (uint32_t i = 0; i < RootCount; i++)
+	{
+		mat4 Local;
+		glm_translate_make(Local, (vec3) { (i % GridSize + 0.5f) * Spacing - 2.0f, (i / GridSize + 0.5f) * Spacing - 2.0f, -1.0f });
+		glm_scale_uni(Local, Spacing * 0.25f);
+		AddSceneNode(Scene, SCENE_NODE_NONE, Local);
+	}
+
+	for (uint32_t Level = 0; Level < 2; Level++)
+	{
+		uint32_t FirstParent = Level == 0 ? FirstRoot : FirstRoot + RootCount;
+		uint32_t ParentCount = Level == 0 ? RootCount : RootCount * SCENE_STRESS_FANOUT;
+
+		for (uint32_t Parent = FirstParent; Parent < FirstParent + ParentCount; Parent++)
+		{
+			for (uint32_t Child = 0; Child < SCENE_STRESS_FANOUT; Child++)
+			{
+				mat4 Local;
+				glm_rotate_make(Local, Child * (2.0f * GLM_PIf / SCENE_STRESS_FANOUT), (vec3) { 0.0f, 0.0f, 1.0f });
+				glm_translate(Local, (vec3) { 1.0f, 0.0f, 0.0f });
+				glm_scale_uni(Local, 0.3f);
+				AddSceneNode(Scene, Parent, Local);
+			}
+		}
+	}
+}
+
+// the view and projection matrices, recomputed only when the camera or the scene extent moves
+struct SceneCamera
+{
+	float Yaw;
+	float Pitch;
+	float Distance;
+	VkExtent2D Extent;
+
+	mat4 View[MAX_VIEWS];
+	mat4 Proj[MAX_VIEWS];
+
+	// bumped whenever the matrices change. 0 until they are first computed
+	uint64_t Version;
+
+	// the version each frame slot's uniform buffer holds
+	uint64_t UploadedVersions[MAX_FRAMES_IN_FLIGHT];
+};
+
+#ifdef ENABLE_PROFILING
+
+#define GPU_PROFILE_MAX_ZONES 32
+
+/*
+* timestamps are written in pairs around each zone and read back when the frame slot comes
+* around again, by which point the frame's timeline wait guarantees they are available
+*/
+struct GpuProfiler
+{
+	VkDevice Device;
+	VkQueryPool QueryPool;
+
+	uint32_t CurrentFrame;
+	uint32_t ZoneCounts[MAX_FRAMES_IN_FLIGHT];
+	const char* ZoneNames[MAX_FRAMES_IN_FLIGHT][GPU_PROFILE_MAX_ZONES];
+
+	// maps GPU timestamps onto the QueryPerformanceCounter timeline the CPU zones use
+	uint64_t CalibrationGpuTime;
+	LONGLONG CalibrationCpuTime;
+	double CpuTicksPerGpuTick;
+	uint64_t TimestampMask;
+
+	struct ProfileThreadBuffer* Track;
+};
+
+struct GpuZoneScope
+{
+	VkCommandBuffer CommandBuffer;
+	uint32_t Query;
+	bool Active;
+};
+
+struct GpuZoneScope GpuZoneBegin(struct GpuProfiler* Profiler, VkCommandBuffer CommandBuffer, const char* Name)
+{
+	struct GpuZoneScope Scope = { CommandBuffer, UINT32_MAX, true };
+
+	if (Profiler == NULL || Profiler->QueryPool == VK_NULL_HANDLE)
+		return Scope;
+
+	uint32_t Frame = Profiler->CurrentFrame;
+
+	if (Profiler->ZoneCounts[Frame] == GPU_PROFILE_MAX_ZONES)
+		return Scope;
+
+	uint32_t Zone = Profiler->ZoneCounts[Frame]++;
+	Profiler->ZoneNames[Frame][Zone] = Name;
+
+	Scope.Query = (Frame * GPU_PROFILE_MAX_ZONES + Zone) * 2;
+	vkCmdWriteTimestamp(CommandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, Profiler->QueryPool, Scope.Query);
+
+	return Scope;
+}
+
+void GpuZoneEnd(struct GpuProfiler* Profiler, struct GpuZoneScope* Scope)
+{
+	if (Scope->Query != UINT32_MAX)
+		vkCmdWriteTimestamp(Scope->CommandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, Profiler->QueryPool, Scope->Query + 1);
+
+	Scope->Active = false;
+}
+
+static LONGLONG GpuProfilerToCpuTicks(const struct GpuProfiler* Profiler, uint64_t GpuTime)
+{
+	int64_t GpuTicks = (int64_t)((GpuTime - Profiler->CalibrationGpuTime) & Profiler->TimestampMask);
+
+	// a timestamp from before the calibration wraps to a huge value within the valid bits
+	if (Profiler->TimestampMask != UINT64_MAX && (uint64_t)GpuTicks > Profiler->TimestampMask / 2)
+		GpuTicks -= (int64_t)Profiler->TimestampMask + 1;
+
+	return Profiler->CalibrationCpuTime + (LONGLONG)(GpuTicks * Profiler->CpuTicksPerGpuTick);
+}
+
+/*
+* turns the zones of the slot's last frame into events. a cached frame submitted again writes
+* the same zones, so this is all it needs
+*/
+void GpuProfilerCollectFrame(struct GpuProfiler* Profiler, uint32_t Frame)
+{
+	if (Profiler->QueryPool == VK_NULL_HANDLE)
+		return;
+
+	uint32_t ZoneCount = Profiler->ZoneCounts[Frame];
+
+	if (ZoneCount > 0)
+	{
+		uint64_t Timestamps[GPU_PROFILE_MAX_ZONES * 2];
+		VkResult Result = vkGetQueryPoolResults(Profiler->Device, Profiler->QueryPool, Frame * GPU_PROFILE_MAX_ZONES * 2, ZoneCount * 2, sizeof(Timestamps), Timestamps, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+
+		if (Result == VK_SUCCESS)
+		{
+			for (uint32_t i = 0; i < ZoneCount; i++)
+			{
+				struct ProfileEvent Event = { 0 };
+				Event.Name = Profiler->ZoneNames[Frame][i];
+				Event.Type = PROFILE_EVENT_ZONE;
+				Event.Start = GpuProfilerToCpuTicks(Profiler, Timestamps[i * 2]);
+				Event.End = GpuProfilerToCpuTicks(Profiler, Timestamps[i * 2 + 1]);
+				ProfileRecord(Profiler->Track, &Event);
+			}
+		}
+	}
+}
+
+/*
+* moves the zones the frame slot recorded last time around onto the GPU track, then resets
+* the slot's queries for this frame. must be recorded outside of any render pass
+*/
+void GpuProfilerBeginFrame(struct GpuProfiler* Profiler, VkCommandBuffer CommandBuffer, uint32_t Frame)
+{
+	if (Profiler->QueryPool == VK_NULL_HANDLE)
+		return;
+
+	GpuProfilerCollectFrame(Profiler, Frame);
+
+	vkCmdResetQueryPool(CommandBuffer, Profiler->QueryPool, Frame * GPU_PROFILE_MAX_ZONES * 2, GPU_PROFILE_MAX_ZONES * 2);
+
+	Profiler->ZoneCounts[Frame] = 0;
+	Profiler->CurrentFrame = Frame;
+}
+
+#define GPU_PROFILE_ZONE(Profiler, CommandBuffer, Name) for (struct GpuZoneScope GpuZone = GpuZoneBegin(Profiler, CommandBuffer, Name); GpuZone.Active; GpuZoneEnd(Profiler, &GpuZone))
+
+#else
+
+#define GPU_PROFILE_ZONE(Profiler, CommandBuffer, Name)
+
+#endif
+
+#define RENDER_GRAPH_MAX_RESOURCES 16
+#define RENDER_GRAPH_MAX_PASSES 16
+#define RENDER_GRAPH_MAX_PASS_RESOURCES 8
+#define RENDER_GRAPH_MAX_LAYERS MAX_VIEWS
+
+enum RenderGraphAccess
+{
+	RENDER_GRAPH_ACCESS_NONE,
+	RENDER_GRAPH_ACCESS_SWAPCHAIN_ACQUIRE,
+	RENDER_GRAPH_ACCESS_COLOR_ATTACHMENT_WRITE,
+	RENDER_GRAPH_ACCESS_DEPTH_ATTACHMENT_WRITE,
+	RENDER_GRAPH_ACCESS_TRANSFER_READ,
+	RENDER_GRAPH_ACCESS_TRANSFER_WRITE,
+	RENDER_GRAPH_ACCESS_FRAGMENT_SHADER_READ,
+	RENDER_GRAPH_ACCESS_PRESENT,
+	RENDER_GRAPH_ACCESS_COUNT
+};
+
+struct RenderGraphAccessInfo
+{
+	VkPipelineStageFlags StageMask;
+	VkAccessFlags AccessMask;
+	VkImageLayout Layout;
+	VkImageUsageFlags Usage;
+	bool Write;
+};
+
+static const struct RenderGraphAccessInfo RENDER_GRAPH_ACCESS_INFO[RENDER_GRAPH_ACCESS_COUNT] = {
+	[RENDER_GRAPH_ACCESS_NONE] = {
+		VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+		0,
+		VK_IMAGE_LAYOUT_UNDEFINED,
+		0,
+		false
+	},
+	// chains with the acquire semaphore wait, which happens at color attachment output
+	[RENDER_GRAPH_ACCESS_SWAPCHAIN_ACQUIRE] = {
+		VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+		0,
+		VK_IMAGE_LAYOUT_UNDEFINED,
+		0,
+		false
+	},
+	[RENDER_GRAPH_ACCESS_COLOR_ATTACHMENT_WRITE] = {
+		VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+		VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+		VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+		VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+		true
+	},
+	[RENDER_GRAPH_ACCESS_DEPTH_ATTACHMENT_WRITE] = {
+		VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+		VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+		VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+		VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+		true
+	},
+	[RENDER_GRAPH_ACCESS_TRANSFER_READ] = {
+		VK_PIPELINE_STAGE_TRANSFER_BIT,
+		VK_ACCESS_TRANSFER_READ_BIT,
+		VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+		VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+		false
+	},
+	[RENDER_GRAPH_ACCESS_TRANSFER_WRITE] = {
+		VK_PIPELINE_STAGE_TRANSFER_BIT,
+		VK_ACCESS_TRANSFER_WRITE_BIT,
+		VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+		VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+		true
+	},
+	[RENDER_GRAPH_ACCESS_FRAGMENT_SHADER_READ] = {
+		VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+		VK_ACCESS_SHADER_READ_BIT,
+		VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+		VK_IMAGE_USAGE_SAMPLED_BIT,
+		false
+	},
+	[RENDER_GRAPH_ACCESS_PRESENT] = {
+		VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+		0,
+		VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+		0,
+		false
+	}
+};
+
+enum RenderGraphResourceFlags
+{
+	RENDER_GRAPH_RESOURCE_IMPORTED = 0x1,
+	RENDER_GRAPH_RESOURCE_TRANSIENT = 0x2
+};
+
+struct RenderGraphResource
+{
+	const char* Name;
+	uint32_t Flags;
+	VkFormat Format;
+	VkImageAspectFlags Aspect;
+	uint32_t Layers;
+
+	// imported resources: the state the image is in when the graph starts, and the state it has to be left in
+	enum RenderGraphAccess InitialAccess;
+	enum RenderGraphAccess FinalAccess;
+
+	VkImage Image;
+	VkImageView View;
+
+	// one 2D view per layer of an array image, for passes that render a single layer
+	VkImageView LayerViews[RENDER_GRAPH_MAX_LAYERS];
+
+	uint32_t RefCount;
+	int FirstPass;
+	int LastPass;
+	enum RenderGraphAccess LastAccess;
+	VkImageUsageFlags Usage;
+	uint32_t MemorySlot;
+};
+
+typedef void (*RenderGraphRecordFunction)(VkCommandBuffer CommandBuffer, void* Context, void* FrameData);
+
+struct RenderGraphResourceUse
+{
+	uint32_t Resource;
+	enum RenderGraphAccess Access;
+};
+
+struct RenderGraphBarrier
+{
+	uint32_t Resource;
+	enum RenderGraphAccess Before;
+	enum RenderGraphAccess After;
+	bool Discard;
+};
+
+struct RenderGraphPass
+{
+	const char* Name;
+	RenderGraphRecordFunction Record;
+	void* Context;
+	bool SideEffects;
+
+	struct RenderGraphResourceUse Uses[RENDER_GRAPH_MAX_PASS_RESOURCES];
+	uint32_t UseCount;
+
+	bool Culled;
+	uint32_t RefCount;
+
+	struct RenderGraphBarrier Barriers[RENDER_GRAPH_MAX_PASS_RESOURCES];
+	uint32_t BarrierCount;
+};
+
+struct RenderGraphMemorySlot
+{
+	VkDeviceMemory Memory;
+	VkDeviceSize Size;
+	uint32_t TypeBits;
+	bool Lazy;
+	int LastPass;
+};
+
+struct RenderGraph
+{
+	struct RenderGraphResource Resources[RENDER_GRAPH_MAX_RESOURCES];
+	uint32_t ResourceCount;
+
+	struct RenderGraphPass Passes[RENDER_GRAPH_MAX_PASSES];
+	uint32_t PassCount;
+
+	struct RenderGraphBarrier FinalBarriers[RENDER_GRAPH_MAX_RESOURCES];
+	uint32_t FinalBarrierCount;
+
+	struct RenderGraphMemorySlot MemorySlots[RENDER_GRAPH_MAX_RESOURCES];
+	uint32_t MemorySlotCount;
+
+	VkExtent2D Extent;
+
+#ifdef ENABLE_PROFILING
+	// optional, wraps every pass in a GPU zone
+	struct GpuProfiler* GpuProfiler;
+#endif
+};
+
+/*
+* one timeline semaphore per queue. every submission signals the next value, so any
+* point of the queue's history can be polled or waited on from the CPU
+*/
+struct QueueTimeline
+{
+	VkSemaphore Semaphore;
+	uint64_t Value;
+};
+
+#define PARTICLE_GROUP_SIZE 256
+#define PARTICLE_DEFAULT_CAPACITY 65536
+
+struct Particle
+{
+	vec4 PositionLife;
+	vec4 VelocityMaxLife;
+};
+
+struct ParticleSimulationConstants
+{
+	float DeltaTime;
+	float Time;
+	uint32_t EmitCount;
+	uint32_t Capacity;
+	uint32_t Seed;
+};
+
+struct ParticleDrawConstants
+{
+	mat4 ViewProj;
+	vec4 CameraRight;
+	vec4 CameraUp;
+};
+
+/*
+* the particles live in two buffers that trade places every frame. the simulation reads
+* last frame's particles from one, integrates them and compacts the survivors into the
+* other, then emits new particles behind them; the frame draws that second buffer. each
+* buffer has a VkDrawIndirectCommand next to it whose instance count the compute passes
+* increment, so the draw never goes through the CPU
+*/
+struct ParticleSystem
+{
+	// zero when the simulation is disabled
+	uint32_t Capacity;
+
+	VkBuffer ParticleBuffers[2];
+	VkDeviceMemory ParticleBuffersMemory[2];
+	VkBuffer DrawArgsBuffers[2];
+	VkDeviceMemory DrawArgsBuffersMemory[2];
+
+	VkDescriptorSetLayout DescriptorSetLayout;
+	VkDescriptorPool DescriptorPool;
+
+	// indexed by the buffer the simulation reads from
+	VkDescriptorSet DescriptorSets[2];
+
+	VkPipelineLayout ComputePipelineLayout;
+	VkPipeline SimulatePipeline;
+	VkPipeline EmitPipeline;
+
+	VkPipelineLayout GraphicsPipelineLayout;
+	VkPipeline GraphicsPipeline;
+
+	// the pool belongs to the compute family, which may not be the graphics one
+	VkCommandPool CommandPool;
+	VkCommandBuffer CommandBuffers[MAX_FRAMES_IN_FLIGHT];
+	struct QueueTimeline Timeline;
+
+	// graphics timeline value of the last frame that drew from each buffer
+	uint64_t BufferReleaseValues[2];
+	uint32_t DrawBuffer;
+	bool DrawArgsInitialized;
+
+	float LastTime;
+	float EmitRemainder;
+	uint32_t Seed;
+
+	struct ParticleDrawConstants DrawConstants;
+
+	// GPU time of the simulation, averaged over each stats interval
+	VkQueryPool QueryPool;
+	float TimestampPeriod;
+	bool QueryPending[MAX_FRAMES_IN_FLIGHT];
+	double SimulationMilliseconds;
+	uint32_t SimulationSamples;
+};
+
+#define CAPTURE_BUFFER_COUNT 4
+
+enum CaptureFormat
+{
+	// RGBA8 pixels, one tightly packed frame after the other
+	CAPTURE_FORMAT_RAW,
+	// one QOI image per frame, back to back. each carries its own size
+	CAPTURE_FORMAT_QOI,
+	CAPTURE_FORMAT_COUNT
+};
+
+static const char* const CAPTURE_FORMAT_NAMES[CAPTURE_FORMAT_COUNT] = {
+	"raw",
+	"qoi"
+};
+
+struct CaptureBuffer
+{
+	VkBuffer Buffer;
+	VkDeviceMemory Memory;
+	VkDeviceSize Size;
+	void* Mapped;
+
+	// non coherent memory has to be invalidated before the writer reads it
+	bool Coherent;
+
+	uint32_t Width;
+	uint32_t Height;
+
+	// graphics timeline value of the frame that copied into the buffer
+	uint64_t TimelineValue;
+};
+
+/*
+* the readback buffers form a ring shared by the render thread, which fills them, and the
+* writer thread, which encodes them and hands them back. Tail is only written by the render
+* thread and Head only by the writer, like the render command queue. when the writer still
+* holds every buffer, the frame is left out of the capture instead of waiting for it
+*/
+struct FrameCapture
+{
+	bool Enabled;
+	enum CaptureFormat Format;
+	HANDLE Output;
+	bool OutputIsStdout;
+	bool Bgra;
+
+	struct CaptureBuffer Buffers[CAPTURE_BUFFER_COUNT];
+
+	alignas(64) volatile ULONG Head;
+	alignas(64) volatile ULONG Tail;
+	HANDLE WakeEvent;
+	HANDLE Thread;
+	volatile LONG Quit;
+
+	// only touched by the writer thread
+	uint8_t* EncodeBuffer;
+	size_t EncodeBufferSize;
+	bool OutputFailed;
+
+	volatile LONG64 FramesWritten;
+	volatile LONG64 BytesWritten;
+
+	// only touched by the render thread
+	uint32_t FramesDropped;
+};
+
+struct DeferredDeletion
+{
+	uint64_t TimelineValue;
+	VkBuffer Buffer;
+	VkDeviceMemory Memory;
+	VkCommandBuffer CommandBuffer;
+};
+
+struct FrameContext
+{
+	uint32_t FrameIndex;
+	uint32_t ImageIndex;
+
+	// NULL when the capture is off or dropped this frame
+	struct CaptureBuffer* CaptureBuffer;
+};
+
+struct TextureUploadContext
+{
+	VkBuffer StagingBuffer;
+	VkImage Image;
+	uint32_t Width;
+	uint32_t Height;
+};
+
+// the views one scene pass renders. multiview passes cover all of them at once
+struct ScenePassContext
+{
+	struct VulkanObjects* VulkanObjects;
+	uint32_t FirstView;
+	uint32_t ViewCount;
+};
+
+// GPU time from the start of the first scene pass to the end of the last, averaged over each stats interval
+struct SceneTimer
+{
+	VkQueryPool QueryPool;
+	float TimestampPeriod;
+	bool QueryPending[MAX_FRAMES_IN_FLIGHT];
+	double Milliseconds;
+	uint32_t Samples;
+
+	// the most recent frame on its own, for the resolution controller
+	double LastMilliseconds;
+};
+
+#define DYNAMIC_RESOLUTION_MIN_SCALE 0.5f
+#define DYNAMIC_RESOLUTION_MAX_SCALE 1.0f
+
+/*
+* the scene is rendered into the top left corner of a swapchain sized target and blitted up
+* to the swapchain, so a new scale only changes the viewport and never reallocates anything
+*/
+struct DynamicResolution
+{
+	bool Enabled;
+	float BudgetMilliseconds;
+	float Scale;
+	VkFilter Filter;
+
+	// the scale each frame slot was last recorded with, to match up with its timestamps
+	float FrameScales[MAX_FRAMES_IN_FLIGHT];
+
+	// moving average of the scene's GPU time projected to full resolution
+	double SmoothedMilliseconds;
+};
+
+// everything a frame's commands depend on besides the mapped buffers. a cached frame whose
+// key differs from the current one is recorded again
+struct FrameRecordKey
+{
+	// bumped when the swapchain, the frame graph or the pipelines are recreated
+	uint64_t Version;
+	VkPipeline ScenePipeline;
+	VkExtent2D SceneExtent;
+
+	// the particle draw pushes the camera, and alternates between two buffers
+	uint64_t CameraVersion;
+	uint32_t ParticleBuffer;
+};
+
+struct CachedFrame
+{
+	VkCommandBuffer CommandBuffer;
+	struct FrameRecordKey Key;
+	bool Recorded;
+};
+
+/*
+* command buffers recorded once per swapchain image, frame slot and particle buffer, then
+* submitted again for as long as their key holds. a frame slot's previous submission has
+* retired before the slot is reused, so a cached buffer is never pending when it is submitted
+*/
+struct FrameCache
+{
+	bool Enabled;
+	uint64_t Version;
+	struct CachedFrame Frames[SWAP_CHAIN_MAX_IMAGE_COUNT][MAX_FRAMES_IN_FLIGHT][2];
+
+	// over each stats interval
+	uint32_t RecordedFrames;
+	uint32_t ReusedFrames;
+};
+
+struct VulkanObjects
+{
+#ifdef _DEBUG
+	VkDebugUtilsMessengerEXT DebugMessenger;
+#endif
+	VkSurfaceKHR Surface;
+
+	VkFormat DepthFormat;
+
+	VkPhysicalDevice PhysicalDevice;
+	VkDevice Device;
+
+	uint32_t DeviceApiVersion;
+
+	bool UseDynamicRendering;
+	bool UsePipelineLibrary;
+	bool PipelineLibraryFastLinking;
+	PFN_vkCmdBeginRendering CmdBeginRendering;
+	PFN_vkCmdEndRendering CmdEndRendering;
+
+	// the texture is written from the host instead of through a staging buffer
+	bool UseHostImageCopy;
+	PFN_vkTransitionImageLayoutEXT TransitionImageLayout;
+	PFN_vkCopyMemoryToImageEXT CopyMemoryToImage;
+
+	// the scene pipelines have no vertex input and the vertex shader reads the mesh through
+	// VertexBufferAddress and IndexBufferAddress
+	bool UseVertexPulling;
+
+	struct QueueFamilyIndices QueueFamilyIndices;
+
+
+	VkQueue PresentQueue;
+	VkQueue GraphicsQueue;
+	VkQueue ComputeQueue;
+
+	uint32_t SwapChainImageCount;
+
+	VkSurfaceCapabilitiesKHR SurfaceCapabilities;
+	VkSwapchainKHR SwapChain;
+	VkImage SwapChainImages[SWAP_CHAIN_MAX_IMAGE_COUNT];
+	VkSurfaceFormatKHR SwapChainImageFormat;
+	VkPresentModeKHR SwapChainPresentMode;
+	VkExtent2D SwapChainExtent;
+	VkImageView SwapChainImageViews[SWAP_CHAIN_MAX_IMAGE_COUNT];
+	VkFramebuffer SwapChainFramebuffers[SWAP_CHAIN_MAX_IMAGE_COUNT];
+
+	VkRenderPass RenderPass;
+	VkPipelineLayout PipelineLayout;
+	VkPipeline GraphicsPipeline;
+
+	// every scene pipeline is compiled through the cache, on whichever thread builds it
+	VkPipelineCache PipelineCache;
+	struct PipelineRegistry* Pipelines;
+
+	// what the scene pass binds this frame. the render thread picks it before recording
+	VkPipeline ScenePipeline;
+
+	struct RenderGraph FrameGraph;
+	uint32_t SwapChainResource;
+	uint32_t DepthResource;
+
+	// the swapchain, or an offscreen target when more than one view is rendered or the
+	// resolution is dynamic. with several views each one has its own layer, and the layers
+	// are then copied side by side onto the swapchain
+	uint32_t SceneColorResource;
+	uint32_t ViewCount;
+	enum ViewMode ViewMode;
+	struct ScenePassContext ScenePasses[MAX_VIEWS];
+	struct SceneTimer SceneTimer;
+	struct DynamicResolution Resolution;
+
+	VkBuffer VertexBuffer;
+	VkDeviceMemory VertexBufferMemory;
+	VkBuffer IndexBuffer;
+	VkDeviceMemory IndexBufferMemory;
+	VkDeviceAddress VertexBufferAddress;
+	VkDeviceAddress IndexBufferAddress;
+
+	void* UniformBuffersMapped[MAX_FRAMES_IN_FLIGHT];
+
+	// owned by the startup context. kept here for flushing when the memory isn't coherent
+	VkDeviceMemory UniformBuffersMemory[MAX_FRAMES_IN_FLIGHT];
+	bool UniformBuffersCoherent;
+
+	struct SceneGraph Scene;
+	struct SceneCamera SceneCamera;
+
+	// the node the window's model hangs from, rotated every frame
+	uint32_t ModelNode;
+
+	// a world transform per scene node, one buffer per frame slot. owned by the startup
+	// context like the uniform buffers
+	VkDeviceMemory InstanceBuffersMemory[MAX_FRAMES_IN_FLIGHT];
+	void* InstanceBuffersMapped[MAX_FRAMES_IN_FLIGHT];
+	bool InstanceBuffersCoherent;
+
+	VkDescriptorSet DescriptorSets[MAX_FRAMES_IN_FLIGHT];
+
+	VkCommandPool CommandPool;
+	VkCommandBuffer CommandBuffers[MAX_FRAMES_IN_FLIGHT];
+	struct FrameCache FrameCache;
+
+	// binary semaphores are only kept where the swapchain requires them
+	VkSemaphore ImageAvailableSemaphores[MAX_FRAMES_IN_FLIGHT];
+	VkSemaphore RenderFinishedSemaphores[MAX_FRAMES_IN_FLIGHT];
+
+	struct QueueTimeline GraphicsTimeline;
+	uint32_t CurrentFrame;
+	uint64_t FrameTimelineValues[MAX_FRAMES_IN_FLIGHT];
+
+	struct ParticleSystem Particles;
+
+	struct FrameCapture Capture;
+
+#ifdef ENABLE_PROFILING
+	struct GpuProfiler GpuProfiler;
+#endif
+
+	struct DeferredDeletion DeferredDeletions[MAX_DEFERRED_DELETIONS];
+	uint32_t DeferredDeletionCount;
+};
+
+// the state a scene material is built with on this device
+struct PipelineState GetSceneMaterialState(const struct VulkanObjects* VulkanObjects, uint32_t Material)
+{
+	struct PipelineState State = SCENE_MATERIALS[Material].State;
+
+	if (VulkanObjects->UseVertexPulling)
+	{
+		State.VertexShader = SHADER_SCENE_VERTEX_PULLING;
+		State.VertexLayout = VERTEX_LAYOUT_PULLED;
+	}
+
+	return State;
+}
+
+uint32_t ClampU32(uint32_t value, uint32_t min, uint32_t max)
+{
+	if (value < min)
+	{
+		return min;
+	}
+	else if (value > max)
+	{
+		return max;
+	}
+	return value;
+}
+
+#define JOB_SYSTEM_MAX_THREADS 16
+// deques kept free for JobSystemAddThread: the render thread
+#define JOB_SYSTEM_ADDED_THREADS 1
+#define JOB_DEQUE_SIZE 256
+#define JOB_POOL_SIZE 1024
+#define JOB_MAX_SUCCESSORS 8
+
+typedef void (*JobFunction)(void* Context);
+
+/*
+* counts unfinished jobs. a counter is incremented when a job is created against it and
+* decremented when that job has run, so waiting for zero waits for the whole group. the job
+* that takes it to zero wakes the threads sleeping on Value
+*/
+struct JobCounter
+{
+	volatile LONG Value;
+};
+
+struct Job
+{
+	const char* Name;
+	JobFunction Function;
+	void* Context;
+	struct JobCounter* Counter;
+
+	// predecessors that have not finished, plus one until the job is submitted
+	volatile LONG UnfinishedDependencies;
+
+	struct Job* Successors[JOB_MAX_SUCCESSORS];
+	uint32_t SuccessorCount;
+
+	// set from JobCreate until the job has run, so a pool slot still in use isn't handed out
+	volatile LONG Alive;
+};
+
+/*
+* Chase-Lev work stealing deque. the owning thread pushes and pops at Bottom, any other
+* thread steals from Top
+*/
+struct JobDeque
+{
+	alignas(64) volatile LONG64 Top;
+	alignas(64) volatile LONG64 Bottom;
+	struct Job* volatile Jobs[JOB_DEQUE_SIZE];
+};
+
+struct JobWorker
+{
+	struct JobSystem* System;
+	uint32_t ThreadIndex;
+	HANDLE Thread;
+};
+
+/*
+* thread 0 is the thread that created the job system; it only runs jobs while it waits in
+* JobSystemWait. threads 1 to WorkerCount are workers, and any thread after them was added
+* with JobSystemAddThread and, like thread 0, only runs jobs while it waits. each thread owns
+* the deque at its index
+*/
+struct JobSystem
+{
+	struct JobDeque Deques[JOB_SYSTEM_MAX_THREADS];
+	struct JobWorker Workers[JOB_SYSTEM_MAX_THREADS];
+	uint32_t WorkerCount;
+
+	// grows when a thread is added, so it is read with ReadAcquire
+	volatile LONG ThreadCount;
+
+	// released once per pushed job, idle threads sleep on it
+	HANDLE WorkAvailable;
+	volatile LONG Quit;
+
+	// jobs are recycled round robin. reaching a slot that is still alive fails fast
+	volatile LONG NextJob;
+	struct Job Jobs[JOB_POOL_SIZE];
+};
+
+#define JOB_THREAD_NONE UINT32_MAX
+
+// a Chase-Lev deque has one owner, so a thread that was never given one must not touch any
+static __declspec(thread) uint32_t JobThreadIndex = JOB_THREAD_NONE;
+
+static void JobDequePush(struct JobDeque* Deque, struct Job* Job)
+{
+	LONG64 Bottom = Deque->Bottom;
+	LONG64 Top = ReadAcquire64(&Deque->Top);
+
+	if (Bottom - Top >= JOB_DEQUE_SIZE)
+		FailFastWithMessage("job deque overflow\n");
+
+	Deque->Jobs[Bottom & (JOB_DEQUE_SIZE - 1)] = Job;
+	WriteRelease64(&Deque->Bottom, Bottom + 1);
+}
+
+static struct Job* JobDequePop(struct JobDeque* Deque)
+{
+	LONG64 Bottom = Deque->Bottom - 1;
+
+	// the exchange is a full barrier, so a thief either sees the lowered Bottom or loses
+	// the race for Top below
+	InterlockedExchange64(&Deque->Bottom, Bottom);
+
+	LONG64 Top = Deque->Top;
+
+	if (Top > Bottom)
+	{
+		Deque->Bottom = Top;
+		return NULL;
+	}
+
+	struct Job* Job = Deque->Jobs[Bottom & (JOB_DEQUE_SIZE - 1)];
+
+	if (Top == Bottom)
+	{
+		// last job, race the thieves for it
+		if (InterlockedCompareExchange64(&Deque->Top, Top + 1, Top) != Top)
+			Job = NULL;
+
+		Deque->Bottom = Top + 1;
+	}
+
+	return Job;
+}
+
+static struct Job* JobDequeSteal(struct JobDeque* Deque)
+{
+	LONG64 Top = ReadAcquire64(&Deque->Top);
+	MemoryBarrier();
+	LONG64 Bottom = ReadAcquire64(&Deque->Bottom);
+
+	if (Top >= Bottom)
+		return NULL;
+
+	struct Job* Job = Deque->Jobs[Top & (JOB_DEQUE_SIZE - 1)];
+
+	if (InterlockedCompareExchange64(&Deque->Top, Top + 1, Top) != Top)
+		return NULL;
+
+	return Job;
+}
+
+static void JobSystemPush(struct JobSystem* System, struct Job* Job)
+{
+	if (JobThreadIndex == JOB_THREAD_NONE)
+		FailFastWithMessage("job submitted from a thread the job system doesn't know\n");
+
+	JobDequePush(&System->Deques[JobThreadIndex], Job);
+	ReleaseSemaphore(System->WorkAvailable, 1, NULL);
+}
+
+static struct Job* JobSystemFindWork(struct JobSystem* System)
+{
+	if (JobThreadIndex == JOB_THREAD_NONE)
+		FailFastWithMessage("job system waited on from a thread it doesn't know\n");
+
+	struct Job* Job = JobDequePop(&System->Deques[JobThreadIndex]);
+	uint32_t ThreadCount = ReadAcquire(&System->ThreadCount);
+
+	for (uint32_t i = 1; i < ThreadCount && Job == NULL; i++)
+	{
+		Job = JobDequeSteal(&System->Deques[(JobThreadIndex + i) % ThreadCount]);
+	}
+
+	return Job;
+}
+
+static void JobExecute(struct JobSystem* System, struct Job* Job)
+{
+	PROFILE_ZONE(Job->Name)
+	{
+		Job->Function(Job->Context);
+	}
+
+	for (uint32_t i = 0; i < Job->SuccessorCount; i++)
+	{
+		if (InterlockedDecrement(&Job->Successors[i]->UnfinishedDependencies) == 0)
+			JobSystemPush(System, Job->Successors[i]);
+	}
+
+	// the slot may be reused as soon as Alive is cleared, so Counter is read first
+	struct JobCounter* Counter = Job->Counter;
+	WriteRelease(&Job->Alive, FALSE);
+
+	// the waiter may return and end the counter's lifetime before the wake, which only uses
+	// the address as a key
+	if (Counter && InterlockedDecrement(&Counter->Value) == 0)
+		WakeByAddressAll((PVOID)&Counter->Value);
+}
+
+static DWORD WINAPI JobWorkerProc(LPVOID Parameter)
+{
+	struct JobWorker* Worker = Parameter;
+	struct JobSystem* System = Worker->System;
+
+	JobThreadIndex = Worker->ThreadIndex;
+
+#ifdef ENABLE_PROFILING
+	{
+		char ThreadName[32];
+		_snprintf_s(ThreadName, sizeof(ThreadName), _TRUNCATE, "Job Worker %u", Worker->ThreadIndex);
+		PROFILE_THREAD_NAME(ThreadName);
+	}
+#endif
+
+	while (!ReadAcquire(&System->Quit))
+	{
+		struct Job* Job = JobSystemFindWork(System);
+
+		if (Job)
+			JobExecute(System, Job);
+		else
+			WaitForSingleObject(System->WorkAvailable, INFINITE);
+	}
+
+	return 0;
+}
+
+struct JobSystem* JobSystemCreate(uint32_t WorkerCount)
+{
+	struct JobSystem* System = _aligned_malloc(sizeof(struct JobSystem), alignof(struct JobSystem));
+
+	if (System == NULL)
+		FailFastWithMessage("failed to allocate the job system\n");
+
+	memset(System, 0, sizeof(struct JobSystem));
+
+	System->WorkerCount = ClampU32(WorkerCount, 0, JOB_SYSTEM_MAX_THREADS - 1 - JOB_SYSTEM_ADDED_THREADS);
+	System->ThreadCount = System->WorkerCount + 1;
+
+	System->WorkAvailable = CreateSemaphoreW(NULL, 0, MAXLONG, NULL);
+	VALIDATE_HANDLE(System->WorkAvailable);
+
+	JobThreadIndex = 0;
+
+	for (uint32_t i = 1; i <= System->WorkerCount; i++)
+	{
+		System->Workers[i].System = System;
+		System->Workers[i].ThreadIndex = i;
+		System->Workers[i].Thread = CreateThread(NULL, 0, JobWorkerProc, &System->Workers[i], 0, NULL);
+		VALIDATE_HANDLE(System->Workers[i].Thread);
+	}
+
+	return System;
+}
+
+void JobSystemDestroy(struct JobSystem* System)
+{
+	WriteRelease(&System->Quit, TRUE);
+	ReleaseSemaphore(System->WorkAvailable, System->ThreadCount, NULL);
+
+	for (uint32_t i = 1; i <= System->WorkerCount; i++)
+	{
+		WaitForSingleObject(System->Workers[i].Thread, INFINITE);
+		THROW_ON_FALSE(CloseHandle(System->Workers[i].Thread));
+	}
+
+	THROW_ON_FALSE(CloseHandle(System->WorkAvailable));
+	_aligned_free(System);
+}
+
+/*
+* gives the calling thread a deque of its own, so it can submit jobs and wait for them. the
+* workers start stealing from it once they see the new ThreadCount
+*/
+void JobSystemAddThread(struct JobSystem* System)
+{
+	LONG Index = InterlockedIncrement(&System->ThreadCount) - 1;
+
+	if (Index >= JOB_SYSTEM_MAX_THREADS)
+		FailFastWithMessage("too many job system threads\n");
+
+	JobThreadIndex = Index;
+}
+
+/*
+* the job does not run before JobSubmit, so dependencies can be added in between
+*/
+struct Job* JobCreate(struct JobSystem* System, const char* Name, JobFunction Function, void* Context, struct JobCounter* Counter)
+{
+	struct Job* Job = &System->Jobs[(ULONG)InterlockedIncrement(&System->NextJob) % JOB_POOL_SIZE];
+
+	if (InterlockedCompareExchange(&Job->Alive, TRUE, FALSE) != FALSE)
+		FailFastWithMessage("more than JOB_POOL_SIZE jobs alive\n");
+
+	Job->Name = Name;
+	Job->Function = Function;
+	Job->Context = Context;
+	Job->Counter = Counter;
+	Job->UnfinishedDependencies = 1;
+	Job->SuccessorCount = 0;
+
+	if (Counter)
+		InterlockedIncrement(&Counter->Value);
+
+	return Job;
+}
+
+// Job runs after DependsOn. DependsOn must not have been submitted yet
+void JobAddDependency(struct Job* Job, struct Job* DependsOn)
+{
+	if (DependsOn->SuccessorCount == JOB_MAX_SUCCESSORS)
+		FailFastWithMessage("too many job successors\n");
+
+	DependsOn->Successors[DependsOn->SuccessorCount++] = Job;
+	InterlockedIncrement(&Job->UnfinishedDependencies);
+}
+
+void JobSubmit(struct JobSystem* System, struct Job* Job)
+{
+	if (InterlockedDecrement(&Job->UnfinishedDependencies) == 0)
+		JobSystemPush(System, Job);
+}
+
+// runs jobs on the calling thread until every job counted by Counter has finished
+void JobSystemWait(struct JobSystem* System, struct JobCounter* Counter)
+{
+	LONG Value;
+
+	while ((Value = ReadAcquire(&Counter->Value)) > 0)
+	{
+		struct Job* Job = JobSystemFindWork(System);
+
+		if (Job)
+		{
+			JobExecute(System, Job);
+		}
+		else
+		{
+			// the rest are running on other threads. returns at once if Value is already stale
+			WaitOnAddress(&Counter->Value, &Value, sizeof(Value), INFINITE);
+		}
+	}
+}
+
+#define PIPELINE_REGISTRY_SIZE 64
+
+/*
+* a variant goes from COMPILING straight to READY when it is compiled whole. with pipeline
+* libraries it is LINKED in between: the render thread links it from its parts without
+* optimization and draws with that until the optimized link is READY. without fast linking
+* that link could take as long as a compile, so LinkedPipeline stays null and the startup
+* pipeline is drawn instead
+*/
+enum PipelineStatus
+{
+	PIPELINE_STATUS_EMPTY,
+	PIPELINE_STATUS_COMPILING,
+	PIPELINE_STATUS_LINKED,
+	PIPELINE_STATUS_READY
+};
+
+struct PipelineEntry
+{
+	struct PipelineRegistry* Registry;
+	uint64_t Hash;
+	struct PipelineState State;
+	VkPipeline Pipeline;
+	volatile LONG Status;
+
+	// only used with pipeline libraries
+	VkPipeline LinkedPipeline;
+	VkPipeline Libraries[PIPELINE_PART_COUNT];
+	double LinkMilliseconds;
+};
+
+// State only holds the fields of Part
+struct PipelineLibraryEntry
+{
+	struct PipelineRegistry* Registry;
+	enum PipelinePart Part;
+	uint64_t Hash;
+	struct PipelineState State;
+	VkPipeline Library;
+	volatile LONG Status;
+};
+
+/*
+* scene pipeline variants, keyed by the hash of their state. lookups and inserts only happen
+* on the render thread; a compile job only fills in the entry it was created for and
+* publishes it through Status
+*/
+struct PipelineRegistry
+{
+	struct VulkanObjects* VulkanObjects;
+	struct JobSystem* JobSystem;
+	struct JobCounter Pending;
+
+	// counts finished compiles, so the render thread knows when to redraw. WakeEvent is
+	// signaled with each one when it is set
+	volatile LONG Completed;
+	HANDLE WakeEvent;
+
+	// open addressing, entries are never removed one by one
+	struct PipelineEntry Entries[PIPELINE_REGISTRY_SIZE];
+	struct PipelineLibraryEntry Libraries[PIPELINE_REGISTRY_SIZE];
+};
+
+bool DeviceSupportsExtension(VkPhysicalDevice PhysicalDevice, const char* ExtensionName)
+{
+	uint32_t ExtensionCount = 0;
+	vkEnumerateDeviceExtensionProperties(PhysicalDevice, NULL, &ExtensionCount, NULL);
+
+	VkExtensionProperties* Extensions = malloc(ExtensionCount * sizeof(VkExtensionProperties));
+
+	if (Extensions == NULL)
+		FailFastWithMessage("out of memory\n");
+
+	vkEnumerateDeviceExtensionProperties(PhysicalDevice, NULL, &ExtensionCount, Extensions);
+
+	bool Supported = false;
+
+	for (uint32_t i = 0; i < ExtensionCount; i++)
+	{
+		if (strcmp(Extensions[i].extensionName, ExtensionName) == 0)
+		{
+			Supported = true;
+			break;
+		}
+	}
+
+	free(Extensions);
+
+	return Supported;
+}
+
+static const char* PhysicalDeviceTypeName(VkPhysicalDeviceType Type)
+{
+	switch (Type)
+	{
+	case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU: return "integrated";
+	case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU: return "discrete";
+	case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU: return "virtual";
+	case VK_PHYSICAL_DEVICE_TYPE_CPU: return "cpu";
+	default: return "other";
+	}
+}
+
+/*
+* returns -1 and sets Reason when the device can't run the renderer at all. otherwise the
+* device type decides, then the size of the largest device-local heap in MiB, with a few
+* queue and feature bonuses that are worth less than a GiB of VRAM
+*/
+int64_t ScorePhysicalDevice(VkPhysicalDevice PhysicalDevice, VkSurfaceKHR Surface, const char** Reason)
+{
+	VkPhysicalDeviceProperties Properties = { 0 };
+	vkGetPhysicalDeviceProperties(PhysicalDevice, &Properties);
+
+	if (Properties.apiVersion < VK_API_VERSION_1_2)
+	{
+		*Reason = "Vulkan 1.2 not supported";
+		return -1;
+	}
+
+	// a headless run presents nothing
+	for (int i = 0; i < ARRAYSIZE(DEVICE_EXTENSIONS) && Surface != VK_NULL_HANDLE; i++)
+	{
+		if (!DeviceSupportsExtension(PhysicalDevice, DEVICE_EXTENSIONS[i]))
+		{
+			*Reason = "missing a required extension";
+			return -1;
+		}
+	}
+
+	VkPhysicalDeviceDynamicRenderingFeatures DynamicRenderingFeatures = { 0 };
+	DynamicRenderingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES;
+
+	VkPhysicalDeviceTimelineSemaphoreFeatures TimelineSemaphoreFeatures = { 0 };
+	TimelineSemaphoreFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
+
+	bool DynamicRenderingAvailable = Properties.apiVersion >= VK_API_VERSION_1_3 || DeviceSupportsExtension(PhysicalDevice, VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME);
+	TimelineSemaphoreFeatures.pNext = DynamicRenderingAvailable ? &DynamicRenderingFeatures : NULL;
+
+	VkPhysicalDeviceFeatures2 Features = { 0 };
+	Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+	Features.pNext = &TimelineSemaphoreFeatures;
+	vkGetPhysicalDeviceFeatures2(PhysicalDevice, &Features);
+
+	if (TimelineSemaphoreFeatures.timelineSemaphore != VK_TRUE)
+	{
+		*Reason = "timeline semaphores not supported";
+		return -1;
+	}
+
+	if (Features.features.samplerAnisotropy != VK_TRUE)
+	{
+		*Reason = "sampler anisotropy not supported";
+		return -1;
+	}
+
+	uint32_t QueueFamilyCount = MAX_QUEUE_FAMILY_COUNT;
+	VkQueueFamilyProperties QueueFamilies[MAX_QUEUE_FAMILY_COUNT];
+	vkGetPhysicalDeviceQueueFamilyProperties(PhysicalDevice, &QueueFamilyCount, QueueFamilies);
+
+	bool HasGraphics = false;
+	bool HasPresent = false;
+	bool HasGraphicsPresent = false;
+	bool HasComputeOnly = false;
+
+	for (uint32_t i = 0; i < QueueFamilyCount; i++)
+	{
+		bool Graphics = (QueueFamilies[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) != 0;
+
+		VkBool32 PresentSupport = Graphics;
+
+		if (Surface != VK_NULL_HANDLE)
+			vkGetPhysicalDeviceSurfaceSupportKHR(PhysicalDevice, i, Surface, &PresentSupport);
+
+		HasGraphics |= Graphics;
+		HasPresent |= PresentSupport == VK_TRUE;
+		HasGraphicsPresent |= Graphics && PresentSupport == VK_TRUE;
+		HasComputeOnly |= !Graphics && (QueueFamilies[i].queueFlags & VK_QUEUE_COMPUTE_BIT) != 0;
+	}
+
+	if (!HasGraphics || !HasPresent)
+	{
+		*Reason = "no graphics or present queue for this window";
+		return -1;
+	}
+
+	int64_t Score = 0;
+
+	switch (Properties.deviceType)
+	{
+	case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU: Score += 4000000000LL; break;
+	case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU: Score += 3000000000LL; break;
+	case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU: Score += 2000000000LL; break;
+	case VK_PHYSICAL_DEVICE_TYPE_CPU: Score += 1000000000LL; break;
+	default: break;
+	}
+
+	VkPhysicalDeviceMemoryProperties MemoryProperties = { 0 };
+	vkGetPhysicalDeviceMemoryProperties(PhysicalDevice, &MemoryProperties);
+
+	VkDeviceSize LargestDeviceLocalHeap = 0;
+
+	for (uint32_t i = 0; i < MemoryProperties.memoryHeapCount; i++)
+	{
+		if (MemoryProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+			LargestDeviceLocalHeap = max(LargestDeviceLocalHeap, MemoryProperties.memoryHeaps[i].size);
+	}
+
+	Score += (int64_t)(LargestDeviceLocalHeap / (1024 * 1024));
+
+	// one family for both saves the ownership transfer between graphics and present
+	if (HasGraphicsPresent)
+		Score += 512;
+
+	if (DynamicRenderingFeatures.dynamicRendering == VK_TRUE)
+		Score += 256;
+
+	if (HasComputeOnly)
+		Score += 128;
+
+	*Reason = NULL;
+	return Score;
+}
+
+/*
+* a selector is a device index ("1"), a vendor:device pair in hex ("10de:2684") or a case
+* insensitive substring of the device name ("llvmpipe")
+*/
+bool PhysicalDeviceMatchesSelector(uint32_t Index, const VkPhysicalDeviceProperties* Properties, const char* Selector)
+{
+	bool AllDigits = Selector[0] != '\0';
+
+	for (const char* c = Selector; *c != '\0'; c++)
+		AllDigits &= *c >= '0' && *c <= '9';
+
+	if (AllDigits)
+		return strtoul(Selector, NULL, 10) == Index;
+
+	const char* Colon = strchr(Selector, ':');
+
+	if (Colon != NULL)
+	{
+		char* VendorEnd;
+		char* DeviceEnd;
+		unsigned long VendorId = strtoul(Selector, &VendorEnd, 16);
+		unsigned long DeviceId = strtoul(Colon + 1, &DeviceEnd, 16);
+
+		if (VendorEnd == Colon && *DeviceEnd == '\0')
+			return VendorId == Properties->vendorID && DeviceId == Properties->deviceID;
+	}
+
+	size_t SelectorLength = strlen(Selector);
+
+	for (const char* Name = Properties->deviceName; *Name != '\0'; Name++)
+	{
+		if (_strnicmp(Name, Selector, SelectorLength) == 0)
+			return true;
+	}
+
+	return false;
+}
+
+/*
+* picks the highest scoring device, or the first suitable device matching Selector when one
+* is given. an unsuitable match is skipped, so a selector like "nvidia" still finds a usable
+* card. every candidate is logged so the choice can be checked on multi-GPU hosts
+*/
+VkPhysicalDevice SelectPhysicalDevice(VkInstance Instance, VkSurfaceKHR Surface, const char* Selector)
+{
+	uint32_t DeviceCount = MAX_DEVICE_COUNT;
+	VkPhysicalDevice Devices[MAX_DEVICE_COUNT];
+
+	VkResult Result = vkEnumeratePhysicalDevices(Instance, &DeviceCount, Devices);
+
+	if (Result != VK_SUCCESS && Result != VK_INCOMPLETE)
+		THROW_ON_FAIL_VK(Result);
+
+	if (DeviceCount == 0)
+		FailFastWithMessage("no Vulkan devices found\n");
+
+	VkPhysicalDevice Selected = VK_NULL_HANDLE;
+	int64_t SelectedScore = -1;
+	uint32_t SelectorMatches = 0;
+
+	for (uint32_t i = 0; i < DeviceCount; i++)
+	{
+		VkPhysicalDeviceProperties Properties = { 0 };
+		vkGetPhysicalDeviceProperties(Devices[i], &Properties);
+
+		const char* Reason;
+		int64_t Score = ScorePhysicalDevice(Devices[i], Surface, &Reason);
+
+		if (Score < 0)
+			LogMessage("device %u: %s (%04x:%04x, %s) unsuitable: %s\n", i, Properties.deviceName, Properties.vendorID, Properties.deviceID, PhysicalDeviceTypeName(Properties.deviceType), Reason);
+		else
+			LogMessage("device %u: %s (%04x:%04x, %s) score %lld\n", i, Properties.deviceName, Properties.vendorID, Properties.deviceID, PhysicalDeviceTypeName(Properties.deviceType), Score);
+
+		if (Selector != NULL)
+		{
+			if (Selected != VK_NULL_HANDLE || !PhysicalDeviceMatchesSelector(i, &Properties, Selector))
+				continue;
+
+			SelectorMatches++;
+
+			if (Score < 0)
+			{
+				LogMessage("device selector \"%s\" matches device %u, which can't be used\n", Selector, i);
+				continue;
+			}
+
+			Selected = Devices[i];
+		}
+		else if (Score > SelectedScore)
+		{
+			Selected = Devices[i];
+			SelectedScore = Score;
+		}
+	}
+
+	if (Selector != NULL && Selected == VK_NULL_HANDLE)
+	{
+		LogMessage("device selector: \"%s\"\n", Selector);
+
+		if (SelectorMatches == 0)
+			FailFastWithMessage("no device matches the selector\n");
+
+		FailFastWithMessage("none of the devices matching the selector can be used\n");
+	}
+
+	if (Selected == VK_NULL_HANDLE)
+		FailFastWithMessage("no suitable Vulkan device found\n");
+
+	VkPhysicalDeviceProperties Properties = { 0 };
+	vkGetPhysicalDeviceProperties(Selected, &Properties);
+	LogMessage("using %s\n", Properties.deviceName);
+
+	return Selected;
+}
+
+#define MEMORY_MAX_TRACKED_ALLOCATIONS 256
+
+#define MEMORY_MAX_CANDIDATES 4
+#define MEMORY_MAX_FLUSH_RANGES 16
+
+// smaller host visible device local heaps are the legacy 256 MB BAR window, or less
+#define MEMORY_REBAR_MIN_HEAP_SIZE (256ull * 1024 * 1024)
+
+// static buffers up to this size are written in place instead of through a staging copy
+#define MEMORY_DIRECT_UPLOAD_MAX_SIZE (256 * 1024)
+
+enum MemoryCategory
+{
+	MEMORY_CATEGORY_VERTEX,
+	MEMORY_CATEGORY_INDEX,
+	MEMORY_CATEGORY_UNIFORM,
+	// scene node transforms
+	MEMORY_CATEGORY_INSTANCE,
+	MEMORY_CATEGORY_TEXTURE,
+	// depth and any other frame graph attachment
+	MEMORY_CATEGORY_RENDER_TARGET,
+	MEMORY_CATEGORY_STAGING,
+	// particle state and indirect arguments
+	MEMORY_CATEGORY_STORAGE,
+	MEMORY_CATEGORY_READBACK,
+	MEMORY_CATEGORY_COUNT
+};
+
+static const char* const MEMORY_CATEGORY_NAMES[MEMORY_CATEGORY_COUNT] = {
+	"vertex",
+	"index",
+	"uniform",
+	"instance",
+	"texture",
+	"render target",
+	"staging",
+	"storage",
+	"readback"
+};
+
+struct MemoryUsage
+{
+	VkDeviceSize Bytes;
+	VkDeviceSize PeakBytes;
+	uint32_t AllocationCount;
+	uint32_t PeakAllocationCount;
+
+	// counts frees too, so churn shows up even when the live numbers stay flat
+	uint64_t TotalAllocations;
+};
+
+struct MemoryReport
+{
+	struct MemoryUsage Categories[MEMORY_CATEGORY_COUNT];
+	struct MemoryUsage Types[VK_MAX_MEMORY_TYPES];
+	struct MemoryUsage Heaps[VK_MAX_MEMORY_HEAPS];
+	uint32_t TypeCount;
+	uint32_t HeapCount;
+	VkDeviceSize HeapSizes[VK_MAX_MEMORY_HEAPS];
+
+	// from VK_EXT_memory_budget. the driver's usage covers the whole process, including
+	// memory it allocated internally, so it is usually above what the heaps above add up to
+	bool BudgetSupported;
+	VkDeviceSize HeapBudgets[VK_MAX_MEMORY_HEAPS];
+	VkDeviceSize HeapUsages[VK_MAX_MEMORY_HEAPS];
+	VkDeviceSize PeakHeapUsages[VK_MAX_MEMORY_HEAPS];
+
+	// allocations made while every record was in use. they are left out of the totals and
+	// the leak check, so the numbers above are a lower bound whenever this isn't zero
+	uint64_t UntrackedAllocations;
+};
+
+struct MemoryAllocationRecord
+{
+	VkDeviceMemory Memory;
+	VkDeviceSize Size;
+	uint32_t MemoryType;
+	enum MemoryCategory Category;
+};
+
+/*
+* every device memory allocation goes through AllocateDeviceMemory and FreeDeviceMemory.
+* both the startup jobs and the render thread allocate, so the totals are kept behind a
+* lock; vkAllocateMemory itself costs far more than taking it
+*/
+static struct
+{
+	SRWLOCK Lock;
+	struct MemoryReport Report;
+
+	// written once by MemoryTrackerInit and read without the lock. the memory type policy
+	// works from this copy instead of asking the driver on every allocation
+	VkPhysicalDeviceMemoryProperties Properties;
+	VkDeviceSize NonCoherentAtomSize;
+
+	// resizable BAR, or a GPU that shares system memory: per-frame data can live in VRAM
+	bool HostVisibleDeviceLocal;
+
+	struct MemoryAllocationRecord Allocations[MEMORY_MAX_TRACKED_ALLOCATIONS];
+	uint32_t AllocationCount;
+} MemoryTracker = { SRWLOCK_INIT };
+
+void MemoryTrackerInit(VkPhysicalDevice PhysicalDevice, bool BudgetSupported)
+{
+	vkGetPhysicalDeviceMemoryProperties(PhysicalDevice, &MemoryTracker.Properties);
+
+	MemoryTracker.Report.TypeCount = MemoryTracker.Properties.memoryTypeCount;
+	MemoryTracker.Report.HeapCount = MemoryTracker.Properties.memoryHeapCount;
+	MemoryTracker.Report.BudgetSupported = BudgetSupported;
+
+	for (uint32_t i = 0; i < MemoryTracker.Properties.memoryHeapCount; i++)
+	{
+		MemoryTracker.Report.HeapSizes[i] = MemoryTracker.Properties.memoryHeaps[i].size;
+	}
+
+	VkPhysicalDeviceProperties DeviceProperties;
+	vkGetPhysicalDeviceProperties(PhysicalDevice, &DeviceProperties);
+	MemoryTracker.NonCoherentAtomSize = DeviceProperties.limits.nonCoherentAtomSize;
+
+	VkMemoryPropertyFlags Mappable = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+	VkDeviceSize MappableHeapSize = 0;
+
+	for (uint32_t i = 0; i < MemoryTracker.Properties.memoryTypeCount; i++)
+	{
+		const VkMemoryType* Type = &MemoryTracker.Properties.memoryTypes[i];
+
+		if ((Type->propertyFlags & Mappable) == Mappable)
+			MappableHeapSize = max(MappableHeapSize, MemoryTracker.Properties.memoryHeaps[Type->heapIndex].size);
+	}
+
+	MemoryTracker.HostVisibleDeviceLocal = MappableHeapSize >= MEMORY_REBAR_MIN_HEAP_SIZE;
+
+	if (MemoryTracker.HostVisibleDeviceLocal)
+		LogMessage("memory: per-frame data in host visible device local memory (%.0f MB heap)\n", MappableHeapSize / (1024.0 * 1024.0));
+	else
+		LogMessage("memory: per-frame data in host memory\n");
+}
+
+static void MemoryUsageAdd(struct MemoryUsage* Usage, VkDeviceSize Size)
+{
+	Usage->Bytes += Size;
+	Usage->AllocationCount++;
+	Usage->TotalAllocations++;
+
+	if (Usage->Bytes > Usage->PeakBytes)
+		Usage->PeakBytes = Usage->Bytes;
+
+	if (Usage->AllocationCount > Usage->PeakAllocationCount)
+		Usage->PeakAllocationCount = Usage->AllocationCount;
+}
+
+static void MemoryUsageRemove(struct MemoryUsage* Usage, VkDeviceSize Size)
+{
+	Usage->Bytes -= Size;
+	Usage->AllocationCount--;
+}
+
+/*
+* same contract as vkAllocateMemory, plus the category the allocation is accounted to. past
+* MEMORY_MAX_TRACKED_ALLOCATIONS the allocation still succeeds, it is only counted
+*/
+VkResult AllocateDeviceMemory(VkDevice Device, const VkMemoryAllocateInfo* AllocInfo, enum MemoryCategory Category, VkDeviceMemory* Memory)
+{
+	VkResult Result = vkAllocateMemory(Device, AllocInfo, NULL, Memory);
+
+	if (Result != VK_SUCCESS)
+		return Result;
+
+	AcquireSRWLockExclusive(&MemoryTracker.Lock);
+
+	if (MemoryTracker.AllocationCount == MEMORY_MAX_TRACKED_ALLOCATIONS)
+	{
+		MemoryTracker.Report.UntrackedAllocations++;
+		ReleaseSRWLockExclusive(&MemoryTracker.Lock);
+		return VK_SUCCESS;
+	}
+
+	struct MemoryAllocationRecord* Record = &MemoryTracker.Allocations[MemoryTracker.AllocationCount++];
+	Record->Memory = *Memory;
+	Record->Size = AllocInfo->allocationSize;
+	Record->MemoryType = AllocInfo->memoryTypeIndex;
+	Record->Category = Category;
+
+	MemoryUsageAdd(&MemoryTracker.Report.Categories[Category], Record->Size);
+	MemoryUsageAdd(&MemoryTracker.Report.Types[Record->MemoryType], Record->Size);
+	MemoryUsageAdd(&MemoryTracker.Report.Heaps[MemoryTracker.Properties.memoryTypes[Record->MemoryType].heapIndex], Record->Size);
+
+	ReleaseSRWLockExclusive(&MemoryTracker.Lock);
+
+	return VK_SUCCESS;
+}
+
+void FreeDeviceMemory(VkDevice Device, VkDeviceMemory Memory)
+{
+	if (Memory == VK_NULL_HANDLE)
+		return;
+
+	AcquireSRWLockExclusive(&MemoryTracker.Lock);
+
+	for (uint32_t i = 0; i < MemoryTracker.AllocationCount; i++)
+	{
+		struct MemoryAllocationRecord* Record = &MemoryTracker.Allocations[i];
+
+		if (Record->Memory != Memory)
+			continue;
+
+		MemoryUsageRemove(&MemoryTracker.Report.Categories[Record->Category], Record->Size);
+		MemoryUsageRemove(&MemoryTracker.Report.Types[Record->MemoryType], Record->Size);
+		MemoryUsageRemove(&MemoryTracker.Report.Heaps[MemoryTracker.Properties.memoryTypes[Record->MemoryType].heapIndex], Record->Size);
+
+		*Record = MemoryTracker.Allocations[--MemoryTracker.AllocationCount];
+		break;
+	}
+
+	ReleaseSRWLockExclusive(&MemoryTracker.Lock);
+
+	vkFreeMemory(Device, Memory, NULL);
+}
+
+// cheap enough to call every frame; without VK_EXT_memory_budget it does nothing
+void UpdateMemoryBudget(VkPhysicalDevice PhysicalDevice)
+{
+	if (!MemoryTracker.Report.BudgetSupported)
+		return;
+
+	VkPhysicalDeviceMemoryBudgetPropertiesEXT Budget = { 0 };
+	Budget.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+
+	VkPhysicalDeviceMemoryProperties2 Properties = { 0 };
+	Properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+	Properties.pNext = &Budget;
+	vkGetPhysicalDeviceMemoryProperties2(PhysicalDevice, &Properties);
+
+	AcquireSRWLockExclusive(&MemoryTracker.Lock);
+
+	for (uint32_t i = 0; i < MemoryTracker.Report.HeapCount; i++)
+	{
+		MemoryTracker.Report.HeapBudgets[i] = Budget.heapBudget[i];
+		MemoryTracker.Report.HeapUsages[i] = Budget.heapUsage[i];
+
+		if (Budget.heapUsage[i] > MemoryTracker.Report.PeakHeapUsages[i])
+			MemoryTracker.Report.PeakHeapUsages[i] = Budget.heapUsage[i];
+	}
+
+	ReleaseSRWLockExclusive(&MemoryTracker.Lock);
+}
+
+void GetMemoryReport(struct MemoryReport* Report)
+{
+	AcquireSRWLockShared(&MemoryTracker.Lock);
+	*Report = MemoryTracker.Report;
+	ReleaseSRWLockShared(&MemoryTracker.Lock);
+}
+
+void LogMemoryReport(void)
+{
+	struct MemoryReport Report;
+	GetMemoryReport(&Report);
+
+	// one line for the categories, with the allocation count of each in brackets
+	char Line[512] = "memory:";
+	size_t Length = strlen(Line);
+
+	for (int i = 0; i < MEMORY_CATEGORY_COUNT; i++)
+	{
+		if (Report.Categories[i].AllocationCount == 0)
+			continue;
+
+		int Written = _snprintf_s(Line + Length, sizeof(Line) - Length, _TRUNCATE, "%s %s %.2f MB (%u)", Length > strlen("memory:") ? "," : "", MEMORY_CATEGORY_NAMES[i], Report.Categories[i].Bytes / (1024.0 * 1024.0), Report.Categories[i].AllocationCount);
+
+		if (Written < 0)
+			break;
+
+		Length += Written;
+	}
+
+	LogMessage("%s\n", Line);
+
+	if (Report.UntrackedAllocations > 0)
+		LogMessage("memory: %llu allocations not tracked, only %u can be\n", Report.UntrackedAllocations, MEMORY_MAX_TRACKED_ALLOCATIONS);
+
+	for (uint32_t i = 0; i < Report.HeapCount; i++)
+	{
+		if (Report.BudgetSupported)
+		{
+			LogMessage("memory heap %u: %.1f MB allocated (peak %.1f), %.1f of %.1f MB budget used (peak %.1f)\n",
+				i,
+				Report.Heaps[i].Bytes / (1024.0 * 1024.0),
+				Report.Heaps[i].PeakBytes / (1024.0 * 1024.0),
+				Report.HeapUsages[i] / (1024.0 * 1024.0),
+				Report.HeapBudgets[i] / (1024.0 * 1024.0),
+				Report.PeakHeapUsages[i] / (1024.0 * 1024.0));
+		}
+		else
+		{
+			LogMessage("memory heap %u: %.1f MB allocated (peak %.1f) of %.1f MB\n",
+				i,
+				Report.Heaps[i].Bytes / (1024.0 * 1024.0),
+				Report.Heaps[i].PeakBytes / (1024.0 * 1024.0),
+				Report.HeapSizes[i] / (1024.0 * 1024.0));
+		}
+	}
+}
+
+// called right before the device is destroyed, when everything should have been freed
+void ReportLeakedDeviceMemory(void)
+{
+	AcquireSRWLockShared(&MemoryTracker.Lock);
+
+	for (uint32_t i = 0; i < MemoryTracker.AllocationCount; i++)
+	{
+		const struct MemoryAllocationRecord* Record = &MemoryTracker.Allocations[i];
+		LogMessage("leaked %s memory: %llu bytes of memory type %u\n", MEMORY_CATEGORY_NAMES[Record->Category], Record->Size, Record->MemoryType);
+	}
+
+	if (MemoryTracker.Report.UntrackedAllocations > 0)
+		LogMessage("%llu untracked allocations were not checked for leaks\n", MemoryTracker.Report.UntrackedAllocations);
+
+	ReleaseSRWLockShared(&MemoryTracker.Lock);
+}
+
+VkSemaphore CreateTimelineSemaphore(VkDevice Device)
+{
+	VkSemaphoreTypeCreateInfo TypeInfo = { 0 };
+	TypeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+	TypeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+	TypeInfo.initialValue = 0;
+
+	VkSemaphoreCreateInfo SemaphoreInfo = { 0 };
+	SemaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+	SemaphoreInfo.pNext = &TypeInfo;
+
+	VkSemaphore Semaphore;
+	THROW_ON_FAIL_VK(vkCreateSemaphore(Device, &SemaphoreInfo, NULL, &Semaphore));
+	return Semaphore;
+}
+
+void WaitForTimelineValue(VkDevice Device, const struct QueueTimeline* Timeline, uint64_t Value)
+{
+	VkSemaphoreWaitInfo WaitInfo = { 0 };
+	WaitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+	WaitInfo.semaphoreCount = 1;
+	WaitInfo.pSemaphores = &Timeline->Semaphore;
+	WaitInfo.pValues = &Value;
+	THROW_ON_FAIL_VK(vkWaitSemaphores(Device, &WaitInfo, UINT64_MAX));
+}
+
+uint64_t GetCompletedTimelineValue(VkDevice Device, const struct QueueTimeline* Timeline)
+{
+	uint64_t Value;
+	THROW_ON_FAIL_VK(vkGetSemaphoreCounterValue(Device, Timeline->Semaphore, &Value));
+	return Value;
+}
+
+/*
+* releases everything whose last use has retired on the graphics queue.
+* with Wait set, blocks until all of it has
+*/
+void ProcessDeferredDeletions(struct VulkanObjects* VulkanObjects, bool Wait)
+{
+	if (VulkanObjects->DeferredDeletionCount == 0)
+		return;
+
+	if (Wait)
+		WaitForTimelineValue(VulkanObjects->Device, &VulkanObjects->GraphicsTimeline, VulkanObjects->GraphicsTimeline.Value);
+
+	uint64_t CompletedValue = GetCompletedTimelineValue(VulkanObjects->Device, &VulkanObjects->GraphicsTimeline);
+
+	for (uint32_t i = 0; i < VulkanObjects->DeferredDeletionCount;)
+	{
+		struct DeferredDeletion* Deletion = &VulkanObjects->DeferredDeletions[i];
+
+		if (Deletion->TimelineValue > CompletedValue)
+		{
+			i++;
+			continue;
+		}
+
+		vkDestroyBuffer(VulkanObjects->Device, Deletion->Buffer, NULL);
+		FreeDeviceMemory(VulkanObjects->Device, Deletion->Memory);
+
+		if (Deletion->CommandBuffer != VK_NULL_HANDLE)
+			vkFreeCommandBuffers(VulkanObjects->Device, VulkanObjects->CommandPool, 1, &Deletion->CommandBuffer);
+
+		*Deletion = VulkanObjects->DeferredDeletions[--VulkanObjects->DeferredDeletionCount];
+	}
+}
+
+void DeferDeletion(struct VulkanObjects* VulkanObjects, uint64_t TimelineValue, VkBuffer Buffer, VkDeviceMemory Memory, VkCommandBuffer CommandBuffer)
+{
+	if (VulkanObjects->DeferredDeletionCount == MAX_DEFERRED_DELETIONS)
+		ProcessDeferredDeletions(VulkanObjects, true);
+
+	struct DeferredDeletion* Deletion = &VulkanObjects->DeferredDeletions[VulkanObjects->DeferredDeletionCount++];
+	Deletion->TimelineValue = TimelineValue;
+	Deletion->Buffer = Buffer;
+	Deletion->Memory = Memory;
+	Deletion->CommandBuffer = CommandBuffer;
+}
+
+VkCommandBuffer BeginSingleTimeCommands(VkDevice Device, VkCommandPool CommandPool)
+{
+	VkCommandBuffer CommandBuffer;
+
+	{
+		VkCommandBufferAllocateInfo AllocInfo = { 0 };
+		AllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		AllocInfo.commandPool = CommandPool;
+		AllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		AllocInfo.commandBufferCount = 1;
+		vkAllocateCommandBuffers(Device, &AllocInfo, &CommandBuffer);
+	}
+
+	{
+		VkCommandBufferBeginInfo BeginInfo = { 0 };
+		BeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		BeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		vkBeginCommandBuffer(CommandBuffer, &BeginInfo);
+	}
+
+	return CommandBuffer;
+}
+
+/*
+* submits without waiting. the returned graphics timeline value is reached once the
+* commands have executed; the command buffer itself is freed through the deletion queue
+*/
+uint64_t EndSingleTimeCommands(struct VulkanObjects* VulkanObjects, VkCommandBuffer CommandBuffer)
+{
+	vkEndCommandBuffer(CommandBuffer);
+
+	uint64_t SignalValue = ++VulkanObjects->GraphicsTimeline.Value;
+
+	{
+		VkTimelineSemaphoreSubmitInfo TimelineInfo = { 0 };
+		TimelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+		TimelineInfo.signalSemaphoreValueCount = 1;
+		TimelineInfo.pSignalSemaphoreValues = &SignalValue;
+
+		VkSubmitInfo SubmitInfo = { 0 };
+		SubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		SubmitInfo.pNext = &TimelineInfo;
+		SubmitInfo.commandBufferCount = 1;
+		SubmitInfo.pCommandBuffers = &CommandBuffer;
+		SubmitInfo.signalSemaphoreCount = 1;
+		SubmitInfo.pSignalSemaphores = &VulkanObjects->GraphicsTimeline.Semaphore;
+		THROW_ON_FAIL_VK(vkQueueSubmit(VulkanObjects->GraphicsQueue, 1, &SubmitInfo, VK_NULL_HANDLE));
+	}
+
+	DeferDeletion(VulkanObjects, SignalValue, VK_NULL_HANDLE, VK_NULL_HANDLE, CommandBuffer);
+
+	return SignalValue;
+}
+
+#ifdef ENABLE_PROFILING
+bool SupportsCalibratedTimestamps(VkInstance VulkanInstance, VkPhysicalDevice PhysicalDevice)
+{
+	if (!DeviceSupportsExtension(PhysicalDevice, VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME))
+		return false;
+
+	PFN_vkGetPhysicalDeviceCalibrateableTimeDomainsEXT GetTimeDomains = (PFN_vkGetPhysicalDeviceCalibrateableTimeDomainsEXT)vkGetInstanceProcAddr(VulkanInstance, "vkGetPhysicalDeviceCalibrateableTimeDomainsEXT");
+
+	if (GetTimeDomains == NULL)
+		return false;
+
+	VkTimeDomainEXT TimeDomains[8];
+	uint32_t TimeDomainCount = ARRAYSIZE(TimeDomains);
+	GetTimeDomains(PhysicalDevice, &TimeDomainCount, TimeDomains);
+
+	bool HasDevice = false;
+	bool HasQueryPerformanceCounter = false;
+
+	for (uint32_t i = 0; i < TimeDomainCount; i++)
+	{
+		HasDevice |= TimeDomains[i] == VK_TIME_DOMAIN_DEVICE_EXT;
+		HasQueryPerformanceCounter |= TimeDomains[i] == VK_TIME_DOMAIN_QUERY_PERFORMANCE_COUNTER_EXT;
+	}
+
+	return HasDevice && HasQueryPerformanceCounter;
+}
+
+/*
+* needs the command pool and the graphics timeline, and must not run while anything else
+* records from the pool
+*/
+void GpuProfilerInit(struct VulkanObjects* VulkanObjects, bool CalibratedTimestamps)
+{
+	struct GpuProfiler* Profiler = &VulkanObjects->GpuProfiler;
+	Profiler->Device = VulkanObjects->Device;
+
+	// thread ids are multiples of four, so this can't collide with a real thread
+	Profiler->Track = ProfileCreateTrack("GPU (graphics queue)", 1);
+
+	{
+		uint32_t QueueFamilyCount = 0;
+		vkGetPhysicalDeviceQueueFamilyProperties(VulkanObjects->PhysicalDevice, &QueueFamilyCount, NULL);
+
+		VkQueueFamilyProperties QueueFamilies[MAX_QUEUE_FAMILY_COUNT];
+		vkGetPhysicalDeviceQueueFamilyProperties(VulkanObjects->PhysicalDevice, &QueueFamilyCount, QueueFamilies);
+
+		uint32_t ValidBits = QueueFamilies[VulkanObjects->QueueFamilyIndices.GraphicsFamily].timestampValidBits;
+
+		if (ValidBits == 0)
+		{
+			LogMessage("profiler: the graphics queue does not support timestamps, GPU zones are disabled\n");
+			return;
+		}
+
+		Profiler->TimestampMask = ValidBits == 64 ? UINT64_MAX : (1ull << ValidBits) - 1;
+	}
+
+	{
+		VkPhysicalDeviceProperties DeviceProperties = { 0 };
+		vkGetPhysicalDeviceProperties(VulkanObjects->PhysicalDevice, &DeviceProperties);
+
+		// timestampPeriod is in nanoseconds
+		Profiler->CpuTicksPerGpuTick = DeviceProperties.limits.timestampPeriod * ProfilerState.Frequency.QuadPart / 1000000000.0;
+	}
+
+	{
+		VkQueryPoolCreateInfo QueryPoolInfo = { 0 };
+		QueryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+		QueryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+		QueryPoolInfo.queryCount = MAX_FRAMES_IN_FLIGHT * GPU_PROFILE_MAX_ZONES * 2;
+		THROW_ON_FAIL_VK(vkCreateQueryPool(VulkanObjects->Device, &QueryPoolInfo, NULL, &Profiler->QueryPool));
+	}
+
+	if (CalibratedTimestamps)
+	{
+		PFN_vkGetCalibratedTimestampsEXT GetCalibratedTimestamps = (PFN_vkGetCalibratedTimestampsEXT)vkGetDeviceProcAddr(VulkanObjects->Device, "vkGetCalibratedTimestampsEXT");
+
+		VkCalibratedTimestampInfoEXT TimestampInfos[2] = { 0 };
+		TimestampInfos[0].sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+		TimestampInfos[0].timeDomain = VK_TIME_DOMAIN_DEVICE_EXT;
+		TimestampInfos[1].sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+		TimestampInfos[1].timeDomain = VK_TIME_DOMAIN_QUERY_PERFORMANCE_COUNTER_EXT;
+
+		uint64_t Timestamps[2];
+		uint64_t MaxDeviation;
+		THROW_ON_FAIL_VK(GetCalibratedTimestamps(VulkanObjects->Device, ARRAYSIZE(TimestampInfos), TimestampInfos, Timestamps, &MaxDeviation));
+
+		Profiler->CalibrationGpuTime = Timestamps[0] & Profiler->TimestampMask;
+		Profiler->CalibrationCpuTime = Timestamps[1];
+	}
+	else
+	{
+		// bracket a lone timestamp with its submission and the wait for it. the midpoint is
+		// off by at most half of that round trip
+		VkCommandBuffer CommandBuffer = BeginSingleTimeCommands(VulkanObjects->Device, VulkanObjects->CommandPool);
+		vkCmdResetQueryPool(CommandBuffer, Profiler->QueryPool, 0, 1);
+		vkCmdWriteTimestamp(CommandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, Profiler->QueryPool, 0);
+
+		LARGE_INTEGER Before;
+		LARGE_INTEGER After;
+		QueryPerformanceCounter(&Before);
+
+		uint64_t CalibrationValue = EndSingleTimeCommands(VulkanObjects, CommandBuffer);
+		WaitForTimelineValue(VulkanObjects->Device, &VulkanObjects->GraphicsTimeline, CalibrationValue);
+
+		QueryPerformanceCounter(&After);
+
+		uint64_t GpuTime;
+		THROW_ON_FAIL_VK(vkGetQueryPoolResults(VulkanObjects->Device, Profiler->QueryPool, 0, 1, sizeof(GpuTime), &GpuTime, sizeof(GpuTime), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT));
+
+		Profiler->CalibrationGpuTime = GpuTime & Profiler->TimestampMask;
+		Profiler->CalibrationCpuTime = (Before.QuadPart + After.QuadPart) / 2;
+	}
+}
+#endif
+
+enum MemoryUsageClass
+{
+	// only the GPU touches it after creation
+	MEMORY_USAGE_GPU_ONLY,
+	// rewritten by the CPU every frame, read by the GPU
+	MEMORY_USAGE_CPU_TO_GPU,
+	// written by the GPU, read back by the CPU
+	MEMORY_USAGE_GPU_TO_CPU,
+	// written once by the CPU, copied from by the GPU
+	MEMORY_USAGE_STAGING,
+	MEMORY_USAGE_COUNT
+};
+
+struct MemoryCandidate
+{
+	VkMemoryPropertyFlags Required;
+	VkMemoryPropertyFlags Avoided;
+};
+
+/*
+* the property sets each usage accepts, best first. an empty entry ends the list. device
+* local memory is kept out of GPU_ONLY's first choice when the CPU can map it, so the
+* mappable part of VRAM stays free for the data that needs it
+*/
+static const struct MemoryCandidate MEMORY_CANDIDATES[MEMORY_USAGE_COUNT][MEMORY_MAX_CANDIDATES] = {
+	[MEMORY_USAGE_GPU_ONLY] = {
+		{ VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT },
+		{ VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0 }
+	},
+	[MEMORY_USAGE_CPU_TO_GPU] = {
+		{ VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 0 },
+		{ VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, 0 },
+		{ VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 0 },
+		{ VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, 0 }
+	},
+	[MEMORY_USAGE_GPU_TO_CPU] = {
+		{ VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT, 0 },
+		{ VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 0 },
+		{ VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, 0 }
+	},
+	[MEMORY_USAGE_STAGING] = {
+		{ VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT },
+		{ VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT },
+		{ VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, 0 }
+	}
+};
+
+static uint32_t FindMemoryTypeExcluding(uint32_t TypeFilter, VkMemoryPropertyFlags Required, VkMemoryPropertyFlags Avoided)
+{
+	const VkPhysicalDeviceMemoryProperties* MemProperties = &MemoryTracker.Properties;
+
+	for (uint32_t i = 0; i < MemProperties->memoryTypeCount; i++)
+	{
+		VkMemoryPropertyFlags Flags = MemProperties->memoryTypes[i].propertyFlags;
+
+		if ((TypeFilter & (1 << i)) && (Flags & Required) == Required && (Flags & Avoided) == 0)
+			return i;
+	}
+
+	return UINT32_MAX;
+}
+
+uint32_t TryFindMemoryType(uint32_t TypeFilter, VkMemoryPropertyFlags Properties)
+{
+	return FindMemoryTypeExcluding(TypeFilter, Properties, 0);
+}
+
+uint32_t FindMemoryType(uint32_t TypeFilter, VkMemoryPropertyFlags Properties)
+{
+	uint32_t MemoryType = TryFindMemoryType(TypeFilter, Properties);
+
+	if (MemoryType == UINT32_MAX)
+		FailFastWithMessage("failed to find suitable memory type!");
+
+	return MemoryType;
+}
+
+uint32_t SelectMemoryType(uint32_t TypeFilter, enum MemoryUsageClass Usage)
+{
+	for (int i = 0; i < MEMORY_MAX_CANDIDATES; i++)
+	{
+		const struct MemoryCandidate* Candidate = &MEMORY_CANDIDATES[Usage][i];
+
+		if (Candidate->Required == 0)
+			break;
+
+		// a small BAR window would run out long before the per-frame data does
+		if (Usage == MEMORY_USAGE_CPU_TO_GPU && (Candidate->Required & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) && !MemoryTracker.HostVisibleDeviceLocal)
+			continue;
+
+		uint32_t MemoryType = FindMemoryTypeExcluding(TypeFilter, Candidate->Required, Candidate->Avoided);
+
+		if (MemoryType != UINT32_MAX)
+			return MemoryType;
+	}
+
+	FailFastWithMessage("failed to find suitable memory type!");
+	return UINT32_MAX;
+}
+
+VkMemoryPropertyFlags GetMemoryTypeFlags(uint32_t MemoryType)
+{
+	return MemoryTracker.Properties.memoryTypes[MemoryType].propertyFlags;
+}
+
+/*
+* returns the property flags of the memory type that was picked, so the caller knows
+* whether the memory is mapped, device local or needs flushing
+*/
+VkMemoryPropertyFlags CreateBuffer(VkDevice Device, VkDeviceSize Size, VkBufferUsageFlags Usage, enum MemoryUsageClass MemoryUsage, enum MemoryCategory Category, VkBuffer* Buffer, VkDeviceMemory* BufferMemory)
+{
+	{
+		VkBufferCreateInfo BufferInfo = { 0 };
+		BufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		BufferInfo.size = Size;
+		BufferInfo.usage = Usage;
+		BufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		THROW_ON_FAIL_VK(vkCreateBuffer(Device, &BufferInfo, NULL, Buffer));
+	}
+
+	VkMemoryPropertyFlags Flags;
+
+	{
+		VkMemoryRequirements MemRequirements;
+		vkGetBufferMemoryRequirements(Device, *Buffer, &MemRequirements);
+
+		// a buffer with an address needs memory that can give it one
+		VkMemoryAllocateFlagsInfo AllocFlagsInfo = { 0 };
+		AllocFlagsInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO;
+		AllocFlagsInfo.flags = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT;
+
+		VkMemoryAllocateInfo AllocInfo = { 0 };
+		AllocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		AllocInfo.pNext = (Usage & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT) ? &AllocFlagsInfo : NULL;
+		AllocInfo.allocationSize = MemRequirements.size;
+		AllocInfo.memoryTypeIndex = SelectMemoryType(MemRequirements.memoryTypeBits, MemoryUsage);
+
+		Flags = GetMemoryTypeFlags(AllocInfo.memoryTypeIndex);
+
+		// flushes are rounded out to whole atoms, which must not run past the allocation
+		if ((Flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) && !(Flags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT))
+		{
+			VkDeviceSize Atom = MemoryTracker.NonCoherentAtomSize;
+			AllocInfo.allocationSize = (AllocInfo.allocationSize + Atom - 1) / Atom * Atom;
+		}
+
+		THROW_ON_FAIL_VK(AllocateDeviceMemory(Device, &AllocInfo, Category, BufferMemory));
+	}
+
+	vkBindBufferMemory(Device, *Buffer, *BufferMemory, 0);
+
+	return Flags;
+}
+
+// Buffer has to be created with VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT and bound to memory
+VkDeviceAddress GetBufferAddress(VkDevice Device, VkBuffer Buffer)
+{
+	VkBufferDeviceAddressInfo AddressInfo = { 0 };
+	AddressInfo.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO;
+	AddressInfo.buffer = Buffer;
+	return vkGetBufferDeviceAddress(Device, &AddressInfo);
+}
+
+/*
+* collects the ranges written through non coherent mappings so they go to the driver in a
+* single vkFlushMappedMemoryRanges call. neighbouring ranges of the same allocation merge
+*/
+struct MemoryFlushBatch
+{
+	VkMappedMemoryRange Ranges[MEMORY_MAX_FLUSH_RANGES];
+	uint32_t Count;
+};
+
+void FlushMemoryBatch(VkDevice Device, struct MemoryFlushBatch* Batch)
+{
+	if (Batch->Count == 0)
+		return;
+
+	THROW_ON_FAIL_VK(vkFlushMappedMemoryRanges(Device, Batch->Count, Batch->Ranges));
+	Batch->Count = 0;
+}
+
+// Memory has to be bound at offset 0 of an allocation made by CreateBuffer
+void AddMemoryFlush(VkDevice Device, struct MemoryFlushBatch* Batch, VkDeviceMemory Memory, VkDeviceSize Offset, VkDeviceSize Size)
+{
+	VkDeviceSize Atom = MemoryTracker.NonCoherentAtomSize;
+	VkDeviceSize Begin = Offset / Atom * Atom;
+	VkDeviceSize End = (Offset + Size + Atom - 1) / Atom * Atom;
+
+	if (Batch->Count > 0)
+	{
+		VkMappedMemoryRange* Last = &Batch->Ranges[Batch->Count - 1];
+
+		if (Last->memory == Memory && Begin <= Last->offset + Last->size && End >= Last->offset)
+		{
+			VkDeviceSize MergedBegin = min(Begin, Last->offset);
+			VkDeviceSize MergedEnd = max(End, Last->offset + Last->size);
+			Last->offset = MergedBegin;
+			Last->size = MergedEnd - MergedBegin;
+			return;
+		}
+	}
+
+	if (Batch->Count == MEMORY_MAX_FLUSH_RANGES)
+		FlushMemoryBatch(Device, Batch);
+
+	VkMappedMemoryRange* Range = &Batch->Ranges[Batch->Count++];
+	*Range = (VkMappedMemoryRange){ 0 };
+	Range->sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+	Range->memory = Memory;
+	Range->offset = Begin;
+	Range->size = End - Begin;
+}
+
+/*
+* creates a buffer holding Data for the GPU. small buffers go straight into device local
+* memory when the CPU can map it; otherwise the data is put in a staging buffer, returned
+* through StagingBuffer, and the caller records the copy
+*/
+bool CreateStaticBuffer(VkDevice Device, const void* Data, VkDeviceSize Size, VkBufferUsageFlags Usage, enum MemoryCategory Category, VkBuffer* Buffer, VkDeviceMemory* BufferMemory, VkBuffer* StagingBuffer, VkDeviceMemory* StagingBufferMemory)
+{
+	bool Direct = Size <= MEMORY_DIRECT_UPLOAD_MAX_SIZE && MemoryTracker.HostVisibleDeviceLocal;
+
+	if (Direct)
+	{
+		VkMemoryPropertyFlags Flags = CreateBuffer(Device, Size, Usage, MEMORY_USAGE_CPU_TO_GPU, Category, Buffer, BufferMemory);
+
+		void* Mapped;
+		THROW_ON_FAIL_VK(vkMapMemory(Device, *BufferMemory, 0, VK_WHOLE_SIZE, 0, &Mapped));
+		memcpy(Mapped, Data, Size);
+
+		if (!(Flags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT))
+		{
+			struct MemoryFlushBatch Batch = { 0 };
+			AddMemoryFlush(Device, &Batch, *BufferMemory, 0, Size);
+			FlushMemoryBatch(Device, &Batch);
+		}
+
+		vkUnmapMemory(Device, *BufferMemory);
+
+		*StagingBuffer = VK_NULL_HANDLE;
+		*StagingBufferMemory = VK_NULL_HANDLE;
+		return false;
+	}
+
+	VkMemoryPropertyFlags StagingFlags = CreateBuffer(Device, Size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, MEMORY_USAGE_STAGING, MEMORY_CATEGORY_STAGING, StagingBuffer, StagingBufferMemory);
+
+	void* Mapped;
+	THROW_ON_FAIL_VK(vkMapMemory(Device, *StagingBufferMemory, 0, VK_WHOLE_SIZE, 0, &Mapped));
+	memcpy(Mapped, Data, Size);
+
+	if (!(StagingFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT))
+	{
+		struct MemoryFlushBatch Batch = { 0 };
+		AddMemoryFlush(Device, &Batch, *StagingBufferMemory, 0, Size);
+		FlushMemoryBatch(Device, &Batch);
+	}
+
+	vkUnmapMemory(Device, *StagingBufferMemory);
+
+	CreateBuffer(Device, Size, Usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT, MEMORY_USAGE_GPU_ONLY, Category, Buffer, BufferMemory);
+	return true;
+}
+
+bool HasStencilComponent(VkFormat Format)
+{
+	return Format == VK_FORMAT_D32_SFLOAT_S8_UINT || Format == VK_FORMAT_D24_UNORM_S8_UINT;
+}
+
+uint32_t RenderGraphImportImage(struct RenderGraph* Graph, const char* Name, VkFormat Format, VkImageAspectFlags Aspect, enum RenderGraphAccess InitialAccess, enum RenderGraphAccess FinalAccess)
+{
+	if (Graph->ResourceCount == RENDER_GRAPH_MAX_RESOURCES)
+		FailFastWithMessage("render graph: too many resources\n");
+
+	struct RenderGraphResource* Resource = &Graph->Resources[Graph->ResourceCount];
+	*Resource = (struct RenderGraphResource){ 0 };
+	Resource->Name = Name;
+	Resource->Flags = RENDER_GRAPH_RESOURCE_IMPORTED;
+	Resource->Format = Format;
+	Resource->Aspect = Aspect;
+	Resource->Layers = 1;
+	Resource->InitialAccess = InitialAccess;
+	Resource->FinalAccess = FinalAccess;
+
+	return Graph->ResourceCount++;
+}
+
+// barriers and the View cover every layer; LayerViews address them one at a time
+uint32_t RenderGraphCreateImageArray(struct RenderGraph* Graph, const char* Name, VkFormat Format, VkImageAspectFlags Aspect, uint32_t Layers, bool Transient)
+{
+	if (Graph->ResourceCount == RENDER_GRAPH_MAX_RESOURCES)
+		FailFastWithMessage("render graph: too many resources\n");
+
+	if (Layers == 0 || Layers > RENDER_GRAPH_MAX_LAYERS)
+		FailFastWithMessage("render graph: unsupported layer count\n");
+
+	struct RenderGraphResource* Resource = &Graph->Resources[Graph->ResourceCount];
+	*Resource = (struct RenderGraphResource){ 0 };
+	Resource->Name = Name;
+	Resource->Flags = Transient ? RENDER_GRAPH_RESOURCE_TRANSIENT : 0;
+	Resource->Format = Format;
+	Resource->Aspect = Aspect;
+	Resource->Layers = Layers;
+	Resource->InitialAccess = RENDER_GRAPH_ACCESS_NONE;
+	Resource->FinalAccess = RENDER_GRAPH_ACCESS_NONE;
+
+	return Graph->ResourceCount++;
+}
+
+uint32_t RenderGraphCreateImage(struct RenderGraph* Graph, const char* Name, VkFormat Format, VkImageAspectFlags Aspect, bool Transient)
+{
+	return RenderGraphCreateImageArray(Graph, Name, Format, Aspect, 1, Transient);
+}
+
+void RenderGraphSetImage(struct RenderGraph* Graph, uint32_t Resource, VkImage Image, VkImageView View)
+{
+	Graph->Resources[Resource].Image = Image;
+	Graph->Resources[Resource].View = View;
+}
+
+uint32_t RenderGraphAddPass(struct RenderGraph* Graph, const char* Name, RenderGraphRecordFunction Record, void* Context)
+{
+	if (Graph->PassCount == RENDER_GRAPH_MAX_PASSES)
+		FailFastWithMessage("render graph: too many passes\n");
+
+	struct RenderGraphPass* Pass = &Graph->Passes[Graph->PassCount];
+	*Pass = (struct RenderGraphPass){ 0 };
+	Pass->Name = Name;
+	Pass->Record = Record;
+	Pass->Context = Context;
+
+	return Graph->PassCount++;
+}
+
+void RenderGraphUseResource(struct RenderGraph* Graph, uint32_t Pass, uint32_t Resource, enum RenderGraphAccess Access)
+{
+	struct RenderGraphPass* GraphPass = &Graph->Passes[Pass];
+
+	if (GraphPass->UseCount == RENDER_GRAPH_MAX_PASS_RESOURCES)
+		FailFastWithMessage("render graph: too many resources used by one pass\n");
+
+	GraphPass->Uses[GraphPass->UseCount].Resource = Resource;
+	GraphPass->Uses[GraphPass->UseCount].Access = Access;
+	GraphPass->UseCount++;
+}
+
+// keeps a pass that only reads, and so would otherwise be culled
+void RenderGraphSetSideEffects(struct RenderGraph* Graph, uint32_t Pass)
+{
+	Graph->Passes[Pass].SideEffects = true;
+}
+
+static bool RenderGraphNeedsBarrier(enum RenderGraphAccess Before, enum RenderGraphAccess After)
+{
+	// read after read in the same layout is the only transition that needs nothing
+	return RENDER_GRAPH_ACCESS_INFO[Before].Write ||
+		RENDER_GRAPH_ACCESS_INFO[After].Write ||
+		RENDER_GRAPH_ACCESS_INFO[Before].Layout != RENDER_GRAPH_ACCESS_INFO[After].Layout;
+}
+
+static void RenderGraphCullPass(struct RenderGraph* Graph, struct RenderGraphPass* Pass, uint32_t* UnreferencedResources, uint32_t* UnreferencedCount)
+{
+	Pass->Culled = true;
+
+	for (uint32_t i = 0; i < Pass->UseCount; i++)
+	{
+		if (RENDER_GRAPH_ACCESS_INFO[Pass->Uses[i].Access].Write)
+			continue;
+
+		if (--Graph->Resources[Pass->Uses[i].Resource].RefCount != 0)
+			continue;
+
+		// a resource only drops to 0 once, so the stack never holds more than every resource
+		if (*UnreferencedCount == RENDER_GRAPH_MAX_RESOURCES)
+			FailFastWithMessage("render graph: resource queued twice while culling\n");
+
+		UnreferencedResources[(*UnreferencedCount)++] = Pass->Uses[i].Resource;
+	}
+}
+
+/*
+* culls passes whose output nobody consumes, records the lifetime of every resource
+* and derives the barriers each surviving pass needs before it runs
+*
+* passes are executed in the order they were added, so that order has to be a valid
+* topological order of the dependencies
+*/
+void RenderGraphCompile(struct RenderGraph* Graph)
+{
+	for (uint32_t i = 0; i < Graph->ResourceCount; i++)
+	{
+		struct RenderGraphResource* Resource = &Graph->Resources[i];
+
+		// resources that leave the graph count as being read by whoever comes after it
+		Resource->RefCount = Resource->FinalAccess != RENDER_GRAPH_ACCESS_NONE ? 1 : 0;
+		Resource->FirstPass = -1;
+		Resource->LastPass = -1;
+		Resource->LastAccess = Resource->InitialAccess;
+		Resource->Usage = 0;
+	}
+
+	for (uint32_t i = 0; i < Graph->PassCount; i++)
+	{
+		struct RenderGraphPass* Pass = &Graph->Passes[i];
+		Pass->RefCount = Pass->SideEffects ? 1 : 0;
+		Pass->Culled = false;
+		Pass->BarrierCount = 0;
+
+		for (uint32_t j = 0; j < Pass->UseCount; j++)
+		{
+			if (RENDER_GRAPH_ACCESS_INFO[Pass->Uses[j].Access].Write)
+				Pass->RefCount++;
+			else
+				Graph->Resources[Pass->Uses[j].Resource].RefCount++;
+		}
+	}
+
+	{
+		uint32_t UnreferencedResources[RENDER_GRAPH_MAX_RESOURCES];
+		uint32_t UnreferencedCount = 0;
+
+		// seeded before any pass is culled, since culling pushes the resources it unreferences
+		for (uint32_t i = 0; i < Graph->ResourceCount; i++)
+		{
+			if (Graph->Resources[i].RefCount == 0)
+				UnreferencedResources[UnreferencedCount++] = i;
+		}
+
+		for (uint32_t i = 0; i < Graph->PassCount; i++)
+		{
+			if (Graph->Passes[i].RefCount == 0)
+				RenderGraphCullPass(Graph, &Graph->Passes[i], UnreferencedResources, &UnreferencedCount);
+		}
+
+		while (UnreferencedCount > 0)
+		{
+			uint32_t ResourceIndex = UnreferencedResources[--UnreferencedCount];
+
+			for (uint32_t i = 0; i < Graph->PassCount; i++)
+			{
+				struct RenderGraphPass* Pass = &Graph->Passes[i];
+
+				if (Pass->Culled)
+					continue;
+
+				for (uint32_t j = 0; j < Pass->UseCount; j++)
+				{
+					if (Pass->Uses[j].Resource == ResourceIndex && RENDER_GRAPH_ACCESS_INFO[Pass->Uses[j].Access].Write && --Pass->RefCount == 0)
+					{
+						RenderGraphCullPass(Graph, Pass, UnreferencedResources, &UnreferencedCount);
+						break;
+					}
+				}
+			}
+		}
+	}
+
+	for (uint32_t i = 0; i < Graph->PassCount; i++)
+	{
+		struct RenderGraphPass* Pass = &Graph->Passes[i];
+
+		if (Pass->Culled)
+			continue;
+
+		for (uint32_t j = 0; j < Pass->UseCount; j++)
+		{
+			struct RenderGraphResource* Resource = &Graph->Resources[Pass->Uses[j].Resource];
+			enum RenderGraphAccess Access = Pass->Uses[j].Access;
+
+			bool FirstUse = Resource->FirstPass == -1;
+
+			// graph owned images never carry contents over from a previous frame, so their
+			// first use always gets a barrier; which access it waits on depends on who else
+			// shares the memory and is patched in once the memory is laid out
+			if ((FirstUse && !(Resource->Flags & RENDER_GRAPH_RESOURCE_IMPORTED)) || RenderGraphNeedsBarrier(Resource->LastAccess, Access))
+			{
+				struct RenderGraphBarrier* Barrier = &Pass->Barriers[Pass->BarrierCount++];
+				Barrier->Resource = Pass->Uses[j].Resource;
+				Barrier->Before = Resource->LastAccess;
+				Barrier->After = Access;
+				Barrier->Discard = FirstUse;
+			}
+
+			if (FirstUse)
+				Resource->FirstPass = i;
+
+			Resource->LastPass = i;
+			Resource->LastAccess = Access;
+			Resource->Usage |= RENDER_GRAPH_ACCESS_INFO[Access].Usage;
+		}
+	}
+
+	Graph->FinalBarrierCount = 0;
+
+	for (uint32_t i = 0; i < Graph->ResourceCount; i++)
+	{
+		struct RenderGraphResource* Resource = &Graph->Resources[i];
+
+		if (Resource->FinalAccess == RENDER_GRAPH_ACCESS_NONE || !RenderGraphNeedsBarrier(Resource->LastAccess, Resource->FinalAccess))
+			continue;
+
+		struct RenderGraphBarrier* Barrier = &Graph->FinalBarriers[Graph->FinalBarrierCount++];
+		Barrier->Resource = i;
+		Barrier->Before = Resource->LastAccess;
+		Barrier->After = Resource->FinalAccess;
+		Barrier->Discard = Resource->FirstPass == -1;
+	}
+}
+
+/*
+* creates the graph owned images and places them in memory
+*
+* images whose lifetimes don't overlap share a memory slot. transient images that are
+* only ever used as attachments go to lazily allocated memory where the device has it,
+* which on tiled GPUs means they never get backing memory at all
+*/
+void RenderGraphRealize(struct RenderGraph* Graph, VkDevice Device, VkExtent2D Extent)
+{
+	static const VkImageUsageFlags ATTACHMENT_USAGE = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT;
+
+	Graph->Extent = Extent;
+	Graph->MemorySlotCount = 0;
+
+	uint32_t Order[RENDER_GRAPH_MAX_RESOURCES];
+	uint32_t OrderCount = 0;
+
+	for (uint32_t i = 0; i < Graph->ResourceCount; i++)
+	{
+		struct RenderGraphResource* Resource = &Graph->Resources[i];
+
+		if ((Resource->Flags & RENDER_GRAPH_RESOURCE_IMPORTED) || Resource->FirstPass == -1)
+			continue;
+
+		uint32_t Position = OrderCount++;
+
+		while (Position > 0 && Graph->Resources[Order[Position - 1]].FirstPass > Resource->FirstPass)
+		{
+			Order[Position] = Order[Position - 1];
+			Position--;
+		}
+
+		Order[Position] = i;
+	}
+
+	VkMemoryRequirements MemRequirements[RENDER_GRAPH_MAX_RESOURCES];
+
+	for (uint32_t i = 0; i < OrderCount; i++)
+	{
+		struct RenderGraphResource* Resource = &Graph->Resources[Order[i]];
+
+		VkImageUsageFlags Usage = Resource->Usage;
+		bool Lazy = (Resource->Flags & RENDER_GRAPH_RESOURCE_TRANSIENT) && (Usage & ~ATTACHMENT_USAGE) == 0;
+
+		if (Lazy)
+			Usage |= VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+
+		{
+			VkImageCreateInfo ImageInfo = { 0 };
+			ImageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+			ImageInfo.imageType = VK_IMAGE_TYPE_2D;
+			ImageInfo.extent.width = Extent.width;
+			ImageInfo.extent.height = Extent.height;
+			ImageInfo.extent.depth = 1;
+			ImageInfo.mipLevels = 1;
+			ImageInfo.arrayLayers = Resource->Layers;
+			ImageInfo.format = Resource->Format;
+			ImageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+			ImageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			ImageInfo.usage = Usage;
+			ImageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+			ImageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+			THROW_ON_FAIL_VK(vkCreateImage(Device, &ImageInfo, NULL, &Resource->Image));
+		}
+
+		vkGetImageMemoryRequirements(Device, Resource->Image, &MemRequirements[Order[i]]);
+
+		uint32_t Slot = Graph->MemorySlotCount;
+
+		for (uint32_t j = 0; j < Graph->MemorySlotCount; j++)
+		{
+			struct RenderGraphMemorySlot* MemorySlot = &Graph->MemorySlots[j];
+
+			if (MemorySlot->Lazy == Lazy && MemorySlot->LastPass < Resource->FirstPass && (MemorySlot->TypeBits & MemRequirements[Order[i]].memoryTypeBits) != 0)
+			{
+				Slot = j;
+				break;
+			}
+		}
+
+		if (Slot == Graph->MemorySlotCount)
+		{
+			Graph->MemorySlots[Slot] = (struct RenderGraphMemorySlot){ 0 };
+			Graph->MemorySlots[Slot].TypeBits = UINT32_MAX;
+			Graph->MemorySlots[Slot].Lazy = Lazy;
+			Graph->MemorySlotCount++;
+		}
+
+		struct RenderGraphMemorySlot* MemorySlot = &Graph->MemorySlots[Slot];
+		MemorySlot->TypeBits &= MemRequirements[Order[i]].memoryTypeBits;
+		MemorySlot->LastPass = Resource->LastPass;
+
+		if (MemRequirements[Order[i]].size > MemorySlot->Size)
+			MemorySlot->Size = MemRequirements[Order[i]].size;
+
+		Resource->MemorySlot = Slot;
+	}
+
+	for (uint32_t i = 0; i < Graph->MemorySlotCount; i++)
+	{
+		struct RenderGraphMemorySlot* MemorySlot = &Graph->MemorySlots[i];
+
+		uint32_t MemoryType = UINT32_MAX;
+
+		if (MemorySlot->Lazy)
+			MemoryType = TryFindMemoryType(MemorySlot->TypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT);
+
+		if (MemoryType == UINT32_MAX)
+			MemoryType = SelectMemoryType(MemorySlot->TypeBits, MEMORY_USAGE_GPU_ONLY);
+
+		VkMemoryAllocateInfo AllocInfo = { 0 };
+		AllocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		AllocInfo.allocationSize = MemorySlot->Size;
+		AllocInfo.memoryTypeIndex = MemoryType;
+		THROW_ON_FAIL_VK(AllocateDeviceMemory(Device, &AllocInfo, MEMORY_CATEGORY_RENDER_TARGET, &MemorySlot->Memory));
+	}
+
+	for (uint32_t i = 0; i < OrderCount; i++)
+	{
+		struct RenderGraphResource* Resource = &Graph->Resources[Order[i]];
+
+		THROW_ON_FAIL_VK(vkBindImageMemory(Device, Resource->Image, Graph->MemorySlots[Resource->MemorySlot].Memory, 0));
+
+		{
+			VkImageViewCreateInfo ViewInfo = { 0 };
+			ViewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+			ViewInfo.image = Resource->Image;
+			ViewInfo.viewType = Resource->Layers > 1 ? VK_IMAGE_VIEW_TYPE_2D_ARRAY : VK_IMAGE_VIEW_TYPE_2D;
+			ViewInfo.format = Resource->Format;
+			ViewInfo.subresourceRange.aspectMask = (Resource->Aspect & VK_IMAGE_ASPECT_DEPTH_BIT) ? VK_IMAGE_ASPECT_DEPTH_BIT : Resource->Aspect;
+			ViewInfo.subresourceRange.baseMipLevel = 0;
+			ViewInfo.subresourceRange.levelCount = 1;
+			ViewInfo.subresourceRange.baseArrayLayer = 0;
+			ViewInfo.subresourceRange.layerCount = Resource->Layers;
+			THROW_ON_FAIL_VK(vkCreateImageView(Device, &ViewInfo, NULL, &Resource->View));
+
+			ViewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+			ViewInfo.subresourceRange.layerCount = 1;
+
+			for (uint32_t Layer = 0; Layer < Resource->Layers && Resource->Layers > 1; Layer++)
+			{
+				ViewInfo.subresourceRange.baseArrayLayer = Layer;
+				THROW_ON_FAIL_VK(vkCreateImageView(Device, &ViewInfo, NULL, &Resource->LayerViews[Layer]));
+			}
+		}
+
+		// the first use has to wait for whoever touched the memory last: the previous image in
+		// the same slot this frame, or the last one in the slot during the previous frame
+		const struct RenderGraphResource* Previous = NULL;
+		const struct RenderGraphResource* Wrapped = NULL;
+
+		for (uint32_t j = 0; j < OrderCount; j++)
+		{
+			const struct RenderGraphResource* Other = &Graph->Resources[Order[j]];
+
+			if (Other->MemorySlot != Resource->MemorySlot)
+				continue;
+
+			if (Other->LastPass < Resource->FirstPass && (Previous == NULL || Other->LastPass > Previous->LastPass))
+				Previous = Other;
+
+			if (Wrapped == NULL || Other->LastPass > Wrapped->LastPass)
+				Wrapped = Other;
+		}
+
+		if (Previous == NULL)
+			Previous = Wrapped;
+
+		struct RenderGraphPass* FirstPass = &Graph->Passes[Resource->FirstPass];
+
+		for (uint32_t j = 0; j < FirstPass->BarrierCount; j++)
+		{
+			if (FirstPass->Barriers[j].Resource == Order[i])
+				FirstPass->Barriers[j].Before = Previous->LastAccess;
+		}
+	}
+}
+
+void RenderGraphRelease(struct RenderGraph* Graph, VkDevice Device)
+{
+	for (uint32_t i = 0; i < Graph->ResourceCount; i++)
+	{
+		struct RenderGraphResource* Resource = &Graph->Resources[i];
+
+		if (Resource->Flags & RENDER_GRAPH_RESOURCE_IMPORTED)
+			continue;
+
+		for (uint32_t Layer = 0; Layer < RENDER_GRAPH_MAX_LAYERS; Layer++)
+		{
+			vkDestroyImageView(Device, Resource->LayerViews[Layer], NULL);
+			Resource->LayerViews[Layer] = VK_NULL_HANDLE;
+		}
+
+		vkDestroyImageView(Device, Resource->View, NULL);
+		vkDestroyImage(Device, Resource->Image, NULL);
+		Resource->View = VK_NULL_HANDLE;
+		Resource->Image = VK_NULL_HANDLE;
+	}
+
+	for (uint32_t i = 0; i < Graph->MemorySlotCount; i++)
+	{
+		FreeDeviceMemory(Device, Graph->MemorySlots[i].Memory);
+	}
+
+	Graph->MemorySlotCount = 0;
+}
+
+static void RenderGraphRecordBarriers(const struct RenderGraph* Graph, VkCommandBuffer CommandBuffer, const struct RenderGraphBarrier* Barriers, uint32_t BarrierCount)
+{
+	if (BarrierCount == 0)
+		return;
+
+	VkImageMemoryBarrier ImageBarriers[RENDER_GRAPH_MAX_RESOURCES];
+	VkPipelineStageFlags SrcStageMask = 0;
+	VkPipelineStageFlags DstStageMask = 0;
+
+	for (uint32_t i = 0; i < BarrierCount; i++)
+	{
+		const struct RenderGraphAccessInfo* Before = &RENDER_GRAPH_ACCESS_INFO[Barriers[i].Before];
+		const struct RenderGraphAccessInfo* After = &RENDER_GRAPH_ACCESS_INFO[Barriers[i].After];
+		const struct RenderGraphResource* Resource = &Graph->Resources[Barriers[i].Resource];
+
+		ImageBarriers[i] = (VkImageMemoryBarrier){ 0 };
+		ImageBarriers[i].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		ImageBarriers[i].srcAccessMask = Before->AccessMask;
+		ImageBarriers[i].dstAccessMask = After->AccessMask;
+		ImageBarriers[i].oldLayout = Barriers[i].Discard ? VK_IMAGE_LAYOUT_UNDEFINED : Before->Layout;
+		ImageBarriers[i].newLayout = After->Layout;
+		ImageBarriers[i].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		ImageBarriers[i].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		ImageBarriers[i].image = Resource->Image;
+		ImageBarriers[i].subresourceRange.aspectMask = Resource->Aspect;
+		ImageBarriers[i].subresourceRange.baseMipLevel = 0;
+		ImageBarriers[i].subresourceRange.levelCount = 1;
+		ImageBarriers[i].subresourceRange.baseArrayLayer = 0;
+		ImageBarriers[i].subresourceRange.layerCount = Resource->Layers;
+
+		SrcStageMask |= Before->StageMask;
+		DstStageMask |= After->StageMask;
+	}
+
+	vkCmdPipelineBarrier(
+		CommandBuffer,
+		SrcStageMask,
+		DstStageMask,
+		0,
+		0,
+		NULL,
+		0,
+		NULL,
+		BarrierCount,
+		ImageBarriers
+	);
+}
+
+void RenderGraphExecute(const struct RenderGraph* Graph, VkCommandBuffer CommandBuffer, void* FrameData)
+{
+	for (uint32_t i = 0; i < Graph->PassCount; i++)
+	{
+		const struct RenderGraphPass* Pass = &Graph->Passes[i];
+
+		if (Pass->Culled)
+			continue;
+
+		PROFILE_ZONE(Pass->Name)
+		GPU_PROFILE_ZONE(Graph->GpuProfiler, CommandBuffer, Pass->Name)
+		{
+			RenderGraphRecordBarriers(Graph, CommandBuffer, Pass->Barriers, Pass->BarrierCount);
+
+			Pass->Record(CommandBuffer, Pass->Context, FrameData);
+		}
+	}
+
+	RenderGraphRecordBarriers(Graph, CommandBuffer, Graph->FinalBarriers, Graph->FinalBarrierCount);
+}
+
+void RecordTextureUpload(VkCommandBuffer CommandBuffer, void* Context, void* FrameData)
+{
+	const struct TextureUploadContext* Upload = Context;
+
+	VkBufferImageCopy Region = { 0 };
+	Region.bufferOffset = 0;
+	Region.bufferRowLength = 0;
+	Region.bufferImageHeight = 0;
+	Region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	Region.imageSubresource.mipLevel = 0;
+	Region.imageSubresource.baseArrayLayer = 0;
+	Region.imageSubresource.layerCount = 1;
+	Region.imageOffset.x = 0;
+	Region.imageOffset.y = 0;
+	Region.imageOffset.z = 0;
+	Region.imageExtent.width = Upload->Width;
+	Region.imageExtent.height = Upload->Height;
+	Region.imageExtent.depth = 1;
+	vkCmdCopyBufferToImage(CommandBuffer, Upload->StagingBuffer, Upload->Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &Region);
+}
+
+void RecordParticleDraw(const struct VulkanObjects* VulkanObjects, VkCommandBuffer CommandBuffer)
+{
+	const struct ParticleSystem* Particles = &VulkanObjects->Particles;
+
+	vkCmdBindPipeline(CommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, Particles->GraphicsPipeline);
+	vkCmdPushConstants(CommandBuffer, Particles->GraphicsPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(Particles->DrawConstants), &Particles->DrawConstants);
+
+	VkDeviceSize Offset = 0;
+	vkCmdBindVertexBuffers(CommandBuffer, 0, 1, &Particles->ParticleBuffers[Particles->DrawBuffer], &Offset);
+
+	// the instance count was written by the compaction on the compute queue
+	vkCmdDrawIndirect(CommandBuffer, Particles->DrawArgsBuffers[Particles->DrawBuffer], 0, 1, sizeof(VkDrawIndirectCommand));
+}
+
+static void ParticleComputeBarrier(VkCommandBuffer CommandBuffer, VkPipelineStageFlags SourceStage, VkAccessFlags SourceAccess)
+{
+	VkMemoryBarrier Barrier = { 0 };
+	Barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	Barrier.srcAccessMask = SourceAccess;
+	Barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+	vkCmdPipelineBarrier(CommandBuffer, SourceStage, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &Barrier, 0, NULL, 0, NULL);
+}
+
+// called once the frame slot's previous use has retired
+void ReadParticleTimestamps(struct ParticleSystem* Particles, VkDevice Device, uint32_t Frame)
+{
+	if (Particles->QueryPool == VK_NULL_HANDLE || !Particles->QueryPending[Frame])
+		return;
+
+	uint64_t Timestamps[2];
+
+	if (vkGetQueryPoolResults(Device, Particles->QueryPool, Frame * 2, 2, sizeof(Timestamps), Timestamps, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) == VK_SUCCESS)
+	{
+		Particles->SimulationMilliseconds += (Timestamps[1] - Timestamps[0]) * Particles->TimestampPeriod / 1000000.0;
+		Particles->SimulationSamples++;
+	}
+
+	Particles->QueryPending[Frame] = false;
+}
+
+/*
+* records and submits this frame's simulation on the compute queue and returns the compute
+* timeline value the frame's draw has to wait for. the buffer written here was last drawn
+* two frames ago, so the submission waits for that frame on the graphics timeline. the
+* previous frame only reads the other buffer, so it keeps rendering while this runs
+*/
+uint64_t SubmitParticleSimulation(struct VulkanObjects* VulkanObjects, uint32_t Frame, float Time)
+{
+	struct ParticleSystem* Particles = &VulkanObjects->Particles;
+	VkCommandBuffer CommandBuffer = Particles->CommandBuffers[Frame];
+
+	uint32_t ReadBuffer = Particles->DrawBuffer;
+	uint32_t WriteBuffer = ReadBuffer ^ 1;
+
+	struct ParticleSimulationConstants Constants = { 0 };
+	Constants.DeltaTime = glm_clamp(Time - Particles->LastTime, 0.0f, 0.1f);
+	Constants.Time = Time;
+	Constants.Capacity = Particles->Capacity;
+	Constants.Seed = Particles->Seed++ * 0x9e3779b9u;
+
+	// the lifetimes average three seconds, so this keeps the buffer close to full
+	Particles->EmitRemainder += Constants.DeltaTime * Particles->Capacity / 3.0f;
+	Constants.EmitCount = min((uint32_t)Particles->EmitRemainder, Particles->Capacity);
+	Particles->EmitRemainder -= Constants.EmitCount;
+	Particles->LastTime = Time;
+
+	vkResetCommandBuffer(CommandBuffer, 0);
+
+	{
+		VkCommandBufferBeginInfo BeginInfo = { 0 };
+		BeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		BeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		THROW_ON_FAIL_VK(vkBeginCommandBuffer(CommandBuffer, &BeginInfo));
+	}
+
+	if (Particles->QueryPool != VK_NULL_HANDLE)
+	{
+		vkCmdResetQueryPool(CommandBuffer, Particles->QueryPool, Frame * 2, 2);
+		vkCmdWriteTimestamp(CommandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, Particles->QueryPool, Frame * 2);
+	}
+
+	static const VkDrawIndirectCommand EmptyDraw = { 4, 0, 0, 0 };
+
+	if (!Particles->DrawArgsInitialized)
+	{
+		vkCmdUpdateBuffer(CommandBuffer, Particles->DrawArgsBuffers[ReadBuffer], 0, sizeof(EmptyDraw), &EmptyDraw);
+		Particles->DrawArgsInitialized = true;
+	}
+
+	vkCmdUpdateBuffer(CommandBuffer, Particles->DrawArgsBuffers[WriteBuffer], 0, sizeof(EmptyDraw), &EmptyDraw);
+
+	// also orders this frame's reads after the previous frame's passes on this queue
+	ParticleComputeBarrier(CommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+
+	vkCmdBindDescriptorSets(CommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, Particles->ComputePipelineLayout, 0, 1, &Particles->DescriptorSets[ReadBuffer], 0, NULL);
+	vkCmdPushConstants(CommandBuffer, Particles->ComputePipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(Constants), &Constants);
+
+	// the live count is only known on the GPU, so every group past it returns right away
+	vkCmdBindPipeline(CommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, Particles->SimulatePipeline);
+	vkCmdDispatch(CommandBuffer, Particles->Capacity / PARTICLE_GROUP_SIZE, 1, 1);
+
+	// survivors go first, so emission only fills the space they leave
+	if (Constants.EmitCount > 0)
+	{
+		ParticleComputeBarrier(CommandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT);
+
+		vkCmdBindPipeline(CommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, Particles->EmitPipeline);
+		vkCmdDispatch(CommandBuffer, (Constants.EmitCount + PARTICLE_GROUP_SIZE - 1) / PARTICLE_GROUP_SIZE, 1, 1);
+	}
+
+	if (Particles->QueryPool != VK_NULL_HANDLE)
+	{
+		vkCmdWriteTimestamp(CommandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, Particles->QueryPool, Frame * 2 + 1);
+		Particles->QueryPending[Frame] = true;
+	}
+
+	THROW_ON_FAIL_VK(vkEndCommandBuffer(CommandBuffer));
+
+	uint64_t SignalValue = ++Particles->Timeline.Value;
+
+	{
+		uint64_t WaitValue = Particles->BufferReleaseValues[WriteBuffer];
+
+		// all commands, so the first timestamp is not taken while the wait is still pending
+		VkPipelineStageFlags WaitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+
+		VkTimelineSemaphoreSubmitInfo TimelineInfo = { 0 };
+		TimelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+		TimelineInfo.waitSemaphoreValueCount = 1;
+		TimelineInfo.pWaitSemaphoreValues = &WaitValue;
+		TimelineInfo.signalSemaphoreValueCount = 1;
+		TimelineInfo.pSignalSemaphoreValues = &SignalValue;
+
+		VkSubmitInfo SubmitInfo = { 0 };
+		SubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		SubmitInfo.pNext = &TimelineInfo;
+		SubmitInfo.waitSemaphoreCount = 1;
+		SubmitInfo.pWaitSemaphores = &VulkanObjects->GraphicsTimeline.Semaphore;
+		SubmitInfo.pWaitDstStageMask = &WaitStage;
+		SubmitInfo.commandBufferCount = 1;
+		SubmitInfo.pCommandBuffers = &CommandBuffer;
+		SubmitInfo.signalSemaphoreCount = 1;
+		SubmitInfo.pSignalSemaphores = &Particles->Timeline.Semaphore;
+		THROW_ON_FAIL_VK(vkQueueSubmit(VulkanObjects->ComputeQueue, 1, &SubmitInfo, VK_NULL_HANDLE));
+	}
+
+	Particles->DrawBuffer = WriteBuffer;
+
+	return SignalValue;
+}
+
+/*
+* views are laid out two to a row on the swapchain. each one is rendered into the top left
+* corner of its layer at the size of its tile and copied into place by the composite pass
+*/
+VkRect2D GetViewTile(const struct VulkanObjects* VulkanObjects, uint32_t View)
+{
+	uint32_t Columns = VulkanObjects->ViewCount > 1 ? 2 : 1;
+	uint32_t Rows = (VulkanObjects->ViewCount + Columns - 1) / Columns;
+
+	VkRect2D Tile = { 0 };
+	Tile.extent.width = max(VulkanObjects->SwapChainExtent.width / Columns, 1);
+	Tile.extent.height = max(VulkanObjects->SwapChainExtent.height / Rows, 1);
+	Tile.offset.x = (View % Columns) * Tile.extent.width;
+	Tile.offset.y = (View / Columns) * Tile.extent.height;
+
+	return Tile;
+}
+
+// the size the scene passes render at this frame
+VkExtent2D GetSceneExtent(const struct VulkanObjects* VulkanObjects)
+{
+	if (VulkanObjects->ViewCount > 1)
+		return GetViewTile(VulkanObjects, 0).extent;
+
+	if (!VulkanObjects->Resolution.Enabled)
+		return VulkanObjects->SwapChainExtent;
+
+	VkExtent2D Extent;
+	Extent.width = max((uint32_t)(VulkanObjects->SwapChainExtent.width * VulkanObjects->Resolution.Scale + 0.5f), 1);
+	Extent.height = max((uint32_t)(VulkanObjects->SwapChainExtent.height * VulkanObjects->Resolution.Scale + 0.5f), 1);
+
+	return Extent;
+}
+
+/*
+* the scene's GPU time grows with its pixel count, so dividing by the square of the scale the
+* frame was rendered at estimates the full resolution cost, and the square root of the budget
+* over that cost is the scale that just fits. the estimate is averaged over a few frames, and
+* small corrections are ignored so the scale doesn't twitch around the budget
+*/
+void UpdateResolutionScale(struct DynamicResolution* Resolution, double Milliseconds, float FrameScale)
+{
+	double FullMilliseconds = Milliseconds / (FrameScale * FrameScale);
+
+	if (Resolution->SmoothedMilliseconds == 0.0)
+		Resolution->SmoothedMilliseconds = FullMilliseconds;
+	else
+		Resolution->SmoothedMilliseconds += (FullMilliseconds - Resolution->SmoothedMilliseconds) * 0.1;
+
+	float Scale = sqrtf((float)(Resolution->BudgetMilliseconds / Resolution->SmoothedMilliseconds));
+	Scale = glm_clamp(Scale, DYNAMIC_RESOLUTION_MIN_SCALE, DYNAMIC_RESOLUTION_MAX_SCALE);
+
+	if (fabsf(Scale - Resolution->Scale) >= 0.02f || Scale == DYNAMIC_RESOLUTION_MIN_SCALE || Scale == DYNAMIC_RESOLUTION_MAX_SCALE)
+		Resolution->Scale = Scale;
+}
+
+// the view mask both the multiview pass and the pipelines it draws with are created for
+uint32_t GetSceneViewMask(const struct VulkanObjects* VulkanObjects)
+{
+	if (VulkanObjects->ViewCount == 1 || VulkanObjects->ViewMode != VIEW_MODE_MULTIVIEW)
+		return 0;
+
+	return (1u << VulkanObjects->ViewCount) - 1;
+}
+
+// called once the frame slot's previous use has retired. returns whether LastMilliseconds is new
+bool ReadSceneTimestamps(struct SceneTimer* Timer, VkDevice Device, uint32_t Frame)
+{
+	if (Timer->QueryPool == VK_NULL_HANDLE || !Timer->QueryPending[Frame])
+		return false;
+
+	Timer->QueryPending[Frame] = false;
+
+	uint64_t Timestamps[2];
+
+	if (vkGetQueryPoolResults(Device, Timer->QueryPool, Frame * 2, 2, sizeof(Timestamps), Timestamps, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) != VK_SUCCESS)
+		return false;
+
+	Timer->LastMilliseconds = (Timestamps[1] - Timestamps[0]) * Timer->TimestampPeriod / 1000000.0;
+	Timer->Milliseconds += Timer->LastMilliseconds;
+	Timer->Samples++;
+
+	return true;
+}
+
+void CreateSceneTimer(struct VulkanObjects* VulkanObjects)
+{
+	struct SceneTimer* Timer = &VulkanObjects->SceneTimer;
+
+	uint32_t QueueFamilyCount = MAX_QUEUE_FAMILY_COUNT;
+	VkQueueFamilyProperties QueueFamilies[MAX_QUEUE_FAMILY_COUNT];
+	vkGetPhysicalDeviceQueueFamilyProperties(VulkanObjects->PhysicalDevice, &QueueFamilyCount, QueueFamilies);
+
+	// without timestamps the scene is simply not timed
+	if (QueueFamilies[VulkanObjects->QueueFamilyIndices.GraphicsFamily].timestampValidBits == 0)
+		return;
+
+	VkPhysicalDeviceProperties DeviceProperties = { 0 };
+	vkGetPhysicalDeviceProperties(VulkanObjects->PhysicalDevice, &DeviceProperties);
+
+	VkQueryPoolCreateInfo QueryPoolInfo = { 0 };
+	QueryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	QueryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+	QueryPoolInfo.queryCount = MAX_FRAMES_IN_FLIGHT * 2;
+	THROW_ON_FAIL_VK(vkCreateQueryPool(VulkanObjects->Device, &QueryPoolInfo, NULL, &Timer->QueryPool));
+
+	Timer->TimestampPeriod = DeviceProperties.limits.timestampPeriod;
+}
+
+/*
+* a draw is a 64 bit key plus a payload. the key orders draws by pass, then pipeline, then
+* material, then mesh, then depth, so sorting the keys puts draws that share state next to
+* each other and front to back within it. the fields index into the tables the list is
+* recorded with
+*/
+#define DRAW_KEY_PASS_SHIFT 56
+#define DRAW_KEY_PIPELINE_SHIFT 44
+#define DRAW_KEY_MATERIAL_SHIFT 28
+#define DRAW_KEY_MESH_SHIFT 16
+#define DRAW_KEY_DEPTH_SHIFT 0
+
+#define DRAW_KEY_PASS_MASK 0xFFull
+#define DRAW_KEY_PIPELINE_MASK 0xFFFull
+#define DRAW_KEY_MATERIAL_MASK 0xFFFFull
+#define DRAW_KEY_MESH_MASK 0xFFFull
+#define DRAW_KEY_DEPTH_MASK 0xFFFFull
+
+#define DRAW_LIST_SORT_MIN_CHUNK 16384
+#define DRAW_LIST_SORT_RADIX 256
+
+struct DrawItem
+{
+	uint64_t Key;
+
+	// pushed as the vertex stage's push constant
+	uint32_t Payload;
+};
+
+struct DrawList
+{
+	struct DrawItem* Items;
+
+	// as large as Items, the radix sort ping-pongs between the two. NULL if never sorted
+	struct DrawItem* Scratch;
+
+	uint32_t Count;
+};
+
+/*
+* a mesh is either a pair of buffers to bind, or with vertex pulling a pair of addresses the
+* vertex shader reads from. meshes that only differ in their addresses don't rebind anything
+*/
+struct DrawMesh
+{
+	VkBuffer VertexBuffer;
+	VkBuffer IndexBuffer;
+	uint32_t IndexCount;
+
+	// instances 0 to InstanceCount - 1 of the scene's instance buffer
+	uint32_t InstanceCount;
+
+	// 0 binds the buffers above
+	VkDeviceAddress VertexAddress;
+	VkDeviceAddress IndexAddress;
+};
+
+// everything a key can refer to. all pipelines share Layout
+struct DrawTables
+{
+	VkPipelineLayout Layout;
+	const VkPipeline* Pipelines;
+	const VkDescriptorSet* Materials;
+	const struct DrawMesh* Meshes;
+};
+
+struct DrawBindCounts
+{
+	uint32_t Pipelines;
+	uint32_t DescriptorSets;
+	uint32_t VertexBuffers;
+	uint32_t IndexBuffers;
+	uint32_t PushConstants;
+};
+
+// Depth is 0 at the near plane and 1 at the far plane
+uint64_t MakeDrawKey(uint32_t Pass, uint32_t Pipeline, uint32_t Material, uint32_t Mesh, float Depth)
+{
+	uint64_t QuantizedDepth = (uint64_t)(glm_clamp(Depth, 0.0f, 1.0f) * DRAW_KEY_DEPTH_MASK);
+
+	return ((Pass & DRAW_KEY_PASS_MASK) << DRAW_KEY_PASS_SHIFT) |
+		((Pipeline & DRAW_KEY_PIPELINE_MASK) << DRAW_KEY_PIPELINE_SHIFT) |
+		((Material & DRAW_KEY_MATERIAL_MASK) << DRAW_KEY_MATERIAL_SHIFT) |
+		((Mesh & DRAW_KEY_MESH_MASK) << DRAW_KEY_MESH_SHIFT) |
+		(QuantizedDepth << DRAW_KEY_DEPTH_SHIFT);
+}
+
+// records the list in order. a bind is only recorded when the draw needs something else than what is bound
+void RecordDrawList(VkCommandBuffer CommandBuffer, const struct DrawList* List, const struct DrawTables* Tables, struct DrawBindCounts* Counts)
+{
+	uint32_t BoundPipeline = UINT32_MAX;
+	uint32_t BoundMaterial = UINT32_MAX;
+	uint32_t BoundMesh = UINT32_MAX;
+	uint32_t BoundPayload = UINT32_MAX;
+
+	VkBuffer BoundIndexBuffer = VK_NULL_HANDLE;
+
+	struct DrawBindCounts Binds = { 0 };
+
+	for (uint32_t i = 0; i < List->Count; i++)
+	{
+		const struct DrawItem* Item = &List->Items[i];
+
+		uint32_t Pipeline = (uint32_t)((Item->Key >> DRAW_KEY_PIPELINE_SHIFT) & DRAW_KEY_PIPELINE_MASK);
+		uint32_t Material = (uint32_t)((Item->Key >> DRAW_KEY_MATERIAL_SHIFT) & DRAW_KEY_MATERIAL_MASK);
+		uint32_t Mesh = (uint32_t)((Item->Key >> DRAW_KEY_MESH_SHIFT) & DRAW_KEY_MESH_MASK);
+
+		if (Pipeline != BoundPipeline)
+		{
+			vkCmdBindPipeline(CommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, Tables->Pipelines[Pipeline]);
+			BoundPipeline = Pipeline;
+			Binds.Pipelines++;
+		}
+
+		// the layout is shared, so switching pipelines keeps the set and the push constants
+		if (Material != BoundMaterial)
+		{
+			vkCmdBindDescriptorSets(CommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, Tables->Layout, 0, 1, &Tables->Materials[Material], 0, NULL);
+			BoundMaterial = Material;
+			Binds.DescriptorSets++;
+		}
+
+		const struct DrawMesh* DrawMesh = &Tables->Meshes[Mesh];
+
+		if (Mesh != BoundMesh && DrawMesh->VertexAddress != 0)
+		{
+			VkDeviceAddress Addresses[2] = { DrawMesh->VertexAddress, DrawMesh->IndexAddress };
+			vkCmdPushConstants(CommandBuffer, Tables->Layout, VK_SHADER_STAGE_VERTEX_BIT, offsetof(struct ScenePushConstants, Vertices), sizeof(Addresses), Addresses);
+			BoundMesh = Mesh;
+			Binds.PushConstants++;
+		}
+		else if (Mesh != BoundMesh)
+		{
+			VkDeviceSize Offset = 0;
+			vkCmdBindVertexBuffers(CommandBuffer, 0, 1, &DrawMesh->VertexBuffer, &Offset);
+			BoundMesh = Mesh;
+			Binds.VertexBuffers++;
+
+			// meshes often share one index buffer
+			if (DrawMesh->IndexBuffer != BoundIndexBuffer)
+			{
+				vkCmdBindIndexBuffer(CommandBuffer, DrawMesh->IndexBuffer, 0, VK_INDEX_TYPE_UINT16);
+				BoundIndexBuffer = DrawMesh->IndexBuffer;
+				Binds.IndexBuffers++;
+			}
+		}
+
+		if (Item->Payload != BoundPayload)
+		{
+			vkCmdPushConstants(CommandBuffer, Tables->Layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(Item->Payload), &Item->Payload);
+			BoundPayload = Item->Payload;
+			Binds.PushConstants++;
+		}
+
+		// a pulled mesh indexes itself, one invocation per index
+		if (DrawMesh->VertexAddress != 0)
+			vkCmdDraw(CommandBuffer, DrawMesh->IndexCount, DrawMesh->InstanceCount, 0, 0);
+		else
+			vkCmdDrawIndexed(CommandBuffer, DrawMesh->IndexCount, DrawMesh->InstanceCount, 0, 0, 0);
+	}
+
+	if (Counts)
+		*Counts = Binds;
+}
+
+struct DrawListSortChunk
+{
+	const struct DrawItem* Source;
+	struct DrawItem* Destination;
+	uint32_t Begin;
+	uint32_t End;
+	uint32_t Shift;
+
+	// the chunk's histogram of the digit, then where each of its digits is written
+	uint32_t Offsets[DRAW_LIST_SORT_RADIX];
+};
+
+static void DrawListCountJob(void* Context)
+{
+	struct DrawListSortChunk* Chunk = Context;
+
+	memset(Chunk->Offsets, 0, sizeof(Chunk->Offsets));
+
+	for (uint32_t i = Chunk->Begin; i < Chunk->End; i++)
+	{
+		Chunk->Offsets[(Chunk->Source[i].Key >> Chunk->Shift) & (DRAW_LIST_SORT_RADIX - 1)]++;
+	}
+}
+
+static void DrawListScatterJob(void* Context)
+{
+	struct DrawListSortChunk* Chunk = Context;
+
+	for (uint32_t i = Chunk->Begin; i < Chunk->End; i++)
+	{
+		uint32_t Digit = (Chunk->Source[i].Key >> Chunk->Shift) & (DRAW_LIST_SORT_RADIX - 1);
+		Chunk->Destination[Chunk->Offsets[Digit]++] = Chunk->Source[i];
+	}
+}
+
+static void DrawListRunChunks(struct JobSystem* JobSystem, JobFunction Function, struct DrawListSortChunk* Chunks, uint32_t ChunkCount)
+{
+	if (ChunkCount == 1)
+	{
+		Function(&Chunks[0]);
+		return;
+	}
+
+	struct JobCounter Counter = { 0 };
+
+	for (uint32_t i = 0; i < ChunkCount; i++)
+	{
+		JobSubmit(JobSystem, JobCreate(JobSystem, "DrawListSortChunk", Function, &Chunks[i], &Counter));
+	}
+
+	JobSystemWait(JobSystem, &Counter);
+}
+
+/*
+* stable least significant digit radix sort, eight bits per pass. each pass splits the list
+* into one chunk per thread: the chunks count their digits in parallel, the counts are
+* turned into write offsets on this thread, and the chunks scatter in parallel. digits every
+* key agrees on, usually the pass and the top of the depth, are skipped
+*/
+void DrawListSort(struct DrawList* List, struct JobSystem* JobSystem)
+{
+	if (List->Count < 2)
+		return;
+
+	uint64_t Differing = 0;
+
+	for (uint32_t i = 1; i < List->Count; i++)
+	{
+		Differing |= List->Items[i].Key ^ List->Items[0].Key;
+	}
+
+	uint32_t ChunkCount = List->Count / DRAW_LIST_SORT_MIN_CHUNK;
+	ChunkCount = max(1, min(ChunkCount, JobSystem->WorkerCount + 1));
+
+	struct DrawListSortChunk Chunks[JOB_SYSTEM_MAX_THREADS];
+
+	for (uint32_t Shift = 0; Shift < 64; Shift += 8)
+	{
+		if (((Differing >> Shift) & (DRAW_LIST_SORT_RADIX - 1)) == 0)
+			continue;
+
+		for (uint32_t i = 0; i < ChunkCount; i++)
+		{
+			Chunks[i].Source = List->Items;
+			Chunks[i].Destination = List->Scratch;
+			Chunks[i].Begin = (uint32_t)((uint64_t)List->Count * i / ChunkCount);
+			Chunks[i].End = (uint32_t)((uint64_t)List->Count * (i + 1) / ChunkCount);
+			Chunks[i].Shift = Shift;
+		}
+
+		DrawListRunChunks(JobSystem, DrawListCountJob, Chunks, ChunkCount);
+
+		// digit by digit, and within a digit chunk by chunk, which keeps the sort stable
+		uint32_t Offset = 0;
+
+		for (uint32_t Digit = 0; Digit < DRAW_LIST_SORT_RADIX; Digit++)
+		{
+			for (uint32_t i = 0; i < ChunkCount; i++)
+			{
+				uint32_t Count = Chunks[i].Offsets[Digit];
+				Chunks[i].Offsets[Digit] = Offset;
+				Offset += Count;
+			}
+		}
+
+		DrawListRunChunks(JobSystem, DrawListScatterJob, Chunks, ChunkCount);
+
+		struct DrawItem* Sorted = List->Scratch;
+		List->Scratch = List->Items;
+		List->Items = Sorted;
+	}
+}
+
+void RecordScenePass(VkCommandBuffer CommandBuffer, void* Context, void* FrameData)
+{
+	const struct ScenePassContext* Pass = Context;
+	const struct VulkanObjects* VulkanObjects = Pass->VulkanObjects;
+	const struct FrameContext* Frame = FrameData;
+	const struct SceneTimer* Timer = &VulkanObjects->SceneTimer;
+
+	bool FirstPass = Pass->FirstView == 0;
+	bool LastPass = Pass->FirstView + Pass->ViewCount == VulkanObjects->ViewCount;
+
+	// outside the render pass, which timestamps can't be reset in
+	if (FirstPass && Timer->QueryPool != VK_NULL_HANDLE)
+	{
+		vkCmdResetQueryPool(CommandBuffer, Timer->QueryPool, Frame->FrameIndex * 2, 2);
+		vkCmdWriteTimestamp(CommandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, Timer->QueryPool, Frame->FrameIndex * 2);
+	}
+
+	VkRect2D RenderArea = { 0 };
+	RenderArea.extent = GetSceneExtent(VulkanObjects);
+
+	const struct RenderGraphResource* ColorResource = &VulkanObjects->FrameGraph.Resources[VulkanObjects->SceneColorResource];
+	const struct RenderGraphResource* DepthResource = &VulkanObjects->FrameGraph.Resources[VulkanObjects->DepthResource];
+
+	VkImageView ColorView = ColorResource->View;
+	VkImageView DepthView = DepthResource->View;
+
+	// a sequential pass renders a single layer
+	if (Pass->ViewCount < VulkanObjects->ViewCount)
+	{
+		ColorView = ColorResource->LayerViews[Pass->FirstView];
+		DepthView = DepthResource->LayerViews[Pass->FirstView];
+	}
+
+	VkClearValue ClearValues[2] = { 0 };
+	ClearValues[0].color = (VkClearColorValue){ {0.0f, 0.0f, 0.0f, 1.0f} };
+	ClearValues[1].depthStencil.depth = 1.0f;
+	ClearValues[1].depthStencil.stencil = 0;
+
+	if (VulkanObjects->UseDynamicRendering)
+	{
+		VkRenderingAttachmentInfo ColorAttachment = { 0 };
+		ColorAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+		ColorAttachment.imageView = ColorView;
+		ColorAttachment.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+		ColorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+		ColorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+		ColorAttachment.clearValue = ClearValues[0];
+
+		VkRenderingAttachmentInfo DepthAttachment = { 0 };
+		DepthAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+		DepthAttachment.imageView = DepthView;
+		DepthAttachment.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+		DepthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+		DepthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		DepthAttachment.clearValue = ClearValues[1];
+
+		VkRenderingInfo RenderingInfo = { 0 };
+		RenderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
+		RenderingInfo.renderArea = RenderArea;
+		RenderingInfo.layerCount = 1;
+		RenderingInfo.viewMask = Pass->ViewCount > 1 ? GetSceneViewMask(VulkanObjects) : 0;
+		RenderingInfo.colorAttachmentCount = 1;
+		RenderingInfo.pColorAttachments = &ColorAttachment;
+		RenderingInfo.pDepthAttachment = &DepthAttachment;
+		VulkanObjects->CmdBeginRendering(CommandBuffer, &RenderingInfo);
+	}
+	else
+	{
+		VkRenderPassBeginInfo RenderPassInfo = { 0 };
+		RenderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+		RenderPassInfo.renderPass = VulkanObjects->RenderPass;
+		RenderPassInfo.framebuffer = VulkanObjects->SwapChainFramebuffers[Frame->ImageIndex];
+		RenderPassInfo.renderArea = RenderArea;
+		RenderPassInfo.clearValueCount = ARRAYSIZE(ClearValues);
+		RenderPassInfo.pClearValues = ClearValues;
+		vkCmdBeginRenderPass(CommandBuffer, &RenderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+	}
+
+	{
+		VkViewport Viewport = { 0 };
+		Viewport.x = 0.0f;
+		Viewport.y = 0.0f;
+		Viewport.width = RenderArea.extent.width;
+		Viewport.height = RenderArea.extent.height;
+		Viewport.minDepth = 0.0f;
+		Viewport.maxDepth = 1.0f;
+		vkCmdSetViewport(CommandBuffer, 0, 1, &Viewport);
+	}
+
+	vkCmdSetScissor(CommandBuffer, 0, 1, &RenderArea);
+
+	{
+		struct DrawMesh Mesh = { VulkanObjects->VertexBuffer, VulkanObjects->IndexBuffer, ARRAYSIZE(Indices), VulkanObjects->Scene.Count, VulkanObjects->VertexBufferAddress, VulkanObjects->IndexBufferAddress };
+
+		struct DrawTables Tables = { 0 };
+		Tables.Layout = VulkanObjects->PipelineLayout;
+		Tables.Pipelines = &VulkanObjects->ScenePipeline;
+		Tables.Materials = &VulkanObjects->DescriptorSets[Frame->FrameIndex];
+		Tables.Meshes = &Mesh;
+
+		// gl_ViewIndex is added to the payload, so a multiview pass starts at view 0 as well
+		struct DrawItem Item = { MakeDrawKey(0, 0, 0, 0, 0.0f), Pass->FirstView };
+
+		struct DrawList List = { &Item, NULL, 1 };
+		RecordDrawList(CommandBuffer, &List, &Tables, NULL);
+	}
+
+	if (VulkanObjects->Particles.Capacity > 0)
+		RecordParticleDraw(VulkanObjects, CommandBuffer);
+
+	if (VulkanObjects->UseDynamicRendering)
+		VulkanObjects->CmdEndRendering(CommandBuffer);
+	else
+		vkCmdEndRenderPass(CommandBuffer);
+
+	if (LastPass && Timer->QueryPool != VK_NULL_HANDLE)
+		vkCmdWriteTimestamp(CommandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, Timer->QueryPool, Frame->FrameIndex * 2 + 1);
+}
+
+// stretches the scaled scene over the whole swapchain image
+void RecordUpscalePass(VkCommandBuffer CommandBuffer, void* Context, void* FrameData)
+{
+	const struct VulkanObjects* VulkanObjects = Context;
+
+	VkExtent2D SceneExtent = GetSceneExtent(VulkanObjects);
+
+	VkImageBlit Region = { 0 };
+	Region.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	Region.srcSubresource.mipLevel = 0;
+	Region.srcSubresource.baseArrayLayer = 0;
+	Region.srcSubresource.layerCount = 1;
+	Region.srcOffsets[0] = (VkOffset3D){ 0, 0, 0 };
+	Region.srcOffsets[1] = (VkOffset3D){ SceneExtent.width, SceneExtent.height, 1 };
+	Region.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	Region.dstSubresource.mipLevel = 0;
+	Region.dstSubresource.baseArrayLayer = 0;
+	Region.dstSubresource.layerCount = 1;
+	Region.dstOffsets[0] = (VkOffset3D){ 0, 0, 0 };
+	Region.dstOffsets[1] = (VkOffset3D){ VulkanObjects->SwapChainExtent.width, VulkanObjects->SwapChainExtent.height, 1 };
+
+	vkCmdBlitImage(
+		CommandBuffer,
+		VulkanObjects->FrameGraph.Resources[VulkanObjects->SceneColorResource].Image,
+		VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+		VulkanObjects->FrameGraph.Resources[VulkanObjects->SwapChainResource].Image,
+		VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+		1,
+		&Region,
+		VulkanObjects->Resolution.Filter
+	);
+}
+
+// copies each view's tile out of its layer onto the swapchain
+void RecordCompositePass(VkCommandBuffer CommandBuffer, void* Context, void* FrameData)
+{
+	const struct VulkanObjects* VulkanObjects = Context;
+
+	VkImage SwapChainImage = VulkanObjects->FrameGraph.Resources[VulkanObjects->SwapChainResource].Image;
+
+	// the tiles leave an empty one with an odd view count, and a strip when the size doesn't divide evenly
+	{
+		VkClearColorValue ClearColor = { {0.0f, 0.0f, 0.0f, 1.0f} };
+
+		VkImageSubresourceRange Range = { 0 };
+		Range.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		Range.baseMipLevel = 0;
+		Range.levelCount = 1;
+		Range.baseArrayLayer = 0;
+		Range.layerCount = 1;
+		vkCmdClearColorImage(CommandBuffer, SwapChainImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, &ClearColor, 1, &Range);
+
+		VkMemoryBarrier Barrier = { 0 };
+		Barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		Barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		Barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		vkCmdPipelineBarrier(CommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &Barrier, 0, NULL, 0, NULL);
+	}
+
+	VkImageCopy Regions[MAX_VIEWS];
+	uint32_t RegionCount = 0;
+
+	for (uint32_t View = 0; View < VulkanObjects->ViewCount; View++)
+	{
+		VkRect2D Tile = GetViewTile(VulkanObjects, View);
+
+		// a window a pixel wide has no room for the second column
+		if (Tile.offset.x + Tile.extent.width > VulkanObjects->SwapChainExtent.width || Tile.offset.y + Tile.extent.height > VulkanObjects->SwapChainExtent.height)
+			continue;
+
+		VkImageCopy* Region = &Regions[RegionCount++];
+		*Region = (VkImageCopy){ 0 };
+		Region->srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		Region->srcSubresource.mipLevel = 0;
+		Region->srcSubresource.baseArrayLayer = View;
+		Region->srcSubresource.layerCount = 1;
+		Region->srcOffset = (VkOffset3D){ 0, 0, 0 };
+		Region->dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		Region->dstSubresource.mipLevel = 0;
+		Region->dstSubresource.baseArrayLayer = 0;
+		Region->dstSubresource.layerCount = 1;
+		Region->dstOffset = (VkOffset3D){ Tile.offset.x, Tile.offset.y, 0 };
+		Region->extent = (VkExtent3D){ Tile.extent.width, Tile.extent.height, 1 };
+	}
+
+	if (RegionCount == 0)
+		return;
+
+	vkCmdCopyImage(
+		CommandBuffer,
+		VulkanObjects->FrameGraph.Resources[VulkanObjects->SceneColorResource].Image,
+		VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+		SwapChainImage,
+		VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+		RegionCount,
+		Regions
+	);
+}
+
+void RecordCapturePass(VkCommandBuffer CommandBuffer, void* Context, void* FrameData)
+{
+	const struct VulkanObjects* VulkanObjects = Context;
+	const struct FrameContext* Frame = FrameData;
+
+	if (Frame->CaptureBuffer == NULL)
+		return;
+
+	VkBufferImageCopy Region = { 0 };
+	Region.bufferOffset = 0;
+	Region.bufferRowLength = 0;
+	Region.bufferImageHeight = 0;
+	Region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	Region.imageSubresource.mipLevel = 0;
+	Region.imageSubresource.baseArrayLayer = 0;
+	Region.imageSubresource.layerCount = 1;
+	Region.imageOffset = (VkOffset3D){ 0, 0, 0 };
+	Region.imageExtent = (VkExtent3D){ Frame->CaptureBuffer->Width, Frame->CaptureBuffer->Height, 1 };
+
+	vkCmdCopyImageToBuffer(
+		CommandBuffer,
+		VulkanObjects->FrameGraph.Resources[VulkanObjects->SwapChainResource].Image,
+		VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+		Frame->CaptureBuffer->Buffer,
+		1,
+		&Region
+	);
+
+	// the writer thread reads the buffer once the frame's timeline value is reached
+	VkMemoryBarrier HostBarrier = { 0 };
+	HostBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	HostBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	HostBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+
+	vkCmdPipelineBarrier(
+		CommandBuffer,
+		VK_PIPELINE_STAGE_TRANSFER_BIT,
+		VK_PIPELINE_STAGE_HOST_BIT,
+		0,
+		1,
+		&HostBarrier,
+		0,
+		NULL,
+		0,
+		NULL
+	);
+}
+
+static void CreateCaptureBuffer(const struct VulkanObjects* VulkanObjects, struct CaptureBuffer* Buffer, VkDeviceSize Size)
+{
+	{
+		VkBufferCreateInfo BufferInfo = { 0 };
+		BufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		BufferInfo.size = Size;
+		BufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+		BufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		THROW_ON_FAIL_VK(vkCreateBuffer(VulkanObjects->Device, &BufferInfo, NULL, &Buffer->Buffer));
+	}
+
+	{
+		VkMemoryRequirements MemRequirements;
+		vkGetBufferMemoryRequirements(VulkanObjects->Device, Buffer->Buffer, &MemRequirements);
+
+		uint32_t MemoryType = SelectMemoryType(MemRequirements.memoryTypeBits, MEMORY_USAGE_GPU_TO_CPU);
+		Buffer->Coherent = (GetMemoryTypeFlags(MemoryType) & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0;
+
+		VkMemoryAllocateInfo AllocInfo = { 0 };
+		AllocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		AllocInfo.allocationSize = MemRequirements.size;
+		AllocInfo.memoryTypeIndex = MemoryType;
+		THROW_ON_FAIL_VK(AllocateDeviceMemory(VulkanObjects->Device, &AllocInfo, MEMORY_CATEGORY_READBACK, &Buffer->Memory));
+	}
+
+	vkBindBufferMemory(VulkanObjects->Device, Buffer->Buffer, Buffer->Memory, 0);
+	THROW_ON_FAIL_VK(vkMapMemory(VulkanObjects->Device, Buffer->Memory, 0, VK_WHOLE_SIZE, 0, &Buffer->Mapped));
+
+	Buffer->Size = Size;
+}
+
+static void DestroyCaptureBuffer(VkDevice Device, struct CaptureBuffer* Buffer)
+{
+	if (Buffer->Buffer == VK_NULL_HANDLE)
+		return;
+
+	vkUnmapMemory(Device, Buffer->Memory);
+	vkDestroyBuffer(Device, Buffer->Buffer, NULL);
+	FreeDeviceMemory(Device, Buffer->Memory);
+
+	*Buffer = (struct CaptureBuffer){ 0 };
+}
+
+/*
+* picks the readback buffer the frame copies into, or returns NULL when the writer still
+* owns all of them. the frame is then dropped from the capture, so a slow disk or pipe never
+* stalls the render loop
+*/
+struct CaptureBuffer* BeginFrameCapture(struct VulkanObjects* VulkanObjects)
+{
+	struct FrameCapture* Capture = &VulkanObjects->Capture;
+	ULONG Tail = Capture->Tail;
+
+	if (Tail - ReadULongAcquire(&Capture->Head) == CAPTURE_BUFFER_COUNT)
+	{
+		Capture->FramesDropped++;
+		return NULL;
+	}
+
+	struct CaptureBuffer* Buffer = &Capture->Buffers[Tail % CAPTURE_BUFFER_COUNT];
+	VkDeviceSize Size = (VkDeviceSize)VulkanObjects->SwapChainExtent.width * VulkanObjects->SwapChainExtent.height * 4;
+
+	// the writer waited for the buffer's frame before handing it back, so after a resize it
+	// can be replaced right away
+	if (Buffer->Size < Size)
+	{
+		DestroyCaptureBuffer(VulkanObjects->Device, Buffer);
+		CreateCaptureBuffer(VulkanObjects, Buffer, Size);
+	}
+
+	Buffer->Width = VulkanObjects->SwapChainExtent.width;
+	Buffer->Height = VulkanObjects->SwapChainExtent.height;
+
+	return Buffer;
+}
+
+// called once the frame that copied into the buffer from BeginFrameCapture is submitted
+void EndFrameCapture(struct FrameCapture* Capture, uint64_t TimelineValue)
+{
+	ULONG Tail = Capture->Tail;
+
+	Capture->Buffers[Tail % CAPTURE_BUFFER_COUNT].TimelineValue = TimelineValue;
+	WriteULongRelease(&Capture->Tail, Tail + 1);
+
+	THROW_ON_FALSE(SetEvent(Capture->WakeEvent));
+}
+
+#define QOI_OP_INDEX 0x00
+#define QOI_OP_DIFF 0x40
+#define QOI_OP_LUMA 0x80
+#define QOI_OP_RUN 0xc0
+#define QOI_OP_RGB 0xfe
+
+// the largest QOI image of the given size: a header, four bytes per pixel and the end marker
+static size_t QoiMaxSize(uint32_t Width, uint32_t Height)
+{
+	return 14 + (size_t)Width * Height * 4 + 8;
+}
+
+static uint8_t* QoiWriteU32(uint8_t* Cursor, uint32_t Value)
+{
+	*Cursor++ = (uint8_t)(Value >> 24);
+	*Cursor++ = (uint8_t)(Value >> 16);
+	*Cursor++ = (uint8_t)(Value >> 8);
+	*Cursor++ = (uint8_t)Value;
+	return Cursor;
+}
+
+/*
+* encodes 8 bit RGBA or BGRA pixels as an opaque QOI image (https://qoiformat.org). the
+* swapchain is opaque, so alpha is dropped and the RGBA op is never needed
+*/
+size_t QoiEncode(const uint8_t* Pixels, uint32_t Width, uint32_t Height, bool Bgra, uint8_t* Output)
+{
+	uint8_t* Cursor = Output;
+
+	*Cursor++ = 'q';
+	*Cursor++ = 'o';
+	*Cursor++ = 'i';
+	*Cursor++ = 'f';
+	Cursor = QoiWriteU32(Cursor, Width);
+	Cursor = QoiWriteU32(Cursor, Height);
+	*Cursor++ = 3;
+	*Cursor++ = 0;
+
+	uint32_t Index[64] = { 0 };
+	uint8_t PreviousR = 0;
+	uint8_t PreviousG = 0;
+	uint8_t PreviousB = 0;
+	uint32_t Run = 0;
+
+	uint32_t RedOffset = Bgra ? 2 : 0;
+	uint32_t BlueOffset = Bgra ? 0 : 2;
+	size_t PixelCount = (size_t)Width * Height;
+
+	for (size_t i = 0; i < PixelCount; i++)
+	{
+		const uint8_t* Pixel = Pixels + i * 4;
+		uint8_t R = Pixel[RedOffset];
+		uint8_t G = Pixel[1];
+		uint8_t B = Pixel[BlueOffset];
+
+		if (R == PreviousR && G == PreviousG && B == PreviousB)
+		{
+			Run++;
+
+			if (Run == 62 || i == PixelCount - 1)
+			{
+				*Cursor++ = QOI_OP_RUN | (Run - 1);
+				Run = 0;
+			}
+
+			continue;
+		}
+
+		if (Run > 0)
+		{
+			*Cursor++ = QOI_OP_RUN | (Run - 1);
+			Run = 0;
+		}
+
+		uint32_t Hash = (R * 3 + G * 5 + B * 7 + 255 * 11) % 64;
+		uint32_t Packed = R | (G << 8) | (B << 16) | 0xff000000u;
+
+		if (Index[Hash] == Packed)
+		{
+			*Cursor++ = QOI_OP_INDEX | Hash;
+		}
+		else
+		{
+			Index[Hash] = Packed;
+
+			int DeltaR = (int8_t)(R - PreviousR);
+			int DeltaG = (int8_t)(G - PreviousG);
+			int DeltaB = (int8_t)(B - PreviousB);
+			int DeltaRG = DeltaR - DeltaG;
+			int DeltaBG = DeltaB - DeltaG;
+
+			if (DeltaR >= -2 && DeltaR <= 1 && DeltaG >= -2 && DeltaG <= 1 && DeltaB >= -2 && DeltaB <= 1)
+			{
+				*Cursor++ = QOI_OP_DIFF | ((DeltaR + 2) << 4) | ((DeltaG + 2) << 2) | (DeltaB + 2);
+			}
+			else if (DeltaRG >= -8 && DeltaRG <= 7 && DeltaG >= -32 && DeltaG <= 31 && DeltaBG >= -8 && DeltaBG <= 7)
+			{
+				*Cursor++ = QOI_OP_LUMA | (DeltaG + 32);
+				*Cursor++ = ((DeltaRG + 8) << 4) | (DeltaBG + 8);
+			}
+			else
+			{
+				*Cursor++ = QOI_OP_RGB;
+				*Cursor++ = R;
+				*Cursor++ = G;
+				*Cursor++ = B;
+			}
+		}
+
+		PreviousR = R;
+		PreviousG = G;
+		PreviousB = B;
+	}
+
+	for (int i = 0; i < 7; i++)
+	{
+		*Cursor++ = 0;
+	}
+
+	*Cursor++ = 1;
+
+	return Cursor - Output;
+}
+
+static size_t EncodeCaptureFrame(struct FrameCapture* Capture, const struct CaptureBuffer* Buffer)
+{
+	size_t PixelCount = (size_t)Buffer->Width * Buffer->Height;
+	size_t RequiredSize = Capture->Format == CAPTURE_FORMAT_QOI ? QoiMaxSize(Buffer->Width, Buffer->Height) : PixelCount * 4;
+
+	if (Capture->EncodeBufferSize < RequiredSize)
+	{
+		free(Capture->EncodeBuffer);
+		Capture->EncodeBuffer = malloc(RequiredSize);
+
+		if (Capture->EncodeBuffer == NULL)
+			FailFastWithMessage("out of memory\n");
+
+		Capture->EncodeBufferSize = RequiredSize;
+	}
+
+	if (Capture->Format == CAPTURE_FORMAT_QOI)
+		return QoiEncode(Buffer->Mapped, Buffer->Width, Buffer->Height, Capture->Bgra, Capture->EncodeBuffer);
+
+	// raw frames are always RGBA, whatever order the swapchain stores them in
+	const uint8_t* Source = Buffer->Mapped;
+	uint8_t* Destination = Capture->EncodeBuffer;
+	uint32_t RedOffset = Capture->Bgra ? 2 : 0;
+	uint32_t BlueOffset = Capture->Bgra ? 0 : 2;
+
+	for (size_t i = 0; i < PixelCount; i++)
+	{
+		Destination[i * 4 + 0] = Source[i * 4 + RedOffset];
+		Destination[i * 4 + 1] = Source[i * 4 + 1];
+		Destination[i * 4 + 2] = Source[i * 4 + BlueOffset];
+		Destination[i * 4 + 3] = 255;
+	}
+
+	return PixelCount * 4;
+}
+
+DWORD WINAPI CaptureWriterProc(LPVOID Parameter)
+{
+	struct VulkanObjects* VulkanObjects = Parameter;
+	struct FrameCapture* Capture = &VulkanObjects->Capture;
+
+	PROFILE_THREAD_NAME("CaptureWriter");
+
+	for (;;)
+	{
+		// read before Tail: the render thread has pushed its last frame by the time Quit is set
+		bool Quit = ReadAcquire(&Capture->Quit);
+		ULONG Head = Capture->Head;
+
+		if (Head == ReadULongAcquire(&Capture->Tail))
+		{
+			if (Quit)
+				break;
+
+			WaitForSingleObject(Capture->WakeEvent, INFINITE);
+			continue;
+		}
+
+		struct CaptureBuffer* Buffer = &Capture->Buffers[Head % CAPTURE_BUFFER_COUNT];
+
+		PROFILE_ZONE("WaitForCapture")
+		{
+			WaitForTimelineValue(VulkanObjects->Device, &VulkanObjects->GraphicsTimeline, Buffer->TimelineValue);
+		}
+
+		// after a failed write the buffers are still cycled, so the render thread keeps going
+		if (!Capture->OutputFailed)
+		{
+			if (!Buffer->Coherent)
+			{
+				VkMappedMemoryRange Range = { 0 };
+				Range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+				Range.memory = Buffer->Memory;
+				Range.offset = 0;
+				Range.size = VK_WHOLE_SIZE;
+				THROW_ON_FAIL_VK(vkInvalidateMappedMemoryRanges(VulkanObjects->Device, 1, &Range));
+			}
+
+			size_t EncodedSize = 0;
+
+			PROFILE_ZONE("EncodeFrame")
+			{
+				EncodedSize = EncodeCaptureFrame(Capture, Buffer);
+			}
+
+			DWORD BytesWritten = 0;
+			BOOL Written = FALSE;
+
+			PROFILE_ZONE("WriteFrame")
+			{
+				Written = WriteFile(Capture->Output, Capture->EncodeBuffer, (DWORD)EncodedSize, &BytesWritten, NULL);
+			}
+
+			if (Written && BytesWritten == EncodedSize)
+			{
+				InterlockedIncrement64(&Capture->FramesWritten);
+				InterlockedAdd64(&Capture->BytesWritten, EncodedSize);
+			}
+			else
+			{
+				// usually the reading end of a pipe going away
+				LogMessage("capture: writing a frame failed (error %lu), capture stopped\n", GetLastError());
+				Capture->OutputFailed = true;
+			}
+		}
+
+		WriteULongRelease(&Capture->Head, Head + 1);
+	}
+
+	return 0;
+}
+
+/*
+* Path "-" streams to stdout. ParseCommandLine has already moved the log to stderr, so it
+* never ends up in the pipe
+*/
+void StartFrameCapture(struct VulkanObjects* VulkanObjects, const char* Path, enum CaptureFormat Format)
+{
+	struct FrameCapture* Capture = &VulkanObjects->Capture;
+
+	switch (VulkanObjects->SwapChainImageFormat.format)
+	{
+	case VK_FORMAT_B8G8R8A8_UNORM:
+	case VK_FORMAT_B8G8R8A8_SRGB:
+		Capture->Bgra = true;
+		break;
+	case VK_FORMAT_R8G8B8A8_UNORM:
+	case VK_FORMAT_R8G8B8A8_SRGB:
+		Capture->Bgra = false;
+		break;
+	default:
+		FailFastWithMessage("capture: the swapchain format is not 8 bit RGBA or BGRA\n");
+	}
+
+	if ((VulkanObjects->SurfaceCapabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT) == 0)
+		FailFastWithMessage("capture: the surface does not support copying from swapchain images\n");
+
+	if (strcmp(Path, "-") == 0)
+	{
+		Capture->Output = GetStdHandle(STD_OUTPUT_HANDLE);
+		Capture->OutputIsStdout = true;
+	}
+	else
+	{
+		Capture->Output = CreateFileA(Path, GENERIC_WRITE, FILE_SHARE_READ, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+		Capture->OutputIsStdout = false;
+	}
+
+	VALIDATE_HANDLE(Capture->Output);
+
+	Capture->Enabled = true;
+	Capture->Format = Format;
+
+	Capture->WakeEvent = CreateEventW(NULL, FALSE, FALSE, NULL);
+	VALIDATE_HANDLE(Capture->WakeEvent);
+
+	Capture->Thread = CreateThread(NULL, 0, CaptureWriterProc, VulkanObjects, 0, NULL);
+	VALIDATE_HANDLE(Capture->Thread);
+
+	LogMessage("capturing %s frames to %s\n", CAPTURE_FORMAT_NAMES[Format], Capture->OutputIsStdout ? "stdout" : Path);
+}
+
+// the render thread has exited and the device is idle, so the writer only drains what is queued
+void StopFrameCapture(struct VulkanObjects* VulkanObjects)
+{
+	struct FrameCapture* Capture = &VulkanObjects->Capture;
+
+	WriteRelease(&Capture->Quit, TRUE);
+	THROW_ON_FALSE(SetEvent(Capture->WakeEvent));
+
+	WaitForSingleObject(Capture->Thread, INFINITE);
+
+	THROW_ON_FALSE(CloseHandle(Capture->Thread));
+	THROW_ON_FALSE(CloseHandle(Capture->WakeEvent));
+
+	if (!Capture->OutputIsStdout)
+		THROW_ON_FALSE(CloseHandle(Capture->Output));
+
+	for (int i = 0; i < CAPTURE_BUFFER_COUNT; i++)
+	{
+		DestroyCaptureBuffer(VulkanObjects->Device, &Capture->Buffers[i]);
+	}
+
+	free(Capture->EncodeBuffer);
+
+	LogMessage("capture: %lld frames written (%.1f MB), %u dropped\n", Capture->FramesWritten, Capture->BytesWritten / (1024.0 * 1024.0), Capture->FramesDropped);
+}
+
+/*
+* declares the passes of a frame. called again whenever the swapchain is recreated
+*/
+void BuildFrameGraph(struct VulkanObjects* VulkanObjects)
+{
+	struct RenderGraph* Graph = &VulkanObjects->FrameGraph;
+	Graph->ResourceCount = 0;
+	Graph->PassCount = 0;
+
+#ifdef ENABLE_PROFILING
+	Graph->GpuProfiler = &VulkanObjects->GpuProfiler;
+#endif
+
+	VulkanObjects->SwapChainResource = RenderGraphImportImage(
+		Graph,
+		"SwapChain",
+		VulkanObjects->SwapChainImageFormat.format,
+		VK_IMAGE_ASPECT_COLOR_BIT,
+		RENDER_GRAPH_ACCESS_SWAPCHAIN_ACQUIRE,
+		RENDER_GRAPH_ACCESS_PRESENT
+	);
+
+	VulkanObjects->DepthResource = RenderGraphCreateImageArray(
+		Graph,
+		"Depth",
+		VulkanObjects->DepthFormat,
+		VK_IMAGE_ASPECT_DEPTH_BIT | (HasStencilComponent(VulkanObjects->DepthFormat) ? VK_IMAGE_ASPECT_STENCIL_BIT : 0),
+		VulkanObjects->ViewCount,
+		true
+	);
+
+	VulkanObjects->SceneColorResource = VulkanObjects->SwapChainResource;
+
+	if (VulkanObjects->ViewCount > 1)
+	{
+		VulkanObjects->SceneColorResource = RenderGraphCreateImageArray(
+			Graph,
+			"Views",
+			VulkanObjects->SwapChainImageFormat.format,
+			VK_IMAGE_ASPECT_COLOR_BIT,
+			VulkanObjects->ViewCount,
+			false
+		);
+	}
+	else if (VulkanObjects->Resolution.Enabled)
+	{
+		// swapchain sized, the largest the scale ever gets
+		VulkanObjects->SceneColorResource = RenderGraphCreateImage(
+			Graph,
+			"SceneColor",
+			VulkanObjects->SwapChainImageFormat.format,
+			VK_IMAGE_ASPECT_COLOR_BIT,
+			false
+		);
+	}
+
+	static const char* const SCENE_VIEW_PASS_NAMES[MAX_VIEWS] = {
+		"Scene View 0",
+		"Scene View 1",
+		"Scene View 2",
+		"Scene View 3"
+	};
+
+	bool Sequential = VulkanObjects->ViewCount > 1 && VulkanObjects->ViewMode == VIEW_MODE_SEQUENTIAL;
+	uint32_t ScenePassCount = Sequential ? VulkanObjects->ViewCount : 1;
+
+	for (uint32_t i = 0; i < ScenePassCount; i++)
+	{
+		struct ScenePassContext* Context = &VulkanObjects->ScenePasses[i];
+		Context->VulkanObjects = VulkanObjects;
+		Context->FirstView = i;
+		Context->ViewCount = Sequential ? 1 : VulkanObjects->ViewCount;
+
+		uint32_t ScenePass = RenderGraphAddPass(Graph, Sequential ? SCENE_VIEW_PASS_NAMES[i] : "Scene", RecordScenePass, Context);
+		RenderGraphUseResource(Graph, ScenePass, VulkanObjects->SceneColorResource, RENDER_GRAPH_ACCESS_COLOR_ATTACHMENT_WRITE);
+		RenderGraphUseResource(Graph, ScenePass, VulkanObjects->DepthResource, RENDER_GRAPH_ACCESS_DEPTH_ATTACHMENT_WRITE);
+	}
+
+	if (VulkanObjects->ViewCount > 1)
+	{
+		uint32_t CompositePass = RenderGraphAddPass(Graph, "Composite", RecordCompositePass, VulkanObjects);
+		RenderGraphUseResource(Graph, CompositePass, VulkanObjects->SceneColorResource, RENDER_GRAPH_ACCESS_TRANSFER_READ);
+		RenderGraphUseResource(Graph, CompositePass, VulkanObjects->SwapChainResource, RENDER_GRAPH_ACCESS_TRANSFER_WRITE);
+	}
+	else if (VulkanObjects->Resolution.Enabled)
+	{
+		uint32_t UpscalePass = RenderGraphAddPass(Graph, "Upscale", RecordUpscalePass, VulkanObjects);
+		RenderGraphUseResource(Graph, UpscalePass, VulkanObjects->SceneColorResource, RENDER_GRAPH_ACCESS_TRANSFER_READ);
+		RenderGraphUseResource(Graph, UpscalePass, VulkanObjects->SwapChainResource, RENDER_GRAPH_ACCESS_TRANSFER_WRITE);
+	}
+
+	if (VulkanObjects->Capture.Enabled)
+	{
+		uint32_t CapturePass = RenderGraphAddPass(Graph, "Capture", RecordCapturePass, VulkanObjects);
+		RenderGraphUseResource(Graph, CapturePass, VulkanObjects->SwapChainResource, RENDER_GRAPH_ACCESS_TRANSFER_READ);
+		RenderGraphSetSideEffects(Graph, CapturePass);
+	}
+
+	RenderGraphCompile(Graph);
+}
+
+#define RENDER_COMMAND_QUEUE_SIZE 64
+#define FRAME_STATS_INTERVAL_MS 2000
+#define MEMORY_STATS_INTERVAL_MS 10000
+
+enum FrameMode
+{
+	// render as fast as the present mode allows
+	FRAME_MODE_CONTINUOUS,
+	// render at TargetFps, sleeping on a high resolution waitable timer in between
+	FRAME_MODE_THROTTLED,
+	// render only when the window or the camera changes; the animation is paused
+	FRAME_MODE_ON_DEMAND,
+	FRAME_MODE_COUNT
+};
+
+static const char* const FRAME_MODE_NAMES[FRAME_MODE_COUNT] = {
+	"continuous",
+	"throttled",
+	"on-demand"
+};
+
+struct LaunchOptions
+{
+	enum FrameMode FrameMode;
+	uint32_t TargetFps;
+	uint32_t ParticleCount;
+
+	// static nodes added to the scene graph besides the model
+	uint32_t SceneNodes;
+
+	uint32_t ViewCount;
+	enum ViewMode ViewMode;
+
+	// 0 renders at the swapchain size
+	float ResolutionBudget;
+
+	bool CacheFrames;
+	bool VertexPulling;
+
+	// 0 skips the benchmark
+	uint32_t DispatchBenchmarkDraws;
+
+	// 0 opens the window. anything else runs headless and exits after the benchmark
+	uint32_t DrawBenchmarkDraws;
+
+	// empty uses the embedded shaders
+	char ShaderDirectory[MAX_PATH];
+
+	// empty uses the compiled-in assets
+	char AssetPackPath[MAX_PATH];
+
+	// anything but empty writes the pack and exits
+	char PackAssetsPath[MAX_PATH];
+	bool PackCompression;
+
+	// 0 skips the benchmark. needs an asset pack, and exits afterwards
+	uint32_t AssetBenchmarkIterations;
+
+	// empty selects the highest scoring device
+	char DeviceSelector[256];
+
+	// empty turns the capture off, "-" is stdout
+	char CapturePath[MAX_PATH];
+	enum CaptureFormat CaptureFormat;
+};
+
+enum RenderCommandType
+{
+	RENDER_COMMAND_RESIZE,
+	RENDER_COMMAND_REDRAW,
+	RENDER_COMMAND_CYCLE_FRAME_MODE,
+	RENDER_COMMAND_CYCLE_MATERIAL,
+	RENDER_COMMAND_TOGGLE_FULLSCREEN,
+	RENDER_COMMAND_QUIT
+};
+
+struct RenderCommand
+{
+	enum RenderCommandType Type;
+
+	union
+	{
+		struct
+		{
+			uint32_t Width;
+			uint32_t Height;
+		} Resize;
+	};
+};
+
+/*
+* single producer (the window thread), single consumer (the render thread). Head is only
+* written by the consumer and Tail only by the producer, so no locks are needed
+*/
+struct RenderCommandQueue
+{
+	alignas(64) volatile ULONG Head;
+	alignas(64) volatile ULONG Tail;
+	HANDLE WakeEvent;
+	struct RenderCommand Commands[RENDER_COMMAND_QUEUE_SIZE];
+
+	// camera input is summed here instead of queued, so a flood of mouse messages during a
+	// long frame can't fill the ring. in pixels and wheel units, taken whole by the consumer
+	alignas(64) volatile LONG OrbitX;
+	volatile LONG OrbitY;
+	volatile LONG Zoom;
+
+	// set by the consumer when it stops draining, after which commands are dropped
+	volatile LONG Closed;
+};
+
+struct RenderThreadContext
+{
+	struct RenderCommandQueue Queue;
+	struct VulkanObjects* VulkanObjects;
+	HWND Window;
+	HANDLE Thread;
+	enum FrameMode FrameMode;
+	uint32_t TargetFps;
+	LONGLONG StartupTime;
+	uint32_t StartupThreadCount;
+};
+
+struct Camera
+{
+	float Yaw;
+	float Pitch;
+	float Distance;
+};
+
+/*
+* what is left in the ring are key presses, size changes and paints, a handful per frame at
+* most, so the ring only fills if the render thread stops draining for a long time, e.g. in
+* a swapchain rebuild. then the window thread yields until a slot frees up
+*/
+void RenderCommandQueuePush(struct RenderCommandQueue* Queue, const struct RenderCommand* Command)
+{
+	ULONG Tail = Queue->Tail;
+
+	while (Tail - ReadULongAcquire(&Queue->Head) == RENDER_COMMAND_QUEUE_SIZE)
+	{
+		if (ReadAcquire(&Queue->Closed))
+			return;
+
+		SwitchToThread();
+	}
+
+	Queue->Commands[Tail % RENDER_COMMAND_QUEUE_SIZE] = *Command;
+	WriteULongRelease(&Queue->Tail, Tail + 1);
+
+	THROW_ON_FALSE(SetEvent(Queue->WakeEvent));
+}
+
+// never waits: the deltas are added to whatever the render thread hasn't taken yet
+void RenderCommandQueueAddCameraInput(struct RenderCommandQueue* Queue, LONG OrbitX, LONG OrbitY, LONG Zoom)
+{
+	InterlockedAdd(&Queue->OrbitX, OrbitX);
+	InterlockedAdd(&Queue->OrbitY, OrbitY);
+	InterlockedAdd(&Queue->Zoom, Zoom);
+
+	THROW_ON_FALSE(SetEvent(Queue->WakeEvent));
+}
+
+bool RenderCommandQueuePop(struct RenderCommandQueue* Queue, struct RenderCommand* Command)
+{
+	ULONG Head = Queue->Head;
+
+	if (Head == ReadULongAcquire(&Queue->Tail))
+		return false;
+
+	*Command = Queue->Commands[Head % RENDER_COMMAND_QUEUE_SIZE];
+	WriteULongRelease(&Queue->Head, Head + 1);
+
+	return true;
+}
+
+/*
+* writes the world transforms that changed since the slot's instance buffer was last
+* written. returns the bytes written
+*/
+VkDeviceSize UploadSceneInstances(struct VulkanObjects* VulkanObjects, uint32_t Slot)
+{
+	struct SceneGraph* Scene = &VulkanObjects->Scene;
+	mat4* Instances = VulkanObjects->InstanceBuffersMapped[Slot];
+
+	struct MemoryFlushBatch Batch = { 0 };
+
+	for (uint32_t i = 0; i < Scene->PendingCounts[Slot]; i++)
+	{
+		uint32_t Node = Scene->Pending[Slot][i];
+
+		memcpy(Instances[Node], Scene->Worlds[Node], sizeof(mat4));
+		Scene->PendingSlots[Node] &= ~(1 << Slot);
+
+		if (!VulkanObjects->InstanceBuffersCoherent)
+			AddMemoryFlush(VulkanObjects->Device, &Batch, VulkanObjects->InstanceBuffersMemory[Slot], Node * sizeof(mat4), sizeof(mat4));
+	}
+
+	FlushMemoryBatch(VulkanObjects->Device, &Batch);
+
+	VkDeviceSize Bytes = Scene->PendingCounts[Slot] * sizeof(mat4);
+	Scene->PendingCounts[Slot] = 0;
+
+	return Bytes;
+}
+
+/*
+* records and submits one frame. returns true when the swapchain no longer matches the
+* surface and has to be recreated before the next frame
+*/
+bool DrawFrame(struct VulkanObjects* VulkanObjects, const struct Camera* Camera, float Time)
+{
+	uint32_t CurrentFrame = VulkanObjects->CurrentFrame;
+
+	PROFILE_ZONE("WaitForFrameSlot")
+	{
+		WaitForTimelineValue(VulkanObjects->Device, &VulkanObjects->GraphicsTimeline, VulkanObjects->FrameTimelineValues[CurrentFrame]);
+	}
+
+	ProcessDeferredDeletions(VulkanObjects, false);
+
+	UpdateMemoryBudget(VulkanObjects->PhysicalDevice);
+
+	// the slot's last draw waited for its simulation, so the timestamps are written by now
+	if (VulkanObjects->Particles.Capacity > 0)
+		ReadParticleTimestamps(&VulkanObjects->Particles, VulkanObjects->Device, CurrentFrame);
+
+	if (ReadSceneTimestamps(&VulkanObjects->SceneTimer, VulkanObjects->Device, CurrentFrame) && VulkanObjects->Resolution.Enabled)
+		UpdateResolutionScale(&VulkanObjects->Resolution, VulkanObjects->SceneTimer.LastMilliseconds, VulkanObjects->Resolution.FrameScales[CurrentFrame]);
+
+	VulkanObjects->Resolution.FrameScales[CurrentFrame] = VulkanObjects->Resolution.Scale;
+
+	PROFILE_COUNTER("DeferredDeletions", VulkanObjects->DeferredDeletionCount);
+
+	uint32_t ImageIndex;
+	VkResult AcquireResult;
+
+	PROFILE_ZONE("Acquire")
+	{
+		AcquireResult = vkAcquireNextImageKHR(VulkanObjects->Device, VulkanObjects->SwapChain, UINT64_MAX, VulkanObjects->ImageAvailableSemaphores[CurrentFrame], VK_NULL_HANDLE, &ImageIndex);
+	}
+
+	// the window changed size after the last resize command was handled; nothing was
+	// signalled, so the frame is simply skipped
+	if (AcquireResult == VK_ERROR_OUT_OF_DATE_KHR)
+		return true;
+
+	THROW_ON_FAIL_VK(AcquireResult);
+
+	PROFILE_ZONE("UpdateScene")
+	{
+		LARGE_INTEGER Frequency;
+		LARGE_INTEGER UpdateStart;
+		QueryPerformanceFrequency(&Frequency);
+		QueryPerformanceCounter(&UpdateStart);
+
+		struct SceneGraph* Scene = &VulkanObjects->Scene;
+
+		mat4 Model;
+		glm_rotate_make(Model, Time * glm_rad(90.0f), (vec3) { 0.0f, 0.0f, 1.0f });
+		SetSceneNodeLocal(Scene, VulkanObjects->ModelNode, Model);
+
+		UpdateSceneGraph(Scene);
+		Scene->UploadedBytes += UploadSceneInstances(VulkanObjects, CurrentFrame);
+
+		LARGE_INTEGER UpdateEnd;
+		QueryPerformanceCounter(&UpdateEnd);
+		Scene->UpdateMilliseconds += (UpdateEnd.QuadPart - UpdateStart.QuadPart) * 1000.0 / Frequency.QuadPart;
+		Scene->Samples++;
+	}
+
+	PROFILE_ZONE("UpdateCamera")
+	{
+		struct SceneCamera* SceneCamera = &VulkanObjects->SceneCamera;
+		VkExtent2D ViewExtent = GetSceneExtent(VulkanObjects);
+
+		bool Moved = SceneCamera->Version == 0 ||
+			SceneCamera->Yaw != Camera->Yaw ||
+			SceneCamera->Pitch != Camera->Pitch ||
+			SceneCamera->Distance != Camera->Distance ||
+			SceneCamera->Extent.width != ViewExtent.width ||
+			SceneCamera->Extent.height != ViewExtent.height;
+
+		if (Moved)
+		{
+			SceneCamera->Yaw = Camera->Yaw;
+			SceneCamera->Pitch = Camera->Pitch;
+			SceneCamera->Distance = Camera->Distance;
+			SceneCamera->Extent = ViewExtent;
+
+			// the extra cameras orbit at the same distance, spread evenly around the model
+			for (uint32_t View = 0; View < VulkanObjects->ViewCount; View++)
+			{
+				float Yaw = Camera->Yaw + View * (2.0f * GLM_PIf / VulkanObjects->ViewCount);
+
+				vec3 Eye = {
+					Camera->Distance * cosf(Camera->Pitch) * cosf(Yaw),
+					Camera->Distance * cosf(Camera->Pitch) * sinf(Yaw),
+					Camera->Distance * sinf(Camera->Pitch)
+				};
+
+				glm_lookat_rh(Eye, (vec3) { 0.0f, 0.0f, 0.0f }, (vec3) { 0.0f, 0.0f, 1.0f }, SceneCamera->View[View]);
+				glm_perspective_rh_zo(glm_rad(45.0f), ViewExtent.width / (float)ViewExtent.height, 0.1f, 10.0f, SceneCamera->Proj[View]);
+				SceneCamera->Proj[View][1][1] *= -1;
+			}
+
+			SceneCamera->Version++;
+
+			// the particles are not rotated with the model, and billboard along the view axes
+			struct ParticleDrawConstants* ParticleConstants = &VulkanObjects->Particles.DrawConstants;
+			glm_mat4_mul(SceneCamera->Proj[0], SceneCamera->View[0], ParticleConstants->ViewProj);
+			glm_vec4_copy((vec4) { SceneCamera->View[0][0][0], SceneCamera->View[0][1][0], SceneCamera->View[0][2][0], 0.0f }, ParticleConstants->CameraRight);
+			glm_vec4_copy((vec4) { SceneCamera->View[0][0][1], SceneCamera->View[0][1][1], SceneCamera->View[0][2][1], 0.0f }, ParticleConstants->CameraUp);
+		}
+
+		// each slot's buffer is still read by the frame that last used it, so a change is
+		// written to every slot as it comes around
+		if (SceneCamera->UploadedVersions[CurrentFrame] != SceneCamera->Version)
+		{
+			struct UniformBufferObject* Ubo = VulkanObjects->UniformBuffersMapped[CurrentFrame];
+			memcpy(Ubo->View, SceneCamera->View, sizeof(Ubo->View));
+			memcpy(Ubo->Proj, SceneCamera->Proj, sizeof(Ubo->Proj));
+
+			if (!VulkanObjects->UniformBuffersCoherent)
+			{
+				struct MemoryFlushBatch Batch = { 0 };
+				AddMemoryFlush(VulkanObjects->Device, &Batch, VulkanObjects->UniformBuffersMemory[CurrentFrame], 0, sizeof(struct UniformBufferObject));
+				FlushMemoryBatch(VulkanObjects->Device, &Batch);
+			}
+
+			SceneCamera->UploadedVersions[CurrentFrame] = SceneCamera->Version;
+		}
+	}
+
+	uint64_t SimulationValue = 0;
+
+	if (VulkanObjects->Particles.Capacity > 0)
+	{
+		PROFILE_ZONE("SimulateParticles")
+		{
+			SimulationValue = SubmitParticleSimulation(VulkanObjects, CurrentFrame, Time);
+		}
+	}
+
+	struct CaptureBuffer* CaptureBuffer = NULL;
+
+	VkCommandBuffer CommandBuffer = VulkanObjects->CommandBuffers[CurrentFrame];
+	bool Reuse = false;
+
+	if (VulkanObjects->FrameCache.Enabled)
+	{
+		struct FrameCache* Cache = &VulkanObjects->FrameCache;
+		bool HasParticles = VulkanObjects->Particles.Capacity > 0;
+
+		struct FrameRecordKey Key = { 0 };
+		Key.Version = Cache->Version;
+		Key.ScenePipeline = VulkanObjects->ScenePipeline;
+		Key.SceneExtent = GetSceneExtent(VulkanObjects);
+		Key.CameraVersion = HasParticles ? VulkanObjects->SceneCamera.Version : 0;
+		Key.ParticleBuffer = HasParticles ? VulkanObjects->Particles.DrawBuffer : 0;
+
+		struct CachedFrame* Cached = &Cache->Frames[ImageIndex][CurrentFrame][Key.ParticleBuffer];
+
+		if (Cached->CommandBuffer == VK_NULL_HANDLE)
+		{
+			VkCommandBufferAllocateInfo AllocInfo = { 0 };
+			AllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+			AllocInfo.commandPool = VulkanObjects->CommandPool;
+			AllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+			AllocInfo.commandBufferCount = 1;
+			THROW_ON_FAIL_VK(vkAllocateCommandBuffers(VulkanObjects->Device, &AllocInfo, &Cached->CommandBuffer));
+		}
+
+		Reuse = Cached->Recorded &&
+			Cached->Key.Version == Key.Version &&
+			Cached->Key.ScenePipeline == Key.ScenePipeline &&
+			Cached->Key.SceneExtent.width == Key.SceneExtent.width &&
+			Cached->Key.SceneExtent.height == Key.SceneExtent.height &&
+			Cached->Key.CameraVersion == Key.CameraVersion &&
+			Cached->Key.ParticleBuffer == Key.ParticleBuffer;
+
+		Cached->Key = Key;
+		Cached->Recorded = true;
+		CommandBuffer = Cached->CommandBuffer;
+
+		if (Reuse)
+			Cache->ReusedFrames++;
+		else
+			Cache->RecordedFrames++;
+	}
+
+	if (Reuse)
+	{
+#ifdef ENABLE_PROFILING
+		GpuProfilerCollectFrame(&VulkanObjects->GpuProfiler, CurrentFrame);
+#endif
+	}
+	else
+	{
+		PROFILE_ZONE("Record")
+		{
+			vkResetCommandBuffer(CommandBuffer, 0);
+
+			{
+				VkCommandBufferBeginInfo BeginInfo = { 0 };
+				BeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+				THROW_ON_FAIL_VK(vkBeginCommandBuffer(CommandBuffer, &BeginInfo));
+			}
+
+#ifdef ENABLE_PROFILING
+			GpuProfilerBeginFrame(&VulkanObjects->GpuProfiler, CommandBuffer, CurrentFrame);
+#endif
+
+			{
+				RenderGraphSetImage(&VulkanObjects->FrameGraph, VulkanObjects->SwapChainResource, VulkanObjects->SwapChainImages[ImageIndex], VulkanObjects->SwapChainImageViews[ImageIndex]);
+
+				struct FrameContext Frame = { 0 };
+				Frame.FrameIndex = CurrentFrame;
+				Frame.ImageIndex = ImageIndex;
+				Frame.CaptureBuffer = VulkanObjects->Capture.Enabled ? BeginFrameCapture(VulkanObjects) : NULL;
+				CaptureBuffer = Frame.CaptureBuffer;
+				RenderGraphExecute(&VulkanObjects->FrameGraph, CommandBuffer, &Frame);
+			}
+
+			THROW_ON_FAIL_VK(vkEndCommandBuffer(CommandBuffer));
+		}
+	}
+
+	VulkanObjects->SceneTimer.QueryPending[CurrentFrame] = VulkanObjects->SceneTimer.QueryPool != VK_NULL_HANDLE;
+
+	VkSemaphore SignalSemaphores[] = { VulkanObjects->RenderFinishedSemaphores[CurrentFrame], VulkanObjects->GraphicsTimeline.Semaphore };
+
+	PROFILE_ZONE("Submit")
+	{
+		// the particle draw is the only consumer of the simulation, so nothing before the
+		// indirect draw and its vertex fetch waits for it
+		VkSemaphore WaitSemaphores[] = { VulkanObjects->ImageAvailableSemaphores[CurrentFrame], VulkanObjects->Particles.Timeline.Semaphore };
+		VkPipelineStageFlags WaitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT };
+		uint32_t WaitSemaphoreCount = VulkanObjects->Particles.Capacity > 0 ? 2 : 1;
+
+		VulkanObjects->FrameTimelineValues[CurrentFrame] = ++VulkanObjects->GraphicsTimeline.Value;
+
+		// the value paired with the binary semaphore is ignored
+		uint64_t WaitValues[] = { 0, SimulationValue };
+		uint64_t SignalValues[] = { 0, VulkanObjects->FrameTimelineValues[CurrentFrame] };
+
+		VkTimelineSemaphoreSubmitInfo TimelineInfo = { 0 };
+		TimelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+		TimelineInfo.waitSemaphoreValueCount = WaitSemaphoreCount;
+		TimelineInfo.pWaitSemaphoreValues = WaitValues;
+		TimelineInfo.signalSemaphoreValueCount = ARRAYSIZE(SignalValues);
+		TimelineInfo.pSignalSemaphoreValues = SignalValues;
+
+		VkSubmitInfo SubmitInfo = { 0 };
+		SubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		SubmitInfo.pNext = &TimelineInfo;
+		SubmitInfo.waitSemaphoreCount = WaitSemaphoreCount;
+		SubmitInfo.pWaitSemaphores = WaitSemaphores;
+		SubmitInfo.pWaitDstStageMask = WaitStages;
+		SubmitInfo.commandBufferCount = 1;
+		SubmitInfo.pCommandBuffers = &CommandBuffer;
+		SubmitInfo.signalSemaphoreCount = ARRAYSIZE(SignalSemaphores);
+		SubmitInfo.pSignalSemaphores = SignalSemaphores;
+		THROW_ON_FAIL_VK(vkQueueSubmit(VulkanObjects->GraphicsQueue, 1, &SubmitInfo, VK_NULL_HANDLE));
+
+		VulkanObjects->Particles.BufferReleaseValues[VulkanObjects->Particles.DrawBuffer] = VulkanObjects->FrameTimelineValues[CurrentFrame];
+	}
+
+	if (CaptureBuffer != NULL)
+		EndFrameCapture(&VulkanObjects->Capture, VulkanObjects->FrameTimelineValues[CurrentFrame]);
+
+	VkResult PresentResult;
+
+	PROFILE_ZONE("Present")
+	{
+		VkSwapchainKHR SwapChains[] = { VulkanObjects->SwapChain };
+		VkPresentInfoKHR PresentInfo = { 0 };
+		PresentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+		PresentInfo.waitSemaphoreCount = 1;
+		PresentInfo.pWaitSemaphores = &VulkanObjects->RenderFinishedSemaphores[CurrentFrame];
+		PresentInfo.swapchainCount = 1;
+		PresentInfo.pSwapchains = SwapChains;
+		PresentInfo.pImageIndices = &ImageIndex;
+
+		PresentResult = vkQueuePresentKHR(VulkanObjects->PresentQueue, &PresentInfo);
+	}
+
+	PROFILE_FRAME_MARK();
+
+	VulkanObjects->CurrentFrame = (CurrentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+
+	if (PresentResult == VK_ERROR_OUT_OF_DATE_KHR || PresentResult == VK_SUBOPTIMAL_KHR)
+		return true;
+
+	THROW_ON_FAIL_VK(PresentResult);
+
+	return false;
+}
+
+void RecreateSwapChain(struct VulkanObjects* VulkanObjects, uint32_t Width, uint32_t Height)
+{
+	// the graphics timeline would cover the frames, but tearing down the swapchain also
+	// has to wait for the present queue
+	vkDeviceWaitIdle(VulkanObjects->Device);
+
+	VulkanObjects->FrameCache.Version++;
+
+	RenderGraphRelease(&VulkanObjects->FrameGraph, VulkanObjects->Device);
+
+	for (int i = 0; i < VulkanObjects->SwapChainImageCount; i++)
+	{
+		vkDestroyFramebuffer(VulkanObjects->Device, VulkanObjects->SwapChainFramebuffers[i], NULL);
+	}
+
+	for (int i = 0; i < VulkanObjects->SwapChainImageCount; i++)
+	{
+		vkDestroyImageView(VulkanObjects->Device, VulkanObjects->SwapChainImageViews[i], NULL);
+	}
+
+	vkDestroySwapchainKHR(VulkanObjects->Device, VulkanObjects->SwapChain, NULL);
+
+	vkGetPhysicalDeviceSurfaceCapabilitiesKHR(VulkanObjects->PhysicalDevice, VulkanObjects->Surface, &VulkanObjects->SurfaceCapabilities);
+
+	if (VulkanObjects->SurfaceCapabilities.currentExtent.width != UINT32_MAX)
+	{
+		VulkanObjects->SwapChainExtent = VulkanObjects->SurfaceCapabilities.currentExtent;
+	}
+	else
+	{
+		VulkanObjects->SwapChainExtent.width = ClampU32(Width, VulkanObjects->SurfaceCapabilities.minImageExtent.width, VulkanObjects->SurfaceCapabilities.maxImageExtent.width);
+		VulkanObjects->SwapChainExtent.height = ClampU32(Height, VulkanObjects->SurfaceCapabilities.minImageExtent.height, VulkanObjects->SurfaceCapabilities.maxImageExtent.height);
+	}
+
+	{
+		VkSwapchainCreateInfoKHR SwapchainCreateInfo = { 0 };
+		SwapchainCreateInfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
+		SwapchainCreateInfo.surface = VulkanObjects->Surface;
+		SwapchainCreateInfo.minImageCount = VulkanObjects->SwapChainImageCount;
+		SwapchainCreateInfo.imageFormat = VulkanObjects->SwapChainImageFormat.format;
+		SwapchainCreateInfo.imageColorSpace = VulkanObjects->SwapChainImageFormat.colorSpace;
+		SwapchainCreateInfo.imageExtent = VulkanObjects->SwapChainExtent;
+		SwapchainCreateInfo.imageArrayLayers = 1;
+		SwapchainCreateInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | (VulkanObjects->Capture.Enabled ? VK_IMAGE_USAGE_TRANSFER_SRC_BIT : 0) | (VulkanObjects->ViewCount > 1 || VulkanObjects->Resolution.Enabled ? VK_IMAGE_USAGE_TRANSFER_DST_BIT : 0);
+
+		uint32_t QueueFamilyIndicesU32[] = { VulkanObjects->QueueFamilyIndices.GraphicsFamily, VulkanObjects->QueueFamilyIndices.PresentFamily };
+
+		if (VulkanObjects->QueueFamilyIndices.GraphicsFamily != VulkanObjects->QueueFamilyIndices.PresentFamily)
+		{
+			SwapchainCreateInfo.imageSharingMode = VK_SHARING_MODE_CONCURRENT;
+			SwapchainCreateInfo.queueFamilyIndexCount = 2;
+			SwapchainCreateInfo.pQueueFamilyIndices = QueueFamilyIndicesU32;
+		}
+		else
+		{
+			SwapchainCreateInfo.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		}
+
+		SwapchainCreateInfo.preTransform = VulkanObjects->SurfaceCapabilities.currentTransform;
+		SwapchainCreateInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
+		SwapchainCreateInfo.presentMode = VulkanObjects->SwapChainPresentMode;
+		SwapchainCreateInfo.clipped = VK_TRUE;
+
+		THROW_ON_FAIL_VK(vkCreateSwapchainKHR(VulkanObjects->Device, &SwapchainCreateInfo, NULL, &VulkanObjects->SwapChain));
+	}
+
+	vkGetSwapchainImagesKHR(VulkanObjects->Device, VulkanObjects->SwapChain, &VulkanObjects->SwapChainImageCount, NULL);
+	vkGetSwapchainImagesKHR(VulkanObjects->Device, VulkanObjects->SwapChain, &VulkanObjects->SwapChainImageCount, VulkanObjects->SwapChainImages);
+
+	for (int i = 0; i < VulkanObjects->SwapChainImageCount; i++)
+	{
+		VkImageViewCreateInfo ViewInfo = { 0 };
+		ViewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		ViewInfo.image = VulkanObjects->SwapChainImages[i];
+		ViewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+		ViewInfo.format = VulkanObjects->SwapChainImageFormat.format;
+		ViewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		ViewInfo.subresourceRange.baseMipLevel = 0;
+		ViewInfo.subresourceRange.levelCount = 1;
+		ViewInfo.subresourceRange.baseArrayLayer = 0;
+		ViewInfo.subresourceRange.layerCount = 1;
+		THROW_ON_FAIL_VK(vkCreateImageView(VulkanObjects->Device, &ViewInfo, NULL, &VulkanObjects->SwapChainImageViews[i]));
+	}
+	
+	BuildFrameGraph(VulkanObjects);
+	RenderGraphRealize(&VulkanObjects->FrameGraph, VulkanObjects->Device, VulkanObjects->SwapChainExtent);
+
+	for (int i = 0; i < VulkanObjects->SwapChainImageCount && !VulkanObjects->UseDynamicRendering; i++)
+	{
+		VkImageView Attachments[2] = {
+			VulkanObjects->SwapChainImageViews[i],
+			VulkanObjects->FrameGraph.Resources[VulkanObjects->DepthResource].View
+		};
+
+		VkFramebufferCreateInfo FramebufferInfo = { 0 };
+		FramebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+		FramebufferInfo.renderPass = VulkanObjects->RenderPass;
+		FramebufferInfo.attachmentCount = ARRAYSIZE(Attachments);
+		FramebufferInfo.pAttachments = Attachments;
+		FramebufferInfo.width = VulkanObjects->SwapChainExtent.width;
+		FramebufferInfo.height = VulkanObjects->SwapChainExtent.height;
+		FramebufferInfo.layers = 1;
+
+		THROW_ON_FAIL_VK(vkCreateFramebuffer(VulkanObjects->Device, &FramebufferInfo, NULL, &VulkanObjects->SwapChainFramebuffers[i]));
+	}
+}
+
+// total user and kernel time of every thread in the process, in 100ns units
+ULONGLONG GetProcessCpuTime(void)
+{
+	FILETIME CreationTime;
+	FILETIME ExitTime;
+	FILETIME KernelTime;
+	FILETIME UserTime;
+	THROW_ON_FALSE(GetProcessTimes(GetCurrentProcess(), &CreationTime, &ExitTime, &KernelTime, &UserTime));
+
+	ULARGE_INTEGER Kernel = { .LowPart = KernelTime.dwLowDateTime, .HighPart = KernelTime.dwHighDateTime };
+	ULARGE_INTEGER User = { .LowPart = UserTime.dwLowDateTime, .HighPart = UserTime.dwHighDateTime };
+
+	return Kernel.QuadPart + User.QuadPart;
+}
+
+void ReloadShaders(struct VulkanObjects* VulkanObjects);
+VkPipeline PipelineRegistryGet(struct PipelineRegistry* Registry, const struct PipelineState* State);
+
+DWORD WINAPI RenderThreadProc(LPVOID Parameter)
+{
+	struct RenderThreadContext* Context = Parameter;
+	struct VulkanObjects* VulkanObjects = Context->VulkanObjects;
+
+	PROFILE_THREAD_NAME("Render");
+
+	// pipeline compiles are submitted from here while the window thread owns deque 0
+	JobSystemAddThread(VulkanObjects->Pipelines->JobSystem);
+
+	// matches the fixed eye at (2, 2, 2) the scene used before the camera could move
+	struct Camera Camera = { 0 };
+	Camera.Yaw = glm_rad(45.0f);
+	Camera.Pitch = atanf(1.0f / sqrtf(2.0f));
+	Camera.Distance = sqrtf(12.0f);
+
+	LARGE_INTEGER ProcessorFrequency;
+	LARGE_INTEGER LastTickCount;
+	QueryPerformanceFrequency(&ProcessorFrequency);
+	QueryPerformanceCounter(&LastTickCount);
+
+	HANDLE FrameTimer = CreateWaitableTimerExW(NULL, NULL, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+	VALIDATE_HANDLE(FrameTimer);
+
+	HANDLE ShaderChange = NULL;
+
+	if (ShaderDirectory[0] != L'\0')
+	{
+		ShaderChange = FindFirstChangeNotificationW(ShaderDirectory, FALSE, FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME);
+		VALIDATE_HANDLE(ShaderChange);
+	}
+
+	// a shader change wakes the thread like a command does
+	HANDLE WakeHandles[] = { Context->Queue.WakeEvent, ShaderChange };
+	DWORD WakeHandleCount = ShaderChange != NULL ? 2 : 1;
+
+	enum FrameMode FrameMode = Context->FrameMode;
+	LONGLONG FramePeriod = ProcessorFrequency.QuadPart / Context->TargetFps;
+	LONGLONG NextFrameTime = LastTickCount.QuadPart;
+	float AnimationTime = 0.0f;
+
+	struct
+	{
+		LONGLONG StartTime;
+		ULONGLONG StartCpuTime;
+		uint32_t FrameCount;
+		LONG64 CaptureFrames;
+		LONG64 CaptureBytes;
+		uint32_t CaptureDropped;
+		LONGLONG MemoryStartTime;
+	} Stats = { LastTickCount.QuadPart, GetProcessCpuTime(), 0 };
+
+	Stats.MemoryStartTime = LastTickCount.QuadPart;
+
+	// the registry wakes the thread when a variant finishes compiling, so on-demand mode
+	// redraws with it instead of keeping the fallback on screen
+	VulkanObjects->Pipelines->WakeEvent = Context->Queue.WakeEvent;
+	LONG PipelinesCompleted = ReadAcquire(&VulkanObjects->Pipelines->Completed);
+	uint32_t Material = 0;
+
+	bool FullScreen = false;
+	bool Minimized = true;
+	bool SwapChainDirty = false;
+	bool Redraw = true;
+	uint32_t Width = 0;
+	uint32_t Height = 0;
+
+	for (;;)
+	{
+		bool Quit = false;
+		struct RenderCommand Command;
+
+		while (RenderCommandQueuePop(&Context->Queue, &Command))
+		{
+			switch (Command.Type)
+			{
+			case RENDER_COMMAND_RESIZE:
+				// only the newest size is kept, so dragging the window border recreates the
+				// swapchain at most once per frame
+				Width = Command.Resize.Width;
+				Height = Command.Resize.Height;
+				Minimized = Width == 0 || Height == 0;
+
+				if (Width != VulkanObjects->SwapChainExtent.width || Height != VulkanObjects->SwapChainExtent.height)
+					SwapChainDirty = true;
+
+				Redraw = true;
+				break;
+			case RENDER_COMMAND_REDRAW:
+				Redraw = true;
+				break;
+			case RENDER_COMMAND_CYCLE_FRAME_MODE:
+				FrameMode = (FrameMode + 1) % FRAME_MODE_COUNT;
+				LogMessage("frame mode: %s\n", FRAME_MODE_NAMES[FrameMode]);
+				Redraw = true;
+
+				// the time spent in the old mode, idle or paused, doesn't reach the animation
+				QueryPerformanceCounter(&LastTickCount);
+				NextFrameTime = LastTickCount.QuadPart;
+				break;
+			case RENDER_COMMAND_CYCLE_MATERIAL:
+				Material = (Material + 1) % ARRAYSIZE(SCENE_MATERIALS);
+				LogMessage("material: %s\n", SCENE_MATERIALS[Material].Name);
+				Redraw = true;
+				break;
+			case RENDER_COMMAND_TOGGLE_FULLSCREEN:
+				FullScreen = !FullScreen;
+
+				// window styles belong to the thread that owns the window
+				THROW_ON_FALSE(PostMessageW(Context->Window, WM_APPLY_FULLSCREEN, FullScreen, 0));
+				break;
+			case RENDER_COMMAND_QUIT:
+				Quit = true;
+				break;
+			}
+		}
+
+		if (Quit)
+			break;
+
+		{
+			LONG OrbitX = InterlockedExchange(&Context->Queue.OrbitX, 0);
+			LONG OrbitY = InterlockedExchange(&Context->Queue.OrbitY, 0);
+			LONG Zoom = InterlockedExchange(&Context->Queue.Zoom, 0);
+
+			if (OrbitX != 0 || OrbitY != 0)
+			{
+				Camera.Yaw -= OrbitX * 0.01f;
+				Camera.Pitch = glm_clamp(Camera.Pitch + OrbitY * 0.01f, -glm_rad(89.0f), glm_rad(89.0f));
+				Redraw = true;
+			}
+
+			if (Zoom != 0)
+			{
+				Camera.Distance = glm_clamp(Camera.Distance * powf(0.9f, Zoom / (float)WHEEL_DELTA), 1.5f, 8.0f);
+				Redraw = true;
+			}
+		}
+
+		{
+			LONG Completed = ReadAcquire(&VulkanObjects->Pipelines->Completed);
+
+			if (Completed != PipelinesCompleted)
+			{
+				PipelinesCompleted = Completed;
+				Redraw = true;
+			}
+		}
+
+		if (ShaderChange != NULL && WaitForSingleObject(ShaderChange, 0) == WAIT_OBJECT_0)
+		{
+			// the compiler writes one file after another; reload once the directory settles
+			do
+			{
+				THROW_ON_FALSE(FindNextChangeNotification(ShaderChange));
+			} while (WaitForSingleObject(ShaderChange, 100) == WAIT_OBJECT_0);
+
+			PROFILE_ZONE("ReloadShaders")
+			{
+				ReloadShaders(VulkanObjects);
+			}
+
+			Redraw = true;
+		}
+
+		LARGE_INTEGER TickCountNow;
+		QueryPerformanceCounter(&TickCountNow);
+
+		if (TickCountNow.QuadPart - Stats.StartTime >= ProcessorFrequency.QuadPart * FRAME_STATS_INTERVAL_MS / 1000)
+		{
+			ULONGLONG CpuTime = GetProcessCpuTime();
+
+			double Seconds = (TickCountNow.QuadPart - Stats.StartTime) / (double)ProcessorFrequency.QuadPart;
+			double CpuPercent = (CpuTime - Stats.StartCpuTime) / (Seconds * 10000000.0) * 100.0;
+
+			LogMessage("%s: %.1f fps, cpu %.1f%% of one core\n", FRAME_MODE_NAMES[FrameMode], Stats.FrameCount / Seconds, CpuPercent);
+
+			struct ParticleSystem* Particles = &VulkanObjects->Particles;
+
+			if (Particles->SimulationSamples > 0)
+			{
+				LogMessage("particles: %u, simulation %.3f ms on the gpu\n", Particles->Capacity, Particles->SimulationMilliseconds / Particles->SimulationSamples);
+				Particles->SimulationMilliseconds = 0.0;
+				Particles->SimulationSamples = 0;
+			}
+
+			struct SceneTimer* SceneTimer = &VulkanObjects->SceneTimer;
+
+			if (SceneTimer->Samples > 0)
+			{
+				LogMessage("scene: %u view%s (%s), %.3f ms on the gpu\n", VulkanObjects->ViewCount, VulkanObjects->ViewCount > 1 ? "s" : "",
+					VulkanObjects->ViewCount > 1 ? VIEW_MODE_NAMES[VulkanObjects->ViewMode] : "single pass", SceneTimer->Milliseconds / SceneTimer->Samples);
+				SceneTimer->Milliseconds = 0.0;
+				SceneTimer->Samples = 0;
+			}
+
+			struct FrameCache* FrameCache = &VulkanObjects->FrameCache;
+
+			if (FrameCache->Enabled && FrameCache->RecordedFrames + FrameCache->ReusedFrames > 0)
+			{
+				LogMessage("frame cache: %u recorded, %u reused\n", FrameCache->RecordedFrames, FrameCache->ReusedFrames);
+				FrameCache->RecordedFrames = 0;
+				FrameCache->ReusedFrames = 0;
+			}
+
+			struct SceneGraph* Scene = &VulkanObjects->Scene;
+
+			if (Scene->Samples > 0)
+			{
+				LogMessage("scene graph: %u nodes, %.3f ms updating, %.1f KB uploaded per frame\n", Scene->Count, Scene->UpdateMilliseconds / Scene->Samples, Scene->UploadedBytes / (Scene->Samples * 1024.0));
+				Scene->UpdateMilliseconds = 0.0;
+				Scene->UploadedBytes = 0;
+				Scene->Samples = 0;
+			}
+
+			if (VulkanObjects->Resolution.Enabled)
+			{
+				VkExtent2D SceneExtent = GetSceneExtent(VulkanObjects);
+				LogMessage("resolution: %.0f%% (%ux%u), budget %.2f ms\n", VulkanObjects->Resolution.Scale * 100.0f, SceneExtent.width, SceneExtent.height, VulkanObjects->Resolution.BudgetMilliseconds);
+			}
+
+			struct FrameCapture* Capture = &VulkanObjects->Capture;
+
+			if (Capture->Enabled)
+			{
+				LONG64 CaptureFrames = ReadAcquire64(&Capture->FramesWritten);
+				LONG64 CaptureBytes = ReadAcquire64(&Capture->BytesWritten);
+
+				LogMessage("capture: %.1f fps written, %.1f MB/s, %u dropped\n", (CaptureFrames - Stats.CaptureFrames) / Seconds, (CaptureBytes - Stats.CaptureBytes) / (Seconds * 1024.0 * 1024.0), Capture->FramesDropped - Stats.CaptureDropped);
+
+				Stats.CaptureFrames = CaptureFrames;
+				Stats.CaptureBytes = CaptureBytes;
+				Stats.CaptureDropped = Capture->FramesDropped;
+			}
+
+			Stats.StartTime = TickCountNow.QuadPart;
+			Stats.StartCpuTime = CpuTime;
+			Stats.FrameCount = 0;
+		}
+
+		// less often than the frame stats: the numbers only move on startup and resize
+		if (TickCountNow.QuadPart - Stats.MemoryStartTime >= ProcessorFrequency.QuadPart * MEMORY_STATS_INTERVAL_MS / 1000)
+		{
+			LogMemoryReport();
+			Stats.MemoryStartTime = TickCountNow.QuadPart;
+		}
+
+		if (Minimized)
+		{
+			// a zero sized surface cannot be presented to; sleep until the window thread sends something
+			WaitForSingleObject(Context->Queue.WakeEvent, INFINITE);
+
+			// the animation picks up where it stopped instead of jumping over the idle time
+			QueryPerformanceCounter(&LastTickCount);
+			NextFrameTime = LastTickCount.QuadPart;
+			continue;
+		}
+
+		if (FrameMode == FRAME_MODE_ON_DEMAND && !Redraw && !SwapChainDirty)
+		{
+			// the image on screen is still correct. the timeout only keeps the stats line coming
+			WaitForMultipleObjects(WakeHandleCount, WakeHandles, FALSE, FRAME_STATS_INTERVAL_MS);
+
+			QueryPerformanceCounter(&LastTickCount);
+			NextFrameTime = LastTickCount.QuadPart;
+			continue;
+		}
+
+		if (FrameMode == FRAME_MODE_THROTTLED && TickCountNow.QuadPart < NextFrameTime)
+		{
+			// negative due times are relative, in 100ns units
+			LARGE_INTEGER DueTime;
+			DueTime.QuadPart = -(NextFrameTime - TickCountNow.QuadPart) * 10000000 / ProcessorFrequency.QuadPart;
+			THROW_ON_FALSE(SetWaitableTimer(FrameTimer, &DueTime, 0, NULL, NULL, FALSE));
+
+			// commands still wake the thread early so they are drained before the frame starts
+			HANDLE WaitHandles[] = { FrameTimer, Context->Queue.WakeEvent, ShaderChange };
+			WaitForMultipleObjects(WakeHandleCount + 1, WaitHandles, FALSE, INFINITE);
+			continue;
+		}
+
+		if (FrameMode != FRAME_MODE_ON_DEMAND)
+			AnimationTime += (TickCountNow.QuadPart - LastTickCount.QuadPart) / ((float)ProcessorFrequency.QuadPart);
+
+		LastTickCount = TickCountNow;
+
+		// a frame that ran late starts a new cadence instead of trying to catch up
+		if (TickCountNow.QuadPart - NextFrameTime >= FramePeriod)
+			NextFrameTime = TickCountNow.QuadPart + FramePeriod;
+		else
+			NextFrameTime += FramePeriod;
+
+		if (SwapChainDirty)
+		{
+			PROFILE_ZONE("RecreateSwapChain")
+			{
+				RecreateSwapChain(VulkanObjects, Width, Height);
+			}
+
+			SwapChainDirty = false;
+		}
+
+		struct PipelineState MaterialState = GetSceneMaterialState(VulkanObjects, Material);
+		VulkanObjects->ScenePipeline = PipelineRegistryGet(VulkanObjects->Pipelines, &MaterialState);
+
+		SwapChainDirty = DrawFrame(VulkanObjects, &Camera, AnimationTime);
+		Redraw = false;
+
+		if (Context->StartupTime != 0)
+		{
+			// measured up to the submission of the first frame, which is what startup controls
+			QueryPerformanceCounter(&TickCountNow);
+			LogMessage("time to first frame: %.1f ms (%u startup threads)\n", (TickCountNow.QuadPart - Context->StartupTime) * 1000.0 / ProcessorFrequency.QuadPart, Context->StartupThreadCount);
+			Context->StartupTime = 0;
+		}
+
+		Stats.FrameCount++;
+	}
+
+	// a full ring would otherwise keep the window thread waiting for a slot forever
+	WriteRelease(&Context->Queue.Closed, 1);
+
+	// the wake event is closed once this thread has exited, so no compile may still signal it
+	JobSystemWait(VulkanObjects->Pipelines->JobSystem, &VulkanObjects->Pipelines->Pending);
+	VulkanObjects->Pipelines->WakeEvent = NULL;
+
+	if (ShaderChange != NULL)
+		THROW_ON_FALSE(FindCloseChangeNotification(ShaderChange));
+
+	THROW_ON_FALSE(CloseHandle(FrameTimer));
+
+	// the window is destroyed only now, so it outlives the last present
+	THROW_ON_FALSE(PostMessageW(Context->Window, WM_RENDER_THREAD_EXITED, 0, 0));
+
+	return 0;
+}
+
+#define DISPATCH_BENCHMARK_RUNS 5
+
+// returns the time per draw in nanoseconds
+static double RecordBenchmarkDraws(const struct VulkanObjects* VulkanObjects, VkCommandBuffer CommandBuffer, const VkCommandBufferInheritanceInfo* Inheritance, PFN_vkCmdDrawIndexed DrawIndexed, uint32_t DrawCount)
+{
+	THROW_ON_FAIL_VK(vkResetCommandBuffer(CommandBuffer, 0));
+
+	VkCommandBufferBeginInfo BeginInfo = { 0 };
+	BeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	BeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+	BeginInfo.pInheritanceInfo = Inheritance;
+	THROW_ON_FAIL_VK(vkBeginCommandBuffer(CommandBuffer, &BeginInfo));
+
+	vkCmdBindPipeline(CommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, VulkanObjects->GraphicsPipeline);
+
+	VkViewport Viewport = { 0.0f, 0.0f, 64.0f, 64.0f, 0.0f, 1.0f };
+	vkCmdSetViewport(CommandBuffer, 0, 1, &Viewport);
+
+	VkRect2D Scissor = { {0, 0}, {64, 64} };
+	vkCmdSetScissor(CommandBuffer, 0, 1, &Scissor);
+
+	VkDeviceSize Offset = 0;
+	vkCmdBindVertexBuffers(CommandBuffer, 0, 1, &VulkanObjects->VertexBuffer, &Offset);
+	vkCmdBindIndexBuffer(CommandBuffer, VulkanObjects->IndexBuffer, 0, VK_INDEX_TYPE_UINT16);
+	vkCmdBindDescriptorSets(CommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, VulkanObjects->PipelineLayout, 0, 1, &VulkanObjects->DescriptorSets[0], 0, NULL);
+
+	uint32_t FirstView = 0;
+	vkCmdPushConstants(CommandBuffer, VulkanObjects->PipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(FirstView), &FirstView);
+
+	LARGE_INTEGER Start;
+	QueryPerformanceCounter(&Start);
+
+	for (uint32_t i = 0; i < DrawCount; i++)
+	{
+		DrawIndexed(CommandBuffer, ARRAYSIZE(Indices), 1, 0, 0, 0);
+	}
+
+	LARGE_INTEGER End;
+	QueryPerformanceCounter(&End);
+
+	THROW_ON_FAIL_VK(vkEndCommandBuffer(CommandBuffer));
+
+	LARGE_INTEGER Frequency;
+	QueryPerformanceFrequency(&Frequency);
+
+	return (End.QuadPart - Start.QuadPart) * 1000000000.0 / Frequency.QuadPart / DrawCount;
+}
+
+/*
+* records the same draws through the device dispatch table and through the trampoline
+* vulkan-1.dll exports, which is where a call linked against the import library lands.
+* the draws go into a secondary command buffer that inherits the scene's attachment
+* formats, so no images are needed and nothing is submitted. the best of a few runs of
+* each is logged, alternating so both see the same clocks and caches
+*/
+void RunDispatchBenchmark(const struct VulkanObjects* VulkanObjects, uint32_t DrawCount)
+{
+	PFN_vkCmdDrawIndexed LoaderDrawIndexed = (PFN_vkCmdDrawIndexed)GetProcAddress(VulkanLibrary, "vkCmdDrawIndexed");
+
+	if (LoaderDrawIndexed == NULL)
+		FailFastWithMessage("vulkan-1.dll does not export vkCmdDrawIndexed\n");
+
+	VkCommandPool CommandPool;
+
+	{
+		VkCommandPoolCreateInfo PoolInfo = { 0 };
+		PoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		PoolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+		PoolInfo.queueFamilyIndex = VulkanObjects->QueueFamilyIndices.GraphicsFamily;
+		THROW_ON_FAIL_VK(vkCreateCommandPool(VulkanObjects->Device, &PoolInfo, NULL, &CommandPool));
+	}
+
+	VkCommandBuffer CommandBuffer;
+
+	{
+		VkCommandBufferAllocateInfo AllocInfo = { 0 };
+		AllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		AllocInfo.commandPool = CommandPool;
+		AllocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+		AllocInfo.commandBufferCount = 1;
+		THROW_ON_FAIL_VK(vkAllocateCommandBuffers(VulkanObjects->Device, &AllocInfo, &CommandBuffer));
+	}
+
+	VkCommandBufferInheritanceRenderingInfo RenderingInheritance = { 0 };
+	RenderingInheritance.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO;
+	RenderingInheritance.viewMask = GetSceneViewMask(VulkanObjects);
+	RenderingInheritance.colorAttachmentCount = 1;
+	RenderingInheritance.pColorAttachmentFormats = &VulkanObjects->SwapChainImageFormat.format;
+	RenderingInheritance.depthAttachmentFormat = VulkanObjects->DepthFormat;
+	RenderingInheritance.stencilAttachmentFormat = VK_FORMAT_UNDEFINED;
+	RenderingInheritance.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+	VkCommandBufferInheritanceInfo Inheritance = { 0 };
+	Inheritance.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+	Inheritance.pNext = VulkanObjects->UseDynamicRendering ? &RenderingInheritance : NULL;
+	Inheritance.renderPass = VulkanObjects->UseDynamicRendering ? VK_NULL_HANDLE : VulkanObjects->RenderPass;
+	Inheritance.subpass = 0;
+	Inheritance.framebuffer = VK_NULL_HANDLE;
+
+	double TableNanoseconds = DBL_MAX;
+	double LoaderNanoseconds = DBL_MAX;
+
+	for (uint32_t Run = 0; Run < DISPATCH_BENCHMARK_RUNS; Run++)
+	{
+		TableNanoseconds = min(TableNanoseconds, RecordBenchmarkDraws(VulkanObjects, CommandBuffer, &Inheritance, vkCmdDrawIndexed, DrawCount));
+		LoaderNanoseconds = min(LoaderNanoseconds, RecordBenchmarkDraws(VulkanObjects, CommandBuffer, &Inheritance, LoaderDrawIndexed, DrawCount));
+	}
+
+	LogMessage("dispatch benchmark: %u draws, %.2f ns/draw through the device table, %.2f ns/draw through the loader (%.1f%% saved)\n",
+		DrawCount, TableNanoseconds, LoaderNanoseconds, (1.0 - TableNanoseconds / LoaderNanoseconds) * 100.0);
+
+	vkDestroyCommandPool(VulkanObjects->Device, CommandPool, NULL);
+}
+
+/*
+* --frame-mode=continuous|throttled|on-demand
+* --target-fps=N (implies throttled unless a frame mode is given)
+* --device=index|vendor:device|name (overrides MINIMALVULKAN_DEVICE)
+* --particles=N (0 turns the simulation off)
+* --scene-nodes=N (adds N static scene graph nodes in hierarchies of their own, for timing the scene update)
+* --shader-dir=PATH (loads .spv files from PATH and reloads them when they change)
+* --capture=PATH|- (streams every frame to a file or stdout)
+* --capture-format=raw|qoi
+* --views=N (1 to 4 cameras, tiled on the window)
+* --view-mode=multiview|sequential
+* --resolution-budget=MS (scales the scene resolution to keep its GPU time under MS)
+* --cache-frames (records each frame's commands once and submits them again while nothing changes)
+* --dispatch-benchmark=N (times N draws through the dispatch table and the loader at startup)
+* --draw-benchmark=N (records and submits N draws per state change pattern without a window, then exits)
+* --asset-pack=PATH (loads shaders, meshes and the texture from a pack)
+* --pack-assets=PATH (writes every asset into a pack, then exits)
+* --pack-compression=none|lz4
+* --asset-benchmark=N (loads the shaders N times from loose files and from the pack, then exits)
+*/
+void ParseCommandLine(int argc, char** argv, struct LaunchOptions* Options)
+{
+	// stdout carries the frames, so nothing else may be written to it, including what the
+	// loop below logs about the arguments before it reaches this one
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--capture=-") == 0)
+		{
+			LogHandle = GetStdHandle(STD_ERROR_HANDLE);
+			VALIDATE_HANDLE(LogHandle);
+		}
+	}
+
+	Options->FrameMode = FRAME_MODE_CONTINUOUS;
+	Options->TargetFps = 60;
+	Options->ParticleCount = PARTICLE_DEFAULT_CAPACITY;
+	Options->SceneNodes = 0;
+	Options->ViewCount = 1;
+	Options->ViewMode = VIEW_MODE_MULTIVIEW;
+	Options->ResolutionBudget = 0.0f;
+	Options->CacheFrames = false;
+	Options->VertexPulling = false;
+	Options->DispatchBenchmarkDraws = 0;
+	Options->DrawBenchmarkDraws = 0;
+
+	DWORD SelectorLength = GetEnvironmentVariableA("MINIMALVULKAN_DEVICE", Options->DeviceSelector, sizeof(Options->DeviceSelector));
+
+	if (SelectorLength >= sizeof(Options->DeviceSelector))
+		FailFastWithMessage("MINIMALVULKAN_DEVICE is too long\n");
+
+	Options->DeviceSelector[SelectorLength] = '\0';
+	Options->ShaderDirectory[0] = '\0';
+	Options->AssetPackPath[0] = '\0';
+	Options->PackAssetsPath[0] = '\0';
+	Options->PackCompression = false;
+	Options->AssetBenchmarkIterations = 0;
+	Options->CapturePath[0] = '\0';
+	Options->CaptureFormat = CAPTURE_FORMAT_RAW;
+
+	bool FrameModeGiven = false;
+
+	for (int i = 1; i < argc; i++)
+	{
+		const char* Argument = argv[i];
+
+		if (strncmp(Argument, "--frame-mode=", strlen("--frame-mode=")) == 0)
+		{
+			const char* Value = Argument + strlen("--frame-mode=");
+
+			bool Found = false;
+
+			for (int Mode = 0; Mode < FRAME_MODE_COUNT; Mode++)
+			{
+				if (strcmp(Value, FRAME_MODE_NAMES[Mode]) == 0)
+				{
+					Options->FrameMode = Mode;
+					Found = true;
+				}
+			}
+
+			if (!Found)
+				FailFastWithMessage("--frame-mode must be continuous, throttled or on-demand\n");
+
+			FrameModeGiven = true;
+		}
+		else if (strncmp(Argument, "--target-fps=", strlen("--target-fps=")) == 0)
+		{
+			Options->TargetFps = strtoul(Argument + strlen("--target-fps="), NULL, 10);
+
+			if (Options->TargetFps == 0)
+				FailFastWithMessage("--target-fps must be a positive number\n");
+
+			if (!FrameModeGiven)
+				Options->FrameMode = FRAME_MODE_THROTTLED;
+		}
+		else if (strncmp(Argument, "--device=", strlen("--device=")) == 0)
+		{
+			strncpy_s(Options->DeviceSelector, sizeof(Options->DeviceSelector), Argument + strlen("--device="), _TRUNCATE);
+		}
+		else if (strncmp(Argument, "--capture=", strlen("--capture=")) == 0)
+		{
+			strncpy_s(Options->CapturePath, sizeof(Options->CapturePath), Argument + strlen("--capture="), _TRUNCATE);
+		}
+		else if (strncmp(Argument, "--capture-format=", strlen("--capture-format=")) == 0)
+		{
+			const char* Value = Argument + strlen("--capture-format=");
+
+			bool Found = false;
+
+			for (int Format = 0; Format < CAPTURE_FORMAT_COUNT; Format++)
+			{
+				if (strcmp(Value, CAPTURE_FORMAT_NAMES[Format]) == 0)
+				{
+					Options->CaptureFormat = Format;
+					Found = true;
+				}
+			}
+
+			if (!Found)
+				FailFastWithMessage("--capture-format must be raw or qoi\n");
+		}
+		else if (strncmp(Argument, "--views=", strlen("--views=")) == 0)
+		{
+			Options->ViewCount = strtoul(Argument + strlen("--views="), NULL, 10);
+
+			if (Options->ViewCount == 0 || Options->ViewCount > MAX_VIEWS)
+				FailFastWithMessage("--views must be between 1 and 4\n");
+		}
+		else if (strncmp(Argument, "--view-mode=", strlen("--view-mode=")) == 0)
+		{
+			const char* Value = Argument + strlen("--view-mode=");
+
+			bool Found = false;
+
+			for (int Mode = 0; Mode < VIEW_MODE_COUNT; Mode++)
+			{
+				if (strcmp(Value, VIEW_MODE_NAMES[Mode]) == 0)
+				{
+					Options->ViewMode = Mode;
+					Found = true;
+				}
+			}
+
+			if (!Found)
+				FailFastWithMessage("--view-mode must be multiview or sequential\n");
+		}
+		else if (strncmp(Argument, "--resolution-budget=", strlen("--resolution-budget=")) == 0)
+		{
+			Options->ResolutionBudget = strtof(Argument + strlen("--resolution-budget="), NULL);
+
+			if (!(Options->ResolutionBudget > 0.0f))
+				FailFastWithMessage("--resolution-budget must be a positive number of milliseconds\n");
+		}
+		else if (strcmp(Argument, "--cache-frames") == 0)
+		{
+			Options->CacheFrames = true;
+		}
+		else if (strcmp(Argument, "--vertex-pulling") == 0)
+		{
+			Options->VertexPulling = true;
+		}
+		else if (strncmp(Argument, "--dispatch-benchmark=", strlen("--dispatch-benchmark=")) == 0)
+		{
+			Options->DispatchBenchmarkDraws = strtoul(Argument + strlen("--dispatch-benchmark="), NULL, 10);
+
+			if (Options->DispatchBenchmarkDraws == 0)
+				FailFastWithMessage("--dispatch-benchmark must be a positive number of draws\n");
+		}
+		else if (strncmp(Argument, "--draw-benchmark=", strlen("--draw-benchmark=")) == 0)
+		{
+			Options->DrawBenchmarkDraws = strtoul(Argument + strlen("--draw-benchmark="), NULL, 10);
+
+			if (Options->DrawBenchmarkDraws == 0)
+				FailFastWithMessage("--draw-benchmark must be a positive number of draws\n");
+		}
+		else if (strncmp(Argument, "--shader-dir=", strlen("--shader-dir=")) == 0)
+		{
+			strncpy_s(Options->ShaderDirectory, sizeof(Options->ShaderDirectory), Argument + strlen("--shader-dir="), _TRUNCATE);
+		}
+		else if (strncmp(Argument, "--asset-pack=", strlen("--asset-pack=")) == 0)
+		{
+			strncpy_s(Options->AssetPackPath, sizeof(Options->AssetPackPath), Argument + strlen("--asset-pack="), _TRUNCATE);
+		}
+		else if (strncmp(Argument, "--pack-assets=", strlen("--pack-assets=")) == 0)
+		{
+			strncpy_s(Options->PackAssetsPath, sizeof(Options->PackAssetsPath), Argument + strlen("--pack-assets="), _TRUNCATE);
+		}
+		else if (strncmp(Argument, "--pack-compression=", strlen("--pack-compression=")) == 0)
+		{
+			const char* Value = Argument + strlen("--pack-compression=");
+
+			if (strcmp(Value, "lz4") == 0)
+				Options->PackCompression = true;
+			else if (strcmp(Value, "none") == 0)
+				Options->PackCompression = false;
+			else
+				FailFastWithMessage("--pack-compression must be none or lz4\n");
+		}
+		else if (strncmp(Argument, "--asset-benchmark=", strlen("--asset-benchmark=")) == 0)
+		{
+			Options->AssetBenchmarkIterations = strtoul(Argument + strlen("--asset-benchmark="), NULL, 10);
+
+			if (Options->AssetBenchmarkIterations == 0)
+				FailFastWithMessage("--asset-benchmark must be a positive number of iterations\n");
+		}
+		else if (strncmp(Argument, "--particles=", strlen("--particles=")) == 0)
+		{
+			uint32_t ParticleCount = strtoul(Argument + strlen("--particles="), NULL, 10);
+
+			if (ParticleCount > 16 * 1024 * 1024)
+				FailFastWithMessage("--particles must be at most 16777216\n");
+
+			// whole workgroups, so the dispatches need no bounds against the capacity
+			Options->ParticleCount = (ParticleCount + PARTICLE_GROUP_SIZE - 1) / PARTICLE_GROUP_SIZE * PARTICLE_GROUP_SIZE;
+		}
+		else if (strncmp(Argument, "--scene-nodes=", strlen("--scene-nodes=")) == 0)
+		{
+			uint32_t SceneNodes = strtoul(Argument + strlen("--scene-nodes="), NULL, 10);
+
+			if (SceneNodes > 2000000)
+				FailFastWithMessage("--scene-nodes must be at most 2000000\n");
+
+			// whole hierarchies, each a root with two levels of children
+			Options->SceneNodes = (SceneNodes + SCENE_STRESS_NODES_PER_ROOT - 1) / SCENE_STRESS_NODES_PER_ROOT * SCENE_STRESS_NODES_PER_ROOT;
+		}
+		else
+		{
+			LogMessage("ignoring unknown argument: %s\n", Argument);
+		}
+	}
+}
+
+struct StartupContext
+{
+	struct VulkanObjects* VulkanObjects;
+
+	VkDescriptorSetLayout DescriptorSetLayout;
+
+	VkShaderModule VertexShaderModule;
+	VkShaderModule FragmentShaderModule;
+
+	VkImage TextureImage;
+	VkDeviceMemory TextureImageMemory;
+	VkImageView TextureImageView;
+	VkSampler TextureSampler;
+
+	VkBuffer TextureStagingBuffer;
+	VkDeviceMemory TextureStagingBufferMemory;
+	VkBuffer VertexStagingBuffer;
+	VkDeviceMemory VertexStagingBufferMemory;
+	VkBuffer IndexStagingBuffer;
+	VkDeviceMemory IndexStagingBufferMemory;
+
+	VkBuffer UniformBuffers[MAX_FRAMES_IN_FLIGHT];
+	VkDeviceMemory UniformBuffersMemory[MAX_FRAMES_IN_FLIGHT];
+	VkBuffer InstanceBuffers[MAX_FRAMES_IN_FLIGHT];
+	VkDeviceMemory InstanceBuffersMemory[MAX_FRAMES_IN_FLIGHT];
+
+	VkDescriptorPool DescriptorPool;
+};
+
+/*
+* LZ4 block format: each sequence is a token, literals, then a match of at least four bytes
+* given as a 16 bit offset back into the output. the last five bytes are always literals
+*/
+#define LZ4_HASH_BITS 12
+#define LZ4_MIN_MATCH 4
+#define LZ4_LAST_LITERALS 5
+#define LZ4_MATCH_SAFE_DISTANCE 12
+
+static uint8_t* Lz4WriteLength(uint8_t* Output, size_t Length)
+{
+	if (Length < 15)
+		return Output;
+
+	Length -= 15;
+
+	while (Length >= 255)
+	{
+		*Output++ = 255;
+		Length -= 255;
+	}
+
+	*Output++ = (uint8_t)Length;
+	return Output;
+}
+
+/*
+* greedy, with one candidate per hash. returns 0 when the result would not fit in Capacity,
+* so passing the source size as the capacity only keeps data that got smaller
+*/
+size_t Lz4Compress(const uint8_t* Source, size_t SourceSize, uint8_t* Destination, size_t Capacity)
+{
+	uint32_t Table[1 << LZ4_HASH_BITS] = { 0 };
+
+	uint8_t* Output = Destination;
+	uint8_t* OutputEnd = Destination + Capacity;
+
+	size_t Anchor = 0;
+	size_t Position = 0;
+	size_t MatchLimit = SourceSize > LZ4_MATCH_SAFE_DISTANCE ? SourceSize - LZ4_MATCH_SAFE_DISTANCE : 0;
+
+	while (Position < MatchLimit)
+	{
+		uint32_t Sequence;
+		memcpy(&Sequence, Source + Position, sizeof(Sequence));
+
+		uint32_t Hash = (Sequence * 2654435761u) >> (32 - LZ4_HASH_BITS);
+		size_t Candidate = Table[Hash];
+		Table[Hash] = (uint32_t)Position;
+
+		uint32_t CandidateSequence;
+		memcpy(&CandidateSequence, Source + Candidate, sizeof(CandidateSequence));
+
+		if (Candidate >= Position || Position - Candidate > UINT16_MAX || CandidateSequence != Sequence)
+		{
+			Position++;
+			continue;
+		}
+
+		size_t MatchEnd = Position + LZ4_MIN_MATCH;
+
+		while (MatchEnd < SourceSize - LZ4_LAST_LITERALS && Source[MatchEnd] == Source[Candidate + MatchEnd - Position])
+		{
+			MatchEnd++;
+		}
+
+		size_t LiteralLength = Position - Anchor;
+		size_t MatchLength = MatchEnd - Position - LZ4_MIN_MATCH;
+
+		if ((size_t)(OutputEnd - Output) < 1 + LiteralLength / 255 + 1 + LiteralLength + 2 + MatchLength / 255 + 1)
+			return 0;
+
+		*Output++ = (uint8_t)(min(LiteralLength, 15) << 4 | min(MatchLength, 15));
+		Output = Lz4WriteLength(Output, LiteralLength);
+		memcpy(Output, Source + Anchor, LiteralLength);
+		Output += LiteralLength;
+
+		size_t Offset = Position - Candidate;
+		*Output++ = (uint8_t)(Offset & 0xFF);
+		*Output++ = (uint8_t)(Offset >> 8);
+		Output = Lz4WriteLength(Output, MatchLength);
+
+		Position = MatchEnd;
+		Anchor = MatchEnd;
+	}
+
+	size_t LiteralLength = SourceSize - Anchor;
+
+	if ((size_t)(OutputEnd - Output) < 1 + LiteralLength / 255 + 1 + LiteralLength)
+		return 0;
+
+	*Output++ = (uint8_t)(min(LiteralLength, 15) << 4);
+	Output = Lz4WriteLength(Output, LiteralLength);
+	memcpy(Output, Source + Anchor, LiteralLength);
+	Output += LiteralLength;
+
+	return Output - Destination;
+}
+
+static size_t Lz4ReadLength(const uint8_t** Input, const uint8_t* InputEnd)
+{
+	size_t Length = 0;
+	uint8_t Byte;
+
+	do
+	{
+		if (*Input == InputEnd)
+			FailFastWithMessage("truncated LZ4 block\n");
+
+		Byte = *(*Input)++;
+		Length += Byte;
+	} while (Byte == 255);
+
+	return Length;
+}
+
+// the block has to decompress to exactly DestinationSize bytes
+void Lz4Decompress(const uint8_t* Source, size_t SourceSize, uint8_t* Destination, size_t DestinationSize)
+{
+	const uint8_t* Input = Source;
+	const uint8_t* InputEnd = Source + SourceSize;
+	uint8_t* Output = Destination;
+	uint8_t* OutputEnd = Destination + DestinationSize;
+
+	for (;;)
+	{
+		if (Input == InputEnd)
+			FailFastWithMessage("truncated LZ4 block\n");
+
+		uint8_t Token = *Input++;
+
+		size_t LiteralLength = Token >> 4;
+
+		if (LiteralLength == 15)
+			LiteralLength += Lz4ReadLength(&Input, InputEnd);
+
+		if (LiteralLength > (size_t)(InputEnd - Input) || LiteralLength > (size_t)(OutputEnd - Output))
+			FailFastWithMessage("corrupt LZ4 block\n");
+
+		memcpy(Output, Input, LiteralLength);
+		Input += LiteralLength;
+		Output += LiteralLength;
+
+		// the last sequence has no match
+		if (Input == InputEnd)
+			break;
+
+		if (InputEnd - Input < 2)
+			FailFastWithMessage("truncated LZ4 block\n");
+
+		size_t Offset = Input[0] | Input[1] << 8;
+		Input += 2;
+
+		size_t MatchLength = (Token & 15) + LZ4_MIN_MATCH;
+
+		if ((Token & 15) == 15)
+			MatchLength += Lz4ReadLength(&Input, InputEnd);
+
+		if (Offset == 0 || Offset > (size_t)(Output - Destination) || MatchLength > (size_t)(OutputEnd - Output))
+			FailFastWithMessage("corrupt LZ4 block\n");
+
+		// a match may overlap the bytes it produces, so it is copied one byte at a time
+		const uint8_t* Match = Output - Offset;
+
+		for (size_t i = 0; i < MatchLength; i++)
+		{
+			Output[i] = Match[i];
+		}
+
+		Output += MatchLength;
+	}
+
+	if (Output != OutputEnd)
+		FailFastWithMessage("LZ4 block has the wrong size\n");
+}
+
+#define ASSET_PACK_MAGIC 0x4B50564D
+// bumped whenever the asset ids move, e.g. when a shader is added
+#define ASSET_PACK_VERSION 2
+
+// every asset starts on this boundary, which is at least optimalBufferCopyOffsetAlignment and
+// nonCoherentAtomSize on any device, so it can be copied to the GPU straight from the mapping
+#define ASSET_PACK_ALIGNMENT 256
+
+#define ASSET_PACK_FLAG_LZ4 0x1
+
+enum AssetId
+{
+	// one per shader, in ShaderId order
+	ASSET_SHADER_FIRST,
+	ASSET_MESH_VERTICES = ASSET_SHADER_FIRST + SHADER_COUNT,
+	ASSET_MESH_INDICES,
+	ASSET_TEXTURE,
+	ASSET_COUNT
+};
+
+enum AssetType
+{
+	ASSET_TYPE_SHADER,
+	ASSET_TYPE_VERTICES,
+	ASSET_TYPE_INDICES,
+	ASSET_TYPE_TEXTURE
+};
+
+static enum AssetType GetAssetType(enum AssetId Id)
+{
+	switch (Id)
+	{
+	case ASSET_MESH_VERTICES:
+		return ASSET_TYPE_VERTICES;
+	case ASSET_MESH_INDICES:
+		return ASSET_TYPE_INDICES;
+	case ASSET_TEXTURE:
+		return ASSET_TYPE_TEXTURE;
+	default:
+		return ASSET_TYPE_SHADER;
+	}
+}
+
+/*
+* the file starts with the header and the index, followed by the data of each asset. Hash is
+* over the uncompressed data. all values are little endian
+*/
+struct AssetPackHeader
+{
+	uint32_t Magic;
+	uint32_t Version;
+	uint32_t AssetCount;
+	uint32_t Alignment;
+};
+
+struct AssetPackEntry
+{
+	uint32_t Id;
+	uint32_t Type;
+	uint32_t Flags;
+	uint32_t Reserved;
+	uint64_t Offset;
+	uint64_t StoredSize;
+	uint64_t Size;
+	uint64_t Hash;
+};
+
+struct AssetPack
+{
+	HANDLE File;
+	HANDLE Mapping;
+	const uint8_t* Base;
+	uint64_t Size;
+
+	// NULL for assets the pack doesn't have
+	const struct AssetPackEntry* Assets[ASSET_COUNT];
+};
+
+// set by --asset-pack. assets found there replace the compiled-in ones
+static struct AssetPack AssetPack;
+
+// the border is red, the inside is random
+void GenerateTexture(uint16_t* Texels)
+{
+	for (UINT y = 0; y < TEXTURE_HEIGHT; y++)
+	{
+		for (UINT x = 0; x < TEXTURE_WIDTH; x++)
+		{
+			Texels[(y * TEXTURE_WIDTH + x) * (BYTES_PER_TEXEL / sizeof(WORD))] = x == 0 || x == (TEXTURE_WIDTH - 1) || y == 0 || y == (TEXTURE_HEIGHT - 1) ? 0b1111100000000000 : rand() * (UINT16_MAX / RAND_MAX);
+		}
+	}
+}
+
+// returns NULL when the file can't be opened. the caller frees the result
+void* ReadWholeFile(LPCWSTR FileName, size_t* Size)
+{
+	HANDLE File = CreateFileW(FileName, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+
+	if (File == INVALID_HANDLE_VALUE)
+		return NULL;
+
+	LARGE_INTEGER FileSize;
+	THROW_ON_FALSE(GetFileSizeEx(File, &FileSize));
+
+	if (FileSize.QuadPart > MAXDWORD)
+		FailFastWithMessage("file too large\n");
+
+	void* Data = malloc(max(FileSize.QuadPart, 1));
+
+	if (Data == NULL)
+		FailFastWithMessage("out of memory\n");
+
+	DWORD BytesRead;
+	THROW_ON_FALSE(ReadFile(File, Data, (DWORD)FileSize.QuadPart, &BytesRead, NULL));
+	THROW_ON_FALSE(CloseHandle(File));
+
+	if (BytesRead != FileSize.QuadPart)
+		FailFastWithMessage("short read\n");
+
+	*Size = BytesRead;
+	return Data;
+}
+
+// the loose .spv file CreateShaderModule would fall back to
+void GetLooseShaderPath(enum ShaderId Shader, WCHAR* Path, size_t PathLength)
+{
+	if (ShaderDirectory[0] != L'\0')
+	{
+		if (swprintf_s(Path, PathLength, L"%s\\%s", ShaderDirectory, SHADER_SOURCES[Shader].FileName) < 0)
+			FailFastWithMessage("shader path too long\n");
+	}
+	else
+	{
+		wcscpy_s(Path, PathLength, SHADER_SOURCES[Shader].FileName);
+	}
+}
+
+// in the order CreateShaderModule looks: the shader directory, the embedded code, the working directory
+void* LoadShaderCode(enum ShaderId Shader, size_t* Size)
+{
+	const struct ShaderSource* Source = &SHADER_SOURCES[Shader];
+
+	if (ShaderDirectory[0] != L'\0')
+	{
+		WCHAR Path[MAX_PATH];
+		GetLooseShaderPath(Shader, Path, ARRAYSIZE(Path));
+
+		void* Code = ReadWholeFile(Path, Size);
+
+		if (Code != NULL)
+			return Code;
+	}
+
+	if (Source->Code != NULL)
+	{
+		void* Code = malloc(Source->CodeSize);
+
+		if (Code == NULL)
+			FailFastWithMessage("out of memory\n");
+
+		memcpy(Code, Source->Code, Source->CodeSize);
+		*Size = Source->CodeSize;
+		return Code;
+	}
+
+	void* Code = ReadWholeFile(Source->FileName, Size);
+
+	if (Code == NULL)
+		FailFastWithMessage("shader not found. run CompileShaders.ps1\n");
+
+	return Code;
+}
+
+/*
+* writes every asset the executable would otherwise load or generate into one pack. with
+* Compress, each asset is LZ4 compressed on its own, and kept as is when that doesn't make it
+* smaller
+*/
+void WriteAssetPack(const char* Path, bool Compress)
+{
+	void* Data[ASSET_COUNT];
+	size_t Sizes[ASSET_COUNT];
+
+	for (uint32_t i = 0; i < SHADER_COUNT; i++)
+	{
+		Data[ASSET_SHADER_FIRST + i] = LoadShaderCode(i, &Sizes[ASSET_SHADER_FIRST + i]);
+	}
+
+	Sizes[ASSET_MESH_VERTICES] = sizeof(Vertices);
+	Sizes[ASSET_MESH_INDICES] = sizeof(Indices);
+	Sizes[ASSET_TEXTURE] = TEXTURE_WIDTH * TEXTURE_HEIGHT * BYTES_PER_TEXEL;
+
+	for (uint32_t i = ASSET_MESH_VERTICES; i < ASSET_COUNT; i++)
+	{
+		Data[i] = malloc(Sizes[i]);
+
+		if (Data[i] == NULL)
+			FailFastWithMessage("out of memory\n");
+	}
+
+	memcpy(Data[ASSET_MESH_VERTICES], Vertices, sizeof(Vertices));
+	memcpy(Data[ASSET_MESH_INDICES], Indices, sizeof(Indices));
+	GenerateTexture(Data[ASSET_TEXTURE]);
+
+	HANDLE File = CreateFileA(Path, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	VALIDATE_HANDLE(File);
+
+	struct AssetPackHeader Header = { ASSET_PACK_MAGIC, ASSET_PACK_VERSION, ASSET_COUNT, ASSET_PACK_ALIGNMENT };
+	struct AssetPackEntry Entries[ASSET_COUNT] = { 0 };
+
+	uint64_t Offset = sizeof(Header) + sizeof(Entries);
+	uint64_t TotalSize = 0;
+	uint64_t TotalStoredSize = 0;
+
+	// the index is written last, once the offsets are known
+	THROW_ON_FALSE(SetFilePointerEx(File, (LARGE_INTEGER) { .QuadPart = Offset }, NULL, FILE_BEGIN));
+
+	for (uint32_t i = 0; i < ASSET_COUNT; i++)
+	{
+		static const uint8_t Padding[ASSET_PACK_ALIGNMENT] = { 0 };
+		uint64_t Aligned = (Offset + ASSET_PACK_ALIGNMENT - 1) & ~(uint64_t)(ASSET_PACK_ALIGNMENT - 1);
+
+		DWORD BytesWritten;
+		THROW_ON_FALSE(WriteFile(File, Padding, (DWORD)(Aligned - Offset), &BytesWritten, NULL));
+
+		const void* Stored = Data[i];
+		size_t StoredSize = Sizes[i];
+		uint8_t* Compressed = NULL;
+
+		if (Compress)
+		{
+			Compressed = malloc(Sizes[i]);
+
+			if (Compressed == NULL)
+				FailFastWithMessage("out of memory\n");
+
+			size_t CompressedSize = Lz4Compress(Data[i], Sizes[i], Compressed, Sizes[i]);
+
+			if (CompressedSize > 0)
+			{
+				Stored = Compressed;
+				StoredSize = CompressedSize;
+				Entries[i].Flags |= ASSET_PACK_FLAG_LZ4;
+			}
+		}
+
+		THROW_ON_FALSE(WriteFile(File, Stored, (DWORD)StoredSize, &BytesWritten, NULL));
+
+		Entries[i].Id = i;
+		Entries[i].Type = GetAssetType(i);
+		Entries[i].Offset = Aligned;
+		Entries[i].StoredSize = StoredSize;
+		Entries[i].Size = Sizes[i];
+		Entries[i].Hash = HashBytes(Data[i], Sizes[i]);
+
+		Offset = Aligned + StoredSize;
+		TotalSize += Sizes[i];
+		TotalStoredSize += StoredSize;
+
+		free(Compressed);
+		free(Data[i]);
+	}
+
+	THROW_ON_FALSE(SetFilePointerEx(File, (LARGE_INTEGER) { .QuadPart = 0 }, NULL, FILE_BEGIN));
+
+	DWORD BytesWritten;
+	THROW_ON_FALSE(WriteFile(File, &Header, sizeof(Header), &BytesWritten, NULL));
+	THROW_ON_FALSE(WriteFile(File, Entries, sizeof(Entries), &BytesWritten, NULL));
+	THROW_ON_FALSE(CloseHandle(File));
+
+	LogMessage("asset pack: %u assets, %llu bytes stored for %llu (%s), %llu byte file\n", ASSET_COUNT, TotalStoredSize, TotalSize, Compress ? "lz4" : "uncompressed", Offset);
+}
+
+// maps the whole pack and checks the index against the file
+void AssetPackOpen(struct AssetPack* Pack, const char* Path)
+{
+	memset(Pack, 0, sizeof(struct AssetPack));
+
+	Pack->File = CreateFileA(Path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, NULL);
+	VALIDATE_HANDLE(Pack->File);
+
+	LARGE_INTEGER FileSize;
+	THROW_ON_FALSE(GetFileSizeEx(Pack->File, &FileSize));
+	Pack->Size = FileSize.QuadPart;
+
+	if (Pack->Size < sizeof(struct AssetPackHeader))
+		FailFastWithMessage("asset pack too small\n");
+
+	Pack->Mapping = CreateFileMappingW(Pack->File, NULL, PAGE_READONLY, 0, 0, NULL);
+	VALIDATE_HANDLE(Pack->Mapping);
+
+	Pack->Base = MapViewOfFile(Pack->Mapping, FILE_MAP_READ, 0, 0, 0);
+	VALIDATE_HANDLE(Pack->Base);
+
+	const struct AssetPackHeader* Header = (const struct AssetPackHeader*)Pack->Base;
+
+	if (Header->Magic != ASSET_PACK_MAGIC || Header->Version != ASSET_PACK_VERSION)
+		FailFastWithMessage("not an asset pack, or written by another version\n");
+
+	// the offsets are only checked against the boundary this build writes
+	if (Header->Alignment == 0 || (Header->Alignment & (Header->Alignment - 1)) != 0 || Header->Alignment != ASSET_PACK_ALIGNMENT)
+		FailFastWithMessage("asset pack alignment is not 256 bytes\n");
+
+	if (sizeof(struct AssetPackHeader) + (uint64_t)Header->AssetCount * sizeof(struct AssetPackEntry) > Pack->Size)
+		FailFastWithMessage("asset pack index is truncated\n");
+
+	const struct AssetPackEntry* Entries = (const struct AssetPackEntry*)(Header + 1);
+
+	for (uint32_t i = 0; i < Header->AssetCount; i++)
+	{
+		const struct AssetPackEntry* Entry = &Entries[i];
+
+		if (Entry->Offset % ASSET_PACK_ALIGNMENT != 0 || Entry->Offset > Pack->Size || Entry->StoredSize > Pack->Size - Entry->Offset)
+			FailFastWithMessage("asset pack entry is out of bounds\n");
+
+		if (!(Entry->Flags & ASSET_PACK_FLAG_LZ4) && Entry->StoredSize != Entry->Size)
+			FailFastWithMessage("asset pack entry has the wrong size\n");
+
+		// assets this build doesn't know are skipped, so a newer pack still loads
+		if (Entry->Id >= ASSET_COUNT)
+			continue;
+
+		if (Entry->Type != GetAssetType(Entry->Id))
+			FailFastWithMessage("asset pack entry has the wrong type\n");
+
+		// the code is handed to vkCreateShaderModule as 32 bit words
+		if (Entry->Type == ASSET_TYPE_SHADER && (Entry->Size == 0 || Entry->Size % sizeof(uint32_t) != 0))
+			FailFastWithMessage("asset pack shader is not a whole number of 32 bit words\n");
+
+		Pack->Assets[Entry->Id] = Entry;
+	}
+}
+
+void AssetPackClose(struct AssetPack* Pack)
+{
+	THROW_ON_FALSE(UnmapViewOfFile(Pack->Base));
+	THROW_ON_FALSE(CloseHandle(Pack->Mapping));
+	THROW_ON_FALSE(CloseHandle(Pack->File));
+	memset(Pack, 0, sizeof(struct AssetPack));
+}
+
+bool AssetPackHas(const struct AssetPack* Pack, enum AssetId Id)
+{
+	return Pack->Base != NULL && Pack->Assets[Id] != NULL;
+}
+
+uint64_t AssetPackSize(const struct AssetPack* Pack, enum AssetId Id)
+{
+	return Pack->Assets[Id]->Size;
+}
+
+// copies or decompresses the asset into Destination, which holds AssetPackSize bytes
+void AssetPackRead(const struct AssetPack* Pack, enum AssetId Id, void* Destination)
+{
+	const struct AssetPackEntry* Entry = Pack->Assets[Id];
+
+	if (Entry->Flags & ASSET_PACK_FLAG_LZ4)
+		Lz4Decompress(Pack->Base + Entry->Offset, Entry->StoredSize, Destination, Entry->Size);
+	else
+		memcpy(Destination, Pack->Base + Entry->Offset, Entry->Size);
+
+#ifdef _DEBUG
+	if (HashBytes(Destination, Entry->Size) != Entry->Hash)
+		FailFastWithMessage("asset pack entry is corrupt\n");
+#endif
+}
+
+/*
+* an uncompressed asset is returned straight from the mapping. a compressed one is
+* decompressed into a new allocation, returned through Allocation for the caller to free
+*/
+const void* AssetPackAcquire(const struct AssetPack* Pack, enum AssetId Id, void** Allocation)
+{
+	const struct AssetPackEntry* Entry = Pack->Assets[Id];
+
+	if (!(Entry->Flags & ASSET_PACK_FLAG_LZ4))
+	{
+#ifdef _DEBUG
+		if (HashBytes(Pack->Base + Entry->Offset, Entry->Size) != Entry->Hash)
+			FailFastWithMessage("asset pack entry is corrupt\n");
+#endif
+
+		*Allocation = NULL;
+		return Pack->Base + Entry->Offset;
+	}
+
+	*Allocation = malloc(max(Entry->Size, 1));
+
+	if (*Allocation == NULL)
+		FailFastWithMessage("out of memory\n");
+
+	AssetPackRead(Pack, Id, *Allocation);
+	return *Allocation;
+}
+
+#define ASSET_BENCHMARK_RUNS 5
+
+/*
+* the shaders are the only assets that also exist as loose files, so the comparison loads
+* them both ways, including the open and the map. the whole pack is then read once more to
+* show the copy and decompression throughput. the files are in the OS cache after the first
+* run; the best run is kept
+*/
+void RunAssetBenchmark(const char* Path, uint32_t Iterations)
+{
+	LARGE_INTEGER ProcessorFrequency;
+	QueryPerformanceFrequency(&ProcessorFrequency);
+
+	double LooseMicroseconds = DBL_MAX;
+	double PackMicroseconds = DBL_MAX;
+	double ReadMicroseconds = DBL_MAX;
+	uint64_t ReadBytes = 0;
+
+	for (uint32_t Run = 0; Run < ASSET_BENCHMARK_RUNS; Run++)
+	{
+		LARGE_INTEGER StartTime;
+		LARGE_INTEGER EndTime;
+
+		QueryPerformanceCounter(&StartTime);
+
+		for (uint32_t i = 0; i < Iterations; i++)
+		{
+			for (uint32_t Shader = 0; Shader < SHADER_COUNT; Shader++)
+			{
+				WCHAR ShaderPath[MAX_PATH];
+				GetLooseShaderPath(Shader, ShaderPath, ARRAYSIZE(ShaderPath));
+
+				size_t Size;
+				void* Code = ReadWholeFile(ShaderPath, &Size);
+
+				if (Code == NULL)
+					FailFastWithMessage("loose shaders not found. run CompileShaders.ps1\n");
+
+				free(Code);
+			}
+		}
+
+		QueryPerformanceCounter(&EndTime);
+		LooseMicroseconds = min(LooseMicroseconds, (EndTime.QuadPart - StartTime.QuadPart) * 1000000.0 / ProcessorFrequency.QuadPart / Iterations);
+
+		QueryPerformanceCounter(&StartTime);
+
+		for (uint32_t i = 0; i < Iterations; i++)
+		{
+			struct AssetPack Pack;
+			AssetPackOpen(&Pack, Path);
+
+			for (uint32_t Shader = 0; Shader < SHADER_COUNT; Shader++)
+			{
+				if (!AssetPackHas(&Pack, ASSET_SHADER_FIRST + Shader))
+					FailFastWithMessage("the asset pack has no shaders\n");
+
+				void* Code = malloc(AssetPackSize(&Pack, ASSET_SHADER_FIRST + Shader));
+
+				if (Code == NULL)
+					FailFastWithMessage("out of memory\n");
+
+				AssetPackRead(&Pack, ASSET_SHADER_FIRST + Shader, Code);
+				free(Code);
+			}
+
+			AssetPackClose(&Pack);
+		}
+
+		QueryPerformanceCounter(&EndTime);
+		PackMicroseconds = min(PackMicroseconds, (EndTime.QuadPart - StartTime.QuadPart) * 1000000.0 / ProcessorFrequency.QuadPart / Iterations);
+
+		{
+			struct AssetPack Pack;
+			AssetPackOpen(&Pack, Path);
+
+			QueryPerformanceCounter(&StartTime);
+
+			ReadBytes = 0;
+
+			for (uint32_t Id = 0; Id < ASSET_COUNT; Id++)
+			{
+				if (!AssetPackHas(&Pack, Id))
+					continue;
+
+				void* Data = malloc(max(AssetPackSize(&Pack, Id), 1));
+
+				if (Data == NULL)
+					FailFastWithMessage("out of memory\n");
+
+				AssetPackRead(&Pack, Id, Data);
+				ReadBytes += AssetPackSize(&Pack, Id);
+				free(Data);
+			}
+
+			QueryPerformanceCounter(&EndTime);
+			ReadMicroseconds = min(ReadMicroseconds, (EndTime.QuadPart - StartTime.QuadPart) * 1000000.0 / ProcessorFrequency.QuadPart);
+
+			AssetPackClose(&Pack);
+		}
+	}
+
+	LogMessage("asset benchmark: %u shaders, %.1f us from loose files, %.1f us from the pack (%.1fx)\n", SHADER_COUNT, LooseMicroseconds, PackMicroseconds, LooseMicroseconds / PackMicroseconds);
+	LogMessage("asset benchmark: whole pack read in %.1f us, %.1f MB/s\n", ReadMicroseconds, ReadBytes / ReadMicroseconds * 1000000.0 / (1024.0 * 1024.0));
+}
+
+struct ShaderLoadContext
+{
+	VkDevice Device;
+	enum ShaderId Shader;
+	VkShaderModule* Module;
+};
+
+#define SPIRV_MAGIC 0x07230203
+
+/*
+* returns VK_NULL_HANDLE when the file is missing, or doesn't hold SPIR-V yet because it is
+* still being written
+*/
+VkShaderModule TryLoadShaderModule(VkDevice Device, LPCWSTR FileName)
+{
+	HANDLE ShaderFile = CreateFileW(FileName, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+
+	if (ShaderFile == INVALID_HANDLE_VALUE)
+	{
+		DWORD Error = GetLastError();
+
+		if (Error == ERROR_FILE_NOT_FOUND || Error == ERROR_PATH_NOT_FOUND || Error == ERROR_SHARING_VIOLATION)
+			return VK_NULL_HANDLE;
+
+		THROW_ON_FAIL(HRESULT_FROM_WIN32(Error));
+	}
+
+	LARGE_INTEGER ShaderSize;
+	THROW_ON_FALSE(GetFileSizeEx(ShaderFile, &ShaderSize));
+
+	VkShaderModule ShaderModule = VK_NULL_HANDLE;
+
+	if (ShaderSize.QuadPart >= sizeof(uint32_t) && ShaderSize.QuadPart % sizeof(uint32_t) == 0)
+	{
+		HANDLE ShaderFileMap = CreateFileMappingW(ShaderFile, NULL, PAGE_READONLY, 0, 0, NULL);
+		VALIDATE_HANDLE(ShaderFileMap);
+
+		const uint32_t* ShaderBytecode = MapViewOfFile(ShaderFileMap, FILE_MAP_READ, 0, 0, 0);
+		VALIDATE_HANDLE(ShaderBytecode);
+
+		if (ShaderBytecode[0] == SPIRV_MAGIC)
+		{
+			VkShaderModuleCreateInfo CreateInfo = { 0 };
+			CreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+			CreateInfo.codeSize = ShaderSize.QuadPart;
+			CreateInfo.pCode = ShaderBytecode;
+			THROW_ON_FAIL_VK(vkCreateShaderModule(Device, &CreateInfo, NULL, &ShaderModule));
+		}
+
+		THROW_ON_FALSE(UnmapViewOfFile(ShaderBytecode));
+		THROW_ON_FALSE(CloseHandle(ShaderFileMap));
+	}
+
+	THROW_ON_FALSE(CloseHandle(ShaderFile));
+
+	return ShaderModule;
+}
+
+/*
+* the override directory wins, then the asset pack, then the SPIR-V embedded at build time.
+* a build without Shaders.h falls back to the .spv files in the working directory
+*/
+VkShaderModule CreateShaderModule(VkDevice Device, enum ShaderId Shader)
+{
+	const struct ShaderSource* Source = &SHADER_SOURCES[Shader];
+
+	if (ShaderDirectory[0] != L'\0')
+	{
+		WCHAR Path[MAX_PATH];
+
+		if (swprintf_s(Path, ARRAYSIZE(Path), L"%s\\%s", ShaderDirectory, Source->FileName) < 0)
+			FailFastWithMessage("shader path too long\n");
+
+		VkShaderModule ShaderModule = TryLoadShaderModule(Device, Path);
+
+		if (ShaderModule != VK_NULL_HANDLE)
+			return ShaderModule;
+	}
+
+	if (AssetPackHas(&AssetPack, ASSET_SHADER_FIRST + Shader))
+	{
+		void* Allocation;
+
+		VkShaderModuleCreateInfo CreateInfo = { 0 };
+		CreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+		CreateInfo.codeSize = AssetPackSize(&AssetPack, ASSET_SHADER_FIRST + Shader);
+		CreateInfo.pCode = AssetPackAcquire(&AssetPack, ASSET_SHADER_FIRST + Shader, &Allocation);
+
+		VkShaderModule ShaderModule;
+		THROW_ON_FAIL_VK(vkCreateShaderModule(Device, &CreateInfo, NULL, &ShaderModule));
+
+		free(Allocation);
+		return ShaderModule;
+	}
+
+	if (Source->Code != NULL)
+	{
+		VkShaderModuleCreateInfo CreateInfo = { 0 };
+		CreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+		CreateInfo.codeSize = Source->CodeSize;
+		CreateInfo.pCode = Source->Code;
+
+		VkShaderModule ShaderModule;
+		THROW_ON_FAIL_VK(vkCreateShaderModule(Device, &CreateInfo, NULL, &ShaderModule));
+		return ShaderModule;
+	}
+
+	VkShaderModule ShaderModule = TryLoadShaderModule(Device, Source->FileName);
+
+	if (ShaderModule == VK_NULL_HANDLE)
+		FailFastWithMessage("shader not found. run CompileShaders.ps1\n");
+
+	return ShaderModule;
+}
+
+/*
+* like CreateShaderModule, but a file in the shader directory that can't be read or isn't
+* SPIR-V is logged and returns VK_NULL_HANDLE instead of ending the process, since a reload
+* can catch the compiler halfway through writing it
+*/
+VkShaderModule TryReloadShaderModule(VkDevice Device, enum ShaderId Shader)
+{
+	WCHAR Path[MAX_PATH];
+	GetLooseShaderPath(Shader, Path, ARRAYSIZE(Path));
+
+	if (ShaderDirectory[0] == L'\0' || GetFileAttributesW(Path) == INVALID_FILE_ATTRIBUTES)
+		return CreateShaderModule(Device, Shader);
+
+	size_t CodeSize;
+	uint32_t* Code = ReadWholeFile(Path, &CodeSize);
+
+	if (Code == NULL)
+	{
+		LogMessage("%ls can't be read (error %lu)\n", Path, GetLastError());
+		return VK_NULL_HANDLE;
+	}
+
+	VkShaderModule ShaderModule = VK_NULL_HANDLE;
+
+	if (CodeSize == 0 || CodeSize % sizeof(uint32_t) != 0 || Code[0] != SPIRV_MAGIC)
+	{
+		LogMessage("%ls is not SPIR-V (%zu bytes)\n", Path, CodeSize);
+	}
+	else
+	{
+		VkShaderModuleCreateInfo CreateInfo = { 0 };
+		CreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+		CreateInfo.codeSize = CodeSize;
+		CreateInfo.pCode = Code;
+
+		VkResult Result = vkCreateShaderModule(Device, &CreateInfo, NULL, &ShaderModule);
+
+		if (Result != VK_SUCCESS)
+		{
+			LogMessage("%ls: vkCreateShaderModule failed (%d)\n", Path, Result);
+			ShaderModule = VK_NULL_HANDLE;
+		}
+	}
+
+	free(Code);
+	return ShaderModule;
+}
+
+void LoadShaderJob(void* Context)
+{
+	struct ShaderLoadContext* Load = Context;
+	*Load->Module = CreateShaderModule(Load->Device, Load->Shader);
+}
+
+/*
+* builds the pipeline library for Parts, or the whole pipeline when Parts is 0. only the
+* shader modules of the stages being built are used, and they have to match
+* State->VertexShader and State->FragmentShader. safe to call from any thread
+*/
+VkResult CreateScenePipelineParts(const struct VulkanObjects* VulkanObjects, const struct PipelineState* State, VkGraphicsPipelineLibraryFlagsEXT Parts, VkShaderModule VertexShaderModule, VkShaderModule FragmentShaderModule, VkPipeline* Pipeline)
+{
+	bool Complete = Parts == 0;
+	bool VertexInput = Complete || (Parts & VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT);
+	bool PreRasterization = Complete || (Parts & VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT);
+	bool FragmentShader = Complete || (Parts & VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT);
+	bool FragmentOutput = Complete || (Parts & VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT);
+
+	VkSpecializationMapEntry SpecializationEntries[PIPELINE_MAX_SPECIALIZATION_CONSTANTS];
+
+	for (uint32_t i = 0; i < State->SpecializationConstantCount; i++)
+	{
+		SpecializationEntries[i].constantID = i;
+		SpecializationEntries[i].offset = i * sizeof(uint32_t);
+		SpecializationEntries[i].size = sizeof(uint32_t);
+	}
+
+	VkSpecializationInfo SpecializationInfo = { 0 };
+	SpecializationInfo.mapEntryCount = State->SpecializationConstantCount;
+	SpecializationInfo.pMapEntries = SpecializationEntries;
+	SpecializationInfo.dataSize = State->SpecializationConstantCount * sizeof(uint32_t);
+	SpecializationInfo.pData = State->SpecializationConstants;
+
+	VkPipelineShaderStageCreateInfo ShaderStages[2] = { 0 };
+	uint32_t StageCount = 0;
+
+	if (PreRasterization)
+	{
+		ShaderStages[StageCount].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		ShaderStages[StageCount].stage = VK_SHADER_STAGE_VERTEX_BIT;
+		ShaderStages[StageCount].module = VertexShaderModule;
+		ShaderStages[StageCount].pName = "main";
+		ShaderStages[StageCount].pSpecializationInfo = &SpecializationInfo;
+		StageCount++;
+	}
+
+	if (FragmentShader)
+	{
+		ShaderStages[StageCount].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		ShaderStages[StageCount].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+		ShaderStages[StageCount].module = FragmentShaderModule;
+		ShaderStages[StageCount].pName = "main";
+		ShaderStages[StageCount].pSpecializationInfo = &SpecializationInfo;
+		StageCount++;
+	}
+	
+	if (State->VertexLayout != VERTEX_LAYOUT_SCENE && State->VertexLayout != VERTEX_LAYOUT_PULLED)
+		FailFastWithMessage("unknown vertex layout\n");
+
+	VkVertexInputBindingDescription BindingDescription = { 0 };
+	BindingDescription.binding = 0;
+	BindingDescription.stride = sizeof(struct Vertex);
+	BindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+	VkVertexInputAttributeDescription AttributeDescriptions[3] = { 0 };
+	AttributeDescriptions[0].binding = 0;
+	AttributeDescriptions[0].location = 0;
+	AttributeDescriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
+	AttributeDescriptions[0].offset = offsetof(struct Vertex, Pos);
+
+	AttributeDescriptions[1].binding = 0;
+	AttributeDescriptions[1].location = 1;
+	AttributeDescriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT;
+	AttributeDescriptions[1].offset = offsetof(struct Vertex, Color);
+
+	AttributeDescriptions[2].binding = 0;
+	AttributeDescriptions[2].location = 2;
+	AttributeDescriptions[2].format = VK_FORMAT_R32G32_SFLOAT;
+	AttributeDescriptions[2].offset = offsetof(struct Vertex, TexCoord);
+
+	VkPipelineVertexInputStateCreateInfo VertexInputInfo = { 0 };
+	VertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+
+	// a pulled layout leaves the vertex input empty
+	if (State->VertexLayout == VERTEX_LAYOUT_SCENE)
+	{
+		VertexInputInfo.vertexBindingDescriptionCount = 1;
+		VertexInputInfo.pVertexBindingDescriptions = &BindingDescription;
+		VertexInputInfo.vertexAttributeDescriptionCount = ARRAYSIZE(AttributeDescriptions);
+		VertexInputInfo.pVertexAttributeDescriptions = AttributeDescriptions;
+	}
+
+	VkPipelineInputAssemblyStateCreateInfo InputAssembly = { 0 };
+	InputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+	InputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+	InputAssembly.primitiveRestartEnable = VK_FALSE;
+
+	VkPipelineViewportStateCreateInfo ViewportState = { 0 };
+	ViewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+	ViewportState.viewportCount = 1;
+	ViewportState.scissorCount = 1;
+
+	VkPipelineRasterizationStateCreateInfo Rasterizer = { 0 };
+	Rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+	Rasterizer.depthClampEnable = VK_FALSE;
+	Rasterizer.rasterizerDiscardEnable = VK_FALSE;
+	Rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
+	Rasterizer.lineWidth = 1.0f;
+	Rasterizer.cullMode = State->CullMode;
+	Rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+	Rasterizer.depthBiasEnable = VK_FALSE;
+
+	VkPipelineMultisampleStateCreateInfo Multisampling = { 0 };
+	Multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+	Multisampling.sampleShadingEnable = VK_FALSE;
+	Multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+	VkPipelineDepthStencilStateCreateInfo DepthStencil = { 0 };
+	DepthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+	DepthStencil.depthTestEnable = State->DepthTest;
+	DepthStencil.depthWriteEnable = State->DepthWrite;
+	DepthStencil.depthCompareOp = State->DepthCompareOp;
+	DepthStencil.depthBoundsTestEnable = VK_FALSE;
+	DepthStencil.stencilTestEnable = VK_FALSE;
+
+	// blending is always over: source alpha against what is already there
+	VkPipelineColorBlendAttachmentState ColorBlendAttachment = { 0 };
+	ColorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+	ColorBlendAttachment.blendEnable = State->BlendEnable;
+	ColorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+	ColorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+	ColorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+	ColorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+	ColorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+	ColorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+
+	VkPipelineColorBlendStateCreateInfo ColorBlending = { 0 };
+	ColorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+	ColorBlending.logicOpEnable = VK_FALSE;
+	ColorBlending.logicOp = VK_LOGIC_OP_COPY;
+	ColorBlending.attachmentCount = 1;
+	ColorBlending.pAttachments = &ColorBlendAttachment;
+	ColorBlending.blendConstants[0] = 0.0f;
+	ColorBlending.blendConstants[1] = 0.0f;
+	ColorBlending.blendConstants[2] = 0.0f;
+	ColorBlending.blendConstants[3] = 0.0f;
+
+	VkDynamicState DynamicStates[] = {
+		VK_DYNAMIC_STATE_VIEWPORT,
+		VK_DYNAMIC_STATE_SCISSOR
+	};
+
+	VkPipelineDynamicStateCreateInfo DynamicState = { 0 };
+	DynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+	DynamicState.dynamicStateCount = ARRAYSIZE(DynamicStates);
+	DynamicState.pDynamicStates = DynamicStates;
+
+	VkPipelineRenderingCreateInfo RenderingInfo = { 0 };
+	RenderingInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO;
+	RenderingInfo.colorAttachmentCount = 1;
+	RenderingInfo.pColorAttachmentFormats = &VulkanObjects->SwapChainImageFormat.format;
+	RenderingInfo.depthAttachmentFormat = VulkanObjects->DepthFormat;
+	RenderingInfo.stencilAttachmentFormat = VK_FORMAT_UNDEFINED;
+	RenderingInfo.viewMask = GetSceneViewMask(VulkanObjects);
+
+	// the optimized link needs what the parts were compiled from
+	VkGraphicsPipelineLibraryCreateInfoEXT LibraryInfo = { 0 };
+	LibraryInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT;
+	LibraryInfo.pNext = VulkanObjects->UseDynamicRendering ? &RenderingInfo : NULL;
+	LibraryInfo.flags = Parts;
+
+	// state that doesn't belong to one of the parts being built is left out
+	VkGraphicsPipelineCreateInfo PipelineInfo = { 0 };
+	PipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+	PipelineInfo.pNext = Complete ? LibraryInfo.pNext : &LibraryInfo;
+	PipelineInfo.flags = Complete ? 0 : VK_PIPELINE_CREATE_LIBRARY_BIT_KHR | VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT;
+	PipelineInfo.stageCount = StageCount;
+	PipelineInfo.pStages = ShaderStages;
+	PipelineInfo.pVertexInputState = VertexInput ? &VertexInputInfo : NULL;
+	PipelineInfo.pInputAssemblyState = VertexInput ? &InputAssembly : NULL;
+	PipelineInfo.pViewportState = PreRasterization ? &ViewportState : NULL;
+	PipelineInfo.pRasterizationState = PreRasterization ? &Rasterizer : NULL;
+	PipelineInfo.pMultisampleState = (FragmentShader || FragmentOutput) ? &Multisampling : NULL;
+	PipelineInfo.pDepthStencilState = FragmentShader ? &DepthStencil : NULL;
+	PipelineInfo.pColorBlendState = FragmentOutput ? &ColorBlending : NULL;
+	PipelineInfo.pDynamicState = &DynamicState;
+	PipelineInfo.layout = (PreRasterization || FragmentShader) ? VulkanObjects->PipelineLayout : VK_NULL_HANDLE;
+	PipelineInfo.renderPass = VulkanObjects->UseDynamicRendering ? VK_NULL_HANDLE : VulkanObjects->RenderPass;
+	PipelineInfo.subpass = 0;
+	PipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+
+	return vkCreateGraphicsPipelines(VulkanObjects->Device, VulkanObjects->PipelineCache, 1, &PipelineInfo, NULL, Pipeline);
+}
+
+VkPipeline CreateScenePipeline(const struct VulkanObjects* VulkanObjects, const struct PipelineState* State, VkShaderModule VertexShaderModule, VkShaderModule FragmentShaderModule)
+{
+	VkPipeline Pipeline;
+	THROW_ON_FAIL_VK(CreateScenePipelineParts(VulkanObjects, State, 0, VertexShaderModule, FragmentShaderModule, &Pipeline));
+	return Pipeline;
+}
+
+/*
+* without Optimize the link only stitches the parts together, which is what makes it cheap
+* enough to do in the middle of a frame
+*/
+VkPipeline LinkScenePipeline(const struct VulkanObjects* VulkanObjects, const VkPipeline Libraries[PIPELINE_PART_COUNT], bool Optimize)
+{
+	VkPipelineLibraryCreateInfoKHR LibraryInfo = { 0 };
+	LibraryInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR;
+	LibraryInfo.libraryCount = PIPELINE_PART_COUNT;
+	LibraryInfo.pLibraries = Libraries;
+
+	VkGraphicsPipelineCreateInfo PipelineInfo = { 0 };
+	PipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+	PipelineInfo.pNext = &LibraryInfo;
+	PipelineInfo.flags = Optimize ? VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT : 0;
+	PipelineInfo.layout = VulkanObjects->PipelineLayout;
+
+	VkPipeline Pipeline;
+	THROW_ON_FAIL_VK(vkCreateGraphicsPipelines(VulkanObjects->Device, VulkanObjects->PipelineCache, 1, &PipelineInfo, NULL, &Pipeline));
+	return Pipeline;
+}
+
+void CreatePipelineJob(void* Context)
+{
+	struct StartupContext* Startup = Context;
+	struct VulkanObjects* VulkanObjects = Startup->VulkanObjects;
+
+	// the first view a scene pass renders, and the mesh when the vertices are pulled
+	VkPushConstantRange PushConstantRange = { 0 };
+	PushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+	PushConstantRange.offset = 0;
+	PushConstantRange.size = sizeof(struct ScenePushConstants);
+
+	VkPipelineLayoutCreateInfo PipelineLayoutInfo = { 0 };
+	PipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	PipelineLayoutInfo.setLayoutCount = 1;
+	PipelineLayoutInfo.pSetLayouts = &Startup->DescriptorSetLayout;
+	PipelineLayoutInfo.pushConstantRangeCount = 1;
+	PipelineLayoutInfo.pPushConstantRanges = &PushConstantRange;
+
+	THROW_ON_FAIL_VK(vkCreatePipelineLayout(VulkanObjects->Device, &PipelineLayoutInfo, NULL, &VulkanObjects->PipelineLayout));
+
+	struct PipelineState State = GetSceneMaterialState(VulkanObjects, 0);
+	VulkanObjects->GraphicsPipeline = CreateScenePipeline(VulkanObjects, &State, Startup->VertexShaderModule, Startup->FragmentShaderModule);
+
+	vkDestroyShaderModule(VulkanObjects->Device, Startup->FragmentShaderModule, NULL);
+	vkDestroyShaderModule(VulkanObjects->Device, Startup->VertexShaderModule, NULL);
+}
+
+// finishes one compile or link: the result becomes visible and the render thread is woken
+void PipelineRegistryPublish(struct PipelineRegistry* Registry, volatile LONG* Status)
+{
+	WriteRelease(Status, PIPELINE_STATUS_READY);
+	InterlockedIncrement(&Registry->Completed);
+
+	if (Registry->WakeEvent != NULL)
+		THROW_ON_FALSE(SetEvent(Registry->WakeEvent));
+}
+
+// without workers nothing would run the job until the registry is cleared, so it runs here
+void PipelineRegistrySubmit(struct PipelineRegistry* Registry, const char* Name, JobFunction Function, void* Context)
+{
+	JobSubmit(Registry->JobSystem, JobCreate(Registry->JobSystem, Name, Function, Context, &Registry->Pending));
+
+	if (Registry->JobSystem->WorkerCount == 0)
+		JobSystemWait(Registry->JobSystem, &Registry->Pending);
+}
+
+void CompilePipelineJob(void* Context)
+{
+	struct PipelineEntry* Entry = Context;
+	struct PipelineRegistry* Registry = Entry->Registry;
+	VkDevice Device = Registry->VulkanObjects->Device;
+
+	LARGE_INTEGER ProcessorFrequency;
+	LARGE_INTEGER StartTime;
+	LARGE_INTEGER EndTime;
+	QueryPerformanceFrequency(&ProcessorFrequency);
+	QueryPerformanceCounter(&StartTime);
+
+	VkShaderModule VertexShaderModule = CreateShaderModule(Device, Entry->State.VertexShader);
+	VkShaderModule FragmentShaderModule = CreateShaderModule(Device, Entry->State.FragmentShader);
+
+	Entry->Pipeline = CreateScenePipeline(Registry->VulkanObjects, &Entry->State, VertexShaderModule, FragmentShaderModule);
+
+	vkDestroyShaderModule(Device, FragmentShaderModule, NULL);
+	vkDestroyShaderModule(Device, VertexShaderModule, NULL);
+
+	QueryPerformanceCounter(&EndTime);
+
+	LogMessage("pipeline %016llx compiled in %.2f ms\n", Entry->Hash, (EndTime.QuadPart - StartTime.QuadPart) * 1000.0 / ProcessorFrequency.QuadPart);
+
+	PipelineRegistryPublish(Registry, &Entry->Status);
+}
+
+void CompilePipelineLibraryJob(void* Context)
+{
+	struct PipelineLibraryEntry* Library = Context;
+	struct PipelineRegistry* Registry = Library->Registry;
+	VkDevice Device = Registry->VulkanObjects->Device;
+
+	LARGE_INTEGER ProcessorFrequency;
+	LARGE_INTEGER StartTime;
+	LARGE_INTEGER EndTime;
+	QueryPerformanceFrequency(&ProcessorFrequency);
+	QueryPerformanceCounter(&StartTime);
+
+	VkShaderModule VertexShaderModule = VK_NULL_HANDLE;
+	VkShaderModule FragmentShaderModule = VK_NULL_HANDLE;
+
+	if (Library->Part == PIPELINE_PART_PRE_RASTERIZATION)
+		VertexShaderModule = CreateShaderModule(Device, Library->State.VertexShader);
+
+	if (Library->Part == PIPELINE_PART_FRAGMENT_SHADER)
+		FragmentShaderModule = CreateShaderModule(Device, Library->State.FragmentShader);
+
+	THROW_ON_FAIL_VK(CreateScenePipelineParts(Registry->VulkanObjects, &Library->State, PIPELINE_PART_FLAGS[Library->Part], VertexShaderModule, FragmentShaderModule, &Library->Library));
+
+	if (FragmentShaderModule != VK_NULL_HANDLE)
+		vkDestroyShaderModule(Device, FragmentShaderModule, NULL);
+
+	if (VertexShaderModule != VK_NULL_HANDLE)
+		vkDestroyShaderModule(Device, VertexShaderModule, NULL);
+
+	QueryPerformanceCounter(&EndTime);
+
+	LogMessage("pipeline library %016llx (%s) compiled in %.2f ms\n", Library->Hash, PIPELINE_PART_NAMES[Library->Part], (EndTime.QuadPart - StartTime.QuadPart) * 1000.0 / ProcessorFrequency.QuadPart);
+
+	PipelineRegistryPublish(Registry, &Library->Status);
+}
+
+// replaces the quick link with an optimized one, or makes the only link without fast linking
+void OptimizePipelineJob(void* Context)
+{
+	struct PipelineEntry* Entry = Context;
+	struct PipelineRegistry* Registry = Entry->Registry;
+
+	LARGE_INTEGER ProcessorFrequency;
+	LARGE_INTEGER StartTime;
+	LARGE_INTEGER EndTime;
+	QueryPerformanceFrequency(&ProcessorFrequency);
+	QueryPerformanceCounter(&StartTime);
+
+	Entry->Pipeline = LinkScenePipeline(Registry->VulkanObjects, Entry->Libraries, true);
+
+	QueryPerformanceCounter(&EndTime);
+
+	double OptimizeMilliseconds = (EndTime.QuadPart - StartTime.QuadPart) * 1000.0 / ProcessorFrequency.QuadPart;
+
+	if (Entry->LinkedPipeline != VK_NULL_HANDLE)
+		LogMessage("pipeline %016llx: link %.3f ms, optimized link %.2f ms\n", Entry->Hash, Entry->LinkMilliseconds, OptimizeMilliseconds);
+	else
+		LogMessage("pipeline %016llx: optimized link %.2f ms\n", Entry->Hash, OptimizeMilliseconds);
+
+	PipelineRegistryPublish(Registry, &Entry->Status);
+}
+
+// returns the library for the part of State, queueing its compile the first time
+struct PipelineLibraryEntry* PipelineRegistryGetLibrary(struct PipelineRegistry* Registry, const struct PipelineState* State, enum PipelinePart Part)
+{
+	struct PipelineState PartState;
+	GetPipelinePartState(State, Part, &PartState);
+
+	uint64_t Hash = HashPipelineState(&PartState);
+
+	for (uint32_t i = 0; i < PIPELINE_REGISTRY_SIZE; i++)
+	{
+		struct PipelineLibraryEntry* Library = &Registry->Libraries[(Hash + i) % PIPELINE_REGISTRY_SIZE];
+
+		if (ReadAcquire(&Library->Status) == PIPELINE_STATUS_EMPTY)
+		{
+			Library->Registry = Registry;
+			Library->Part = Part;
+			Library->Hash = Hash;
+			Library->State = PartState;
+			Library->Status = PIPELINE_STATUS_COMPILING;
+
+			PipelineRegistrySubmit(Registry, "CompilePipelineLibrary", CompilePipelineLibraryJob, Library);
+			return Library;
+		}
+
+		if (Library->Part == Part && Library->Hash == Hash && memcmp(&Library->State, &PartState, sizeof(struct PipelineState)) == 0)
+			return Library;
+	}
+
+	FailFastWithMessage("pipeline library registry full\n");
+	return NULL;
+}
+
+/*
+* links Entry as soon as all four of its parts are compiled, and queues the optimized link.
+* the quick link is skipped when the device can't link fast
+*/
+void PipelineRegistryLink(struct PipelineRegistry* Registry, struct PipelineEntry* Entry)
+{
+	bool Ready = true;
+
+	for (uint32_t Part = 0; Part < PIPELINE_PART_COUNT; Part++)
+	{
+		struct PipelineLibraryEntry* Library = PipelineRegistryGetLibrary(Registry, &Entry->State, Part);
+
+		if (ReadAcquire(&Library->Status) == PIPELINE_STATUS_READY)
+			Entry->Libraries[Part] = Library->Library;
+		else
+			Ready = false;
+	}
+
+	if (!Ready)
+		return;
+
+	if (Registry->VulkanObjects->PipelineLibraryFastLinking)
+	{
+		LARGE_INTEGER ProcessorFrequency;
+		LARGE_INTEGER StartTime;
+		LARGE_INTEGER EndTime;
+		QueryPerformanceFrequency(&ProcessorFrequency);
+		QueryPerformanceCounter(&StartTime);
+
+		Entry->LinkedPipeline = LinkScenePipeline(Registry->VulkanObjects, Entry->Libraries, false);
+
+		QueryPerformanceCounter(&EndTime);
+		Entry->LinkMilliseconds = (EndTime.QuadPart - StartTime.QuadPart) * 1000.0 / ProcessorFrequency.QuadPart;
+	}
+
+	Entry->Status = PIPELINE_STATUS_LINKED;
+	PipelineRegistrySubmit(Registry, "OptimizePipeline", OptimizePipelineJob, Entry);
+}
+
+/*
+* returns the pipeline for State, or the startup pipeline while it is still being compiled.
+* a state seen for the first time is queued on the job system, so asking for a new material
+* never stalls the frame. with pipeline libraries and fast linking the variant is linked here
+* instead, once its parts are compiled. render thread only
+*/
+VkPipeline PipelineRegistryGet(struct PipelineRegistry* Registry, const struct PipelineState* State)
+{
+	VkPipeline Fallback = Registry->VulkanObjects->GraphicsPipeline;
+	struct PipelineState StartupState = GetSceneMaterialState(Registry->VulkanObjects, 0);
+
+	if (memcmp(State, &StartupState, sizeof(struct PipelineState)) == 0)
+		return Fallback;
+
+	uint64_t Hash = HashPipelineState(State);
+
+	for (uint32_t i = 0; i < PIPELINE_REGISTRY_SIZE; i++)
+	{
+		struct PipelineEntry* Entry = &Registry->Entries[(Hash + i) % PIPELINE_REGISTRY_SIZE];
+		LONG Status = ReadAcquire(&Entry->Status);
+
+		if (Status == PIPELINE_STATUS_EMPTY)
+		{
+			Entry->Registry = Registry;
+			Entry->Hash = Hash;
+			Entry->State = *State;
+			Entry->Status = PIPELINE_STATUS_COMPILING;
+
+			if (!Registry->VulkanObjects->UsePipelineLibrary)
+			{
+				PipelineRegistrySubmit(Registry, "CompilePipeline", CompilePipelineJob, Entry);
+				Status = ReadAcquire(&Entry->Status);
+			}
+		}
+		else if (Entry->Hash != Hash || memcmp(&Entry->State, State, sizeof(struct PipelineState)) != 0)
+		{
+			continue;
+		}
+
+		if (Status == PIPELINE_STATUS_COMPILING && Registry->VulkanObjects->UsePipelineLibrary)
+		{
+			PipelineRegistryLink(Registry, Entry);
+			Status = ReadAcquire(&Entry->Status);
+		}
+
+		if (Status == PIPELINE_STATUS_READY)
+			return Entry->Pipeline;
+
+		if (Status == PIPELINE_STATUS_LINKED && Entry->LinkedPipeline != VK_NULL_HANDLE)
+			return Entry->LinkedPipeline;
+
+		return Fallback;
+	}
+
+	FailFastWithMessage("pipeline registry full\n");
+	return Fallback;
+}
+
+// queues the parts of every material, so the first switch to one only has to link
+void PipelineRegistryPrecompile(struct PipelineRegistry* Registry)
+{
+	if (!Registry->VulkanObjects->UsePipelineLibrary)
+		return;
+
+	for (uint32_t i = 1; i < ARRAYSIZE(SCENE_MATERIALS); i++)
+	{
+		struct PipelineState State = GetSceneMaterialState(Registry->VulkanObjects, i);
+
+		for (uint32_t Part = 0; Part < PIPELINE_PART_COUNT; Part++)
+		{
+			PipelineRegistryGetLibrary(Registry, &State, Part);
+		}
+	}
+}
+
+/*
+* waits for the compiles in flight, then destroys every variant and library. nothing may
+* still be using them on the gpu
+*/
+void PipelineRegistryClear(struct PipelineRegistry* Registry)
+{
+	VkDevice Device = Registry->VulkanObjects->Device;
+
+	JobSystemWait(Registry->JobSystem, &Registry->Pending);
+
+	// linked pipelines go before the libraries they were linked from
+	for (uint32_t i = 0; i < PIPELINE_REGISTRY_SIZE; i++)
+	{
+		struct PipelineEntry* Entry = &Registry->Entries[i];
+
+		if (Entry->Status == PIPELINE_STATUS_READY)
+			vkDestroyPipeline(Device, Entry->Pipeline, NULL);
+
+		if (Entry->LinkedPipeline != VK_NULL_HANDLE)
+			vkDestroyPipeline(Device, Entry->LinkedPipeline, NULL);
+	}
+
+	for (uint32_t i = 0; i < PIPELINE_REGISTRY_SIZE; i++)
+	{
+		if (Registry->Libraries[i].Status == PIPELINE_STATUS_READY)
+			vkDestroyPipeline(Device, Registry->Libraries[i].Library, NULL);
+	}
+
+	memset(Registry->Entries, 0, sizeof(Registry->Entries));
+	memset(Registry->Libraries, 0, sizeof(Registry->Libraries));
+}
+
+/*
+* moves the image into its sampled layout and writes the texels from host memory, either the
+* mapped asset pack or a generated copy. nothing is staged and nothing is submitted
+*/
+static void CopyTextureFromHost(const struct VulkanObjects* VulkanObjects, VkImage Image)
+{
+	void* Allocation = NULL;
+	const void* Texels;
+
+	if (AssetPackHas(&AssetPack, ASSET_TEXTURE))
+	{
+		if (AssetPackSize(&AssetPack, ASSET_TEXTURE) != TEXTURE_WIDTH * TEXTURE_HEIGHT * BYTES_PER_TEXEL)
+			FailFastWithMessage("the asset pack texture doesn't match this build\n");
+
+		Texels = AssetPackAcquire(&AssetPack, ASSET_TEXTURE, &Allocation);
+	}
+	else
+	{
+		Allocation = malloc(TEXTURE_WIDTH * TEXTURE_HEIGHT * BYTES_PER_TEXEL);
+
+		if (Allocation == NULL)
+			FailFastWithMessage("out of memory\n");
+
+		GenerateTexture(Allocation);
+		Texels = Allocation;
+	}
+
+	VkImageSubresourceLayers Subresource = { 0 };
+	Subresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	Subresource.mipLevel = 0;
+	Subresource.baseArrayLayer = 0;
+	Subresource.layerCount = 1;
+
+	{
+		VkHostImageLayoutTransitionInfoEXT Transition = { 0 };
+		Transition.sType = VK_STRUCTURE_TYPE_HOST_IMAGE_LAYOUT_TRANSITION_INFO_EXT;
+		Transition.image = Image;
+		Transition.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		Transition.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		Transition.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		Transition.subresourceRange.baseMipLevel = 0;
+		Transition.subresourceRange.levelCount = 1;
+		Transition.subresourceRange.baseArrayLayer = 0;
+		Transition.subresourceRange.layerCount = 1;
+		THROW_ON_FAIL_VK(VulkanObjects->TransitionImageLayout(VulkanObjects->Device, 1, &Transition));
+	}
+
+	{
+		VkMemoryToImageCopyEXT Region = { 0 };
+		Region.sType = VK_STRUCTURE_TYPE_MEMORY_TO_IMAGE_COPY_EXT;
+		Region.pHostPointer = Texels;
+		Region.memoryRowLength = 0;
+		Region.memoryImageHeight = 0;
+		Region.imageSubresource = Subresource;
+		Region.imageExtent.width = TEXTURE_WIDTH;
+		Region.imageExtent.height = TEXTURE_HEIGHT;
+		Region.imageExtent.depth = 1;
+
+		VkCopyMemoryToImageInfoEXT CopyInfo = { 0 };
+		CopyInfo.sType = VK_STRUCTURE_TYPE_COPY_MEMORY_TO_IMAGE_INFO_EXT;
+		CopyInfo.dstImage = Image;
+		CopyInfo.dstImageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		CopyInfo.regionCount = 1;
+		CopyInfo.pRegions = &Region;
+		THROW_ON_FAIL_VK(VulkanObjects->CopyMemoryToImage(VulkanObjects->Device, &CopyInfo));
+	}
+
+	free(Allocation);
+}
+
+void CreateTextureJob(void* Context)
+{
+	struct StartupContext* Startup = Context;
+	struct VulkanObjects* VulkanObjects = Startup->VulkanObjects;
+
+	VkDeviceSize ImageSize = TEXTURE_WIDTH * TEXTURE_HEIGHT * 4;
+
+	bool HostCopy = VulkanObjects->UseHostImageCopy;
+
+	if (!HostCopy)
+	{
+		VkMemoryPropertyFlags StagingFlags = CreateBuffer(VulkanObjects->Device, ImageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, MEMORY_USAGE_STAGING, MEMORY_CATEGORY_STAGING, &Startup->TextureStagingBuffer, &Startup->TextureStagingBufferMemory);
+
+		uint16_t* Data;
+		vkMapMemory(VulkanObjects->Device, Startup->TextureStagingBufferMemory, 0, VK_WHOLE_SIZE, 0, &Data);
+
+		// straight from the pack into the staging buffer
+		if (AssetPackHas(&AssetPack, ASSET_TEXTURE))
+		{
+			if (AssetPackSize(&AssetPack, ASSET_TEXTURE) != TEXTURE_WIDTH * TEXTURE_HEIGHT * BYTES_PER_TEXEL)
+				FailFastWithMessage("the asset pack texture doesn't match this build\n");
+
+			AssetPackRead(&AssetPack, ASSET_TEXTURE, Data);
+		}
+		else
+		{
+			GenerateTexture(Data);
+		}
+
+		if (!(StagingFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT))
+		{
+			struct MemoryFlushBatch Batch = { 0 };
+			AddMemoryFlush(VulkanObjects->Device, &Batch, Startup->TextureStagingBufferMemory, 0, ImageSize);
+			FlushMemoryBatch(VulkanObjects->Device, &Batch);
+		}
+
+		vkUnmapMemory(VulkanObjects->Device, Startup->TextureStagingBufferMemory);
+	}
+
+	{
+		VkImageCreateInfo ImageInfo = { 0 };
+		ImageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		ImageInfo.imageType = VK_IMAGE_TYPE_2D;
+		ImageInfo.extent.width = TEXTURE_WIDTH;
+		ImageInfo.extent.height = TEXTURE_HEIGHT;
+		ImageInfo.extent.depth = 1;
+		ImageInfo.mipLevels = 1;
+		ImageInfo.arrayLayers = 1;
+		ImageInfo.format = IMAGE_FORMAT;
+		ImageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+		ImageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		ImageInfo.usage = (HostCopy ? VK_IMAGE_USAGE_HOST_TRANSFER_BIT_EXT : VK_IMAGE_USAGE_TRANSFER_DST_BIT) | VK_IMAGE_USAGE_SAMPLED_BIT;
+		ImageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+		ImageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		THROW_ON_FAIL_VK(vkCreateImage(VulkanObjects->Device, &ImageInfo, NULL, &Startup->TextureImage));
+	}
+
+	{
+		VkMemoryRequirements MemRequirements;
+		vkGetImageMemoryRequirements(VulkanObjects->Device, Startup->TextureImage, &MemRequirements);
+
+		VkMemoryAllocateInfo AllocInfo = { 0 };
+		AllocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		AllocInfo.allocationSize = MemRequirements.size;
+		AllocInfo.memoryTypeIndex = SelectMemoryType(MemRequirements.memoryTypeBits, MEMORY_USAGE_GPU_ONLY);
+		THROW_ON_FAIL_VK(AllocateDeviceMemory(VulkanObjects->Device, &AllocInfo, MEMORY_CATEGORY_TEXTURE, &Startup->TextureImageMemory));
+	}
+
+	vkBindImageMemory(VulkanObjects->Device, Startup->TextureImage, Startup->TextureImageMemory, 0);
+
+	if (HostCopy)
+		CopyTextureFromHost(VulkanObjects, Startup->TextureImage);
+
+	{
+		VkImageViewCreateInfo ViewInfo = { 0 };
+		ViewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		ViewInfo.image = Startup->TextureImage;
+		ViewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+		ViewInfo.format = IMAGE_FORMAT;
+		ViewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		ViewInfo.subresourceRange.baseMipLevel = 0;
+		ViewInfo.subresourceRange.levelCount = 1;
+		ViewInfo.subresourceRange.baseArrayLayer = 0;
+		ViewInfo.subresourceRange.layerCount = 1;
+		THROW_ON_FAIL_VK(vkCreateImageView(VulkanObjects->Device, &ViewInfo, NULL, &Startup->TextureImageView));
+	}
+
+	{
+		VkPhysicalDeviceProperties DeviceProperties = { 0 };
+		vkGetPhysicalDeviceProperties(VulkanObjects->PhysicalDevice, &DeviceProperties);
+
+		VkSamplerCreateInfo SamplerInfo = { 0 };
+		SamplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+		SamplerInfo.magFilter = VK_FILTER_LINEAR;
+		SamplerInfo.minFilter = VK_FILTER_LINEAR;
+		SamplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+		SamplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+		SamplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+		SamplerInfo.anisotropyEnable = VK_TRUE;
+		SamplerInfo.maxAnisotropy = DeviceProperties.limits.maxSamplerAnisotropy;
+		SamplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+		SamplerInfo.unnormalizedCoordinates = VK_FALSE;
+		SamplerInfo.compareEnable = VK_FALSE;
+		SamplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
+		SamplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+		THROW_ON_FAIL_VK(vkCreateSampler(VulkanObjects->Device, &SamplerInfo, NULL, &Startup->TextureSampler));
+	}
+}
+
+/*
+* the compiled-in array, or the asset replacing it. the scene draws a fixed index count, so
+* the asset has to be the same size. Allocation is for the caller to free
+*/
+const void* GetMeshData(enum AssetId Id, const void* BuiltIn, size_t Size, void** Allocation)
+{
+	*Allocation = NULL;
+
+	if (!AssetPackHas(&AssetPack, Id))
+		return BuiltIn;
+
+	if (AssetPackSize(&AssetPack, Id) != Size)
+		FailFastWithMessage("the asset pack mesh doesn't match this build\n");
+
+	return AssetPackAcquire(&AssetPack, Id, Allocation);
+}
+
+void CreateVertexBufferJob(void* Context)
+{
+	struct StartupContext* Startup = Context;
+	struct VulkanObjects* VulkanObjects = Startup->VulkanObjects;
+
+	void* Allocation;
+	const void* Data = GetMeshData(ASSET_MESH_VERTICES, Vertices, sizeof(Vertices), &Allocation);
+
+	VkBufferUsageFlags Usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+
+	if (VulkanObjects->UseVertexPulling)
+		Usage |= VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+
+	CreateStaticBuffer(VulkanObjects->Device, Data, sizeof(Vertices), Usage, MEMORY_CATEGORY_VERTEX, &VulkanObjects->VertexBuffer, &VulkanObjects->VertexBufferMemory, &Startup->VertexStagingBuffer, &Startup->VertexStagingBufferMemory);
+
+	if (VulkanObjects->UseVertexPulling)
+		VulkanObjects->VertexBufferAddress = GetBufferAddress(VulkanObjects->Device, VulkanObjects->VertexBuffer);
+
+	free(Allocation);
+}
+
+void CreateIndexBufferJob(void* Context)
+{
+	struct StartupContext* Startup = Context;
+	struct VulkanObjects* VulkanObjects = Startup->VulkanObjects;
+
+	void* Allocation;
+	const void* Data = GetMeshData(ASSET_MESH_INDICES, Indices, sizeof(Indices), &Allocation);
+
+	VkBufferUsageFlags Usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
+
+	if (VulkanObjects->UseVertexPulling)
+		Usage |= VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+
+	CreateStaticBuffer(VulkanObjects->Device, Data, sizeof(Indices), Usage, MEMORY_CATEGORY_INDEX, &VulkanObjects->IndexBuffer, &VulkanObjects->IndexBufferMemory, &Startup->IndexStagingBuffer, &Startup->IndexStagingBufferMemory);
+
+	if (VulkanObjects->UseVertexPulling)
+		VulkanObjects->IndexBufferAddress = GetBufferAddress(VulkanObjects->Device, VulkanObjects->IndexBuffer);
+
+	free(Allocation);
+}
+
+/*
+* the command pool is externally synchronized, so all three copies are recorded by this one
+* job into a single submission
+*/
+void RecordUploadsJob(void* Context)
+{
+	struct StartupContext* Startup = Context;
+	struct VulkanObjects* VulkanObjects = Startup->VulkanObjects;
+
+	VkCommandBuffer CommandBuffer = BeginSingleTimeCommands(VulkanObjects->Device, VulkanObjects->CommandPool);
+
+	// a texture copied from the host is already in its sampled layout
+	if (Startup->TextureStagingBuffer != VK_NULL_HANDLE)
+	{
+		struct TextureUploadContext UploadContext = { 0 };
+		UploadContext.StagingBuffer = Startup->TextureStagingBuffer;
+		UploadContext.Image = Startup->TextureImage;
+		UploadContext.Width = TEXTURE_WIDTH;
+		UploadContext.Height = TEXTURE_HEIGHT;
+
+		struct RenderGraph UploadGraph = { 0 };
+		uint32_t TextureResource = RenderGraphImportImage(&UploadGraph, "Texture", IMAGE_FORMAT, VK_IMAGE_ASPECT_COLOR_BIT, RENDER_GRAPH_ACCESS_NONE, RENDER_GRAPH_ACCESS_FRAGMENT_SHADER_READ);
+		RenderGraphSetImage(&UploadGraph, TextureResource, Startup->TextureImage, VK_NULL_HANDLE);
+
+		uint32_t UploadPass = RenderGraphAddPass(&UploadGraph, "TextureUpload", RecordTextureUpload, &UploadContext);
+		RenderGraphUseResource(&UploadGraph, UploadPass, TextureResource, RENDER_GRAPH_ACCESS_TRANSFER_WRITE);
+
+		RenderGraphCompile(&UploadGraph);
+		RenderGraphExecute(&UploadGraph, CommandBuffer, NULL);
+	}
+
+	// buffers written in place have no staging buffer to copy from
+	if (Startup->VertexStagingBuffer != VK_NULL_HANDLE)
+	{
+		VkBufferCopy CopyRegion = { 0 };
+		CopyRegion.size = sizeof(Vertices);
+		vkCmdCopyBuffer(CommandBuffer, Startup->VertexStagingBuffer, VulkanObjects->VertexBuffer, 1, &CopyRegion);
+	}
+
+	if (Startup->IndexStagingBuffer != VK_NULL_HANDLE)
+	{
+		VkBufferCopy CopyRegion = { 0 };
+		CopyRegion.size = sizeof(Indices);
+		vkCmdCopyBuffer(CommandBuffer, Startup->IndexStagingBuffer, VulkanObjects->IndexBuffer, 1, &CopyRegion);
+	}
+
+	{
+		VkMemoryBarrier Barrier = { 0 };
+		Barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		Barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		Barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT;
+
+		VkPipelineStageFlags DstStages = VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
+
+		// pulled vertices are read by the vertex shader instead
+		if (VulkanObjects->UseVertexPulling)
+		{
+			Barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+			DstStages = VK_PIPELINE_STAGE_VERTEX_SHADER_BIT;
+		}
+
+		vkCmdPipelineBarrier(CommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, DstStages, 0, 1, &Barrier, 0, NULL, 0, NULL);
+	}
+
+	uint64_t UploadValue = EndSingleTimeCommands(VulkanObjects, CommandBuffer);
+	DeferDeletion(VulkanObjects, UploadValue, Startup->TextureStagingBuffer, Startup->TextureStagingBufferMemory, VK_NULL_HANDLE);
+	DeferDeletion(VulkanObjects, UploadValue, Startup->VertexStagingBuffer, Startup->VertexStagingBufferMemory, VK_NULL_HANDLE);
+	DeferDeletion(VulkanObjects, UploadValue, Startup->IndexStagingBuffer, Startup->IndexStagingBufferMemory, VK_NULL_HANDLE);
+}
+
+void CreateUniformBuffersJob(void* Context)
+{
+	struct StartupContext* Startup = Context;
+	struct VulkanObjects* VulkanObjects = Startup->VulkanObjects;
+
+	for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+	{
+		VkMemoryPropertyFlags Flags = CreateBuffer(VulkanObjects->Device, sizeof(struct UniformBufferObject), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, MEMORY_USAGE_CPU_TO_GPU, MEMORY_CATEGORY_UNIFORM, &Startup->UniformBuffers[i], &Startup->UniformBuffersMemory[i]);
+		vkMapMemory(VulkanObjects->Device, Startup->UniformBuffersMemory[i], 0, VK_WHOLE_SIZE, 0, &VulkanObjects->UniformBuffersMapped[i]);
+
+		VulkanObjects->UniformBuffersMemory[i] = Startup->UniformBuffersMemory[i];
+		VulkanObjects->UniformBuffersCoherent = (Flags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0;
+	}
+
+	// the scene is built before the startup jobs run, so its size is known here
+	for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+	{
+		VkMemoryPropertyFlags Flags = CreateBuffer(VulkanObjects->Device, VulkanObjects->Scene.Count * sizeof(mat4), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, MEMORY_USAGE_CPU_TO_GPU, MEMORY_CATEGORY_INSTANCE, &Startup->InstanceBuffers[i], &Startup->InstanceBuffersMemory[i]);
+		vkMapMemory(VulkanObjects->Device, Startup->InstanceBuffersMemory[i], 0, VK_WHOLE_SIZE, 0, &VulkanObjects->InstanceBuffersMapped[i]);
+
+		VulkanObjects->InstanceBuffersMemory[i] = Startup->InstanceBuffersMemory[i];
+		VulkanObjects->InstanceBuffersCoherent = (Flags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0;
+	}
+}
+
+void CreateDescriptorSetsJob(void* Context)
+{
+	struct StartupContext* Startup = Context;
+	struct VulkanObjects* VulkanObjects = Startup->VulkanObjects;
+
+	{
+		VkDescriptorPoolSize PoolSizes[3] = { 0 };
+		PoolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		PoolSizes[0].descriptorCount = MAX_FRAMES_IN_FLIGHT;
+		PoolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		PoolSizes[1].descriptorCount = MAX_FRAMES_IN_FLIGHT;
+		PoolSizes[2].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		PoolSizes[2].descriptorCount = MAX_FRAMES_IN_FLIGHT;
+
+		VkDescriptorPoolCreateInfo PoolInfo = { 0 };
+		PoolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		PoolInfo.poolSizeCount = ARRAYSIZE(PoolSizes);
+		PoolInfo.pPoolSizes = PoolSizes;
+		PoolInfo.maxSets = MAX_FRAMES_IN_FLIGHT;
+		THROW_ON_FAIL_VK(vkCreateDescriptorPool(VulkanObjects->Device, &PoolInfo, NULL, &Startup->DescriptorPool));
+	}
+
+	{
+		VkDescriptorSetLayout DescriptorSetLayouts[MAX_FRAMES_IN_FLIGHT] = { 0 };
+
+		for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+		{
+			DescriptorSetLayouts[i] = Startup->DescriptorSetLayout;
+		}
+
+		{
+			VkDescriptorSetAllocateInfo AllocInfo = { 0 };
+			AllocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+			AllocInfo.descriptorPool = Startup->DescriptorPool;
+			AllocInfo.descriptorSetCount = MAX_FRAMES_IN_FLIGHT;
+			AllocInfo.pSetLayouts = DescriptorSetLayouts;
+			THROW_ON_FAIL_VK(vkAllocateDescriptorSets(VulkanObjects->Device, &AllocInfo, VulkanObjects->DescriptorSets));
+		}
+	}
+
+	for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+	{
+		VkDescriptorBufferInfo BufferInfo = { 0 };
+		BufferInfo.buffer = Startup->UniformBuffers[i];
+		BufferInfo.offset = 0;
+		BufferInfo.range = sizeof(struct UniformBufferObject);
+
+		VkDescriptorImageInfo ImageInfo = { 0 };
+		ImageInfo.sampler = Startup->TextureSampler;
+		ImageInfo.imageView = Startup->TextureImageView;
+		ImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+		VkDescriptorBufferInfo InstanceInfo = { 0 };
+		InstanceInfo.buffer = Startup->InstanceBuffers[i];
+		InstanceInfo.offset = 0;
+		InstanceInfo.range = VK_WHOLE_SIZE;
+
+		VkWriteDescriptorSet DescriptorWrites[3] = { 0 };
+		DescriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		DescriptorWrites[0].dstSet = VulkanObjects->DescriptorSets[i];
+		DescriptorWrites[0].dstBinding = 0;
+		DescriptorWrites[0].dstArrayElement = 0;
+		DescriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		DescriptorWrites[0].descriptorCount = 1;
+		DescriptorWrites[0].pBufferInfo = &BufferInfo;
+
+		DescriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		DescriptorWrites[1].dstSet = VulkanObjects->DescriptorSets[i];
+		DescriptorWrites[1].dstBinding = 1;
+		DescriptorWrites[1].dstArrayElement = 0;
+		DescriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		DescriptorWrites[1].descriptorCount = 1;
+		DescriptorWrites[1].pImageInfo = &ImageInfo;
+
+		DescriptorWrites[2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		DescriptorWrites[2].dstSet = VulkanObjects->DescriptorSets[i];
+		DescriptorWrites[2].dstBinding = 2;
+		DescriptorWrites[2].dstArrayElement = 0;
+		DescriptorWrites[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		DescriptorWrites[2].descriptorCount = 1;
+		DescriptorWrites[2].pBufferInfo = &InstanceInfo;
+
+		vkUpdateDescriptorSets(VulkanObjects->Device, ARRAYSIZE(DescriptorWrites), DescriptorWrites, 0, NULL);
+	}
+}
+
+// shared by the graphics and compute families without ownership transfers
+static void CreateParticleBuffer(const struct VulkanObjects* VulkanObjects, VkDeviceSize Size, VkBufferUsageFlags Usage, VkBuffer* Buffer, VkDeviceMemory* BufferMemory)
+{
+	uint32_t QueueFamilies[] = { VulkanObjects->QueueFamilyIndices.GraphicsFamily, VulkanObjects->QueueFamilyIndices.ComputeFamily };
+
+	{
+		VkBufferCreateInfo BufferInfo = { 0 };
+		BufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		BufferInfo.size = Size;
+		BufferInfo.usage = Usage;
+
+		if (QueueFamilies[0] != QueueFamilies[1])
+		{
+			BufferInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+			BufferInfo.queueFamilyIndexCount = ARRAYSIZE(QueueFamilies);
+			BufferInfo.pQueueFamilyIndices = QueueFamilies;
+		}
+		else
+		{
+			BufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		}
+
+		THROW_ON_FAIL_VK(vkCreateBuffer(VulkanObjects->Device, &BufferInfo, NULL, Buffer));
+	}
+
+	{
+		VkMemoryRequirements MemRequirements;
+		vkGetBufferMemoryRequirements(VulkanObjects->Device, *Buffer, &MemRequirements);
+
+		VkMemoryAllocateInfo AllocInfo = { 0 };
+		AllocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		AllocInfo.allocationSize = MemRequirements.size;
+		AllocInfo.memoryTypeIndex = SelectMemoryType(MemRequirements.memoryTypeBits, MEMORY_USAGE_GPU_ONLY);
+		THROW_ON_FAIL_VK(AllocateDeviceMemory(VulkanObjects->Device, &AllocInfo, MEMORY_CATEGORY_STORAGE, BufferMemory));
+	}
+
+	vkBindBufferMemory(VulkanObjects->Device, *Buffer, *BufferMemory, 0);
+}
+
+#define PARTICLE_SHADER_COUNT 4
+
+// in the order CreateParticlePipelines takes their modules
+static const enum ShaderId PARTICLE_SHADERS[PARTICLE_SHADER_COUNT] = {
+	SHADER_PARTICLE_SIMULATE,
+	SHADER_PARTICLE_EMIT,
+	SHADER_PARTICLE_VERTEX,
+	SHADER_PARTICLE_FRAGMENT
+};
+
+/*
+* needs the pipeline layouts. called again when the shaders are hot-swapped, so a failure is
+* returned, and the pipelines are only written when all three were created
+*/
+VkResult CreateParticlePipelines(const struct VulkanObjects* VulkanObjects, const VkShaderModule Modules[PARTICLE_SHADER_COUNT], VkPipeline* SimulatePipeline, VkPipeline* EmitPipeline, VkPipeline* GraphicsPipeline)
+{
+	const struct ParticleSystem* Particles = &VulkanObjects->Particles;
+	VkDevice Device = VulkanObjects->Device;
+
+	VkPipeline ComputePipelines[2];
+
+	{
+		VkComputePipelineCreateInfo PipelineInfos[2] = { 0 };
+
+		for (int i = 0; i < ARRAYSIZE(PipelineInfos); i++)
+		{
+			PipelineInfos[i].sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+			PipelineInfos[i].stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+			PipelineInfos[i].stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+			PipelineInfos[i].stage.module = Modules[i];
+			PipelineInfos[i].stage.pName = "main";
+			PipelineInfos[i].layout = Particles->ComputePipelineLayout;
+		}
+
+		VkResult Result = vkCreateComputePipelines(Device, VK_NULL_HANDLE, ARRAYSIZE(PipelineInfos), PipelineInfos, NULL, ComputePipelines);
+
+		if (Result != VK_SUCCESS)
+		{
+			// whichever of the two did get created is returned alongside a null handle
+			vkDestroyPipeline(Device, ComputePipelines[1], NULL);
+			vkDestroyPipeline(Device, ComputePipelines[0], NULL);
+			return Result;
+		}
+	}
+
+	{
+		VkPipelineShaderStageCreateInfo ShaderStages[2] = { 0 };
+		ShaderStages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		ShaderStages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+		ShaderStages[0].module = Modules[2];
+		ShaderStages[0].pName = "main";
+
+		ShaderStages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		ShaderStages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+		ShaderStages[1].module = Modules[3];
+		ShaderStages[1].pName = "main";
+
+		// one instance per particle, read straight out of the buffer the simulation wrote
+		VkVertexInputBindingDescription BindingDescription = { 0 };
+		BindingDescription.binding = 0;
+		BindingDescription.stride = sizeof(struct Particle);
+		BindingDescription.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+
+		VkVertexInputAttributeDescription AttributeDescriptions[2] = { 0 };
+		AttributeDescriptions[0].binding = 0;
+		AttributeDescriptions[0].location = 0;
+		AttributeDescriptions[0].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+		AttributeDescriptions[0].offset = offsetof(struct Particle, PositionLife);
+
+		AttributeDescriptions[1].binding = 0;
+		AttributeDescriptions[1].location = 1;
+		AttributeDescriptions[1].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+		AttributeDescriptions[1].offset = offsetof(struct Particle, VelocityMaxLife);
+
+		VkPipelineVertexInputStateCreateInfo VertexInputInfo = { 0 };
+		VertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+		VertexInputInfo.vertexBindingDescriptionCount = 1;
+		VertexInputInfo.pVertexBindingDescriptions = &BindingDescription;
+		VertexInputInfo.vertexAttributeDescriptionCount = ARRAYSIZE(AttributeDescriptions);
+		VertexInputInfo.pVertexAttributeDescriptions = AttributeDescriptions;
+
+		VkPipelineInputAssemblyStateCreateInfo InputAssembly = { 0 };
+		InputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+		InputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP;
+		InputAssembly.primitiveRestartEnable = VK_FALSE;
+
+		VkPipelineViewportStateCreateInfo ViewportState = { 0 };
+		ViewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+		ViewportState.viewportCount = 1;
+		ViewportState.scissorCount = 1;
+
+		VkPipelineRasterizationStateCreateInfo Rasterizer = { 0 };
+		Rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+		Rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
+		Rasterizer.lineWidth = 1.0f;
+		Rasterizer.cullMode = VK_CULL_MODE_NONE;
+		Rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+
+		VkPipelineMultisampleStateCreateInfo Multisampling = { 0 };
+		Multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+		Multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+		// tested against the scene but not written, so the additive sprites need no sorting
+		VkPipelineDepthStencilStateCreateInfo DepthStencil = { 0 };
+		DepthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+		DepthStencil.depthTestEnable = VK_TRUE;
+		DepthStencil.depthWriteEnable = VK_FALSE;
+		DepthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
+
+		VkPipelineColorBlendAttachmentState ColorBlendAttachment = { 0 };
+		ColorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+		ColorBlendAttachment.blendEnable = VK_TRUE;
+		ColorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+		ColorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE;
+		ColorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+		ColorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+		ColorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+		ColorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+
+		VkPipelineColorBlendStateCreateInfo ColorBlending = { 0 };
+		ColorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+		ColorBlending.attachmentCount = 1;
+		ColorBlending.pAttachments = &ColorBlendAttachment;
+
+		VkDynamicState DynamicStates[] = {
+			VK_DYNAMIC_STATE_VIEWPORT,
+			VK_DYNAMIC_STATE_SCISSOR
+		};
+
+		VkPipelineDynamicStateCreateInfo DynamicState = { 0 };
+		DynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+		DynamicState.dynamicStateCount = ARRAYSIZE(DynamicStates);
+		DynamicState.pDynamicStates = DynamicStates;
+
+		VkPipelineRenderingCreateInfo RenderingInfo = { 0 };
+		RenderingInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO;
+		RenderingInfo.colorAttachmentCount = 1;
+		RenderingInfo.pColorAttachmentFormats = &VulkanObjects->SwapChainImageFormat.format;
+		RenderingInfo.depthAttachmentFormat = VulkanObjects->DepthFormat;
+		RenderingInfo.stencilAttachmentFormat = VK_FORMAT_UNDEFINED;
+
+		VkGraphicsPipelineCreateInfo PipelineInfo = { 0 };
+		PipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+		PipelineInfo.pNext = VulkanObjects->UseDynamicRendering ? &RenderingInfo : NULL;
+		PipelineInfo.stageCount = ARRAYSIZE(ShaderStages);
+		PipelineInfo.pStages = ShaderStages;
+		PipelineInfo.pVertexInputState = &VertexInputInfo;
+		PipelineInfo.pInputAssemblyState = &InputAssembly;
+		PipelineInfo.pViewportState = &ViewportState;
+		PipelineInfo.pRasterizationState = &Rasterizer;
+		PipelineInfo.pMultisampleState = &Multisampling;
+		PipelineInfo.pDepthStencilState = &DepthStencil;
+		PipelineInfo.pColorBlendState = &ColorBlending;
+		PipelineInfo.pDynamicState = &DynamicState;
+		PipelineInfo.layout = Particles->GraphicsPipelineLayout;
+		PipelineInfo.renderPass = VulkanObjects->UseDynamicRendering ? VK_NULL_HANDLE : VulkanObjects->RenderPass;
+		PipelineInfo.subpass = 0;
+
+		VkResult Result = vkCreateGraphicsPipelines(Device, VK_NULL_HANDLE, 1, &PipelineInfo, NULL, GraphicsPipeline);
+
+		if (Result != VK_SUCCESS)
+		{
+			vkDestroyPipeline(Device, ComputePipelines[1], NULL);
+			vkDestroyPipeline(Device, ComputePipelines[0], NULL);
+			return Result;
+		}
+	}
+
+	*SimulatePipeline = ComputePipelines[0];
+	*EmitPipeline = ComputePipelines[1];
+	return VK_SUCCESS;
+}
+
+void CreateParticleSystemJob(void* Context)
+{
+	struct StartupContext* Startup = Context;
+	struct VulkanObjects* VulkanObjects = Startup->VulkanObjects;
+	struct ParticleSystem* Particles = &VulkanObjects->Particles;
+	VkDevice Device = VulkanObjects->Device;
+
+	for (int i = 0; i < 2; i++)
+	{
+		CreateParticleBuffer(VulkanObjects, (VkDeviceSize)Particles->Capacity * sizeof(struct Particle), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, &Particles->ParticleBuffers[i], &Particles->ParticleBuffersMemory[i]);
+		CreateParticleBuffer(VulkanObjects, sizeof(VkDrawIndirectCommand), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, &Particles->DrawArgsBuffers[i], &Particles->DrawArgsBuffersMemory[i]);
+	}
+
+	{
+		VkDescriptorSetLayoutBinding Bindings[4] = { 0 };
+
+		for (int i = 0; i < ARRAYSIZE(Bindings); i++)
+		{
+			Bindings[i].binding = i;
+			Bindings[i].descriptorCount = 1;
+			Bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			Bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+		}
+
+		VkDescriptorSetLayoutCreateInfo LayoutInfo = { 0 };
+		LayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		LayoutInfo.bindingCount = ARRAYSIZE(Bindings);
+		LayoutInfo.pBindings = Bindings;
+		THROW_ON_FAIL_VK(vkCreateDescriptorSetLayout(Device, &LayoutInfo, NULL, &Particles->DescriptorSetLayout));
+	}
+
+	{
+		VkDescriptorPoolSize PoolSize = { 0 };
+		PoolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		PoolSize.descriptorCount = 8;
+
+		VkDescriptorPoolCreateInfo PoolInfo = { 0 };
+		PoolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		PoolInfo.poolSizeCount = 1;
+		PoolInfo.pPoolSizes = &PoolSize;
+		PoolInfo.maxSets = ARRAYSIZE(Particles->DescriptorSets);
+		THROW_ON_FAIL_VK(vkCreateDescriptorPool(Device, &PoolInfo, NULL, &Particles->DescriptorPool));
+	}
+
+	{
+		VkDescriptorSetLayout Layouts[] = { Particles->DescriptorSetLayout, Particles->DescriptorSetLayout };
+
+		VkDescriptorSetAllocateInfo AllocInfo = { 0 };
+		AllocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		AllocInfo.descriptorPool = Particles->DescriptorPool;
+		AllocInfo.descriptorSetCount = ARRAYSIZE(Layouts);
+		AllocInfo.pSetLayouts = Layouts;
+		THROW_ON_FAIL_VK(vkAllocateDescriptorSets(Device, &AllocInfo, Particles->DescriptorSets));
+	}
+
+	for (uint32_t Read = 0; Read < 2; Read++)
+	{
+		uint32_t Write = Read ^ 1;
+
+		VkDescriptorBufferInfo BufferInfos[4] = {
+			{ Particles->ParticleBuffers[Read], 0, VK_WHOLE_SIZE },
+			{ Particles->ParticleBuffers[Write], 0, VK_WHOLE_SIZE },
+			{ Particles->DrawArgsBuffers[Read], 0, VK_WHOLE_SIZE },
+			{ Particles->DrawArgsBuffers[Write], 0, VK_WHOLE_SIZE }
+		};
+
+		VkWriteDescriptorSet DescriptorWrite = { 0 };
+		DescriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		DescriptorWrite.dstSet = Particles->DescriptorSets[Read];
+		DescriptorWrite.dstBinding = 0;
+		DescriptorWrite.dstArrayElement = 0;
+		DescriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		DescriptorWrite.descriptorCount = ARRAYSIZE(BufferInfos);
+		DescriptorWrite.pBufferInfo = BufferInfos;
+		vkUpdateDescriptorSets(Device, 1, &DescriptorWrite, 0, NULL);
+	}
+
+	{
+		VkPushConstantRange PushConstantRange = { 0 };
+		PushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+		PushConstantRange.offset = 0;
+		PushConstantRange.size = sizeof(struct ParticleSimulationConstants);
+
+		VkPipelineLayoutCreateInfo PipelineLayoutInfo = { 0 };
+		PipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		PipelineLayoutInfo.setLayoutCount = 1;
+		PipelineLayoutInfo.pSetLayouts = &Particles->DescriptorSetLayout;
+		PipelineLayoutInfo.pushConstantRangeCount = 1;
+		PipelineLayoutInfo.pPushConstantRanges = &PushConstantRange;
+		THROW_ON_FAIL_VK(vkCreatePipelineLayout(Device, &PipelineLayoutInfo, NULL, &Particles->ComputePipelineLayout));
+	}
+
+	{
+		VkPushConstantRange PushConstantRange = { 0 };
+		PushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+		PushConstantRange.offset = 0;
+		PushConstantRange.size = sizeof(struct ParticleDrawConstants);
+
+		VkPipelineLayoutCreateInfo PipelineLayoutInfo = { 0 };
+		PipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		PipelineLayoutInfo.pushConstantRangeCount = 1;
+		PipelineLayoutInfo.pPushConstantRanges = &PushConstantRange;
+		THROW_ON_FAIL_VK(vkCreatePipelineLayout(Device, &PipelineLayoutInfo, NULL, &Particles->GraphicsPipelineLayout));
+	}
+
+	{
+		VkShaderModule Modules[PARTICLE_SHADER_COUNT];
+
+		for (uint32_t i = 0; i < PARTICLE_SHADER_COUNT; i++)
+		{
+			Modules[i] = CreateShaderModule(Device, PARTICLE_SHADERS[i]);
+		}
+
+		THROW_ON_FAIL_VK(CreateParticlePipelines(VulkanObjects, Modules, &Particles->SimulatePipeline, &Particles->EmitPipeline, &Particles->GraphicsPipeline));
+
+		for (uint32_t i = 0; i < PARTICLE_SHADER_COUNT; i++)
+		{
+			vkDestroyShaderModule(Device, Modules[i], NULL);
+		}
+	}
+
+	{
+		VkCommandPoolCreateInfo PoolInfo = { 0 };
+		PoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		PoolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+		PoolInfo.queueFamilyIndex = VulkanObjects->QueueFamilyIndices.ComputeFamily;
+		THROW_ON_FAIL_VK(vkCreateCommandPool(Device, &PoolInfo, NULL, &Particles->CommandPool));
+
+		VkCommandBufferAllocateInfo AllocInfo = { 0 };
+		AllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		AllocInfo.commandPool = Particles->CommandPool;
+		AllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		AllocInfo.commandBufferCount = ARRAYSIZE(Particles->CommandBuffers);
+		THROW_ON_FAIL_VK(vkAllocateCommandBuffers(Device, &AllocInfo, Particles->CommandBuffers));
+	}
+
+	Particles->Timeline.Semaphore = CreateTimelineSemaphore(Device);
+	Particles->Timeline.Value = 0;
+
+	{
+		uint32_t QueueFamilyCount = MAX_QUEUE_FAMILY_COUNT;
+		VkQueueFamilyProperties QueueFamilies[MAX_QUEUE_FAMILY_COUNT];
+		vkGetPhysicalDeviceQueueFamilyProperties(VulkanObjects->PhysicalDevice, &QueueFamilyCount, QueueFamilies);
+
+		VkPhysicalDeviceProperties DeviceProperties = { 0 };
+		vkGetPhysicalDeviceProperties(VulkanObjects->PhysicalDevice, &DeviceProperties);
+
+		// without timestamps the simulation still runs, it just isn't timed
+		if (QueueFamilies[VulkanObjects->QueueFamilyIndices.ComputeFamily].timestampValidBits > 0)
+		{
+			VkQueryPoolCreateInfo QueryPoolInfo = { 0 };
+			QueryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+			QueryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+			QueryPoolInfo.queryCount = MAX_FRAMES_IN_FLIGHT * 2;
+			THROW_ON_FAIL_VK(vkCreateQueryPool(Device, &QueryPoolInfo, NULL, &Particles->QueryPool));
+
+			Particles->TimestampPeriod = DeviceProperties.limits.timestampPeriod;
+		}
+	}
+
+	LogMessage("particles: %u, simulated on queue family %u (%s)\n", Particles->Capacity, VulkanObjects->QueueFamilyIndices.ComputeFamily,
+		VulkanObjects->QueueFamilyIndices.ComputeFamily != VulkanObjects->QueueFamilyIndices.GraphicsFamily ? "async compute" : "shared with graphics");
+}
+
+void DestroyParticleSystem(struct ParticleSystem* Particles, VkDevice Device)
+{
+	vkDestroyQueryPool(Device, Particles->QueryPool, NULL);
+	vkDestroySemaphore(Device, Particles->Timeline.Semaphore, NULL);
+	vkDestroyCommandPool(Device, Particles->CommandPool, NULL);
+
+	vkDestroyPipeline(Device, Particles->GraphicsPipeline, NULL);
+	vkDestroyPipelineLayout(Device, Particles->GraphicsPipelineLayout, NULL);
+	vkDestroyPipeline(Device, Particles->EmitPipeline, NULL);
+	vkDestroyPipeline(Device, Particles->SimulatePipeline, NULL);
+	vkDestroyPipelineLayout(Device, Particles->ComputePipelineLayout, NULL);
+
+	vkDestroyDescriptorPool(Device, Particles->DescriptorPool, NULL);
+	vkDestroyDescriptorSetLayout(Device, Particles->DescriptorSetLayout, NULL);
+
+	for (int i = 0; i < 2; i++)
+	{
+		vkDestroyBuffer(Device, Particles->DrawArgsBuffers[i], NULL);
+		FreeDeviceMemory(Device, Particles->DrawArgsBuffersMemory[i]);
+		vkDestroyBuffer(Device, Particles->ParticleBuffers[i], NULL);
+		FreeDeviceMemory(Device, Particles->ParticleBuffersMemory[i]);
+	}
+}
+
+/*
+* rebuilds every pipeline from the current shader sources. runs on the render thread between
+* frames. every new pipeline is built before any old one is destroyed, so a shader that doesn't
+* compile or link leaves the old pipelines and the registry as they were
+*/
+void ReloadShaders(struct VulkanObjects* VulkanObjects)
+{
+	VkDevice Device = VulkanObjects->Device;
+	struct ParticleSystem* Particles = &VulkanObjects->Particles;
+
+	struct PipelineState State = GetSceneMaterialState(VulkanObjects, 0);
+
+	enum ShaderId Shaders[2 + PARTICLE_SHADER_COUNT] = { State.VertexShader, State.FragmentShader };
+	uint32_t ShaderCount = 2;
+
+	if (Particles->Capacity > 0)
+	{
+		for (uint32_t i = 0; i < PARTICLE_SHADER_COUNT; i++)
+		{
+			Shaders[ShaderCount++] = PARTICLE_SHADERS[i];
+		}
+	}
+
+	VkShaderModule Modules[ARRAYSIZE(Shaders)] = { 0 };
+	bool Loaded = true;
+
+	for (uint32_t i = 0; i < ShaderCount; i++)
+	{
+		Modules[i] = TryReloadShaderModule(Device, Shaders[i]);
+		Loaded &= Modules[i] != VK_NULL_HANDLE;
+	}
+
+	VkPipeline GraphicsPipeline = VK_NULL_HANDLE;
+	VkPipeline SimulatePipeline = VK_NULL_HANDLE;
+	VkPipeline EmitPipeline = VK_NULL_HANDLE;
+	VkPipeline ParticleGraphicsPipeline = VK_NULL_HANDLE;
+	VkResult Result = VK_SUCCESS;
+
+	if (Loaded)
+	{
+		Result = CreateScenePipelineParts(VulkanObjects, &State, 0, Modules[0], Modules[1], &GraphicsPipeline);
+
+		if (Result == VK_SUCCESS && Particles->Capacity > 0)
+			Result = CreateParticlePipelines(VulkanObjects, &Modules[2], &SimulatePipeline, &EmitPipeline, &ParticleGraphicsPipeline);
+	}
+
+	for (uint32_t i = 0; i < ShaderCount; i++)
+	{
+		vkDestroyShaderModule(Device, Modules[i], NULL);
+	}
+
+	if (!Loaded || Result != VK_SUCCESS)
+	{
+		if (Result != VK_SUCCESS)
+			LogMessage("creating the reloaded pipelines failed (%d)\n", Result);
+
+		vkDestroyPipeline(Device, GraphicsPipeline, NULL);
+		LogMessage("shader reload failed, keeping the old pipelines\n");
+		return;
+	}
+
+	// a pipeline can't be destroyed while a frame in flight still uses it
+	THROW_ON_FAIL_VK(vkDeviceWaitIdle(Device));
+
+	// a new pipeline may get the handle of one that was destroyed
+	VulkanObjects->FrameCache.Version++;
+
+	// variants are compiled again the next time a frame asks for them
+	PipelineRegistryClear(VulkanObjects->Pipelines);
+
+	vkDestroyPipeline(Device, VulkanObjects->GraphicsPipeline, NULL);
+	VulkanObjects->GraphicsPipeline = GraphicsPipeline;
+
+	PipelineRegistryPrecompile(VulkanObjects->Pipelines);
+
+	if (Particles->Capacity > 0)
+	{
+		vkDestroyPipeline(Device, Particles->GraphicsPipeline, NULL);
+		vkDestroyPipeline(Device, Particles->EmitPipeline, NULL);
+		vkDestroyPipeline(Device, Particles->SimulatePipeline, NULL);
+
+		Particles->SimulatePipeline = SimulatePipeline;
+		Particles->EmitPipeline = EmitPipeline;
+		Particles->GraphicsPipeline = ParticleGraphicsPipeline;
+	}
+
+	LogMessage("shaders reloaded from %ls\n", ShaderDirectory);
+}
+
+/*
+* everything below only needs the device. shader loading, pipeline compilation, texture
+* generation and buffer preparation run concurrently; the uploads are recorded once their
+* sources exist and the descriptor sets once the texture and uniform buffers do
+*/
+void RunStartupJobs(struct JobSystem* JobSystem, struct StartupContext* Startup)
+{
+	struct JobCounter Counter = { 0 };
+
+	struct PipelineState State = GetSceneMaterialState(Startup->VulkanObjects, 0);
+	struct ShaderLoadContext VertexShaderLoad = { Startup->VulkanObjects->Device, State.VertexShader, &Startup->VertexShaderModule };
+	struct ShaderLoadContext FragmentShaderLoad = { Startup->VulkanObjects->Device, State.FragmentShader, &Startup->FragmentShaderModule };
+
+	struct Job* VertexShaderJob = JobCreate(JobSystem, "LoadVertexShader", LoadShaderJob, &VertexShaderLoad, &Counter);
+	struct Job* FragmentShaderJob = JobCreate(JobSystem, "LoadFragmentShader", LoadShaderJob, &FragmentShaderLoad, &Counter);
+	struct Job* PipelineJob = JobCreate(JobSystem, "CreatePipeline", CreatePipelineJob, Startup, &Counter);
+	struct Job* TextureJob = JobCreate(JobSystem, "CreateTexture", CreateTextureJob, Startup, &Counter);
+	struct Job* VertexBufferJob = JobCreate(JobSystem, "CreateVertexBuffer", CreateVertexBufferJob, Startup, &Counter);
+	struct Job* IndexBufferJob = JobCreate(JobSystem, "CreateIndexBuffer", CreateIndexBufferJob, Startup, &Counter);
+	struct Job* UploadJob = JobCreate(JobSystem, "RecordUploads", RecordUploadsJob, Startup, &Counter);
+	struct Job* UniformBuffersJob = JobCreate(JobSystem, "CreateUniformBuffers", CreateUniformBuffersJob, Startup, &Counter);
+	struct Job* DescriptorSetsJob = JobCreate(JobSystem, "CreateDescriptorSets", CreateDescriptorSetsJob, Startup, &Counter);
+
+	JobAddDependency(PipelineJob, VertexShaderJob);
+	JobAddDependency(PipelineJob, FragmentShaderJob);
+
+	JobAddDependency(UploadJob, TextureJob);
+	JobAddDependency(UploadJob, VertexBufferJob);
+	JobAddDependency(UploadJob, IndexBufferJob);
+
+	JobAddDependency(DescriptorSetsJob, TextureJob);
+	JobAddDependency(DescriptorSetsJob, UniformBuffersJob);
+
+	struct Job* Jobs[] = { VertexShaderJob, FragmentShaderJob, PipelineJob, TextureJob, VertexBufferJob, IndexBufferJob, UploadJob, UniformBuffersJob, DescriptorSetsJob };
+
+	for (int i = 0; i < ARRAYSIZE(Jobs); i++)
+	{
+		JobSubmit(JobSystem, Jobs[i]);
+	}
+
+	// independent of everything above; it records nothing until the first frame
+	if (Startup->VulkanObjects->Particles.Capacity > 0)
+		JobSubmit(JobSystem, JobCreate(JobSystem, "CreateParticleSystem", CreateParticleSystemJob, Startup, &Counter));
+
+	PROFILE_ZONE("WaitForStartupJobs")
+	{
+		JobSystemWait(JobSystem, &Counter);
+	}
+}
+
+#define DRAW_BENCHMARK_RUNS 5
+#define DRAW_BENCHMARK_EXTENT 64
+
+// what changes between consecutive draws; each alternates between two objects
+enum DrawBenchmarkState
+{
+	DRAW_BENCHMARK_STATE_PIPELINE = 1 << 0,
+	DRAW_BENCHMARK_STATE_DESCRIPTOR_SET = 1 << 1,
+	DRAW_BENCHMARK_STATE_VERTEX_BUFFER = 1 << 2,
+	DRAW_BENCHMARK_STATE_PUSH_CONSTANTS = 1 << 3,
+	DRAW_BENCHMARK_STATE_ALL = (1 << 4) - 1
+};
+
+struct DrawBenchmarkCase
+{
+	const char* Name;
+	uint32_t States;
+};
+
+static const struct DrawBenchmarkCase DRAW_BENCHMARK_CASES[] = {
+	{ "none", 0 },
+	{ "push constants", DRAW_BENCHMARK_STATE_PUSH_CONSTANTS },
+	{ "vertex buffer", DRAW_BENCHMARK_STATE_VERTEX_BUFFER },
+	{ "descriptor set", DRAW_BENCHMARK_STATE_DESCRIPTOR_SET },
+	{ "pipeline", DRAW_BENCHMARK_STATE_PIPELINE },
+	{ "all", DRAW_BENCHMARK_STATE_ALL }
+};
+
+struct DrawBenchmark
+{
+	const struct VulkanObjects* VulkanObjects;
+	uint32_t DrawCount;
+	uint32_t States;
+
+	// two of each, so every change really switches objects
+	VkPipeline Pipelines[2];
+	VkBuffer VertexBuffers[2];
+	VkDeviceMemory VertexBufferMemory;
+
+	// render pass path only
+	VkFramebuffer Framebuffer;
+
+	// when set, recorded instead of the States pattern
+	const struct DrawList* DrawList;
+	struct DrawTables Tables;
+	struct DrawBindCounts BindCounts;
+};
+
+struct DrawBenchmarkTimes
+{
+	double RecordNanoseconds;
+	double SubmitNanoseconds;
+	double ExecuteNanoseconds;
+};
+
+void RecordDrawBenchmarkPass(VkCommandBuffer CommandBuffer, void* Context, void* FrameData)
+{
+	struct DrawBenchmark* Benchmark = Context;
+	const struct VulkanObjects* VulkanObjects = Benchmark->VulkanObjects;
+	const struct RenderGraph* Graph = &VulkanObjects->FrameGraph;
+
+	VkRect2D RenderArea = { 0 };
+	RenderArea.extent = Graph->Extent;
+
+	VkClearValue ClearValues[2] = { 0 };
+	ClearValues[0].color = (VkClearColorValue){ {0.0f, 0.0f, 0.0f, 1.0f} };
+	ClearValues[1].depthStencil.depth = 1.0f;
+
+	if (VulkanObjects->UseDynamicRendering)
+	{
+		VkRenderingAttachmentInfo ColorAttachment = { 0 };
+		ColorAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+		ColorAttachment.imageView = Graph->Resources[VulkanObjects->SceneColorResource].View;
+		ColorAttachment.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+		ColorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+		ColorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+		ColorAttachment.clearValue = ClearValues[0];
+
+		VkRenderingAttachmentInfo DepthAttachment = { 0 };
+		DepthAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+		DepthAttachment.imageView = Graph->Resources[VulkanObjects->DepthResource].View;
+		DepthAttachment.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+		DepthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+		DepthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		DepthAttachment.clearValue = ClearValues[1];
+
+		VkRenderingInfo RenderingInfo = { 0 };
+		RenderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
+		RenderingInfo.renderArea = RenderArea;
+		RenderingInfo.layerCount = 1;
+		RenderingInfo.colorAttachmentCount = 1;
+		RenderingInfo.pColorAttachments = &ColorAttachment;
+		RenderingInfo.pDepthAttachment = &DepthAttachment;
+		VulkanObjects->CmdBeginRendering(CommandBuffer, &RenderingInfo);
+	}
+	else
+	{
+		VkRenderPassBeginInfo RenderPassInfo = { 0 };
+		RenderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+		RenderPassInfo.renderPass = VulkanObjects->RenderPass;
+		RenderPassInfo.framebuffer = Benchmark->Framebuffer;
+		RenderPassInfo.renderArea = RenderArea;
+		RenderPassInfo.clearValueCount = ARRAYSIZE(ClearValues);
+		RenderPassInfo.pClearValues = ClearValues;
+		vkCmdBeginRenderPass(CommandBuffer, &RenderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+	}
+
+	vkCmdBindPipeline(CommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, Benchmark->Pipelines[0]);
+
+	{
+		VkViewport Viewport = { 0.0f, 0.0f, (float)RenderArea.extent.width, (float)RenderArea.extent.height, 0.0f, 1.0f };
+		vkCmdSetViewport(CommandBuffer, 0, 1, &Viewport);
+	}
+
+	vkCmdSetScissor(CommandBuffer, 0, 1, &RenderArea);
+
+	VkDeviceSize Offset = 0;
+	vkCmdBindVertexBuffers(CommandBuffer, 0, 1, &Benchmark->VertexBuffers[0], &Offset);
+	vkCmdBindIndexBuffer(CommandBuffer, VulkanObjects->IndexBuffer, 0, VK_INDEX_TYPE_UINT16);
+	vkCmdBindDescriptorSets(CommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, VulkanObjects->PipelineLayout, 0, 1, &VulkanObjects->DescriptorSets[0], 0, NULL);
+
+	uint32_t FirstView = 0;
+	vkCmdPushConstants(CommandBuffer, VulkanObjects->PipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(FirstView), &FirstView);
+
+	uint32_t States = Benchmark->States;
+
+	if (Benchmark->DrawList != NULL)
+	{
+		RecordDrawList(CommandBuffer, Benchmark->DrawList, &Benchmark->Tables, &Benchmark->BindCounts);
+	}
+
+	for (uint32_t i = 0; i < Benchmark->DrawCount && Benchmark->DrawList == NULL; i++)
+	{
+		uint32_t Slot = i & 1;
+
+		if (States & DRAW_BENCHMARK_STATE_PIPELINE)
+			vkCmdBindPipeline(CommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, Benchmark->Pipelines[Slot]);
+
+		if (States & DRAW_BENCHMARK_STATE_DESCRIPTOR_SET)
+			vkCmdBindDescriptorSets(CommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, VulkanObjects->PipelineLayout, 0, 1, &VulkanObjects->DescriptorSets[Slot], 0, NULL);
+
+		if (States & DRAW_BENCHMARK_STATE_VERTEX_BUFFER)
+			vkCmdBindVertexBuffers(CommandBuffer, 0, 1, &Benchmark->VertexBuffers[Slot], &Offset);
+
+		// every view holds the same camera, so either value draws the same thing
+		if (States & DRAW_BENCHMARK_STATE_PUSH_CONSTANTS)
+			vkCmdPushConstants(CommandBuffer, VulkanObjects->PipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(Slot), &Slot);
+
+		vkCmdDrawIndexed(CommandBuffer, ARRAYSIZE(Indices), 1, 0, 0, 0);
+	}
+
+	if (VulkanObjects->UseDynamicRendering)
+		VulkanObjects->CmdEndRendering(CommandBuffer);
+	else
+		vkCmdEndRenderPass(CommandBuffer);
+}
+
+// the best of DRAW_BENCHMARK_RUNS runs of the benchmark's current configuration
+struct DrawBenchmarkTimes TimeDrawBenchmark(struct VulkanObjects* VulkanObjects, const struct DrawBenchmark* Benchmark)
+{
+	VkCommandBuffer CommandBuffer = VulkanObjects->CommandBuffers[0];
+
+	LARGE_INTEGER Frequency;
+	QueryPerformanceFrequency(&Frequency);
+
+	double NanosecondsPerTickAndDraw = 1000000000.0 / Frequency.QuadPart / Benchmark->DrawCount;
+
+	struct DrawBenchmarkTimes Times = { DBL_MAX, DBL_MAX, DBL_MAX };
+
+	for (uint32_t Run = 0; Run < DRAW_BENCHMARK_RUNS; Run++)
+	{
+		LARGE_INTEGER RecordStart;
+		QueryPerformanceCounter(&RecordStart);
+
+		THROW_ON_FAIL_VK(vkResetCommandBuffer(CommandBuffer, 0));
+
+		{
+			VkCommandBufferBeginInfo BeginInfo = { 0 };
+			BeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+			BeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+			THROW_ON_FAIL_VK(vkBeginCommandBuffer(CommandBuffer, &BeginInfo));
+		}
+
+		RenderGraphExecute(&VulkanObjects->FrameGraph, CommandBuffer, NULL);
+
+		THROW_ON_FAIL_VK(vkEndCommandBuffer(CommandBuffer));
+
+		LARGE_INTEGER SubmitStart;
+		QueryPerformanceCounter(&SubmitStart);
+
+		uint64_t SignalValue = ++VulkanObjects->GraphicsTimeline.Value;
+
+		{
+			VkTimelineSemaphoreSubmitInfo TimelineInfo = { 0 };
+			TimelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+			TimelineInfo.signalSemaphoreValueCount = 1;
+			TimelineInfo.pSignalSemaphoreValues = &SignalValue;
+
+			VkSubmitInfo SubmitInfo = { 0 };
+			SubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+			SubmitInfo.pNext = &TimelineInfo;
+			SubmitInfo.commandBufferCount = 1;
+			SubmitInfo.pCommandBuffers = &CommandBuffer;
+			SubmitInfo.signalSemaphoreCount = 1;
+			SubmitInfo.pSignalSemaphores = &VulkanObjects->GraphicsTimeline.Semaphore;
+			THROW_ON_FAIL_VK(vkQueueSubmit(VulkanObjects->GraphicsQueue, 1, &SubmitInfo, VK_NULL_HANDLE));
+		}
+
+		LARGE_INTEGER ExecuteStart;
+		QueryPerformanceCounter(&ExecuteStart);
+
+		WaitForTimelineValue(VulkanObjects->Device, &VulkanObjects->GraphicsTimeline, SignalValue);
+
+		LARGE_INTEGER End;
+		QueryPerformanceCounter(&End);
+
+		Times.RecordNanoseconds = min(Times.RecordNanoseconds, (SubmitStart.QuadPart - RecordStart.QuadPart) * NanosecondsPerTickAndDraw);
+		Times.SubmitNanoseconds = min(Times.SubmitNanoseconds, (ExecuteStart.QuadPart - SubmitStart.QuadPart) * NanosecondsPerTickAndDraw);
+		Times.ExecuteNanoseconds = min(Times.ExecuteNanoseconds, (End.QuadPart - ExecuteStart.QuadPart) * NanosecondsPerTickAndDraw);
+	}
+
+	return Times;
+}
+
+/*
+* the same draws with random pipelines, descriptor sets, meshes and push constants, recorded
+* once in the order they were generated and once sorted by key. both go through
+* RecordDrawList, so the difference is the binds sorting saves
+*/
+void RunDrawListBenchmark(struct VulkanObjects* VulkanObjects, struct DrawBenchmark* Benchmark, struct JobSystem* JobSystem)
+{
+	uint32_t DrawCount = Benchmark->DrawCount;
+
+	struct DrawItem* Generated = malloc(DrawCount * sizeof(struct DrawItem));
+	struct DrawList List = { 0 };
+	List.Items = malloc(DrawCount * sizeof(struct DrawItem));
+	List.Scratch = malloc(DrawCount * sizeof(struct DrawItem));
+	List.Count = DrawCount;
+
+	if (Generated == NULL || List.Items == NULL || List.Scratch == NULL)
+		FailFastWithMessage("out of memory for the draw list\n");
+
+	// the same draws every run, so results are comparable between commits
+	srand(1);
+
+	for (uint32_t i = 0; i < DrawCount; i++)
+	{
+		uint32_t Pipeline = rand() % ARRAYSIZE(Benchmark->Pipelines);
+		uint32_t Material = rand() % MAX_FRAMES_IN_FLIGHT;
+		uint32_t Mesh = rand() % ARRAYSIZE(Benchmark->VertexBuffers);
+		float Depth = rand() / (float)RAND_MAX;
+
+		Generated[i].Key = MakeDrawKey(0, Pipeline, Material, Mesh, Depth);
+		Generated[i].Payload = rand() & 1;
+	}
+
+	struct DrawMesh Meshes[ARRAYSIZE(Benchmark->VertexBuffers)];
+
+	for (uint32_t i = 0; i < ARRAYSIZE(Meshes); i++)
+	{
+		Meshes[i].VertexBuffer = Benchmark->VertexBuffers[i];
+		Meshes[i].IndexBuffer = VulkanObjects->IndexBuffer;
+		Meshes[i].IndexCount = ARRAYSIZE(Indices);
+		Meshes[i].InstanceCount = 1;
+		Meshes[i].VertexAddress = 0;
+		Meshes[i].IndexAddress = 0;
+	}
+
+	Benchmark->Tables.Layout = VulkanObjects->PipelineLayout;
+	Benchmark->Tables.Pipelines = Benchmark->Pipelines;
+	Benchmark->Tables.Materials = VulkanObjects->DescriptorSets;
+	Benchmark->Tables.Meshes = Meshes;
+	Benchmark->DrawList = &List;
+
+	LARGE_INTEGER Frequency;
+	QueryPerformanceFrequency(&Frequency);
+
+	static const char* const ORDER_NAMES[] = { "unsorted", "sorted" };
+
+	for (uint32_t Sorted = 0; Sorted < ARRAYSIZE(ORDER_NAMES); Sorted++)
+	{
+		// every run sorts the generated order again
+		double SortNanoseconds = DBL_MAX;
+
+		for (uint32_t Run = 0; Run < DRAW_BENCHMARK_RUNS && Sorted; Run++)
+		{
+			memcpy(List.Items, Generated, DrawCount * sizeof(struct DrawItem));
+
+			LARGE_INTEGER SortStart;
+			QueryPerformanceCounter(&SortStart);
+
+			DrawListSort(&List, JobSystem);
+
+			LARGE_INTEGER SortEnd;
+			QueryPerformanceCounter(&SortEnd);
+
+			SortNanoseconds = min(SortNanoseconds, (SortEnd.QuadPart - SortStart.QuadPart) * 1000000000.0 / Frequency.QuadPart / DrawCount);
+		}
+
+		if (!Sorted)
+			memcpy(List.Items, Generated, DrawCount * sizeof(struct DrawItem));
+
+		struct DrawBenchmarkTimes Times = TimeDrawBenchmark(VulkanObjects, Benchmark);
+		const struct DrawBindCounts* Binds = &Benchmark->BindCounts;
+
+		LogMessage("draw benchmark: %-14s record %8.2f ns/draw, submit %8.2f ns/draw, execute %8.2f ns/draw\n",
+			ORDER_NAMES[Sorted], Times.RecordNanoseconds, Times.SubmitNanoseconds, Times.ExecuteNanoseconds);
+		LogMessage("draw benchmark: %-14s binds: %u pipeline, %u descriptor set, %u vertex buffer, %u index buffer, %u push constant\n",
+			ORDER_NAMES[Sorted], Binds->Pipelines, Binds->DescriptorSets, Binds->VertexBuffers, Binds->IndexBuffers, Binds->PushConstants);
+
+		if (Sorted)
+			LogMessage("draw benchmark: %-14s sort %8.2f ns/draw on %u threads\n", ORDER_NAMES[Sorted], SortNanoseconds, JobSystem->WorkerCount + 1);
+	}
+
+	Benchmark->DrawList = NULL;
+
+	free(List.Scratch);
+	free(List.Items);
+	free(Generated);
+}
+
+/*
+* records DrawCount indexed draws into one primary command buffer for each case, submits it
+* and waits for it, and logs the best time per draw of a few runs for each step. record is
+* vkBeginCommandBuffer to vkEndCommandBuffer, submit is the vkQueueSubmit call and execute
+* is the wait for the queue after it. everything renders into a small offscreen target, so
+* the run needs no window and works on a CPU device such as lavapipe
+*/
+void RunDrawBenchmark(struct VulkanObjects* VulkanObjects, struct JobSystem* JobSystem, uint32_t DrawCount)
+{
+	VkDevice Device = VulkanObjects->Device;
+
+	struct DrawBenchmark Benchmark = { 0 };
+	Benchmark.VulkanObjects = VulkanObjects;
+	Benchmark.DrawCount = DrawCount;
+
+	{
+		VkShaderModule VertexShaderModule = CreateShaderModule(Device, SHADER_SCENE_VERTEX);
+		VkShaderModule FragmentShaderModule = CreateShaderModule(Device, SHADER_SCENE_FRAGMENT);
+
+		Benchmark.Pipelines[0] = VulkanObjects->GraphicsPipeline;
+		Benchmark.Pipelines[1] = CreateScenePipeline(VulkanObjects, &SCENE_MATERIALS[1].State, VertexShaderModule, FragmentShaderModule);
+
+		vkDestroyShaderModule(Device, FragmentShaderModule, NULL);
+		vkDestroyShaderModule(Device, VertexShaderModule, NULL);
+	}
+
+	{
+		VkMemoryPropertyFlags Flags = CreateBuffer(Device, sizeof(Vertices), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, MEMORY_USAGE_CPU_TO_GPU, MEMORY_CATEGORY_VERTEX, &Benchmark.VertexBuffers[1], &Benchmark.VertexBufferMemory);
+
+		void* Mapped;
+		THROW_ON_FAIL_VK(vkMapMemory(Device, Benchmark.VertexBufferMemory, 0, VK_WHOLE_SIZE, 0, &Mapped));
+		memcpy(Mapped, Vertices, sizeof(Vertices));
+
+		if (!(Flags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT))
+		{
+			struct MemoryFlushBatch Batch = { 0 };
+			AddMemoryFlush(Device, &Batch, Benchmark.VertexBufferMemory, 0, sizeof(Vertices));
+			FlushMemoryBatch(Device, &Batch);
+		}
+
+		vkUnmapMemory(Device, Benchmark.VertexBufferMemory);
+
+		Benchmark.VertexBuffers[0] = VulkanObjects->VertexBuffer;
+	}
+
+	// every descriptor set the draws switch between gets the same camera
+	{
+		struct UniformBufferObject Ubo = { 0 };
+
+		for (uint32_t View = 0; View < MAX_VIEWS; View++)
+		{
+			glm_lookat_rh((vec3) { 2.0f, 2.0f, 2.0f }, (vec3) { 0.0f, 0.0f, 0.0f }, (vec3) { 0.0f, 0.0f, 1.0f }, Ubo.View[View]);
+			glm_perspective_rh_zo(glm_rad(45.0f), 1.0f, 0.1f, 10.0f, Ubo.Proj[View]);
+			Ubo.Proj[View][1][1] *= -1;
+		}
+
+		struct MemoryFlushBatch Batch = { 0 };
+
+		for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+		{
+			memcpy(VulkanObjects->UniformBuffersMapped[i], &Ubo, sizeof(Ubo));
+
+			if (!VulkanObjects->UniformBuffersCoherent)
+				AddMemoryFlush(Device, &Batch, VulkanObjects->UniformBuffersMemory[i], 0, sizeof(Ubo));
+		}
+
+		FlushMemoryBatch(Device, &Batch);
+	}
+
+	struct RenderGraph* Graph = &VulkanObjects->FrameGraph;
+	Graph->ResourceCount = 0;
+	Graph->PassCount = 0;
+
+	VulkanObjects->SceneColorResource = RenderGraphCreateImage(Graph, "BenchmarkColor", VulkanObjects->SwapChainImageFormat.format, VK_IMAGE_ASPECT_COLOR_BIT, false);
+	VulkanObjects->DepthResource = RenderGraphCreateImage(
+		Graph,
+		"Depth",
+		VulkanObjects->DepthFormat,
+		VK_IMAGE_ASPECT_DEPTH_BIT | (HasStencilComponent(VulkanObjects->DepthFormat) ? VK_IMAGE_ASPECT_STENCIL_BIT : 0),
+		true
+	);
+
+	{
+		uint32_t DrawPass = RenderGraphAddPass(Graph, "DrawBenchmark", RecordDrawBenchmarkPass, &Benchmark);
+		RenderGraphUseResource(Graph, DrawPass, VulkanObjects->SceneColorResource, RENDER_GRAPH_ACCESS_COLOR_ATTACHMENT_WRITE);
+		RenderGraphUseResource(Graph, DrawPass, VulkanObjects->DepthResource, RENDER_GRAPH_ACCESS_DEPTH_ATTACHMENT_WRITE);
+
+		// nothing reads the color target back
+		RenderGraphSetSideEffects(Graph, DrawPass);
+	}
+
+	RenderGraphCompile(Graph);
+	RenderGraphRealize(Graph, Device, (VkExtent2D) { DRAW_BENCHMARK_EXTENT, DRAW_BENCHMARK_EXTENT });
+
+	if (!VulkanObjects->UseDynamicRendering)
+	{
+		VkImageView Attachments[] = {
+			Graph->Resources[VulkanObjects->SceneColorResource].View,
+			Graph->Resources[VulkanObjects->DepthResource].View
+		};
+
+		VkFramebufferCreateInfo FramebufferInfo = { 0 };
+		FramebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+		FramebufferInfo.renderPass = VulkanObjects->RenderPass;
+		FramebufferInfo.attachmentCount = ARRAYSIZE(Attachments);
+		FramebufferInfo.pAttachments = Attachments;
+		FramebufferInfo.width = DRAW_BENCHMARK_EXTENT;
+		FramebufferInfo.height = DRAW_BENCHMARK_EXTENT;
+		FramebufferInfo.layers = 1;
+		THROW_ON_FAIL_VK(vkCreateFramebuffer(Device, &FramebufferInfo, NULL, &Benchmark.Framebuffer));
+	}
+
+	// the startup uploads have to land before the draws read the buffers and texture
+	ProcessDeferredDeletions(VulkanObjects, true);
+
+	LogMessage("draw benchmark: %u draws per command buffer, best of %u runs\n", DrawCount, DRAW_BENCHMARK_RUNS);
+
+	for (uint32_t Case = 0; Case < ARRAYSIZE(DRAW_BENCHMARK_CASES); Case++)
+	{
+		Benchmark.States = DRAW_BENCHMARK_CASES[Case].States;
+
+		struct DrawBenchmarkTimes Times = TimeDrawBenchmark(VulkanObjects, &Benchmark);
+
+		LogMessage("draw benchmark: %-14s record %8.2f ns/draw, submit %8.2f ns/draw, execute %8.2f ns/draw\n",
+			DRAW_BENCHMARK_CASES[Case].Name, Times.RecordNanoseconds, Times.SubmitNanoseconds, Times.ExecuteNanoseconds);
+	}
+
+	RunDrawListBenchmark(VulkanObjects, &Benchmark, JobSystem);
+
+	vkDestroyFramebuffer(Device, Benchmark.Framebuffer, NULL);
+	vkDestroyPipeline(Device, Benchmark.Pipelines[1], NULL);
+	vkDestroyBuffer(Device, Benchmark.VertexBuffers[1], NULL);
+	FreeDeviceMemory(Device, Benchmark.VertexBufferMemory);
+}
+
+int main(int argc, char** argv)
+{
+	LogHandle = GetStdHandle(STD_OUTPUT_HANDLE);
+
+	LARGE_INTEGER StartupTime;
+	QueryPerformanceCounter(&StartupTime);
+
+#ifdef ENABLE_PROFILING
+	ProfileInit();
+	PROFILE_THREAD_NAME("Main");
+#endif
+
+	struct LaunchOptions Options;
+	ParseCommandLine(argc, argv, &Options);
+
+	if (MultiByteToWideChar(CP_ACP, 0, Options.ShaderDirectory, -1, ShaderDirectory, ARRAYSIZE(ShaderDirectory)) == 0)
+		THROW_ON_FAIL(HRESULT_FROM_WIN32(GetLastError()));
+
+	// neither needs a device
+	if (Options.PackAssetsPath[0] != '\0')
+	{
+		WriteAssetPack(Options.PackAssetsPath, Options.PackCompression);
+		return EXIT_SUCCESS;
+	}
+
+	if (Options.AssetBenchmarkIterations > 0)
+	{
+		if (Options.AssetPackPath[0] == '\0')
+			FailFastWithMessage("--asset-benchmark needs --asset-pack\n");
+
+		RunAssetBenchmark(Options.AssetPackPath, Options.AssetBenchmarkIterations);
+		return EXIT_SUCCESS;
+	}
+
+	// mapped for the lifetime of the process, since shader reloads can read from it
+	if (Options.AssetPackPath[0] != '\0')
+		AssetPackOpen(&AssetPack, Options.AssetPackPath);
+
+	// no window, surface or swapchain. the benchmark draws the scene pipeline into its own target
+	bool Headless = Options.DrawBenchmarkDraws > 0;
+
+	if (Headless)
+	{
+		Options.ParticleCount = 0;
+		Options.ViewCount = 1;
+		Options.ResolutionBudget = 0.0f;
+		Options.CapturePath[0] = '\0';
+	}
+
+	// the workers start while the instance and device are created on this thread
+	struct JobSystem* JobSystem = NULL;
+
+	{
+		uint32_t WorkerCount = GetActiveProcessorCount(ALL_PROCESSOR_GROUPS) - 1;
+
+		// runs every startup job on the main thread, as a baseline for the time to first frame
+		if (GetEnvironmentVariableW(L"MINIMALVULKAN_SERIAL_STARTUP", NULL, 0) > 0)
+			WorkerCount = 0;
+
+		JobSystem = JobSystemCreate(WorkerCount);
+	}
+
+	HINSTANCE Instance = GetModuleHandleW(NULL);
+
+	HICON Icon = LoadIconW(NULL, IDI_APPLICATION);
+	HCURSOR Cursor = LoadCursorW(NULL, IDC_ARROW);
+
+	WNDCLASSEXW WindowClass = { 0 };
+	WindowClass.cbSize = sizeof(WNDCLASSEXW);
+	WindowClass.style = CS_HREDRAW | CS_VREDRAW;
+	WindowClass.lpfnWndProc = PreInitProc;
+	WindowClass.cbClsExtra = 0;
+	WindowClass.cbWndExtra = 0;
+	WindowClass.hInstance = Instance;
+	WindowClass.hIcon = Icon;
+	WindowClass.hCursor = Cursor;
+	WindowClass.hbrBackground = (HBRUSH)(COLOR_WINDOW + 2);
+	WindowClass.lpszMenuName = NULL;
+	WindowClass.lpszClassName = WindowClassName;
+	WindowClass.hIconSm = Icon;
+
+	ATOM WindowClassAtom = RegisterClassExW(&WindowClass);
+	if (WindowClassAtom == 0)
+		THROW_ON_FAIL(HRESULT_FROM_WIN32(GetLastError()));
+
+	RECT WindowRect = { 0 };
+	WindowRect.left = 0;
+	WindowRect.top = 0;
+	WindowRect.right = 800;
+	WindowRect.bottom = 600;
+
+	THROW_ON_FALSE(AdjustWindowRect(&WindowRect, WS_OVERLAPPEDWINDOW, FALSE));
+
+	HWND Window = NULL;
+
+	if (!Headless)
+	{
+		Window = CreateWindowExW(
+			0,
+			WindowClassName,
+			L"Minimal Vulkan",
+			WS_OVERLAPPEDWINDOW,
+			CW_USEDEFAULT,
+			CW_USEDEFAULT,
+			WindowRect.right - WindowRect.left,
+			WindowRect.bottom - WindowRect.top,
+			NULL,
+			NULL,
+			Instance,
+			NULL);
+
+		VALIDATE_HANDLE(Window);
+
+		THROW_ON_FALSE(ShowWindow(Window, SW_SHOW));
+	}
+
+	VkInstance VulkanInstance;
+
+	PROFILE_ZONE("CreateInstance")
+	{
+		LoadVulkanLibrary();
+
+		VkApplicationInfo AppInfo = { 0 };
+		AppInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+		AppInfo.pApplicationName = "Hello Triangle";
+		AppInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
+		AppInfo.pEngineName = "No Engine";
+		AppInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
+		AppInfo.apiVersion = VK_API_VERSION_1_3;
+
+		// the surface extensions come first so a headless instance can leave them out
+		static const char* const Extensions[] =
+		{
+			"VK_KHR_surface",
+			"VK_KHR_win32_surface",
+#ifdef _DEBUG
+			VK_EXT_DEBUG_UTILS_EXTENSION_NAME
+#endif
+		};
+
+		uint32_t SkippedExtensions = Headless ? 2 : 0;
+
+#ifdef _DEBUG
+		VkDebugUtilsMessengerCreateInfoEXT DebugCreateInfo = { 0 };
+		DebugCreateInfo.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT;
+		DebugCreateInfo.messageSeverity = VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT;
+		DebugCreateInfo.messageType = VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT;
+		DebugCreateInfo.pfnUserCallback = DebugCallback;
+#endif
+
+		VkInstanceCreateInfo CreateInfo = { 0 };
+		CreateInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+		CreateInfo.pApplicationInfo = &AppInfo;
+		CreateInfo.enabledExtensionCount = ARRAYSIZE(Extensions) - SkippedExtensions;
+		CreateInfo.ppEnabledExtensionNames = Extensions + SkippedExtensions;
+
+#ifdef _DEBUG
+		CreateInfo.pNext = &DebugCreateInfo;
+		CreateInfo.enabledLayerCount = ARRAYSIZE(VALIDATION_LAYERS);
+		CreateInfo.ppEnabledLayerNames = VALIDATION_LAYERS;
+#else
+		CreateInfo.pNext = NULL;
+		CreateInfo.enabledLayerCount = 0;
+#endif
+
+		THROW_ON_FAIL_VK(vkCreateInstance(&CreateInfo, NULL, &VulkanInstance));
+
+		LoadInstanceFunctions(VulkanInstance, !Headless);
+	}
+
+	struct VulkanObjects VulkanObjects = { 0 };
+
+#ifdef _DEBUG
+	PFN_vkCreateDebugUtilsMessengerEXT CallbackFunction = vkGetInstanceProcAddr(VulkanInstance, "vkCreateDebugUtilsMessengerEXT");
+	if (CallbackFunction)
+	{
+		VkDebugUtilsMessengerCreateInfoEXT CreateInfo = { 0 };
+		CreateInfo.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT;
+		CreateInfo.messageSeverity = VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT;
+		CreateInfo.messageType = VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT;
+		CreateInfo.pfnUserCallback = DebugCallback;
+		THROW_ON_FAIL_VK(CallbackFunction(VulkanInstance, &CreateInfo, NULL, &VulkanObjects.DebugMessenger));
+	}
+	else
+	{
+		THROW_ON_FAIL_VK(VK_ERROR_EXTENSION_NOT_PRESENT);
+	}
+#endif
+
+	if (!Headless)
+	{
+		PROFILE_ZONE("CreateSurface")
+		{
+			VkWin32SurfaceCreateInfoKHR CreateInfo = { 0 };
+			CreateInfo.sType = VK_STRUCTURE_TYPE_WIN32_SURFACE_CREATE_INFO_KHR;
+			CreateInfo.hinstance = Instance;
+			CreateInfo.hwnd = Window;
+			THROW_ON_FAIL_VK(vkCreateWin32SurfaceKHR(VulkanInstance, &CreateInfo, NULL, &VulkanObjects.Surface));
+		}
+	}
+
+	PROFILE_ZONE("SelectPhysicalDevice")
+	{
+		VulkanObjects.PhysicalDevice = SelectPhysicalDevice(VulkanInstance, VulkanObjects.Surface, Options.DeviceSelector[0] != '\0' ? Options.DeviceSelector : NULL);
+
+		VkPhysicalDeviceProperties DeviceProperties = { 0 };
+		vkGetPhysicalDeviceProperties(VulkanObjects.PhysicalDevice, &DeviceProperties);
+		VulkanObjects.DeviceApiVersion = DeviceProperties.apiVersion;
+	}
+
+	PROFILE_ZONE("FindQueueFamilies")
+	{
+		uint32_t QueueFamilyCount = 0;
+		vkGetPhysicalDeviceQueueFamilyProperties(VulkanObjects.PhysicalDevice, &QueueFamilyCount, NULL);
+
+		VkQueueFamilyProperties QueueFamilies[MAX_QUEUE_FAMILY_COUNT];
+		vkGetPhysicalDeviceQueueFamilyProperties(VulkanObjects.PhysicalDevice, &QueueFamilyCount, QueueFamilies);
+
+		bool HasGraphics = false;
+		bool HasPresent = false;
+
+		for (int i = 0; i < QueueFamilyCount; i++)
+		{
+			if (QueueFamilies[i].queueFlags & VK_QUEUE_GRAPHICS_BIT)
+			{
+				VulkanObjects.QueueFamilyIndices.GraphicsFamily = i;
+				HasGraphics = true;
+			}
+
+			// a headless run presents nothing, so the graphics family stands in
+			VkBool32 PresentSupport = Headless && (QueueFamilies[i].queueFlags & VK_QUEUE_GRAPHICS_BIT);
+
+			if (!Headless)
+				vkGetPhysicalDeviceSurfaceSupportKHR(VulkanObjects.PhysicalDevice, i, VulkanObjects.Surface, &PresentSupport);
+
+			if (PresentSupport)
+			{
+				VulkanObjects.QueueFamilyIndices.PresentFamily = i;
+				HasPresent = true;
+			}
+
+			if (HasGraphics && HasPresent)
+			{
+				break;
+			}
+		}
+
+		// a family without graphics lets the particle simulation run next to the frame
+		// instead of between its submissions
+		VulkanObjects.QueueFamilyIndices.ComputeFamily = VulkanObjects.QueueFamilyIndices.GraphicsFamily;
+
+		for (uint32_t i = 0; i < QueueFamilyCount; i++)
+		{
+			if ((QueueFamilies[i].queueFlags & VK_QUEUE_COMPUTE_BIT) && !(QueueFamilies[i].queueFlags & VK_QUEUE_GRAPHICS_BIT))
+			{
+				VulkanObjects.QueueFamilyIndices.ComputeFamily = i;
+				break;
+			}
+		}
+	}
+
+#ifdef ENABLE_PROFILING
+	bool CalibratedTimestamps = false;
+#endif
+
+	bool MemoryBudgetSupported = false;
+
+	PROFILE_ZONE("CreateDevice")
+	{
+		float QueuePriority = 1.0f;
+
+		uint32_t RequestedQueueFamilies[] = {
+			VulkanObjects.QueueFamilyIndices.GraphicsFamily,
+			VulkanObjects.QueueFamilyIndices.PresentFamily,
+			VulkanObjects.QueueFamilyIndices.ComputeFamily
+		};
+
+		uint32_t UniqueQueueFamilies[ARRAYSIZE(RequestedQueueFamilies)] = { 0 };
+		uint32_t UniqueQueueFamilyCount = 0;
+
+		for (int i = 0; i < ARRAYSIZE(RequestedQueueFamilies); i++)
+		{
+			bool Duplicate = false;
+
+			for (uint32_t j = 0; j < UniqueQueueFamilyCount; j++)
+			{
+				Duplicate |= UniqueQueueFamilies[j] == RequestedQueueFamilies[i];
+			}
+
+			if (!Duplicate)
+				UniqueQueueFamilies[UniqueQueueFamilyCount++] = RequestedQueueFamilies[i];
+		}
+
+		VkDeviceQueueCreateInfo QueueCreateInfos[ARRAYSIZE(RequestedQueueFamilies)] = { 0 };
+	
+		for (int i = 0; i < UniqueQueueFamilyCount; i++)
+		{
+			QueueCreateInfos[i].sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+			QueueCreateInfos[i].queueFamilyIndex = UniqueQueueFamilies[i];
+			QueueCreateInfos[i].queueCount = 1;
+			QueueCreateInfos[i].pQueuePriorities = &QueuePriority;
+		}
+
+		const char* EnabledExtensions[MAX_ENABLED_DEVICE_EXTENSIONS];
+		uint32_t EnabledExtensionCount = 0;
+
+		for (int i = 0; i < ARRAYSIZE(DEVICE_EXTENSIONS) && !Headless; i++)
+		{
+			EnabledExtensions[EnabledExtensionCount++] = DEVICE_EXTENSIONS[i];
+		}
+
+		// timeline semaphores are the one 1.2 feature frame synchronization can't do without
+		if (VulkanObjects.DeviceApiVersion < VK_API_VERSION_1_2)
+			FailFastWithMessage("device does not support Vulkan 1.2\n");
+
+		// dynamic rendering is core in 1.3. on 1.2 devices the extension works the same way
+		// since everything it depends on is core there
+		bool DynamicRenderingIsCore = VulkanObjects.DeviceApiVersion >= VK_API_VERSION_1_3;
+		bool DynamicRenderingIsExtension = !DynamicRenderingIsCore && VulkanObjects.DeviceApiVersion >= VK_API_VERSION_1_2 && DeviceSupportsExtension(VulkanObjects.PhysicalDevice, VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME);
+
+		VkPhysicalDeviceDynamicRenderingFeatures DynamicRenderingFeatures = { 0 };
+		DynamicRenderingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES;
+
+		VkPhysicalDeviceTimelineSemaphoreFeatures TimelineSemaphoreFeatures = { 0 };
+		TimelineSemaphoreFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
+		TimelineSemaphoreFeatures.pNext = (DynamicRenderingIsCore || DynamicRenderingIsExtension) ? &DynamicRenderingFeatures : NULL;
+
+		// core in 1.2 but optional until 1.3
+		VkPhysicalDeviceBufferDeviceAddressFeatures BufferDeviceAddressFeatures = { 0 };
+		BufferDeviceAddressFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_BUFFER_DEVICE_ADDRESS_FEATURES;
+		BufferDeviceAddressFeatures.pNext = &TimelineSemaphoreFeatures;
+
+		VkPhysicalDeviceMultiviewFeatures MultiviewFeatures = { 0 };
+		MultiviewFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MULTIVIEW_FEATURES;
+		MultiviewFeatures.pNext = &BufferDeviceAddressFeatures;
+
+		// scene pipeline variants are linked from precompiled parts when the driver can do it
+		bool PipelineLibrarySupported = DeviceSupportsExtension(VulkanObjects.PhysicalDevice, VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME) && DeviceSupportsExtension(VulkanObjects.PhysicalDevice, VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME);
+
+		VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT PipelineLibraryFeatures = { 0 };
+		PipelineLibraryFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT;
+		PipelineLibraryFeatures.pNext = &MultiviewFeatures;
+
+		// the texture is written from the host when the driver can do it. before 1.3 the
+		// extension also needs the two it builds on
+		bool HostImageCopyDependencies = VulkanObjects.DeviceApiVersion >= VK_API_VERSION_1_3 ||
+			(DeviceSupportsExtension(VulkanObjects.PhysicalDevice, VK_KHR_COPY_COMMANDS_2_EXTENSION_NAME) && DeviceSupportsExtension(VulkanObjects.PhysicalDevice, VK_KHR_FORMAT_FEATURE_FLAGS_2_EXTENSION_NAME));
+		bool HostImageCopySupported = HostImageCopyDependencies && DeviceSupportsExtension(VulkanObjects.PhysicalDevice, VK_EXT_HOST_IMAGE_COPY_EXTENSION_NAME);
+
+		// the rest of the chain is whatever comes after it
+		VkPhysicalDeviceHostImageCopyFeaturesEXT HostImageCopyFeatures = { 0 };
+		HostImageCopyFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_IMAGE_COPY_FEATURES_EXT;
+		HostImageCopyFeatures.pNext = PipelineLibrarySupported ? (void*)&PipelineLibraryFeatures : &MultiviewFeatures;
+
+		{
+			VkPhysicalDeviceFeatures2 SupportedFeatures = { 0 };
+			SupportedFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+			SupportedFeatures.pNext = HostImageCopySupported ? (void*)&HostImageCopyFeatures : HostImageCopyFeatures.pNext;
+			vkGetPhysicalDeviceFeatures2(VulkanObjects.PhysicalDevice, &SupportedFeatures);
+		}
+
+		if (TimelineSemaphoreFeatures.timelineSemaphore != VK_TRUE)
+			FailFastWithMessage("device does not support timeline semaphores\n");
+
+		// required from 1.1 on. the scene vertex shader reads gl_ViewIndex even when rendering one view
+		if (MultiviewFeatures.multiview != VK_TRUE)
+			FailFastWithMessage("device does not support multiview\n");
+
+		VulkanObjects.UseDynamicRendering = DynamicRenderingFeatures.dynamicRendering == VK_TRUE;
+
+		// lets the render pass path be exercised on hardware that would otherwise never take it
+		if (GetEnvironmentVariableW(L"MINIMALVULKAN_NO_DYNAMIC_RENDERING", NULL, 0) > 0)
+			VulkanObjects.UseDynamicRendering = false;
+
+		if (VulkanObjects.UseDynamicRendering && DynamicRenderingIsExtension)
+			EnabledExtensions[EnabledExtensionCount++] = VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME;
+
+		VulkanObjects.UsePipelineLibrary = PipelineLibrarySupported && PipelineLibraryFeatures.graphicsPipelineLibrary == VK_TRUE;
+
+		// compiles every variant whole, for comparing against the linked ones
+		if (GetEnvironmentVariableW(L"MINIMALVULKAN_NO_PIPELINE_LIBRARY", NULL, 0) > 0)
+			VulkanObjects.UsePipelineLibrary = false;
+
+		if (VulkanObjects.UsePipelineLibrary)
+		{
+			EnabledExtensions[EnabledExtensionCount++] = VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME;
+			EnabledExtensions[EnabledExtensionCount++] = VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME;
+
+			VkPhysicalDeviceGraphicsPipelineLibraryPropertiesEXT PipelineLibraryProperties = { 0 };
+			PipelineLibraryProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_PROPERTIES_EXT;
+
+			VkPhysicalDeviceProperties2 Properties = { 0 };
+			Properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+			Properties.pNext = &PipelineLibraryProperties;
+			vkGetPhysicalDeviceProperties2(VulkanObjects.PhysicalDevice, &Properties);
+
+			VulkanObjects.PipelineLibraryFastLinking = PipelineLibraryProperties.graphicsPipelineLibraryFastLinking == VK_TRUE;
+
+			LogMessage("graphics pipeline library: fast linking %s\n", VulkanObjects.PipelineLibraryFastLinking ? "supported" : "not supported");
+		}
+
+		VulkanObjects.UseHostImageCopy = HostImageCopySupported && HostImageCopyFeatures.hostImageCopy == VK_TRUE;
+
+		// uploads the texture through a staging buffer, for comparing against the host copy
+		if (GetEnvironmentVariableW(L"MINIMALVULKAN_NO_HOST_IMAGE_COPY", NULL, 0) > 0)
+			VulkanObjects.UseHostImageCopy = false;
+
+		// the copy writes straight into the layout the texture is sampled in, so that layout
+		// has to be one the driver can copy into
+		if (VulkanObjects.UseHostImageCopy)
+		{
+			VkImageLayout CopyDstLayouts[32];
+
+			VkPhysicalDeviceHostImageCopyPropertiesEXT HostImageCopyProperties = { 0 };
+			HostImageCopyProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_IMAGE_COPY_PROPERTIES_EXT;
+			HostImageCopyProperties.copyDstLayoutCount = ARRAYSIZE(CopyDstLayouts);
+			HostImageCopyProperties.pCopyDstLayouts = CopyDstLayouts;
+
+			VkPhysicalDeviceProperties2 Properties = { 0 };
+			Properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+			Properties.pNext = &HostImageCopyProperties;
+			vkGetPhysicalDeviceProperties2(VulkanObjects.PhysicalDevice, &Properties);
+
+			bool SampledLayout = false;
+
+			for (uint32_t i = 0; i < HostImageCopyProperties.copyDstLayoutCount; i++)
+			{
+				SampledLayout |= CopyDstLayouts[i] == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			}
+
+			VkHostImageCopyDevicePerformanceQueryEXT PerformanceQuery = { 0 };
+			PerformanceQuery.sType = VK_STRUCTURE_TYPE_HOST_IMAGE_COPY_DEVICE_PERFORMANCE_QUERY_EXT;
+
+			VkImageFormatProperties2 FormatProperties = { 0 };
+			FormatProperties.sType = VK_STRUCTURE_TYPE_IMAGE_FORMAT_PROPERTIES_2;
+			FormatProperties.pNext = &PerformanceQuery;
+
+			VkPhysicalDeviceImageFormatInfo2 FormatInfo = { 0 };
+			FormatInfo.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_IMAGE_FORMAT_INFO_2;
+			FormatInfo.format = IMAGE_FORMAT;
+			FormatInfo.type = VK_IMAGE_TYPE_2D;
+			FormatInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+			FormatInfo.usage = VK_IMAGE_USAGE_HOST_TRANSFER_BIT_EXT | VK_IMAGE_USAGE_SAMPLED_BIT;
+
+			bool FormatSupported = vkGetPhysicalDeviceImageFormatProperties2(VulkanObjects.PhysicalDevice, &FormatInfo, &FormatProperties) == VK_SUCCESS;
+
+			VulkanObjects.UseHostImageCopy = SampledLayout && FormatSupported;
+
+			if (VulkanObjects.UseHostImageCopy)
+				LogMessage("host image copy: on, %s device access\n", PerformanceQuery.optimalDeviceAccess ? "optimal" : "slower");
+			else
+				LogMessage("host image copy: the texture format or layout isn't supported, staging instead\n");
+		}
+
+		if (VulkanObjects.UseHostImageCopy)
+		{
+			if (VulkanObjects.DeviceApiVersion < VK_API_VERSION_1_3)
+			{
+				EnabledExtensions[EnabledExtensionCount++] = VK_KHR_COPY_COMMANDS_2_EXTENSION_NAME;
+				EnabledExtensions[EnabledExtensionCount++] = VK_KHR_FORMAT_FEATURE_FLAGS_2_EXTENSION_NAME;
+			}
+
+			EnabledExtensions[EnabledExtensionCount++] = VK_EXT_HOST_IMAGE_COPY_EXTENSION_NAME;
+		}
+
+		// the benchmarks bind vertex buffers themselves, so they always use the vertex input path
+		if (Options.VertexPulling && (Options.DispatchBenchmarkDraws > 0 || Options.DrawBenchmarkDraws > 0))
+			LogMessage("vertex pulling: off, the benchmarks use vertex buffers\n");
+		else if (Options.VertexPulling && BufferDeviceAddressFeatures.bufferDeviceAddress != VK_TRUE)
+			LogMessage("vertex pulling: off, the device has no buffer device addresses\n");
+		else
+			VulkanObjects.UseVertexPulling = Options.VertexPulling;
+
+		MemoryBudgetSupported = DeviceSupportsExtension(VulkanObjects.PhysicalDevice, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+
+		if (MemoryBudgetSupported)
+			EnabledExtensions[EnabledExtensionCount++] = VK_EXT_MEMORY_BUDGET_EXTENSION_NAME;
+
+#ifdef ENABLE_PROFILING
+		// lets gpu zones land on the same timeline as cpu zones without a round trip
+		CalibratedTimestamps = SupportsCalibratedTimestamps(VulkanInstance, VulkanObjects.PhysicalDevice);
+
+		if (CalibratedTimestamps)
+			EnabledExtensions[EnabledExtensionCount++] = VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME;
+#endif
+
+		DynamicRenderingFeatures.pNext = NULL;
+		DynamicRenderingFeatures.dynamicRendering = VulkanObjects.UseDynamicRendering;
+
+		TimelineSemaphoreFeatures.pNext = VulkanObjects.UseDynamicRendering ? &DynamicRenderingFeatures : NULL;
+		TimelineSemaphoreFeatures.timelineSemaphore = VK_TRUE;
+
+		BufferDeviceAddressFeatures.bufferDeviceAddress = VulkanObjects.UseVertexPulling;
+		BufferDeviceAddressFeatures.bufferDeviceAddressCaptureReplay = VK_FALSE;
+		BufferDeviceAddressFeatures.bufferDeviceAddressMultiDevice = VK_FALSE;
+
+		MultiviewFeatures.multiviewGeometryShader = VK_FALSE;
+		MultiviewFeatures.multiviewTessellationShader = VK_FALSE;
+
+		PipelineLibraryFeatures.graphicsPipelineLibrary = VK_TRUE;
+
+		HostImageCopyFeatures.pNext = VulkanObjects.UsePipelineLibrary ? (void*)&PipelineLibraryFeatures : &MultiviewFeatures;
+		HostImageCopyFeatures.hostImageCopy = VK_TRUE;
+
+		VkPhysicalDeviceFeatures2 DeviceFeatures = { 0 };
+		DeviceFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+		DeviceFeatures.pNext = VulkanObjects.UseHostImageCopy ? (void*)&HostImageCopyFeatures : HostImageCopyFeatures.pNext;
+		DeviceFeatures.features.samplerAnisotropy = VK_TRUE;
+
+		VkDeviceCreateInfo DeviceCreationInfo = { 0 };
+		DeviceCreationInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+		DeviceCreationInfo.queueCreateInfoCount = UniqueQueueFamilyCount;
+		DeviceCreationInfo.pQueueCreateInfos = QueueCreateInfos;
+
+
+#ifdef _DEBUG
+		DeviceCreationInfo.enabledLayerCount = ARRAYSIZE(VALIDATION_LAYERS);
+		DeviceCreationInfo.ppEnabledLayerNames = VALIDATION_LAYERS;
+#else
+		DeviceCreationInfo.enabledLayerCount = 0;
+		DeviceCreationInfo.ppEnabledLayerNames = NULL;
+#endif
+
+		DeviceCreationInfo.enabledExtensionCount = EnabledExtensionCount;
+		DeviceCreationInfo.ppEnabledExtensionNames = EnabledExtensions;
+
+		DeviceCreationInfo.pNext = &DeviceFeatures;
+		DeviceCreationInfo.pEnabledFeatures = NULL;
+
+		THROW_ON_FAIL_VK(vkCreateDevice(VulkanObjects.PhysicalDevice, &DeviceCreationInfo, NULL, &VulkanObjects.Device));
+
+		LoadDeviceFunctions(VulkanObjects.Device, !Headless);
+
+		if (VulkanObjects.UseDynamicRendering)
+		{
+			VulkanObjects.CmdBeginRendering = (PFN_vkCmdBeginRendering)vkGetDeviceProcAddr(VulkanObjects.Device, DynamicRenderingIsCore ? "vkCmdBeginRendering" : "vkCmdBeginRenderingKHR");
+			VulkanObjects.CmdEndRendering = (PFN_vkCmdEndRendering)vkGetDeviceProcAddr(VulkanObjects.Device, DynamicRenderingIsCore ? "vkCmdEndRendering" : "vkCmdEndRenderingKHR");
+
+			if (VulkanObjects.CmdBeginRendering == NULL || VulkanObjects.CmdEndRendering == NULL)
+				FailFastWithMessage("failed to load dynamic rendering entry points\n");
+		}
+
+		if (VulkanObjects.UseHostImageCopy)
+		{
+			VulkanObjects.TransitionImageLayout = (PFN_vkTransitionImageLayoutEXT)vkGetDeviceProcAddr(VulkanObjects.Device, "vkTransitionImageLayoutEXT");
+			VulkanObjects.CopyMemoryToImage = (PFN_vkCopyMemoryToImageEXT)vkGetDeviceProcAddr(VulkanObjects.Device, "vkCopyMemoryToImageEXT");
+
+			if (VulkanObjects.TransitionImageLayout == NULL || VulkanObjects.CopyMemoryToImage == NULL)
+				FailFastWithMessage("failed to load host image copy entry points\n");
+		}
+
+		vkGetDeviceQueue(VulkanObjects.Device, VulkanObjects.QueueFamilyIndices.GraphicsFamily, 0, &VulkanObjects.GraphicsQueue);
+		vkGetDeviceQueue(VulkanObjects.Device, VulkanObjects.QueueFamilyIndices.PresentFamily, 0, &VulkanObjects.PresentQueue);
+		vkGetDeviceQueue(VulkanObjects.Device, VulkanObjects.QueueFamilyIndices.ComputeFamily, 0, &VulkanObjects.ComputeQueue);
+	}
+
+	MemoryTrackerInit(VulkanObjects.PhysicalDevice, MemoryBudgetSupported);
+
+	if (!Headless)
+	{
+		vkGetPhysicalDeviceSurfaceCapabilitiesKHR(VulkanObjects.PhysicalDevice, VulkanObjects.Surface, &VulkanObjects.SurfaceCapabilities);
+
+		PROFILE_ZONE("ChooseSurfaceFormat")
+		{
+			uint32_t SurfaceFormatCount;
+			VkSurfaceFormatKHR SurfaceFormats[MAX_SURFACE_FORMATS];
+			vkGetPhysicalDeviceSurfaceFormatsKHR(VulkanObjects.PhysicalDevice, VulkanObjects.Surface, &SurfaceFormatCount, NULL);
+			vkGetPhysicalDeviceSurfaceFormatsKHR(VulkanObjects.PhysicalDevice, VulkanObjects.Surface, &SurfaceFormatCount, SurfaceFormats);
+
+			VulkanObjects.SwapChainImageFormat = SurfaceFormats[0];
+
+			for (int i = 0; i < SurfaceFormatCount; i++)
+			{
+				if (SurfaceFormats[i].format == VK_FORMAT_B8G8R8A8_SRGB &&
+					SurfaceFormats[i].colorSpace == VK_COLOR_SPACE_SRGB_NONLINEAR_KHR)
+				{
+					VulkanObjects.SwapChainImageFormat = SurfaceFormats[i];
+					break;
+				}
+			}
+		}
+	
+		PROFILE_ZONE("ChoosePresentMode")
+		{
+			uint32_t PresentModeCount;
+			VkPresentModeKHR PresentModes[MAX_PRESENT_MODES];
+			vkGetPhysicalDeviceSurfacePresentModesKHR(VulkanObjects.PhysicalDevice, VulkanObjects.Surface, &PresentModeCount, NULL);
+			vkGetPhysicalDeviceSurfacePresentModesKHR(VulkanObjects.PhysicalDevice, VulkanObjects.Surface, &PresentModeCount, PresentModes);
+
+			VulkanObjects.SwapChainPresentMode = VK_PRESENT_MODE_FIFO_KHR;
+
+			for (int i = 0; i < PresentModeCount; i++)
+			{
+				if (PresentModes[i] == VK_PRESENT_MODE_MAILBOX_KHR)
+				{
+					VulkanObjects.SwapChainPresentMode = VK_PRESENT_MODE_MAILBOX_KHR;
+				}
+			}
+		}
+
+		VulkanObjects.SwapChainImageCount = VulkanObjects.SurfaceCapabilities.minImageCount + 1;
+
+		if (VulkanObjects.SurfaceCapabilities.maxImageCount > 0 && VulkanObjects.SwapChainImageCount > VulkanObjects.SurfaceCapabilities.maxImageCount)
+		{
+			VulkanObjects.SwapChainImageCount = VulkanObjects.SurfaceCapabilities.maxImageCount;
+		}
+	}
+	else
+	{
+		// the format the swapchain is most likely to get, so the pipelines match a windowed run
+		VulkanObjects.SwapChainImageFormat.format = VK_FORMAT_B8G8R8A8_SRGB;
+		VulkanObjects.SwapChainImageFormat.colorSpace = VK_COLOR_SPACE_SRGB_NONLINEAR_KHR;
+	}
+
+	PROFILE_ZONE("ChooseDepthFormat")
+	{
+		VkFormat Formats[] = {
+			VK_FORMAT_D32_SFLOAT,
+			VK_FORMAT_D32_SFLOAT_S8_UINT,
+			VK_FORMAT_D24_UNORM_S8_UINT
+		};
+
+		VulkanObjects.DepthFormat == VK_FORMAT_UNDEFINED;
+
+		for (int i = 0; i < ARRAYSIZE(Formats); i++) {
+			VkFormatProperties Props;
+			vkGetPhysicalDeviceFormatProperties(VulkanObjects.PhysicalDevice, Formats[i], &Props);
+
+			if ((Props.optimalTilingFeatures & VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT) == VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT)
+			{
+				VulkanObjects.DepthFormat = Formats[i];
+				break;
+			}
+		}
+
+		if (VulkanObjects.DepthFormat == VK_FORMAT_UNDEFINED)
+			FailFastWithMessage("failed to find supported format!");
+	}
+
+	// with dynamic rendering the scene pass renders straight into image views, so there is
+	// no render pass object to create and no framebuffers to rebuild on resize
+	if (!VulkanObjects.UseDynamicRendering)
+	{
+		VkAttachmentDescription Attachments[2] = { 0 };
+		Attachments[0].format = VulkanObjects.SwapChainImageFormat.format;
+		Attachments[0].samples = VK_SAMPLE_COUNT_1_BIT;
+		Attachments[0].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+		Attachments[0].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+		Attachments[0].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		Attachments[0].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		Attachments[0].initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+		Attachments[0].finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+		Attachments[1].format = VulkanObjects.DepthFormat;
+		Attachments[1].samples = VK_SAMPLE_COUNT_1_BIT;
+		Attachments[1].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+		Attachments[1].storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		Attachments[1].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		Attachments[1].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		Attachments[1].initialLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+		Attachments[1].finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+		VkAttachmentReference ColorAttachmentRef = { 0 };
+		ColorAttachmentRef.attachment = 0;
+		ColorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+		VkAttachmentReference DepthAttachmentRef = { 0 };
+		DepthAttachmentRef.attachment = 1;
+		DepthAttachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+		VkSubpassDescription Subpass = { 0 };
+		Subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+		Subpass.colorAttachmentCount = 1;
+		Subpass.pColorAttachments = &ColorAttachmentRef;
+		Subpass.pDepthStencilAttachment = &DepthAttachmentRef;
+
+		// layout transitions and dependencies are derived by the frame graph and recorded
+		// outside the render pass, so the attachments stay in their attachment layouts here
+		VkRenderPassCreateInfo RenderPassInfo = { 0 };
+		RenderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+		RenderPassInfo.attachmentCount = ARRAYSIZE(Attachments);
+		RenderPassInfo.pAttachments = Attachments;
+		RenderPassInfo.subpassCount = 1;
+		RenderPassInfo.pSubpasses = &Subpass;
+		RenderPassInfo.dependencyCount = 0;
+		RenderPassInfo.pDependencies = NULL;
+
+		THROW_ON_FAIL_VK(vkCreateRenderPass(VulkanObjects.Device, &RenderPassInfo, NULL, &VulkanObjects.RenderPass));
+	}
+
+	VulkanObjects.ViewCount = Options.ViewCount;
+	VulkanObjects.ViewMode = Options.ViewMode;
+
+	if (VulkanObjects.ViewCount > 1)
+	{
+		// the layered attachments only exist on the dynamic rendering path
+		if (!VulkanObjects.UseDynamicRendering)
+		{
+			LogMessage("views: more than one view needs dynamic rendering, rendering one\n");
+			VulkanObjects.ViewCount = 1;
+		}
+		else if ((VulkanObjects.SurfaceCapabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_DST_BIT) == 0)
+		{
+			LogMessage("views: the surface does not support copying to swapchain images, rendering one\n");
+			VulkanObjects.ViewCount = 1;
+		}
+	}
+
+	// the particle pipeline is built for a single view
+	if (VulkanObjects.ViewCount > 1 && Options.ParticleCount > 0)
+	{
+		LogMessage("views: particles are not drawn with more than one view\n");
+		Options.ParticleCount = 0;
+	}
+
+	if (VulkanObjects.ViewCount > 1)
+		LogMessage("views: %u, %s\n", VulkanObjects.ViewCount, VIEW_MODE_NAMES[VulkanObjects.ViewMode]);
+
+	VulkanObjects.Resolution.Enabled = Options.ResolutionBudget > 0.0f;
+	VulkanObjects.Resolution.BudgetMilliseconds = Options.ResolutionBudget;
+	VulkanObjects.Resolution.Scale = DYNAMIC_RESOLUTION_MAX_SCALE;
+
+	if (VulkanObjects.Resolution.Enabled)
+	{
+		VkFormatProperties FormatProperties;
+		vkGetPhysicalDeviceFormatProperties(VulkanObjects.PhysicalDevice, VulkanObjects.SwapChainImageFormat.format, &FormatProperties);
+
+		VkFormatFeatureFlags BlitFeatures = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT;
+
+		// the views already render below the swapchain size, into their tiles
+		if (VulkanObjects.ViewCount > 1)
+		{
+			LogMessage("resolution: dynamic resolution is off with more than one view\n");
+			VulkanObjects.Resolution.Enabled = false;
+		}
+		else if (!VulkanObjects.UseDynamicRendering)
+		{
+			LogMessage("resolution: dynamic resolution needs dynamic rendering\n");
+			VulkanObjects.Resolution.Enabled = false;
+		}
+		else if ((VulkanObjects.SurfaceCapabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_DST_BIT) == 0 || (FormatProperties.optimalTilingFeatures & BlitFeatures) != BlitFeatures)
+		{
+			LogMessage("resolution: the swapchain format can't be blitted, dynamic resolution is off\n");
+			VulkanObjects.Resolution.Enabled = false;
+		}
+
+		VulkanObjects.Resolution.Filter = (FormatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT) ? VK_FILTER_LINEAR : VK_FILTER_NEAREST;
+	}
+
+	CreateSceneTimer(&VulkanObjects);
+
+	// the controller has nothing to go on without timestamps
+	if (VulkanObjects.Resolution.Enabled && VulkanObjects.SceneTimer.QueryPool == VK_NULL_HANDLE)
+	{
+		LogMessage("resolution: the graphics queue has no timestamps, dynamic resolution is off\n");
+		VulkanObjects.Resolution.Enabled = false;
+	}
+
+	if (VulkanObjects.Resolution.Enabled)
+		LogMessage("resolution: dynamic, %.2f ms budget for the scene\n", VulkanObjects.Resolution.BudgetMilliseconds);
+
+	VulkanObjects.Particles.Capacity = Options.ParticleCount;
+
+	PROFILE_ZONE("BuildScene")
+	{
+		InitSceneGraph(&VulkanObjects.Scene, 1 + Options.SceneNodes);
+
+		mat4 Identity = GLM_MAT4_IDENTITY_INIT;
+		VulkanObjects.ModelNode = AddSceneNode(&VulkanObjects.Scene, SCENE_NODE_NONE, Identity);
+
+		if (Options.SceneNodes > 0)
+		{
+			AddStressNodes(&VulkanObjects.Scene, Options.SceneNodes);
+			LogMessage("scene graph: %u static nodes added\n", Options.SceneNodes);
+		}
+	}
+
+	// before the first swapchain is created, which needs to know whether it is copied from
+	if (Options.CapturePath[0] != '\0')
+		StartFrameCapture(&VulkanObjects, Options.CapturePath, Options.CaptureFormat);
+
+	// every captured frame copies into a buffer of its own, which a cached frame can't follow
+	if (Options.CacheFrames && VulkanObjects.Capture.Enabled)
+		LogMessage("frame cache: off while capturing\n");
+
+	VulkanObjects.FrameCache.Enabled = Options.CacheFrames && !VulkanObjects.Capture.Enabled;
+
+	struct StartupContext Startup = { 0 };
+	Startup.VulkanObjects = &VulkanObjects;
+
+	PROFILE_ZONE("CreateDescriptorSetLayout")
+	{
+		VkDescriptorSetLayoutBinding Bindings[3] = { 0 };
+		Bindings[0].binding = 0;
+		Bindings[0].descriptorCount = 1;
+		Bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		Bindings[0].pImmutableSamplers = NULL;
+		Bindings[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+
+		Bindings[1].binding = 1;
+		Bindings[1].descriptorCount = 1;
+		Bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		Bindings[1].pImmutableSamplers = NULL;
+		Bindings[1].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+		Bindings[2].binding = 2;
+		Bindings[2].descriptorCount = 1;
+		Bindings[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		Bindings[2].pImmutableSamplers = NULL;
+		Bindings[2].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+
+		VkDescriptorSetLayoutCreateInfo LayoutInfo = { 0 };
+		LayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		LayoutInfo.bindingCount = ARRAYSIZE(Bindings);
+		LayoutInfo.pBindings = Bindings;
+
+		THROW_ON_FAIL_VK(vkCreateDescriptorSetLayout(VulkanObjects.Device, &LayoutInfo, NULL, &Startup.DescriptorSetLayout));
+	}
+
+	PROFILE_ZONE("CreateCommandPool")
+	{
+		VkCommandPoolCreateInfo PoolInfo = { 0 };
+		PoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		PoolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+		PoolInfo.queueFamilyIndex = VulkanObjects.QueueFamilyIndices.GraphicsFamily;
+		THROW_ON_FAIL_VK(vkCreateCommandPool(VulkanObjects.Device, &PoolInfo, NULL, &VulkanObjects.CommandPool));
+	}
+
+	VulkanObjects.GraphicsTimeline.Semaphore = CreateTimelineSemaphore(VulkanObjects.Device);
+	VulkanObjects.GraphicsTimeline.Value = 0;
+
+	// only kept for the lifetime of the process; the variants compiled later still share
+	// whatever the startup pipeline put into it
+	PROFILE_ZONE("CreatePipelineCache")
+	{
+		VkPipelineCacheCreateInfo CacheInfo = { 0 };
+		CacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+		THROW_ON_FAIL_VK(vkCreatePipelineCache(VulkanObjects.Device, &CacheInfo, NULL, &VulkanObjects.PipelineCache));
+	}
+
+	RunStartupJobs(JobSystem, &Startup);
+
+	// every slot starts out with the whole scene, after that only what changed is written
+	PROFILE_ZONE("UploadScene")
+	{
+		UpdateSceneGraph(&VulkanObjects.Scene);
+
+		for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+		{
+			UploadSceneInstances(&VulkanObjects, i);
+		}
+	}
+
+	struct PipelineRegistry PipelineRegistry = { 0 };
+	PipelineRegistry.VulkanObjects = &VulkanObjects;
+	PipelineRegistry.JobSystem = JobSystem;
+	VulkanObjects.Pipelines = &PipelineRegistry;
+	VulkanObjects.ScenePipeline = VulkanObjects.GraphicsPipeline;
+
+	// the benchmark draws with the startup pipeline only, and shouldn't share the cores
+	if (!Headless)
+		PipelineRegistryPrecompile(&PipelineRegistry);
+
+#ifdef ENABLE_PROFILING
+	GpuProfilerInit(&VulkanObjects, CalibratedTimestamps);
+#endif
+
+	PROFILE_ZONE("AllocateCommandBuffers")
+	{
+		VkCommandBufferAllocateInfo AllocInfo = { 0 };
+		AllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		AllocInfo.commandPool = VulkanObjects.CommandPool;
+		AllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		AllocInfo.commandBufferCount = ARRAYSIZE(VulkanObjects.CommandBuffers);
+		THROW_ON_FAIL_VK(vkAllocateCommandBuffers(VulkanObjects.Device, &AllocInfo, VulkanObjects.CommandBuffers));
+	}
+	
+	PROFILE_ZONE("CreateSemaphores")
+	{
+		VkSemaphoreCreateInfo SemaphoreInfo = { 0 };
+		SemaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+		for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+			THROW_ON_FAIL_VK(vkCreateSemaphore(VulkanObjects.Device, &SemaphoreInfo, NULL, &VulkanObjects.ImageAvailableSemaphores[i]));
+			THROW_ON_FAIL_VK(vkCreateSemaphore(VulkanObjects.Device, &SemaphoreInfo, NULL, &VulkanObjects.RenderFinishedSemaphores[i]));
+			VulkanObjects.FrameTimelineValues[i] = 0;
+		}
+	}
+
+	if (Options.DispatchBenchmarkDraws > 0)
+	{
+		PROFILE_ZONE("DispatchBenchmark")
+		{
+			RunDispatchBenchmark(&VulkanObjects, Options.DispatchBenchmarkDraws);
+		}
+	}
+
+	if (Headless)
+	{
+		PROFILE_ZONE("DrawBenchmark")
+		{
+			RunDrawBenchmark(&VulkanObjects, JobSystem, Options.DrawBenchmarkDraws);
+		}
+	}
+	else
+	{
+		struct RenderThreadContext RenderThreadContext = { 0 };
+		struct RenderThreadContext* RenderThread = &RenderThreadContext;
+		RenderThread->VulkanObjects = &VulkanObjects;
+		RenderThread->Window = Window;
+		RenderThread->FrameMode = Options.FrameMode;
+		RenderThread->TargetFps = Options.TargetFps;
+		RenderThread->StartupTime = StartupTime.QuadPart;
+		RenderThread->StartupThreadCount = JobSystem->WorkerCount + 1;
+
+		RenderThread->Queue.WakeEvent = CreateEventW(NULL, FALSE, FALSE, NULL);
+		VALIDATE_HANDLE(RenderThread->Queue.WakeEvent);
+
+		THROW_ON_FALSE(SetWindowLongPtrW(Window, GWLP_WNDPROC, (LONG_PTR)WndProc) != 0);
+
+	
+		DispatchMessageW(&(MSG) {
+			.hwnd = Window,
+			.message = WM_INIT,
+			.wParam = RenderThread,
+			.lParam = 0
+		});
+	
+		{
+			RECT ClientRect;
+			THROW_ON_FALSE(GetClientRect(Window, &ClientRect));
+
+			DispatchMessageW(&(MSG) {
+				.hwnd = Window,
+				.message = WM_SIZE,
+				.wParam = SIZE_RESTORED,
+				.lParam = MAKELONG(ClientRect.right - ClientRect.left, ClientRect.bottom - ClientRect.top)
+			});
+		}
+
+		// from here on the window thread only translates input into render commands
+		RenderThread->Thread = CreateThread(NULL, 0, RenderThreadProc, RenderThread, 0, NULL);
+		VALIDATE_HANDLE(RenderThread->Thread);
+
+		MSG Message = { 0 };
+
+		while (GetMessageW(&Message, NULL, 0, 0) > 0)
+		{
+			TranslateMessage(&Message);
+			DispatchMessageW(&Message);
+		}
+
+		// the only join. the thread posted WM_RENDER_THREAD_EXITED on its way out
+		WaitForSingleObject(RenderThread->Thread, INFINITE);
+
+		THROW_ON_FALSE(CloseHandle(RenderThread->Thread));
+		THROW_ON_FALSE(CloseHandle(RenderThread->Queue.WakeEvent));
+	}
+
+	vkDeviceWaitIdle(VulkanObjects.Device);
+
+	if (VulkanObjects.Capture.Enabled)
+		StopFrameCapture(&VulkanObjects);
+
+	ProcessDeferredDeletions(&VulkanObjects, true);
+
+	RenderGraphRelease(&VulkanObjects.FrameGraph, VulkanObjects.Device);
+
+	for (int i = 0; i < VulkanObjects.SwapChainImageCount; i++)
+	{
+		vkDestroyFramebuffer(VulkanObjects.Device, VulkanObjects.SwapChainFramebuffers[i], NULL);
+	}
+
+	for (int i = 0; i < VulkanObjects.SwapChainImageCount; i++)
+	{
+		vkDestroyImageView(VulkanObjects.Device, VulkanObjects.SwapChainImageViews[i], NULL);
+	}
+
+	if (!Headless)
+		vkDestroySwapchainKHR(VulkanObjects.Device, VulkanObjects.SwapChain, NULL);
+
+	if (VulkanObjects.Particles.Capacity > 0)
+		DestroyParticleSystem(&VulkanObjects.Particles, VulkanObjects.Device);
+
+	PipelineRegistryClear(&PipelineRegistry);
+
+	vkDestroyPipeline(VulkanObjects.Device, VulkanObjects.GraphicsPipeline, NULL);
+	vkDestroyPipelineCache(VulkanObjects.Device, VulkanObjects.PipelineCache, NULL);
+	vkDestroyPipelineLayout(VulkanObjects.Device, VulkanObjects.PipelineLayout, NULL);
+	vkDestroyRenderPass(VulkanObjects.Device, VulkanObjects.RenderPass, NULL);
+
+	for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+	{
+		vkDestroyBuffer(VulkanObjects.Device, Startup.UniformBuffers[i], NULL);
+		FreeDeviceMemory(VulkanObjects.Device, Startup.UniformBuffersMemory[i]);
+		vkDestroyBuffer(VulkanObjects.Device, Startup.InstanceBuffers[i], NULL);
+		FreeDeviceMemory(VulkanObjects.Device, Startup.InstanceBuffersMemory[i]);
+	}
+
+	DestroySceneGraph(&VulkanObjects.Scene);
+
+	vkDestroyDescriptorPool(VulkanObjects.Device, Startup.DescriptorPool, NULL);
+
+	vkDestroySampler(VulkanObjects.Device, Startup.TextureSampler, NULL);
+	vkDestroyImageView(VulkanObjects.Device, Startup.TextureImageView, NULL);
+
+	vkDestroyImage(VulkanObjects.Device, Startup.TextureImage, NULL);
+	FreeDeviceMemory(VulkanObjects.Device, Startup.TextureImageMemory);
+
+	vkDestroyDescriptorSetLayout(VulkanObjects.Device, Startup.DescriptorSetLayout, NULL);
+
+	vkDestroyBuffer(VulkanObjects.Device, VulkanObjects.IndexBuffer, NULL);
+	FreeDeviceMemory(VulkanObjects.Device, VulkanObjects.IndexBufferMemory);
+
+	vkDestroyBuffer(VulkanObjects.Device, VulkanObjects.VertexBuffer, NULL);
+	FreeDeviceMemory(VulkanObjects.Device, VulkanObjects.VertexBufferMemory);
+
+	for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+	{
+		vkDestroySemaphore(VulkanObjects.Device, VulkanObjects.RenderFinishedSemaphores[i], NULL);
+		vkDestroySemaphore(VulkanObjects.Device, VulkanObjects.ImageAvailableSemaphores[i], NULL);
+	}
+
+	vkDestroySemaphore(VulkanObjects.Device, VulkanObjects.GraphicsTimeline.Semaphore, NULL);
+
+	vkDestroyCommandPool(VulkanObjects.Device, VulkanObjects.CommandPool, NULL);
+
+#ifdef ENABLE_PROFILING
+	vkDestroyQueryPool(VulkanObjects.Device, VulkanObjects.GpuProfiler.QueryPool, NULL);
+#endif
+
+	vkDestroyQueryPool(VulkanObjects.Device, VulkanObjects.SceneTimer.QueryPool, NULL);
+
+	ReportLeakedDeviceMemory();
+
+	vkDestroyDevice(VulkanObjects.Device, NULL);
+
+	JobSystemDestroy(JobSystem);
+
+#ifdef ENABLE_PROFILING
+	ProfileWriteTrace(L"MinimalVulkan-trace.json");
+#endif
+
+#ifdef _DEBUG
+		DestroyDebugUtilsMessengerEXT(VulkanInstance, VulkanObjects.DebugMessenger, NULL);
+#endif
+
+	if (!Headless)
+		vkDestroySurfaceKHR(VulkanInstance, VulkanObjects.Surface, NULL);
+	vkDestroyInstance(VulkanInstance, NULL);
+
+	THROW_ON_FALSE(FreeLibrary(VulkanLibrary));
+
+	if (AssetPack.Base != NULL)
+		AssetPackClose(&AssetPack);
+
+	THROW_ON_FALSE(UnregisterClassW(WindowClassName, Instance));
+
+	THROW_ON_FALSE(DestroyCursor(Cursor));
+	THROW_ON_FALSE(DestroyIcon(Icon));
+
+	return EXIT_SUCCESS;
+}
+
+LRESULT CALLBACK PreInitProc(HWND Window, UINT message, WPARAM wParam, LPARAM lParam)
+{
+	switch (message)
+	{
+	case WM_DESTROY:
+		PostQuitMessage(0);
+		break;
+	default:
+		return DefWindowProcW(Window, message, wParam, lParam);
+	}
+	return 0;
+}
+
+LRESULT CALLBACK WndProc(HWND Window, UINT message, WPARAM wParam, LPARAM lParam)
+{
+	static struct RenderThreadContext* RenderThread = NULL;
+
+	static POINT LastCursor = { 0 };
+
+	switch (message)
+	{
+	case WM_INIT:
+		RenderThread = ((struct RenderThreadContext*)wParam);
+		break;
+	case WM_SIZE:
+	{
+		struct RenderCommand Command = { 0 };
+		Command.Type = RENDER_COMMAND_RESIZE;
+
+		if (wParam != SIZE_MINIMIZED)
+		{
+			Command.Resize.Width = LOWORD(lParam);
+			Command.Resize.Height = HIWORD(lParam);
+		}
+
+		RenderCommandQueuePush(&RenderThread->Queue, &Command);
+		break;
+	}
+	case WM_PAINT:
+	{
+		// the render thread presents on its own; painting only tells it that the window
+		// contents were damaged, which matters when it renders on demand
+		THROW_ON_FALSE(ValidateRect(Window, NULL));
+
+		struct RenderCommand Command = { 0 };
+		Command.Type = RENDER_COMMAND_REDRAW;
+		RenderCommandQueuePush(&RenderThread->Queue, &Command);
+		break;
+	}
+	case WM_LBUTTONDOWN:
+		LastCursor.x = (short)LOWORD(lParam);
+		LastCursor.y = (short)HIWORD(lParam);
+		SetCapture(Window);
+		break;
+	case WM_LBUTTONUP:
+		THROW_ON_FALSE(ReleaseCapture());
+		break;
+	case WM_MOUSEMOVE:
+		if (wParam & MK_LBUTTON)
+		{
+			POINT Cursor = { (short)LOWORD(lParam), (short)HIWORD(lParam) };
+			RenderCommandQueueAddCameraInput(&RenderThread->Queue, Cursor.x - LastCursor.x, Cursor.y - LastCursor.y, 0);
+			LastCursor = Cursor;
+		}
+		break;
+	case WM_MOUSEWHEEL:
+		RenderCommandQueueAddCameraInput(&RenderThread->Queue, 0, 0, GET_WHEEL_DELTA_WPARAM(wParam));
+		break;
+	case WM_KEYDOWN:
+		switch (wParam)
+		{
+		case VK_ESCAPE:
+			THROW_ON_FALSE(PostMessageW(Window, WM_CLOSE, 0, 0));
+			break;
+		case 'F':
+		{
+			struct RenderCommand Command = { 0 };
+			Command.Type = RENDER_COMMAND_CYCLE_FRAME_MODE;
+			RenderCommandQueuePush(&RenderThread->Queue, &Command);
+			break;
+		}
+		case 'M':
+		{
+			struct RenderCommand Command = { 0 };
+			Command.Type = RENDER_COMMAND_CYCLE_MATERIAL;
+			RenderCommandQueuePush(&RenderThread->Queue, &Command);
+			break;
+		}
+		}
+		break;
+	case WM_SYSKEYDOWN:
+		if (wParam == VK_RETURN && (lParam & 0x60000000) == 0x20000000)
+		{
+			struct RenderCommand Command = { 0 };
+			Command.Type = RENDER_COMMAND_TOGGLE_FULLSCREEN;
+			RenderCommandQueuePush(&RenderThread->Queue, &Command);
+		}
+		break;
+	case WM_APPLY_FULLSCREEN:
+		if (wParam)
+		{
+			THROW_ON_FALSE(SetWindowLongPtrW(Window, GWL_EXSTYLE, WS_EX_TOPMOST) != 0);
+			THROW_ON_FALSE(SetWindowLongPtrW(Window, GWL_STYLE, 0) != 0);
+
+			THROW_ON_FALSE(ShowWindow(Window, SW_SHOWMAXIMIZED));
+		}
+		else
+		{
+			THROW_ON_FALSE(SetWindowLongPtrW(Window, GWL_STYLE, WS_OVERLAPPEDWINDOW) != 0);
+			THROW_ON_FALSE(SetWindowLongPtrW(Window, GWL_EXSTYLE, 0) != 0);
+
+			THROW_ON_FALSE(ShowWindow(Window, SW_SHOWMAXIMIZED));
+		}
+		break;
+	case WM_CLOSE:
+	{
+		// the surface must outlive the last present, so the render thread is stopped
+		// before the window goes away. this thread keeps pumping messages meanwhile:
+		// presenting and creating a swapchain can send messages to the window and wait
+		// for them to be handled
+		struct RenderCommand Command = { 0 };
+		Command.Type = RENDER_COMMAND_QUIT;
+		RenderCommandQueuePush(&RenderThread->Queue, &Command);
+		break;
+	}
+	case WM_RENDER_THREAD_EXITED:
+		THROW_ON_FALSE(DestroyWindow(Window));
+		break;
+	case WM_DESTROY:
+		PostQuitMessage(0);
+		break;
+	default:
+		return DefWindowProcW(Window, message, wParam, lParam);
+	}
+	return 0;
+}
@@ -0,0 +1,66 @@
+#version 450
+
+layout(local_size_x = 256) in;
+
+struct Particle {
+    vec4 positionLife;
+    vec4 velocityMaxLife;
+};
+
+layout(std430, binding = 1) writeonly buffer DestinationParticles {
+    Particle particles[];
+} destination;
+
+layout(std430, binding = 3) buffer DestinationArgs {
+    uint vertexCount;
+    uint instanceCount;
+    uint firstVertex;
+    uint firstInstance;
+} destinationArgs;
+
+layout(push_constant) uniform SimulationConstants {
+    float deltaTime;
+    float time;
+    uint emitCount;
+    uint capacity;
+    uint seed;
+} constants;
+
+uint hash(uint x) {
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+}
+
+float random(inout uint state) {
+    state = hash(state);
+    return float(state) / 4294967295.0;
+}
+
+void main() {
+    uint index = gl_GlobalInvocationID.x;
+
+    if (index >= constants.emitCount)
+        return;
+
+    // runs after the survivors were compacted, so new particles only take the space left.
+    // a rejected slot gives its increment back, which leaves the count at the capacity
+    uint slot = atomicAdd(destinationArgs.instanceCount, 1);
+
+    if (slot >= constants.capacity) {
+        atomicAdd(destinationArgs.instanceCount, uint(-1));
+        return;
+    }
+
+    uint state = constants.seed ^ (index * 0x9e3779b9u);
+    float angle = random(state) * 6.2831853;
+    float spread = random(state) * 0.6;
+    float speed = 1.5 + random(state);
+    float life = 2.0 + random(state) * 2.0;
+
+    destination.particles[slot].positionLife = vec4(0.0, 0.0, 0.05, life);
+    destination.particles[slot].velocityMaxLife = vec4(cos(angle) * spread, sin(angle) * spread, speed, life);
+}
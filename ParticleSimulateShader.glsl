@@ -0,0 +1,67 @@
+#version 450
+
+layout(local_size_x = 256) in;
+
+struct Particle {
+    vec4 positionLife;
+    vec4 velocityMaxLife;
+};
+
+// last frame's particles. the previous frame may still be drawing them, so they are only read
+layout(std430, binding = 0) readonly buffer SourceParticles {
+    Particle particles[];
+} source;
+
+layout(std430, binding = 1) writeonly buffer DestinationParticles {
+    Particle particles[];
+} destination;
+
+layout(std430, binding = 2) readonly buffer SourceArgs {
+    uint vertexCount;
+    uint instanceCount;
+    uint firstVertex;
+    uint firstInstance;
+} sourceArgs;
+
+// doubles as this frame's indirect draw and as next frame's source count
+layout(std430, binding = 3) buffer DestinationArgs {
+    uint vertexCount;
+    uint instanceCount;
+    uint firstVertex;
+    uint firstInstance;
+} destinationArgs;
+
+layout(push_constant) uniform SimulationConstants {
+    float deltaTime;
+    float time;
+    uint emitCount;
+    uint capacity;
+    uint seed;
+} constants;
+
+void main() {
+    uint index = gl_GlobalInvocationID.x;
+
+    if (index >= sourceArgs.instanceCount)
+        return;
+
+    Particle particle = source.particles[index];
+
+    particle.positionLife.w -= constants.deltaTime;
+
+    if (particle.positionLife.w <= 0.0)
+        return;
+
+    particle.velocityMaxLife.z -= 2.5 * constants.deltaTime;
+    particle.positionLife.xyz += particle.velocityMaxLife.xyz * constants.deltaTime;
+
+    // bounce off the ground plane
+    if (particle.positionLife.z < 0.0) {
+        particle.positionLife.z = -particle.positionLife.z;
+        particle.velocityMaxLife.z *= -0.5;
+    }
+
+    // compacts the survivors to the front of the destination
+    uint slot = atomicAdd(destinationArgs.instanceCount, 1);
+    destination.particles[slot] = particle;
+}
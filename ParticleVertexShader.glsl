@@ -0,0 +1,25 @@
+#version 450
+
+layout(push_constant) uniform ParticleConstants {
+    mat4 viewProj;
+    vec4 cameraRight;
+    vec4 cameraUp;
+} constants;
+
+layout(location = 0) in vec4 inPositionLife;
+layout(location = 1) in vec4 inVelocityMaxLife;
+
+layout(location = 0) out vec2 fragCorner;
+layout(location = 1) out vec4 fragColor;
+
+void main() {
+    // a camera facing quad drawn as a 4 vertex strip
+    vec2 corner = vec2(gl_VertexIndex & 1, gl_VertexIndex >> 1) * 2.0 - 1.0;
+    vec3 position = inPositionLife.xyz + (constants.cameraRight.xyz * corner.x + constants.cameraUp.xyz * corner.y) * 0.015;
+
+    float age = 1.0 - clamp(inPositionLife.w / inVelocityMaxLife.w, 0.0, 1.0);
+
+    gl_Position = constants.viewProj * vec4(position, 1.0);
+    fragCorner = corner;
+    fragColor = vec4(mix(vec3(1.0, 0.8, 0.3), vec3(0.8, 0.1, 0.05), age), 1.0 - age);
+}
@@ -0,0 +1,52 @@
+#version 450
+#extension GL_EXT_multiview : require
+#extension GL_EXT_buffer_reference : require
+
+// must match MAX_VIEWS in MinimalVulkan.c
+#define MAX_VIEWS 4
+
+// struct Vertex in MinimalVulkan.c: position, color and texture coordinate, 8 floats
+#define VERTEX_FLOATS 8
+
+layout(binding = 0) uniform UniformBufferObject {
+    mat4 view[MAX_VIEWS];
+    mat4 proj[MAX_VIEWS];
+} ubo;
+
+layout(std430, binding = 2) readonly buffer InstanceBuffer {
+    mat4 model[];
+} instances;
+
+layout(buffer_reference, std430, buffer_reference_align = 4) readonly buffer VertexData {
+    float v[];
+};
+
+// 16 bit indices, two to a word
+layout(buffer_reference, std430, buffer_reference_align = 4) readonly buffer IndexData {
+    uint i[];
+};
+
+// must match struct ScenePushConstants in MinimalVulkan.c. the mesh is two addresses, so
+// switching meshes binds nothing
+layout(push_constant) uniform ViewConstants {
+    uint firstView;
+    layout(offset = 8) VertexData vertices;
+    IndexData indices;
+} constants;
+
+layout(location = 0) out vec3 fragColor;
+layout(location = 1) out vec2 fragTexCoord;
+
+void main() {
+    uint word = constants.indices.i[gl_VertexIndex >> 1];
+    uint index = (gl_VertexIndex & 1) != 0 ? word >> 16 : word & 0xffff;
+    uint base = index * VERTEX_FLOATS;
+
+    VertexData vertices = constants.vertices;
+    vec3 position = vec3(vertices.v[base], vertices.v[base + 1], vertices.v[base + 2]);
+
+    uint view = constants.firstView + gl_ViewIndex;
+    gl_Position = ubo.proj[view] * ubo.view[view] * instances.model[gl_InstanceIndex] * vec4(position, 1.0);
+    fragColor = vec3(vertices.v[base + 3], vertices.v[base + 4], vertices.v[base + 5]);
+    fragTexCoord = vec2(vertices.v[base + 6], vertices.v[base + 7]);
+}
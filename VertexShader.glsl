@@ -1,11 +1,24 @@
 #version 450
+#extension GL_EXT_multiview : require
+
+// must match MAX_VIEWS in MinimalVulkan.c
+#define MAX_VIEWS 4
 
 layout(binding = 0) uniform UniformBufferObject {
-    mat4 model;
-    mat4 view;
-    mat4 proj;
+    mat4 view[MAX_VIEWS];
+    mat4 proj[MAX_VIEWS];
 } ubo;
 
+// a world transform per scene node. each instance of the draw is one node
+layout(std430, binding = 2) readonly buffer InstanceBuffer {
+    mat4 model[];
+} instances;
+
+// the first view of the pass. a multiview pass renders all of them and gl_ViewIndex picks one
+layout(push_constant) uniform ViewConstants {
+    uint firstView;
+} constants;
+
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inColor;
 layout(location = 2) in vec2 inTexCoord;
@@ -14,7 +27,8 @@ layout(location = 0) out vec3 fragColor;
 layout(location = 1) out vec2 fragTexCoord;
 
 void main() {
-    gl_Position = ubo.proj * ubo.view * ubo.model * vec4(inPosition, 1.0);
+    uint view = constants.firstView + gl_ViewIndex;
+    gl_Position = ubo.proj[view] * ubo.view[view] * instances.model[gl_InstanceIndex] * vec4(inPosition, 1.0);
     fragColor = inColor;
     fragTexCoord = inTexCoord;
 }